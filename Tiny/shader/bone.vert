@@ -1,5 +1,6 @@
 #include "shader/util.glsl"
 #include "shader/vtf.glsl"
+#include "shader/material.glsl"
 
 uniform mat4 viewProjectMatrix;
 uniform BindlessSampler2D boneTex[MAX_BONE_TEX];
@@ -11,9 +12,8 @@ uniform vec2 camPara;
 
 layout (location = 0) in vec3 vertex;
 layout (location = 1) in vec3 normal;
-layout (location = 2) in vec4 texcoord;
-layout (location = 3) in vec2 texid;
-layout (location = 4) in vec3 color;
+layout (location = 2) in vec2 texcoord;
+layout (location = 3) in float material;
 layout (location = 5) in vec3 tangent;
 layout (location = 6) in vec4 boneids;
 layout (location = 7) in vec4 weights;
@@ -48,13 +48,13 @@ void main() {
 	mat4 modelMat = convertMat(mat3x4(modelMatrix[0], modelMatrix[1], modelMatrix[2]));
 
 #ifndef ShadowPass
-	vColor = MatScale * color * 0.005;
+	vColor = MatScale * GetMaterialColor(material) * 0.005;
 	mat3 matRot = mat3(modelMat);
 	mat3 normalMat = matRot * mat3(boneMat);
 	vNormal = normalMat * normal;
 	vTBN = normalMat * GetTBN(normal, tangent);
-	vTexcoord = texcoord.xy;
-	vTexid = vec4(texcoord.zw, texid);
+	vTexcoord = texcoord;
+	vTexid = GetMaterialTexids(material);
 #endif
 
 	vec4 modelPosition = modelMat * position;
@@ -1,4 +1,5 @@
 #include "shader/util.glsl"
+#include "shader/material.glsl"
 
 uniform mat4 viewProjectMatrix;
 #ifdef BillPass
@@ -10,14 +11,17 @@ uniform mat4 projectMatrix, viewMatrix;
 uniform vec2 camPara;
 #endif
 
-layout (location = 0) in vec3 vertex;
-layout (location = 1) in vec3 normal;
-layout (location = 2) in vec4 texcoord;
-layout (location = 3) in vec2 texid;
-layout (location = 4) in vec3 color;
-layout (location = 5) in vec3 tangent;
+layout (location = 0) in vec4 vertex; // xyz in mesh bounds, w is mesh slot
+layout (location = 1) in vec4 frame; // Octahedral normal & tangent angle
+layout (location = 2) in vec2 texcoord; // In mesh uv bounds
+layout (location = 3) in float material;
 layout (location = 8) in mat4 modelMatrix;
 
+// (posMin, uvMin.x), (posSize, uvMin.y), (uvSize, 0, 0) of each mesh
+layout(binding = 8, std430) readonly buffer MeshBounds {
+	vec4 meshBounds[];
+};
+
 #ifndef LowPass
 out vec2 vTexcoord;
 flat out vec4 vTexid;
@@ -29,22 +33,32 @@ out mat3 vTBN;
 #endif
 
 void main() {
+	uint slot = UnpackMeshSlot(vertex.w) * 3;
+	vec4 bound0 = meshBounds[slot], bound1 = meshBounds[slot + 1], bound2 = meshBounds[slot + 2];
+	vec3 position = bound0.xyz + vertex.xyz * bound1.xyz;
+#ifndef LowPass
+	vec2 uv = vec2(bound0.w, bound1.w) + texcoord * bound2.xy;
+	vec4 texids = GetMaterialTexids(material);
+#endif
+
 #ifndef BillPass
 		#ifndef ShadowPass
+			vec3 normal = UnpackOctNormal(frame.xy);
+			vec3 tangent = UnpackTangent(normal, frame.z);
 			mat3 matRot = mat3(modelMatrix);
 			vNormal = matRot * normal;
-			vTBN = matRot * GetTBN(normalize(normal), normalize(tangent));
-			vColor = COLOR_SCALE * color;
+			vTBN = matRot * GetTBN(normal, tangent);
+			vColor = COLOR_SCALE * GetMaterialColor(material);
 		#endif
 		#ifndef LowPass
-			vTexcoord = texcoord.xy;
-			vTexid = vec4(texcoord.zw, texid);
+			vTexcoord = uv;
+			vTexid = texids;
 		#endif
-		vec4 worldVertex = modelMatrix * vec4(vertex, 1.0);
+		vec4 worldVertex = modelMatrix * vec4(position, 1.0);
 #else
-		vec3 position = modelMatrix[0].xyz;
+		vec3 center = modelMatrix[0].xyz;
 		vec3 board = modelMatrix[1].xyz;
-		vec2 size = vertex.xy * board.xy;
+		vec2 size = position.xy * board.xy;
 		vec3 right = size.x * viewRight;
 		#ifdef ShadowPass
 			vec3 top = vec3(0.0, size.y, 0.0);
@@ -52,10 +66,10 @@ void main() {
 			vec3 top = size.y * UP_VEC3;
 		#endif
 		#ifndef LowPass
-			vTexcoord = texcoord.xy; 
-			vTexid = vec4(texcoord.zw, 0.0, 0.0);
+			vTexcoord = uv; 
+			vTexid = vec4(texids.xy, 0.0, 0.0);
 		#endif
-		vec4 worldVertex = vec4(position + right + top, 1.0);
+		vec4 worldVertex = vec4(center + right + top, 1.0);
 #endif
 
 #ifdef ShadowPass
@@ -0,0 +1,17 @@
+// Filled by MaterialBuffer, 3 vec4 per material:
+// texids, (exTexids, 0, 0), (ambient, diffuse, specular, 0) in 0-255
+layout(binding = 9, std430) readonly buffer MaterialTable {
+	vec4 materialTable[];
+};
+
+vec4 GetMaterialTexids(float material) {
+	return materialTable[uint(material) * 3];
+}
+
+vec2 GetMaterialExTexids(float material) {
+	return materialTable[uint(material) * 3 + 1].xy;
+}
+
+vec3 GetMaterialColor(float material) {
+	return materialTable[uint(material) * 3 + 2].xyz;
+}
\ No newline at end of file
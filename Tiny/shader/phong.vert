@@ -1,4 +1,5 @@
 #include "shader/util.glsl"
+#include "shader/material.glsl"
 
 uniform mat3x4 modelMatrices[100];
 uniform mat4 viewProjectMatrix;
@@ -10,9 +11,8 @@ uniform vec2 camPara;
 
 layout (location = 0) in vec3 vertex;
 layout (location = 1) in vec3 normal;
-layout (location = 2) in vec4 texcoord;
-layout (location = 3) in vec4 texid;
-layout (location = 4) in vec3 color;
+layout (location = 2) in vec2 texcoord;
+layout (location = 3) in float material;
 layout (location = 5) in vec3 tangent;
 layout (location = 6) in float objectid;
 
@@ -33,11 +33,11 @@ void main() {
 	mat3 normalMat = mat3(matModel);
 	vNormal = normalMat * normal;
 	vTBN = normalMat * GetTBN(normalize(normal), normalize(tangent));
-	vColor = COLOR_SCALE * color;
+	vColor = COLOR_SCALE * GetMaterialColor(material);
 #endif 
 #ifndef LowPass
-	vTexcoord = texcoord.xy;
-	vTexid = texid;
+	vTexcoord = texcoord;
+	vTexid = GetMaterialTexids(material);
 #endif
 
 #ifdef ShadowPass
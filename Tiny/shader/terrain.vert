@@ -1,4 +1,5 @@
 #include "shader/util.glsl"
+#include "shader/material.glsl"
 
 uniform mat4 viewProjectMatrix;
 uniform vec3 mapTrans, mapScale;
@@ -6,9 +7,8 @@ uniform vec4 mapInfo;
 
 layout (location = 0) in vec3 vertex;
 layout (location = 1) in vec3 normal;
-layout (location = 2) in vec4 texcoord;
-layout (location = 3) in vec4 texid;
-layout (location = 4) in vec3 color;
+layout (location = 2) in vec2 texcoord;
+layout (location = 3) in float material;
 layout (location = 5) in vec3 tangent;
 
 out vec2 vTexcoord;
@@ -20,7 +20,7 @@ out mat3 vTBN;
 out vec4 vWorldVert;
 
 void main() {
-	vColor = vec3(0.1, 1.8, 1.0) * color * 0.005;
+	vColor = vec3(0.1, 1.8, 1.0) * GetMaterialColor(material) * 0.005;
 	
 	vec4 worldVertex = vec4(vertex, 1.0);
 	vec2 coord = (worldVertex.xz - mapTrans.xz) / (mapScale.xz * mapInfo.zw);
@@ -29,8 +29,8 @@ void main() {
 	vNormal = normal;
 	vTBN = GetTBN(normalize(normal), normalize(tangent));
 	
-	vTexcoord = texcoord.xy;
-	vRMid = texcoord.zw;
-	vTexid = texid;
+	vTexcoord = texcoord;
+	vRMid = GetMaterialExTexids(material);
+	vTexid = GetMaterialTexids(material);
 	gl_Position = viewProjectMatrix * worldVertex;
 }
\ No newline at end of file
@@ -80,6 +80,30 @@ mat3 GetTBN(vec3 normal, vec3 tangent) {
 	return mat3(tangent, bitangent, normal);
 }
 
+// Packed static vertex, encoder is vertexPack.cpp
+uint UnpackMeshSlot(float w) {
+	return uint(w * 65535.0 + 0.5);
+}
+
+vec3 UnpackOctNormal(vec2 oct) {
+	vec2 f = oct * 2.0 - 1.0;
+	vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+vec3 UnpackTangent(vec3 normal, float angle) {
+	float s = normal.z >= 0.0 ? 1.0 : -1.0;
+	float a = -1.0 / (s + normal.z);
+	float b = normal.x * normal.y * a;
+	vec3 b1 = vec3(1.0 + s * normal.x * normal.x * a, s * b, -s * normal.x);
+	vec3 b2 = vec3(b, s + normal.y * normal.y * a, -normal.y);
+	float r = angle * 6.2831853;
+	return cos(r) * b1 + sin(r) * b2;
+}
+
 mat3 GetIdentity() {
 	return mat3(
 		1.0, 0.0, 0.0,
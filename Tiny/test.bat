@@ -0,0 +1,6 @@
+@echo off
+rem Run from here so models and shaders are found, names of tests may be given to run only those
+rem test.bat -benchmark [frames] runs headless benchmark and saves benchmark.txt here
+rem test.bat -bake models\house.obj models\house.mtl [vt] writes house.t3m with its meshlets ahead of time
+bins\tests.exe %*
+exit /b %errorlevel%
@@ -0,0 +1,269 @@
+#include "animCompress.h"
+#include <math.h>
+
+#define ANIM_UNORM15 32767.0f
+#define ANIM_SNORM16 32767.0f
+#define ANIM_SQRT2 1.41421356f
+
+// Bone values of one frame as decoder sees them
+struct BoneKey {
+	vec3 translation, scale;
+	vec4 rotation;
+};
+
+static void MatrixToQuat(const float r[3][3], vec4& q) {
+	float trace = r[0][0] + r[1][1] + r[2][2];
+	if (trace > 0.0) {
+		float s = sqrtf(trace + 1.0) * 2.0;
+		q = vec4((r[2][1] - r[1][2]) / s, (r[0][2] - r[2][0]) / s, (r[1][0] - r[0][1]) / s, 0.25 * s);
+	} else if (r[0][0] > r[1][1] && r[0][0] > r[2][2]) {
+		float s = sqrtf(1.0 + r[0][0] - r[1][1] - r[2][2]) * 2.0;
+		q = vec4(0.25 * s, (r[0][1] + r[1][0]) / s, (r[0][2] + r[2][0]) / s, (r[2][1] - r[1][2]) / s);
+	} else if (r[1][1] > r[2][2]) {
+		float s = sqrtf(1.0 + r[1][1] - r[0][0] - r[2][2]) * 2.0;
+		q = vec4((r[0][1] + r[1][0]) / s, 0.25 * s, (r[1][2] + r[2][1]) / s, (r[0][2] - r[2][0]) / s);
+	} else {
+		float s = sqrtf(1.0 + r[2][2] - r[0][0] - r[1][1]) * 2.0;
+		q = vec4((r[0][2] + r[2][0]) / s, (r[1][2] + r[2][1]) / s, 0.25 * s, (r[1][0] - r[0][1]) / s);
+	}
+	float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	q = length > 0.0 ? q / length : vec4(0.0, 0.0, 0.0, 1.0);
+}
+
+// Rows of bone matrix are (rotation * scale, translation), so scale is length of each 3x3 column
+static void Decompose(const float* bone, BoneKey& key) {
+	vec3 columns[3];
+	for (int c = 0; c < 3; c++)
+		columns[c] = vec3(bone[c], bone[4 + c], bone[8 + c]);
+	key.translation = vec3(bone[3], bone[7], bone[11]);
+	key.scale = vec3(columns[0].GetLength(), columns[1].GetLength(), columns[2].GetLength());
+	if (columns[0].DotProduct(columns[1].CrossProduct(columns[2])) < 0.0) key.scale.x = -key.scale.x;
+
+	float r[3][3];
+	float scales[3] = { key.scale.x, key.scale.y, key.scale.z };
+	for (int c = 0; c < 3; c++) {
+		bool empty = fabsf(scales[c]) < 1e-8;
+		r[0][c] = empty ? (c == 0 ? 1.0 : 0.0) : columns[c].x / scales[c];
+		r[1][c] = empty ? (c == 1 ? 1.0 : 0.0) : columns[c].y / scales[c];
+		r[2][c] = empty ? (c == 2 ? 1.0 : 0.0) : columns[c].z / scales[c];
+	}
+	MatrixToQuat(r, key.rotation);
+}
+
+static void Compose(const BoneKey& key, float* bone) {
+	const vec4& q = key.rotation;
+	float r[3][3] = {
+		{ 1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y - q.w * q.z), 2.0f * (q.x * q.z + q.w * q.y) },
+		{ 2.0f * (q.x * q.y + q.w * q.z), 1.0f - 2.0f * (q.x * q.x + q.z * q.z), 2.0f * (q.y * q.z - q.w * q.x) },
+		{ 2.0f * (q.x * q.z - q.w * q.y), 2.0f * (q.y * q.z + q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y) } };
+	float scales[3] = { key.scale.x, key.scale.y, key.scale.z };
+	float translation[3] = { key.translation.x, key.translation.y, key.translation.z };
+	for (int row = 0; row < 3; row++) {
+		for (int c = 0; c < 3; c++)
+			bone[row * 4 + c] = r[row][c] * scales[c];
+		bone[row * 4 + 3] = translation[row];
+	}
+}
+
+// Translation & scale are lerped, rotation is nlerped along shorter arc
+static void Interpolate(const BoneKey& a, const BoneKey& b, float alpha, float* bone) {
+	BoneKey key;
+	key.translation = a.translation + (b.translation - a.translation) * alpha;
+	key.scale = a.scale + (b.scale - a.scale) * alpha;
+	vec4 qb = b.rotation;
+	if (a.rotation.x * qb.x + a.rotation.y * qb.y + a.rotation.z * qb.z + a.rotation.w * qb.w < 0.0)
+		qb = vec4(-qb.x, -qb.y, -qb.z, -qb.w);
+	vec4 q = a.rotation + (qb - a.rotation) * alpha;
+	float length = sqrtf(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	key.rotation = length > 0.0 ? q / length : vec4(0.0, 0.0, 0.0, 1.0);
+	Compose(key, bone);
+}
+
+// Largest component is dropped & made positive, other 3 lie in +-1/sqrt2 & take 15 bits each
+// Index of dropped one goes to top bits of first 2 shorts
+static void PackRotation(const vec4& q, ushort* packed) {
+	float c[4] = { q.x, q.y, q.z, q.w };
+	int largest = 0;
+	for (int i = 1; i < 4; i++)
+		largest = fabsf(c[i]) > fabsf(c[largest]) ? i : largest;
+	float sign = c[largest] < 0.0 ? -1.0 : 1.0;
+	ushort values[3];
+	for (int i = 0, n = 0; i < 4; i++) {
+		if (i == largest) continue;
+		float unorm = c[i] * sign * ANIM_SQRT2 * 0.5 + 0.5;
+		unorm = unorm < 0.0 ? 0.0 : (unorm > 1.0 ? 1.0 : unorm);
+		values[n++] = (ushort)(unorm * ANIM_UNORM15 + 0.5);
+	}
+	packed[0] = values[0] | ((largest & 1) << 15);
+	packed[1] = values[1] | ((largest >> 1) << 15);
+	packed[2] = values[2];
+}
+
+static vec4 UnpackRotation(const ushort* packed) {
+	int largest = (packed[0] >> 15) | ((packed[1] >> 15) << 1);
+	float c[4], sum = 0.0;
+	for (int i = 0, n = 0; i < 4; i++) {
+		if (i == largest) continue;
+		c[i] = ((packed[n++] & 0x7fff) / ANIM_UNORM15 * 2.0 - 1.0) / ANIM_SQRT2;
+		sum += c[i] * c[i];
+	}
+	c[largest] = sqrtf(sum < 1.0 ? 1.0 - sum : 0.0);
+	return vec4(c[0], c[1], c[2], c[3]);
+}
+
+static short PackScale(float scale, float range) {
+	float snorm = scale / range;
+	snorm = snorm < -1.0 ? -1.0 : (snorm > 1.0 ? 1.0 : snorm);
+	return (short)floorf(snorm * ANIM_SNORM16 + 0.5);
+}
+
+static void GetKey(const AnimKeys& keys, int k, BoneKey& key) {
+	const float* t = keys.translations + k * 3;
+	const short* s = keys.scales + k * 3;
+	float scale = keys.scaleRange / ANIM_SNORM16;
+	key.translation = vec3(t[0], t[1], t[2]);
+	key.scale = vec3(s[0] * scale, s[1] * scale, s[2] * scale);
+	key.rotation = UnpackRotation(keys.rotations + k * 3);
+}
+
+void DecodeAnimKeys(const AnimKeys& keys, float* data) {
+	int stride = keys.boneCount * 12;
+	for (int b = 0; b < keys.boneCount; b++) {
+		uint first = keys.tracks[b * 2], count = keys.tracks[b * 2 + 1];
+		BoneKey a, next;
+		GetKey(keys, first, a);
+		for (uint k = 0; k + 1 < count; k++) {
+			int fa = keys.frames[first + k], fb = keys.frames[first + k + 1];
+			GetKey(keys, first + k + 1, next);
+			for (int f = fa; f < fb; f++)
+				Interpolate(a, next, (float)(f - fa) / (fb - fa), data + f * stride + b * 12);
+			a = next;
+		}
+		Compose(a, data + keys.frames[first + count - 1] * stride + b * 12);
+	}
+}
+
+void SampleAnimKeys(const AnimKeys& keys, float frame, float* bones) {
+	frame = frame < 0.0 ? 0.0 : (frame > keys.frameCount - 1 ? keys.frameCount - 1 : frame);
+	for (int b = 0; b < keys.boneCount; b++) {
+		uint first = keys.tracks[b * 2], count = keys.tracks[b * 2 + 1];
+		const ushort* frames = keys.frames + first;
+		// Last key at or before frame
+		uint low = 0, high = count - 1;
+		while (low < high) {
+			uint mid = (low + high + 1) / 2;
+			if (frames[mid] <= frame) low = mid;
+			else high = mid - 1;
+		}
+		BoneKey a, next;
+		GetKey(keys, first + low, a);
+		if (low + 1 >= count) {
+			Compose(a, bones + b * 12);
+			continue;
+		}
+		GetKey(keys, first + low + 1, next);
+		Interpolate(a, next, (frame - frames[low]) / (frames[low + 1] - frames[low]), bones + b * 12);
+	}
+}
+
+float GetBoneError(const float* a, const float* b, float shell) {
+	vec3 dt(a[3] - b[3], a[7] - b[7], a[11] - b[11]);
+	float error = dt.GetLength();
+	for (int c = 0; c < 3; c++) {
+		vec3 axis = vec3(a[c] - b[c], a[4 + c] - b[4 + c], a[8 + c] - b[8 + c]) * shell;
+		float plus = (dt + axis).GetLength(), minus = (dt - axis).GetLength();
+		error = plus > error ? plus : error;
+		error = minus > error ? minus : error;
+	}
+	return error;
+}
+
+AnimCompressor::AnimCompressor() {
+	boneCount = 0, frameCount = 0;
+	scaleRange = 1.0, shell = 1.0, tolerance = 0.0;
+}
+
+bool AnimCompressor::compress(AnimFrame* animation, float error) {
+	tracks.clear(), frames.clear(), rotations.clear(), translations.clear(), scales.clear();
+	frameCount = animation->frames.size();
+	if (frameCount <= 0 || frameCount > ANIM_KEY_MAX_FRAMES) return false;
+	boneCount = animation->frames[0]->boneCount;
+
+	// Every frame is decomposed first, ranges of clip come from all of them
+	std::vector<BoneKey> decomposed(frameCount * boneCount);
+	float range = 0.0, reach = 0.0;
+	for (int f = 0; f < frameCount; f++) {
+		for (int b = 0; b < boneCount; b++) {
+			BoneKey& key = decomposed[f * boneCount + b];
+			Decompose(animation->frames[f]->data + b * 12, key);
+			float s = fabsf(key.scale.x) > fabsf(key.scale.y) ? fabsf(key.scale.x) : fabsf(key.scale.y);
+			s = fabsf(key.scale.z) > s ? fabsf(key.scale.z) : s;
+			range = s > range ? s : range;
+			float t = key.translation.GetLength();
+			reach = t > reach ? t : reach;
+		}
+	}
+	scaleRange = range > 0.0 ? range : 1.0;
+	shell = reach > 1e-4 ? reach : 1.0;
+	tolerance = error * shell;
+
+	// Each candidate key as decoder will see it after quantization
+	std::vector<ushort> packedRotations(frameCount * 3);
+	std::vector<short> packedScales(frameCount * 3);
+	std::vector<BoneKey> quantized(frameCount);
+	float bone[12];
+	for (int b = 0; b < boneCount; b++) {
+		for (int f = 0; f < frameCount; f++) {
+			const BoneKey& key = decomposed[f * boneCount + b];
+			PackRotation(key.rotation, &packedRotations[f * 3]);
+			packedScales[f * 3] = PackScale(key.scale.x, scaleRange);
+			packedScales[f * 3 + 1] = PackScale(key.scale.y, scaleRange);
+			packedScales[f * 3 + 2] = PackScale(key.scale.z, scaleRange);
+			quantized[f].translation = key.translation;
+			quantized[f].rotation = UnpackRotation(&packedRotations[f * 3]);
+			float scale = scaleRange / ANIM_SNORM16;
+			quantized[f].scale = vec3(packedScales[f * 3] * scale, packedScales[f * 3 + 1] * scale, packedScales[f * 3 + 2] * scale);
+		}
+
+		// Greedy: stretch each span until a frame inside it leaves tolerance, then key the last good end
+		std::vector<int> kept(1, 0);
+		int start = 0;
+		while (start < frameCount - 1) {
+			int end = start + 1;
+			for (int candidate = start + 2; candidate < frameCount && candidate - start <= ANIM_KEY_MAX_GAP; candidate++) {
+				bool fits = true;
+				for (int f = start + 1; f < candidate && fits; f++) {
+					Interpolate(quantized[start], quantized[candidate], (float)(f - start) / (candidate - start), bone);
+					fits = GetBoneError(bone, animation->frames[f]->data + b * 12, shell) <= tolerance;
+				}
+				if (!fits) break;
+				end = candidate;
+			}
+			kept.push_back(end);
+			start = end;
+		}
+
+		tracks.push_back(frames.size());
+		tracks.push_back(kept.size());
+		for (uint k = 0; k < kept.size(); k++) {
+			int f = kept[k];
+			frames.push_back(f);
+			rotations.insert(rotations.end(), &packedRotations[f * 3], &packedRotations[f * 3] + 3);
+			translations.push_back(quantized[f].translation.x);
+			translations.push_back(quantized[f].translation.y);
+			translations.push_back(quantized[f].translation.z);
+			scales.insert(scales.end(), &packedScales[f * 3], &packedScales[f * 3] + 3);
+		}
+	}
+	return true;
+}
+
+void AnimCompressor::getKeys(AnimKeys& keys) {
+	keys.boneCount = boneCount, keys.frameCount = frameCount, keys.keyCount = frames.size();
+	keys.scaleRange = scaleRange;
+	keys.tracks = tracks.size() > 0 ? &tracks[0] : NULL;
+	keys.frames = frames.size() > 0 ? &frames[0] : NULL;
+	keys.rotations = rotations.size() > 0 ? &rotations[0] : NULL;
+	keys.translations = translations.size() > 0 ? &translations[0] : NULL;
+	keys.scales = scales.size() > 0 ? &scales[0] : NULL;
+}
@@ -0,0 +1,48 @@
+#ifndef ANIM_COMPRESS_H_
+#define ANIM_COMPRESS_H_
+
+#include "animation.h"
+
+#define ANIM_KEY_ERROR 0.001f // Default tolerance, fraction of clip shell distance
+#define ANIM_KEY_MAX_GAP 256 // Frames between two keys of one bone at most
+#define ANIM_KEY_MAX_FRAMES 65535 // Key frames are ushort
+
+// Keys of a compressed clip, arrays point into a mapped file or into AnimCompressor
+// Each bone has its own keys, first & last frame of clip are always keys
+struct AnimKeys {
+	int boneCount, frameCount, keyCount;
+	float scaleRange; // snorm16 scales are multiplied by it
+	const uint* tracks; // First key & key count of each bone
+	const ushort* frames; // Frame of each key
+	const ushort* rotations; // Smallest three quaternion, 3 of each key
+	const float* translations; // 3 of each key
+	const short* scales; // 3 of each key
+};
+
+// Rebuild whole frame texture, boneCount * 12 floats of each frame
+void DecodeAnimKeys(const AnimKeys& keys, float* data);
+// Bone matrices of one frame, frame may lie between sampled frames
+void SampleAnimKeys(const AnimKeys& keys, float frame, float* bones);
+// Largest distance between points moved by two bone matrices, points are bone origin & shell distance away on each axis
+float GetBoneError(const float* a, const float* b, float shell);
+
+// Bone matrices are split into translation, rotation & scale, keys are dropped while
+// linear interpolation of the quantized neighbours stays within tolerance at shell points
+class AnimCompressor {
+public:
+	std::vector<uint> tracks;
+	std::vector<ushort> frames;
+	std::vector<ushort> rotations;
+	std::vector<float> translations;
+	std::vector<short> scales;
+	int boneCount, frameCount;
+	float scaleRange;
+	float shell; // Largest bone translation of clip, 1 for clips that barely move
+	float tolerance; // error * shell
+public:
+	AnimCompressor();
+	bool compress(AnimFrame* animation, float error = ANIM_KEY_ERROR);
+	void getKeys(AnimKeys& keys);
+};
+
+#endif
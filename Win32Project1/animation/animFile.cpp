@@ -0,0 +1,327 @@
+#include "animFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <stddef.h>
+#include <fstream>
+#include <sstream>
+
+#define ANIM_SNORM16 32767.0f
+#define ANIM_V2_HEADER_SIZE offsetof(AnimFileHeader, keyCount)
+
+AnimFile::AnimFile() {
+	mapped = NULL;
+	data = NULL;
+	decoded = false;
+	boneCount = 0, frameCount = 0;
+	duration = 0.0, ticksPerSecond = 0.0;
+	format = ANIM_FORMAT_FLOAT;
+	memset(&keys, 0, sizeof(AnimKeys));
+}
+
+AnimFile::~AnimFile() {
+	release();
+}
+
+void AnimFile::release() {
+	if (decoded && data) free(data);
+	data = NULL;
+	decoded = false;
+	if (mapped) delete mapped;
+	mapped = NULL;
+	memset(&keys, 0, sizeof(AnimKeys));
+}
+
+static void GetSectionSizes(uint format, int boneCount, int frameCount, int keyCount, uint* sizes) {
+	uint count = (uint)boneCount * (uint)frameCount;
+	memset(sizes, 0, ANIM_SECTION_COUNT * sizeof(uint));
+	if (format == ANIM_FORMAT_QUANTIZED) {
+		sizes[ANIM_SECTION_FRAMES] = count * ANIM_QUANT_LINEAR * sizeof(short);
+		sizes[ANIM_SECTION_TRANSLATIONS] = count * ANIM_QUANT_TRANSLATION * sizeof(float);
+	} else if (format == ANIM_FORMAT_KEYS) {
+		sizes[ANIM_SECTION_TRACKS] = boneCount * 2 * sizeof(uint);
+		sizes[ANIM_SECTION_KEY_FRAMES] = keyCount * sizeof(ushort);
+		sizes[ANIM_SECTION_KEY_ROTATIONS] = keyCount * 3 * sizeof(ushort);
+		sizes[ANIM_SECTION_KEY_TRANSLATIONS] = keyCount * 3 * sizeof(float);
+		sizes[ANIM_SECTION_KEY_SCALES] = keyCount * 3 * sizeof(short);
+	} else
+		sizes[ANIM_SECTION_FRAMES] = count * ANIM_BONE_FLOATS * sizeof(float);
+}
+
+// Sections of v2 header come first, the ones v3 appended follow
+static uint GetSectionOffset(const AnimFileHeader& header, int s) {
+	return s < ANIM_SECTION_V2_COUNT ? header.offsets[s] : header.keyOffsets[s - ANIM_SECTION_V2_COUNT];
+}
+
+static uint GetSectionSize(const AnimFileHeader& header, int s) {
+	return s < ANIM_SECTION_V2_COUNT ? header.sizes[s] : header.keySizes[s - ANIM_SECTION_V2_COUNT];
+}
+
+static void SetSection(AnimFileHeader& header, int s, uint offset, uint size) {
+	if (s < ANIM_SECTION_V2_COUNT) header.offsets[s] = offset, header.sizes[s] = size;
+	else header.keyOffsets[s - ANIM_SECTION_V2_COUNT] = offset, header.keySizes[s - ANIM_SECTION_V2_COUNT] = size;
+}
+
+// Copy of file's header, fields a v2 file lacks are left zero
+static bool ReadHeader(const MappedFile* file, AnimFileHeader& header, uint& headerSize) {
+	memset(&header, 0, sizeof(AnimFileHeader));
+	if (file->size < ANIM_V2_HEADER_SIZE) return false;
+	memcpy(&header, file->data, ANIM_V2_HEADER_SIZE);
+	if (header.magic != ANIM_FILE_MAGIC || header.version < ANIM_FILE_MIN_VERSION || header.version > ANIM_FILE_VERSION) return false;
+	headerSize = header.version >= 3 ? sizeof(AnimFileHeader) : ANIM_V2_HEADER_SIZE;
+	if (file->size < headerSize) return false;
+	memcpy(&header, file->data, headerSize);
+	return true;
+}
+
+static void GetKeys(const MappedFile* file, const AnimFileHeader& header, AnimKeys& keys) {
+	keys.boneCount = header.boneCount, keys.frameCount = header.frameCount, keys.keyCount = header.keyCount;
+	keys.scaleRange = header.linearScale;
+	keys.tracks = (const uint*)(file->data + GetSectionOffset(header, ANIM_SECTION_TRACKS));
+	keys.frames = (const ushort*)(file->data + GetSectionOffset(header, ANIM_SECTION_KEY_FRAMES));
+	keys.rotations = (const ushort*)(file->data + GetSectionOffset(header, ANIM_SECTION_KEY_ROTATIONS));
+	keys.translations = (const float*)(file->data + GetSectionOffset(header, ANIM_SECTION_KEY_TRANSLATIONS));
+	keys.scales = (const short*)(file->data + GetSectionOffset(header, ANIM_SECTION_KEY_SCALES));
+}
+
+// Decoder walks tracks without checks, so each must cover whole clip with rising frames
+static bool CheckKeys(const AnimKeys& keys) {
+	for (int b = 0; b < keys.boneCount; b++) {
+		uint first = keys.tracks[b * 2], count = keys.tracks[b * 2 + 1];
+		if (count < 1 || first >= (uint)keys.keyCount || count > (uint)keys.keyCount - first) return false;
+		const ushort* frames = keys.frames + first;
+		if (frames[0] != 0 || frames[count - 1] != keys.frameCount - 1) return false;
+		for (uint k = 1; k < count; k++)
+			if (frames[k] <= frames[k - 1]) return false;
+	}
+	return true;
+}
+
+// v2 files only have float & quantized sections
+static bool CheckFile(const MappedFile* file, AnimFileHeader& header) {
+	uint headerSize = 0;
+	if (!ReadHeader(file, header, headerSize)) return false;
+	int sectionCount = header.version >= 3 ? ANIM_SECTION_COUNT : ANIM_SECTION_V2_COUNT;
+	if (header.format > ANIM_FORMAT_KEYS || (header.format == ANIM_FORMAT_KEYS && header.version < 3)) return false;
+	if (header.boneCount <= 0 || header.frameCount <= 0 || header.keyCount < 0) return false;
+	if (header.format == ANIM_FORMAT_KEYS && (header.frameCount > ANIM_KEY_MAX_FRAMES || header.keyCount < header.boneCount))
+		return false;
+
+	uint sizes[ANIM_SECTION_COUNT];
+	GetSectionSizes(header.format, header.boneCount, header.frameCount, header.keyCount, sizes);
+	for (int s = 0; s < sectionCount; s++) {
+		uint offset = GetSectionOffset(header, s), size = GetSectionSize(header, s);
+		if (size != sizes[s]) return false;
+		if (offset % ANIM_FILE_ALIGN != 0 || offset < headerSize) return false;
+		if ((size_t)offset + size > file->size) return false;
+	}
+	if (header.format != ANIM_FORMAT_KEYS) return true;
+	AnimKeys keys;
+	GetKeys(file, header, keys);
+	return CheckKeys(keys);
+}
+
+bool AnimFile::load(const char* path, bool keepKeys) {
+	release();
+	mapped = new MappedFile();
+	AnimFileHeader header;
+	if (!mapped->open(path) || !CheckFile(mapped, header)) {
+		release();
+		return false;
+	}
+
+	boneCount = header.boneCount, frameCount = header.frameCount;
+	duration = header.duration, ticksPerSecond = header.ticksPerSecond;
+	format = header.format;
+	if (format == ANIM_FORMAT_FLOAT) {
+		data = (float*)(mapped->data + header.offsets[ANIM_SECTION_FRAMES]);
+		return true;
+	} else if (format == ANIM_FORMAT_KEYS) {
+		GetKeys(mapped, header, keys);
+		if (keepKeys) return true;
+		data = (float*)malloc(boneCount * frameCount * ANIM_BONE_FLOATS * sizeof(float));
+		decoded = true;
+		DecodeAnimKeys(keys, data);
+		delete mapped;
+		mapped = NULL;
+		memset(&keys, 0, sizeof(AnimKeys));
+		return true;
+	}
+
+	// Unpack into texture layout, mapped view is not needed after that
+	int count = boneCount * frameCount;
+	const short* linear = (const short*)(mapped->data + header.offsets[ANIM_SECTION_FRAMES]);
+	const float* translations = (const float*)(mapped->data + header.offsets[ANIM_SECTION_TRANSLATIONS]);
+	float scale = header.linearScale / ANIM_SNORM16;
+	data = (float*)malloc(count * ANIM_BONE_FLOATS * sizeof(float));
+	decoded = true;
+	for (int i = 0; i < count; i++) {
+		float* bone = data + i * ANIM_BONE_FLOATS;
+		for (int r = 0; r < 3; r++) {
+			bone[r * 4] = linear[r * 3] * scale;
+			bone[r * 4 + 1] = linear[r * 3 + 1] * scale;
+			bone[r * 4 + 2] = linear[r * 3 + 2] * scale;
+			bone[r * 4 + 3] = translations[r];
+		}
+		linear += ANIM_QUANT_LINEAR, translations += ANIM_QUANT_TRANSLATION;
+	}
+	delete mapped;
+	mapped = NULL;
+	return true;
+}
+
+// Nearest frame of texture, or interpolated keys when they were kept
+void AnimFile::sample(float frame, float* bones) {
+	if (!data) {
+		SampleAnimKeys(keys, frame, bones);
+		return;
+	}
+	int f = (int)(frame + 0.5);
+	f = f < 0 ? 0 : (f > frameCount - 1 ? frameCount - 1 : f);
+	memcpy(bones, data + f * boneCount * ANIM_BONE_FLOATS, boneCount * ANIM_BONE_FLOATS * sizeof(float));
+}
+
+bool ReadAnimText(const char* path, AnimFrame* animation) {
+	float boneCount = 0, frameCount = 0, duration = 0, ticksPerSecond = 0;
+
+	std::ifstream ifs(path, std::ios::binary);
+	uint magic = 0;
+	ifs.read((char*)&magic, sizeof(uint));
+	if (magic == ANIM_FILE_MAGIC) return false; // Binary file of another version
+	ifs.seekg(0);
+	ifs.clear();
+	std::string line;
+	if (getline(ifs, line)) {
+		std::istringstream ins(line);
+		ins >> boneCount >> frameCount >> duration >> ticksPerSecond;
+	}
+	if (boneCount <= 0 || frameCount <= 0) return false;
+	int total = (int)(frameCount * boneCount * ANIM_BONE_FLOATS);
+	float* data = (float*)malloc(total * sizeof(float));
+	int cur = 0;
+	while (getline(ifs, line)) {
+		std::istringstream ins(line);
+		float d = 0.0;
+		while (cur < total && ins >> d)
+			data[cur++] = d;
+	}
+	ifs.close();
+	if (cur < total) memset(data + cur, 0, (total - cur) * sizeof(float));
+
+	int curOut = 0;
+	for (uint f = 0; f < frameCount; ++f) {
+		Frame* frame = new Frame(boneCount);
+		memcpy(frame->data, data + curOut, (int)boneCount * ANIM_BONE_FLOATS * sizeof(float));
+		curOut += (int)boneCount * ANIM_BONE_FLOATS;
+		animation->frames.push_back(frame);
+	}
+	free(data);
+
+	animation->setDuration(duration);
+	animation->setTicksPerSecond(ticksPerSecond);
+	return true;
+}
+
+static void WriteSection(FILE* out, const void* data, uint offset, uint size, uint& written) {
+	static const char padding[ANIM_FILE_ALIGN] = { 0 };
+	if (offset > written) fwrite(padding, 1, offset - written, out);
+	if (size > 0) fwrite(data, 1, size, out);
+	written = offset + size;
+}
+
+static void InitHeader(AnimFileHeader& header, AnimFrame* animation, uint format, int boneCount, int frameCount, int keyCount) {
+	memset(&header, 0, sizeof(AnimFileHeader));
+	header.magic = ANIM_FILE_MAGIC;
+	header.version = ANIM_FILE_VERSION;
+	header.format = format;
+	header.boneCount = boneCount, header.frameCount = frameCount, header.keyCount = keyCount;
+	header.duration = animation->duration;
+	header.ticksPerSecond = animation->ticksPerSecond;
+	uint sizes[ANIM_SECTION_COUNT];
+	GetSectionSizes(header.format, boneCount, frameCount, keyCount, sizes);
+	uint offset = sizeof(AnimFileHeader);
+	for (int s = 0; s < ANIM_SECTION_COUNT; s++) {
+		offset = (offset + ANIM_FILE_ALIGN - 1) / ANIM_FILE_ALIGN * ANIM_FILE_ALIGN;
+		SetSection(header, s, offset, sizes[s]);
+		offset += sizes[s];
+	}
+}
+
+static bool WriteFile(const char* path, const AnimFileHeader& header, const void** datas) {
+	FILE* out = fopen(path, "wb");
+	if (!out) return false;
+	uint written = 0;
+	WriteSection(out, &header, 0, sizeof(AnimFileHeader), written);
+	for (int s = 0; s < ANIM_SECTION_COUNT; s++)
+		WriteSection(out, datas[s], GetSectionOffset(header, s), GetSectionSize(header, s), written);
+	fclose(out);
+	return true;
+}
+
+bool SaveAnimFile(AnimFrame* animation, const char* path, bool quantize) {
+	if (animation->frames.size() <= 0 || animation->frames[0]->boneCount <= 0) return false;
+	int boneCount = animation->frames[0]->boneCount, frameCount = animation->frames.size();
+	int floatCount = boneCount * ANIM_BONE_FLOATS;
+
+	AnimFileHeader header;
+	InitHeader(header, animation, quantize ? ANIM_FORMAT_QUANTIZED : ANIM_FORMAT_FLOAT, boneCount, frameCount, 0);
+
+	// Frames of one clip are joined, or split into quantized 3x3 parts & translations
+	char* datas[ANIM_SECTION_COUNT] = { (char*)malloc(header.sizes[ANIM_SECTION_FRAMES]), NULL };
+	if (!quantize) {
+		for (int f = 0; f < frameCount; f++)
+			memcpy((float*)datas[ANIM_SECTION_FRAMES] + f * floatCount, animation->frames[f]->data, floatCount * sizeof(float));
+	} else {
+		float linearScale = 0.0;
+		for (int f = 0; f < frameCount; f++) {
+			const float* frame = animation->frames[f]->data;
+			for (int i = 0; i < floatCount; i++) {
+				if (i % 4 == 3) continue;
+				float value = fabsf(frame[i]);
+				linearScale = value > linearScale ? value : linearScale;
+			}
+		}
+		header.linearScale = linearScale > 0.0 ? linearScale : 1.0;
+		datas[ANIM_SECTION_TRANSLATIONS] = (char*)malloc(header.sizes[ANIM_SECTION_TRANSLATIONS]);
+		short* linear = (short*)datas[ANIM_SECTION_FRAMES];
+		float* translations = (float*)datas[ANIM_SECTION_TRANSLATIONS];
+		for (int f = 0; f < frameCount; f++) {
+			const float* frame = animation->frames[f]->data;
+			for (int i = 0; i < floatCount; i++) {
+				if (i % 4 == 3) {
+					*(translations++) = frame[i];
+					continue;
+				}
+				float snorm = frame[i] / header.linearScale;
+				snorm = snorm < -1.0 ? -1.0 : (snorm > 1.0 ? 1.0 : snorm);
+				*(linear++) = (short)floorf(snorm * ANIM_SNORM16 + 0.5);
+			}
+		}
+	}
+
+	bool written = WriteFile(path, header, (const void**)datas);
+	for (int s = 0; s < ANIM_SECTION_COUNT; s++)
+		if (datas[s]) free(datas[s]);
+	return written;
+}
+
+bool SaveAnimKeyFile(AnimFrame* animation, const char* path, AnimCompressor* compressor) {
+	AnimKeys keys;
+	compressor->getKeys(keys);
+	if (keys.boneCount <= 0 || keys.keyCount <= 0) return false;
+
+	AnimFileHeader header;
+	InitHeader(header, animation, ANIM_FORMAT_KEYS, keys.boneCount, keys.frameCount, keys.keyCount);
+	header.linearScale = keys.scaleRange;
+	const void* datas[ANIM_SECTION_COUNT] = { NULL, NULL, keys.tracks, keys.frames, keys.rotations, keys.translations, keys.scales };
+	return WriteFile(path, header, datas);
+}
+
+bool IsAnimFile(const char* path) {
+	FILE* file = fopen(path, "rb");
+	if (!file) return false;
+	uint head[2] = { 0, 0 };
+	size_t read = fread(head, sizeof(uint), 2, file);
+	fclose(file);
+	return read == 2 && head[0] == ANIM_FILE_MAGIC && head[1] >= ANIM_FILE_MIN_VERSION && head[1] <= ANIM_FILE_VERSION;
+}
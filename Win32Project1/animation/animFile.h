@@ -0,0 +1,76 @@
+#ifndef ANIM_FILE_H_
+#define ANIM_FILE_H_
+
+#include "animation.h"
+#include "animCompress.h"
+#include "../util/mappedFile.h"
+
+#define ANIM_FILE_MAGIC 0x41334554 // "TE3A"
+#define ANIM_FILE_VERSION 3 // 3 appended compressed key sections to v2 header
+#define ANIM_FILE_MIN_VERSION 2 // Oldest binary version still loaded
+#define ANIM_FILE_ALIGN 16
+#define ANIM_BONE_FLOATS 12 // 3 rows of bone matrix, each is 3 rotation & scale values then translation
+#define ANIM_QUANT_LINEAR 9 // snorm16 rotation & scale values of each bone
+#define ANIM_QUANT_TRANSLATION 3 // Float translation of each bone
+
+enum AnimFileFormat {
+	ANIM_FORMAT_FLOAT, // Frame texture as it is uploaded
+	ANIM_FORMAT_QUANTIZED, // 3x3 part as snorm16 scaled by linearScale, translation as float
+	ANIM_FORMAT_KEYS // AnimKeys of AnimCompressor, scales use linearScale
+};
+
+enum AnimFileSection {
+	ANIM_SECTION_FRAMES, // Float format: ANIM_BONE_FLOATS floats, quantized: ANIM_QUANT_LINEAR shorts of each bone in each frame
+	ANIM_SECTION_TRANSLATIONS, // Quantized format only: ANIM_QUANT_TRANSLATION floats of each bone in each frame
+	ANIM_SECTION_V2_COUNT,
+	ANIM_SECTION_TRACKS = ANIM_SECTION_V2_COUNT, // Key format only from here: first key & key count of each bone
+	ANIM_SECTION_KEY_FRAMES,
+	ANIM_SECTION_KEY_ROTATIONS,
+	ANIM_SECTION_KEY_TRANSLATIONS,
+	ANIM_SECTION_KEY_SCALES,
+	ANIM_SECTION_COUNT
+};
+
+// v1 .t3a files are text, binary ones start with this header, sections are aligned to ANIM_FILE_ALIGN
+// v2 files end the header at keyCount, v3 fields are only appended so v2 files keep loading
+struct AnimFileHeader {
+	uint magic;
+	uint version;
+	uint format;
+	int boneCount, frameCount;
+	float duration, ticksPerSecond;
+	float linearScale; // Largest absolute rotation & scale value of clip, largest absolute scale of key files
+	uint offsets[ANIM_SECTION_V2_COUNT];
+	uint sizes[ANIM_SECTION_V2_COUNT];
+	int keyCount;
+	uint keyOffsets[ANIM_SECTION_COUNT - ANIM_SECTION_V2_COUNT]; // Sections from ANIM_SECTION_TRACKS on
+	uint keySizes[ANIM_SECTION_COUNT - ANIM_SECTION_V2_COUNT];
+};
+
+// Frame texture of a binary file, float files are used straight from the mapped view
+class AnimFile {
+public:
+	MappedFile* mapped;
+	float* data; // boneCount * ANIM_BONE_FLOATS floats of each frame
+	bool decoded; // data was unpacked from a quantized or key file & is owned
+	AnimKeys keys; // Key files only, points into mapped view
+	int boneCount, frameCount;
+	float duration, ticksPerSecond;
+	uint format;
+public:
+	AnimFile();
+	~AnimFile();
+	// False for text files, damaged files or files of another version
+	// Key files are decoded into data unless keepKeys, then frames are taken with sample
+	bool load(const char* path, bool keepKeys = false);
+	void sample(float frame, float* bones);
+	void release();
+};
+
+// Read a v1 text file into Frame objects
+bool ReadAnimText(const char* path, AnimFrame* animation);
+bool SaveAnimFile(AnimFrame* animation, const char* path, bool quantize);
+bool SaveAnimKeyFile(AnimFrame* animation, const char* path, AnimCompressor* compressor);
+bool IsAnimFile(const char* path);
+
+#endif
@@ -1,6 +1,6 @@
 #include "animation.h"
-#include <iostream>
-#include <fstream>
+#include "animFile.h"
+#include <stdio.h>
 #include <io.h>
 
 Animation::Animation() {
@@ -20,6 +20,7 @@ Animation::Animation() {
 	aWeights.clear();
 	datasToExport.clear();
 	inverseYZ = false;
+	animId = -1;
 }
 
 Animation::~Animation() {
@@ -61,32 +62,50 @@ std::string Animation::convertTexPath(const std::string& path) {
 	return res;
 }
 
-void Animation::exportAnims(std::string path) {
+void Animation::exportAnims(std::string path, bool quantize, float keyError) {
 	for (uint i = 0; i < getExportSize(); ++i) {
 		AnimFrame* animation = datasToExport[i];
-		float boneCount = animation->frames[0]->boneCount;
-		float frameCount = animation->frames.size();
-		float duration = animation->duration;
-		float ticksPerSecond = animation->ticksPerSecond;
-
-		const char* savePath = (path + "\\" + getName() + "_" + animation->getName() + ".t3a").data();
-		if (access(savePath, 0) == 0) continue;
-
-		std::ofstream of(savePath, std::ios::binary);
-		of << boneCount << " " << frameCount << " " << duration << " " << ticksPerSecond << std::endl;
-		for (uint f = 0; f < frameCount; ++f) {
-			Frame* frame = animation->frames[f];
-			for (uint b = 0; b < boneCount; ++b) {
-				for (uint inn = 0; inn < 12; ++inn) 
-					of << frame->data[b * 12 + inn] << " ";
-				of << std::endl;
-			}
-		}
-		of.close();
+		std::string savePath = path + "\\" + getName() + "_" + animation->getName() + ".t3a";
+		if (access(savePath.data(), 0) == 0) continue;
+		AnimCompressor compressor;
+		if (keyError > 0.0 && compressor.compress(animation, keyError))
+			SaveAnimKeyFile(animation, savePath.data(), &compressor);
+		else
+			SaveAnimFile(animation, savePath.data(), quantize);
 	}
 	clearExportData();
 }
 
+template<typename T>
+static void RemapVertexVector(std::vector<T>& data, const int* remap, int vertexCount) {
+	if ((int)data.size() == vertexCount) RemapVertexData(&data[0], remap, vertexCount);
+}
+
+// Same reorder as Mesh::optimizeVertexOrder, animation indices are one range
+void Animation::optimizeVertexOrder(const char* name) {
+	int indexCount = aIndices.size(), vertexCount = aVertices.size();
+	if (indexCount < 3 || vertexCount <= 0) return;
+	VertexCacheStats before = AnalyzeVertexCache(&aIndices[0], indexCount, vertexCount, VERTEX_CACHE_FIFO);
+	OptimizeVertexCache(&aIndices[0], indexCount, vertexCount);
+
+	int* remap = (int*)malloc(vertexCount * sizeof(int));
+	OptimizeVertexFetch(&aIndices[0], indexCount, vertexCount, remap);
+	RemapVertexVector(aVertices, remap, vertexCount);
+	RemapVertexVector(aNormals, remap, vertexCount);
+	RemapVertexVector(aTangents, remap, vertexCount);
+	RemapVertexVector(aTexcoords, remap, vertexCount);
+	RemapVertexVector(aTextures, remap, vertexCount);
+	RemapVertexVector(aAmbients, remap, vertexCount);
+	RemapVertexVector(aDiffuses, remap, vertexCount);
+	RemapVertexVector(aSpeculars, remap, vertexCount);
+	RemapVertexVector(aBoneids, remap, vertexCount);
+	RemapVertexVector(aWeights, remap, vertexCount);
+	free(remap);
+
+	VertexCacheStats after = AnalyzeVertexCache(&aIndices[0], indexCount, vertexCount, VERTEX_CACHE_FIFO);
+	LogVertexCache(name, indexCount / 3, before, after);
+}
+
 void Animation::clearExportData() {
 	for (uint i = 0; i < datasToExport.size(); i++)
 		delete datasToExport[i];
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../constants/constants.h"
+#include "../mesh/vertexCache.h"
 
 struct Frame {
 	int boneCount;
@@ -52,6 +53,7 @@ class Animation {
 public:
 	std::string name;
 	bool inverseYZ;
+	int animId; // Dense id in scene, assigned by Scene::addObject
 public:
 	int faceCount, vertCount, boneCount;
 	std::vector<vec3> aVertices;
@@ -75,7 +77,10 @@ public:
 	void setName(std::string value) { name = value; }
 	std::string convertTexPath(const std::string& path);
 	uint getExportSize() { return datasToExport.size(); }
-	void exportAnims(std::string path);
+	// Write binary .t3a of each clip, float by default, quantized files keep 3x3 part as snorm16
+	// keyError above 0 writes compressed keys instead, see AnimCompressor
+	void exportAnims(std::string path, bool quantize = false, float keyError = 0.0);
+	void optimizeVertexOrder(const char* name);
 private:
 	void clearExportData();
 };
@@ -7,12 +7,11 @@ AnimationData::AnimationData(Animation* anim, int maxCount) : DataBuffer(ANIMATE
 	vertexBuffer = (float*)malloc(vertexCount * 3 * sizeof(float));
 	normalBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
 	tangentBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
-	texcoordBuffer = (float*)malloc(vertexCount * 4 * sizeof(float));
-	texidBuffer = (float*)malloc(vertexCount * 2 * sizeof(float));
-	colorBuffer = (byte*)malloc(vertexCount * 3 * sizeof(byte));
+	texcoordBuffer = (float*)malloc(vertexCount * 2 * sizeof(float));
+	materialBuffer = (ushort*)malloc(vertexCount * sizeof(ushort));
 	boneids = (byte*)malloc(vertexCount * 4 * sizeof(byte));
 	weights = (half*)malloc(vertexCount * 4 * sizeof(half));
-	indexBuffer = (ushort*)malloc(indexCount * sizeof(ushort));
+	indexBuffer = (uint*)malloc(indexCount * sizeof(uint));
 
 	for (uint i = 0; i < (uint)vertexCount; i++) {
 		SetVec3(anim->aVertices[i], vertexBuffer, i);
@@ -22,34 +21,24 @@ AnimationData::AnimationData(Animation* anim, int maxCount) : DataBuffer(ANIMATE
 				tangentBuffer[i * 3 + v] = Float2Half(GetVec3(&anim->aTangents[i], v));
 		}
 
-		texcoordBuffer[i * 4 + 0] = anim->aTexcoords[i].x;
-		texcoordBuffer[i * 4 + 1] = anim->aTexcoords[i].y;
-		texcoordBuffer[i * 4 + 2] = anim->aTextures[i]->texids.x;
-		texcoordBuffer[i * 4 + 3] = anim->aTextures[i]->texids.y;
-		texidBuffer[i * 2 + 0] = anim->aTextures[i]->texids.z;
-		texidBuffer[i * 2 + 1] = anim->aTextures[i]->texids.w;
-
-		colorBuffer[i * 3 + 0] = (byte)(anim->aAmbients[i].x * 255);
-		colorBuffer[i * 3 + 1] = (byte)(anim->aDiffuses[i].x * 255);
-		colorBuffer[i * 3 + 2] = (byte)(anim->aSpeculars[i].x * 255);
+		texcoordBuffer[i * 2 + 0] = anim->aTexcoords[i].x;
+		texcoordBuffer[i * 2 + 1] = anim->aTexcoords[i].y;
+		materialBuffer[i] = (ushort)anim->aTextures[i]->id;
 
 		SetUVec4(anim->aBoneids[i], boneids, i);
 		for (uint v = 0; v < 4; v++)
 			weights[i * 4 + v] = Float2Half(GetVec4(&anim->aWeights[i], v));
 	}
 	for (uint i = 0; i < (uint)indexCount; i++)
-		indexBuffer[i] = (ushort)(anim->aIndices[i]);
+		indexBuffer[i] = (uint)(anim->aIndices[i]);
 
 	this->maxCount = maxCount;
-	transformsFull = (buff*)malloc(this->maxCount * 16 * sizeof(buff));
-	memset(transformsFull, 0, this->maxCount * 16 * sizeof(buff));
+	stream = NULL;
 	animCount = 0;
 }
 
 AnimationData::~AnimationData() {
 	releaseDatas();
-	free(transformsFull);
-	transformsFull = NULL;
 }
 
 void AnimationData::releaseDatas() {
@@ -58,15 +47,18 @@ void AnimationData::releaseDatas() {
 	if (weights) free(weights); weights = NULL;
 }
 
+// Called by cull task, record goes straight to gpu memory once render thread has mapped the stream
 void AnimationData::addAnimObject(Object* object) {
-	if (transformsFull) {
-		memcpy(transformsFull + (animCount * 16), object->transformsFull, 12 * sizeof(buff));
+	if (!stream) return;
+	buff* record = stream->push();
+	if (!record) return;
 
-		AnimationObject* animObj = (AnimationObject*)object;
-		transformsFull[animCount * 16 + 12] = animObj->fid + 0.1;
-		transformsFull[animCount * 16 + 13] = animObj->getCurFrame();
-		transformsFull[animCount * 16 + 14] = 0.0;
-		transformsFull[animCount * 16 + 15] = animId + 0.1;
-		animCount++;
-	}
+	// Write record once in order, it may be write combined memory
+	memcpy(record, object->transformsFull, 12 * sizeof(buff));
+	AnimationObject* animObj = (AnimationObject*)object;
+	record[12] = animObj->fid + 0.1;
+	record[13] = animObj->getCurFrame();
+	record[14] = 0.0;
+	record[15] = animId + 0.1;
+	animCount++;
 }
\ No newline at end of file
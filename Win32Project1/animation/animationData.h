@@ -5,6 +5,7 @@
 #include "../animation/animation.h"
 #include "../object/animationObject.h"
 #include "../constants/constants.h"
+#include "../render/instanceStream.h"
 
 class AnimationDrawcall;
 
@@ -14,7 +15,7 @@ public:
 	half* weights;
 	int animId;
 	int animCount;
-	buff* transformsFull;
+	InstanceStream* stream; // Transforms are appended to queue's stream like instance records, only their count is kept here
 public:
 	AnimationData(Animation* anim, int maxCount);
 	virtual ~AnimationData();
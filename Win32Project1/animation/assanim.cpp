@@ -10,6 +10,7 @@ AssAnim::AssAnim(const char* path) : Animation() {
 	scene=importer.ReadFile(path,
 				aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_JoinIdenticalVertices);
 	loadModel();
+	optimizeVertexOrder(path);
 
 	for (int ai = 0; ai < scene->mNumAnimations; ai++) {
 		aiAnimation* asAnimation = scene->mAnimations[ai];
@@ -19,6 +19,7 @@ FBXLoader::FBXLoader(const char* path) : Animation() {
 	mAnimStackNameArray.Clear();
 
 	init(path);
+	optimizeVertexOrder(path);
 	inverseYZ = true;
 }
 
@@ -1,7 +1,5 @@
 #include "frameMgr.h"
-#include <iostream>
-#include <fstream>
-#include <sstream>
+#include "animFile.h"
 
 FrameMgr::FrameMgr() {
 	frames.clear();
@@ -21,58 +19,42 @@ FrameMgr::~FrameMgr() {
 int FrameMgr::addFrame(AnimFrame* data) {
 	if (data->frames.size() <= 0) return -1;
 
-	int boneCount = data->frames[0]->boneCount, imgWidth = boneCount * 3;
-	int frameCount = data->frames.size(), imgHeight = frameCount;
-	float* texData = (float*)malloc(imgWidth * imgHeight * 4 * sizeof(float));
+	int boneCount = data->frames[0]->boneCount;
+	int frameCount = data->frames.size();
+	float* texData = (float*)malloc(frameCount * boneCount * 12 * sizeof(float));
 
 	for (int f = 0; f < frameCount; ++f) {
 		Frame* frame = data->frames[f];
 		memcpy(texData + f * boneCount * 12, frame->data, boneCount * 12 * sizeof(float));
 	}
 
-	uint curTex = frames.size();
-	frames.push_back(new Texture2D(imgWidth, imgHeight, TEXTURE_TYPE_ANIME, FLOAT_PRE, 4, NEAREST, false, texData));
+	int curTex = addFrame(boneCount, frameCount, texData);
 	free(texData);
 	return curTex;
 }
 
+// One row of 3 texels for each bone in each frame
+int FrameMgr::addFrame(int boneCount, int frameCount, const float* data) {
+	uint curTex = frames.size();
+	frames.push_back(new Texture2D(boneCount * 3, frameCount, TEXTURE_TYPE_ANIME, FLOAT_PRE, 4, NEAREST, false, (void*)data));
+	return curTex;
+}
+
 void FrameMgr::addAnimationData(AnimFrame* data, Animation* anim) {
 	frameIndex[data->getName()] = addFrame(data);
 }
 
+// Binary clips keep no Frame objects, AnimFrame only carries timing of them
 void FrameMgr::readAnimationData(const char* path, AnimFrame* animation) {
-	float boneCount, frameCount, duration, ticksPerSecond;
-
-	std::ifstream ifs(path, std::ios::binary);
-	std::string line;
-	if (getline(ifs, line)) {
-		std::istringstream ins(line);
-		ins >> boneCount >> frameCount >> duration >> ticksPerSecond;
-	}
-	float* data = (float*)malloc(frameCount * boneCount * 12 * sizeof(float));
-	int cur = 0;
-	while (getline(ifs, line)) {
-		std::istringstream ins(line);
-		float d = 0.0;
-		while (ins >> d) 
-			data[cur++] = d;
+	AnimFile file;
+	if (file.load(path)) {
+		animation->setDuration(file.duration);
+		animation->setTicksPerSecond(file.ticksPerSecond);
+		frameIndex[animation->getName()] = addFrame(file.boneCount, file.frameCount, file.data);
+		return;
 	}
-	ifs.close();
-
-	int curOut = 0;
-	for (uint f = 0; f < frameCount; ++f) {
-		Frame* frame = new Frame(boneCount);
-		int curIn = 0;
-		for (uint b = 0; b < boneCount; ++b) {
-			for (uint inn = 0; inn < 12; ++inn)
-				frame->data[curIn++] = data[curOut++];
-		}
-		animation->frames.push_back(frame);
-	}
-	free(data);
-
-	animation->setDuration(duration);
-	animation->setTicksPerSecond(ticksPerSecond);
+	if (ReadAnimText(path, animation)) addAnimationData(animation, NULL);
+	else frameIndex[animation->getName()] = -1;
 }
 
 void FrameMgr::init() {
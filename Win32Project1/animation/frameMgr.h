@@ -14,10 +14,12 @@ public:
 	FrameMgr();
 	~FrameMgr();
 	void addAnimationData(AnimFrame* data, Animation* anim);
+	// Load .t3a & add its frame texture, float files are uploaded from the mapped view
 	void readAnimationData(const char* path, AnimFrame* animation);
 	void init();
 private:
 	int addFrame(AnimFrame* data);
+	int addFrame(int boneCount, int frameCount, const float* data);
 };
 
 #endif
@@ -1,11 +1,14 @@
 #include "application.h"
 #include "../constants/constants.h"
 #include "../util/util.h"
+#include "../util/profiler.h"
 
 Application::Application() {
 	config = new Config("config/config.txt");
 	cfgs = (ConfigArg*)malloc(sizeof(ConfigArg));
 	memset(cfgs, 0, sizeof(ConfigArg));
+	cfgs->workers = -1;
+	cfgs->renderDepth = 3;
 
 	config->getInt("width", cfgs->width);
 	config->getInt("height", cfgs->height);
@@ -23,6 +26,10 @@ Application::Application() {
 	config->getBool("dynsky", cfgs->dynsky);
 	config->getBool("cartoon", cfgs->cartoon);
 	config->getBool("debug", cfgs->debug);
+	config->getInt("workers", cfgs->workers);
+	config->getInt("renderdepth", cfgs->renderDepth);
+	config->getBool("profile", cfgs->profile);
+	config->getBool("gpulod", cfgs->gpulod);
 
 	windowWidth = cfgs->width;
 	windowHeight = cfgs->height;
@@ -36,6 +43,7 @@ Application::Application() {
 	render = NULL;
 	input = NULL;
 	renderMgr = NULL;
+	cameraPath = new CameraPath();
 }
 
 void Application::init() {
@@ -44,6 +52,8 @@ void Application::init() {
 	render->initShaders(cfgs);
 	AssetManager::Init();
 	MaterialManager::Init();
+	JobSystem::Init(cfgs->workers);
+	if (cfgs->profile) Profiler::Init();
 	scene = new Scene();
 	input = new Input();
 
@@ -63,19 +73,22 @@ void Application::initScene() {
 }
 
 Application::~Application() {
+	delete cameraPath; // Save recorded path or replay timings
 	MaterialManager::Release();
 	AssetManager::Release();
 	delete scene; scene = NULL;
 	delete render; render = NULL;
 	delete input; input = NULL;
 	delete renderMgr; renderMgr = NULL;
+	JobSystem::Release();
+	Profiler::Release();
 	delete config;
 	free(cfgs);
 }
 
 void Application::act(long startTime, long currentTime, float dTime, float velocity) {
 	if (renderMgr) {
-		input->updateExtra(renderMgr);
+		if (!cameraPath->isReplaying()) input->updateExtra(renderMgr);
 		scene->act(currentTime - startTime);
 		scene->setVelocity(velocity);
 	}
@@ -100,16 +113,23 @@ void Application::mouseKey(bool press, bool isMain) {
 }
 
 void Application::updateData() {
+	PROFILE_ZONE("Application::updateData");
 	scene->actCamera->updateFrustum(); // Update main camera's frustum for cull
 	renderMgr->updateMainLight(scene); // Update shadow cameras' frustum for cull
 }
 
 void Application::prepare() {
+	PROFILE_ZONE("Application::prepare");
 	renderMgr->prepareData(scene);
 }
 
-void Application::swapData(bool swapQueue) {
-	renderMgr->swapRenderQueues(scene, swapQueue); // Caculate cull result
+bool Application::swapData(bool swapQueue) {
+	PROFILE_ZONE("Application::swapData");
+	return renderMgr->swapRenderQueues(scene, swapQueue); // Caculate cull result
+}
+
+bool Application::canPrepare() {
+	return renderMgr->canPrepare();
 }
 
 void Application::animate(float velocity) {
@@ -6,6 +6,7 @@
 #include "../render/renderManager.h"
 #include "../material/materialManager.h"
 #include "../assets/assetManager.h"
+#include "../camera/cameraPath.h"
 
 class Application {
 private:
@@ -23,6 +24,7 @@ public:
 	bool pressed;
 	int wheelDir;
 	ConfigArg* cfgs;
+	CameraPath* cameraPath; // Records or replays act steps, idle by default
 public:
 	Application();
 	virtual ~Application();
@@ -37,7 +39,8 @@ public:
 	virtual void mouseKey(bool press, bool isMain);
 	void updateData();
 	void prepare();
-	void swapData(bool swapQueue);
+	bool swapData(bool swapQueue);
+	bool canPrepare();
 	void animate(float velocity);
 	virtual void resize(int width, int height);
 	virtual void keyDown(int key);
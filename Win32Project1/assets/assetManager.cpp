@@ -4,6 +4,8 @@
 #include "../mesh/board.h"
 #include "../mesh/quad.h"
 #include "../mesh/terrain.h"
+#include "../mesh/model.h"
+#include "../mesh/meshCache.h"
 #include "../util/util.h"
 using namespace std;
 
@@ -79,6 +81,7 @@ void AssetManager::initTextureBindless(MaterialManager* mtls) {
 		printf("mat %s: [%d]%s\n", mat->name.data(), (int)mat->texids.x, mat->tex1.data());
 	}
 	texBld->initData(COMMON_TEXTURE);
+	mtls->setChanged();
 }
 
 int AssetManager::findTextureBindless(const char* name) {
@@ -160,11 +163,38 @@ void AssetManager::createHeightTex() {
 	free(normalData);
 }
 
-void AssetManager::addMesh(const char* name, Mesh* mesh, bool billboard, bool drawShadow) {
+void AssetManager::addMesh(const char* name, Mesh* mesh, bool billboard, bool drawShadow, bool genLods) {
 	mesh->setName(name);
 	meshes[name] = mesh;
 	meshes[name]->setIsBillboard(billboard);
 	meshes[name]->drawShadow = drawShadow;
+	if (genLods && !billboard && dynamic_cast<Model*>(mesh) && mesh->indexCount / 3 >= LOD_MIN_TRIANGLES) addLods(name, mesh);
+}
+
+// Obj model is used from its .t3m cache when that is newer than obj & mtl and parsed with same vt, otherwise parsed & cached again
+void AssetManager::addMesh(const char* name, const char* obj, const char* mtl, int vt, bool billboard, bool drawShadow, bool genLods) {
+	string cachePath = GetMeshCachePath(obj);
+	Model* model = LoadMeshCache(cachePath.data(), obj, mtl, vt);
+	if (!model) {
+		model = new Model(obj, mtl, vt);
+		SaveMeshCache(model, cachePath.data(), vt);
+	}
+	addMesh(name, model, billboard, drawShadow, genLods);
+}
+
+// Lods are kept in meshes as name_lod1 & name_lod2, so they are released with other meshes
+void AssetManager::addLods(const char* name, Mesh* mesh) {
+	string base = string(LOD_CACHE_DIR) + "/" + name;
+	mesh->lodMid = CreateLodMesh(mesh, LOD_MID_RATIO, (base + "_lod1.t3l").data());
+	mesh->lodLow = CreateLodMesh(mesh, LOD_LOW_RATIO, (base + "_lod2.t3l").data());
+	if (mesh->lodMid) {
+		mesh->lodMid->setName(string(name) + "_lod1");
+		meshes[mesh->lodMid->getName()] = mesh->lodMid;
+	}
+	if (mesh->lodLow) {
+		mesh->lodLow->setName(string(name) + "_lod2");
+		meshes[mesh->lodLow->getName()] = mesh->lodLow;
+	}
 }
 
 Animation* AssetManager::exportAnimation(const char* name, Animation* animation) {
@@ -177,7 +207,6 @@ Animation* AssetManager::exportAnimation(const char* name, Animation* animation)
 void AssetManager::addAnimationData(const char* name, const char* path, Animation* animation) {
 	AnimFrame* animData = new AnimFrame(name);
 	frames->readAnimationData(path, animData);
-	frames->addAnimationData(animData, animation);
 	animationDatas[animData->getName()] = animData;
 }
 
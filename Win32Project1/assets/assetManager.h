@@ -4,6 +4,7 @@
 #define COMMON_TEXTURE "texture/common"
 
 #include "../mesh/mesh.h"
+#include "../mesh/lodMesh.h"
 #include "../animation/frameMgr.h"
 #include "../animation/assanim.h"
 #include "../animation/fbxloader.h"
@@ -35,7 +36,10 @@ private:
 	AssetManager();
 	~AssetManager();
 public:
-	void addMesh(const char* name, Mesh* mesh, bool billboard = false, bool drawShadow = true);
+	// genLods false for meshes that are hand made lods or have them, objects then never use generated ones
+	void addMesh(const char* name, Mesh* mesh, bool billboard = false, bool drawShadow = true, bool genLods = true);
+	void addMesh(const char* name, const char* obj, const char* mtl, int vt, bool billboard = false, bool drawShadow = true, bool genLods = true);
+	void addLods(const char* name, Mesh* mesh);
 	Animation* exportAnimation(const char* name, Animation* animation);
 	void addAnimationData(const char* name, const char* path, Animation* animation);
 	void initFrames();
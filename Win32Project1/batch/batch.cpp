@@ -11,8 +11,7 @@ Batch::Batch() {
 	normalBuffer = NULL;
 	tangentBuffer = NULL;
 	texcoordBuffer = NULL;
-	texidBuffer = NULL;
-	colorBuffer = NULL;
+	materialBuffer = NULL;
 	objectidBuffer = NULL;
 	indexBuffer = NULL;
 
@@ -31,8 +30,7 @@ Batch::~Batch() {
 	if (normalBuffer) free(normalBuffer); normalBuffer = NULL;
 	if (tangentBuffer) free(tangentBuffer); tangentBuffer = NULL;
 	if (texcoordBuffer) free(texcoordBuffer); texcoordBuffer = NULL;
-	if (texidBuffer) free(texidBuffer); texidBuffer = NULL;
-	if (colorBuffer) free(colorBuffer); colorBuffer = NULL;
+	if (materialBuffer) free(materialBuffer); materialBuffer = NULL;
 	if (objectidBuffer) free(objectidBuffer); objectidBuffer = NULL;
 	if (indexBuffer) free(indexBuffer); indexBuffer = NULL;
 
@@ -49,8 +47,7 @@ void Batch::releaseBatchData() {
 		if (normalBuffer) free(normalBuffer); normalBuffer = NULL;
 		if (tangentBuffer) free(tangentBuffer); tangentBuffer = NULL;
 		if (texcoordBuffer) free(texcoordBuffer); texcoordBuffer = NULL;
-		if (texidBuffer) free(texidBuffer); texidBuffer = NULL;
-		if (colorBuffer) free(colorBuffer); colorBuffer = NULL;
+		if (materialBuffer) free(materialBuffer); materialBuffer = NULL;
 		if (objectidBuffer) free(objectidBuffer); objectidBuffer = NULL;
 	}
 }
@@ -66,9 +63,8 @@ void Batch::initBatchBuffers(int vertCount, int indCount) {
 	if (!vertexBuffer) vertexBuffer = (float*)malloc(vertexCount * 3 * sizeof(float));
 	if (!normalBuffer) normalBuffer = (float*)malloc(vertexCount * 3 * sizeof(float));
 	if (!tangentBuffer) tangentBuffer = (float*)malloc(vertexCount * 3 * sizeof(float));
-	if (!texcoordBuffer) texcoordBuffer = (float*)malloc(vertexCount * 4 * sizeof(float));
-	if (!texidBuffer) texidBuffer = (float*)malloc(vertexCount * 4 * sizeof(float));
-	if (!colorBuffer) colorBuffer = (byte*)malloc(vertexCount * 3 * sizeof(byte));
+	if (!texcoordBuffer) texcoordBuffer = (float*)malloc(vertexCount * 2 * sizeof(float));
+	if (!materialBuffer) materialBuffer = (ushort*)malloc(vertexCount * sizeof(ushort));
 	if (!objectidBuffer) objectidBuffer = (byte*)malloc(vertexCount * sizeof(byte));
 	if (!indexBuffer) indexBuffer = (uint*)malloc(indexCount * sizeof(uint));
 
@@ -84,10 +80,7 @@ void Batch::pushMeshToBuffers(Mesh* mesh,int mid,bool fullStatic,const mat4& tra
 	int baseVertex = vertexCount;
 	int currentObject = objectCount++;
 
-	Material* mat = NULL;
-	if (mid >= 0)
-		mat = MaterialManager::materials->find(mid);
-	if (!mat) mat = MaterialManager::materials->find(0);
+	if (mid < 0 || !MaterialManager::materials->find(mid)) mid = 0;
 
 	for (int i = 0; i < mesh->vertexCount; i++) {
 		vec4 normal = mesh->normals4[i];
@@ -95,9 +88,6 @@ void Batch::pushMeshToBuffers(Mesh* mesh,int mid,bool fullStatic,const mat4& tra
 		vec4 tangent4 = vec4(tangent, 0.0);
 		vec2 texcoord = mesh->texcoords[i];
 
-		if (mesh->materialids)
-			mat = MaterialManager::materials->find(mesh->materialids[i]);
-
 		if (!fullStatic) {
 			vec3 vertex3 = mesh->vertices3[i];
 			for (int v = 0; v < 3; v++) {
@@ -117,19 +107,9 @@ void Batch::pushMeshToBuffers(Mesh* mesh,int mid,bool fullStatic,const mat4& tra
 			}
 		}
 
-		texcoordBuffer[vertexCount * 4 + 0] = texcoord.x;
-		texcoordBuffer[vertexCount * 4 + 1] = texcoord.y;
-		texcoordBuffer[vertexCount * 4 + 2] = mat->exTexids.x;
-		texcoordBuffer[vertexCount * 4 + 3] = mat->exTexids.y;
-
-		texidBuffer[vertexCount * 4 + 0] = mat->texids.x;
-		texidBuffer[vertexCount * 4 + 1] = mat->texids.y;
-		texidBuffer[vertexCount * 4 + 2] = mat->texids.z;
-		texidBuffer[vertexCount * 4 + 3] = mat->texids.w;
-
-		colorBuffer[vertexCount * 3 + 0] = (byte)(mat->ambient.x * 255);
-		colorBuffer[vertexCount * 3 + 1] = (byte)(mat->diffuse.x * 255);
-		colorBuffer[vertexCount * 3 + 2] = (byte)(mat->specular.x * 255);
+		texcoordBuffer[vertexCount * 2 + 0] = texcoord.x;
+		texcoordBuffer[vertexCount * 2 + 1] = texcoord.y;
+		materialBuffer[vertexCount] = (ushort)(mesh->materialids ? mesh->materialids[i] : mid);
 
 		objectidBuffer[vertexCount++] = currentObject;
 	}
@@ -169,12 +149,11 @@ void Batch::setRenderData(int pass, BatchData* data) {
 
 	memcpy(vertexBuffer, data->vertices, vertexCount * 3 * sizeof(float));
 	if (pass == NEAR_SHADOW_PASS || pass == MID_SHADOW_PASS || pass == COLOR_PASS) {
-		memcpy(texcoordBuffer, data->texcoords, vertexCount * 4 * sizeof(float));
+		memcpy(texcoordBuffer, data->texcoords, vertexCount * 2 * sizeof(float));
+		memcpy(materialBuffer, data->materials, vertexCount * sizeof(ushort));
 		if (pass == COLOR_PASS) {
-			memcpy(texidBuffer, data->texids, vertexCount * 4 * sizeof(float));
 			memcpy(normalBuffer, data->normals, vertexCount * 3 * sizeof(float));
 			memcpy(tangentBuffer, data->tangents, vertexCount * 3 * sizeof(float));
-			memcpy(colorBuffer, data->colors, vertexCount * 3 * sizeof(byte));
 		}
 	}
 	memcpy(objectidBuffer, data->objectids, vertexCount * sizeof(byte));
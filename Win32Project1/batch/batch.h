@@ -30,8 +30,7 @@ public:
 	float* normalBuffer;
 	float* tangentBuffer;
 	float* texcoordBuffer;
-	float* texidBuffer;
-	unsigned char* colorBuffer;
+	unsigned short* materialBuffer; // Index of MaterialBuffer table
 	unsigned char* objectidBuffer;
 	unsigned int* indexBuffer;
 
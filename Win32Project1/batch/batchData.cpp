@@ -4,9 +4,8 @@ BatchData::BatchData() {
 	vertices = (float*)malloc(MAX_VERTEX_COUNT * 3 * sizeof(float));
 	normals = (float*)malloc(MAX_VERTEX_COUNT * 3 * sizeof(float));
 	tangents = (float*)malloc(MAX_VERTEX_COUNT * 3 * sizeof(float));
-	texcoords = (float*)malloc(MAX_VERTEX_COUNT * 4 * sizeof(float));
-	texids = (float*)malloc(MAX_VERTEX_COUNT * 4 * sizeof(float));
-	colors = (byte*)malloc(MAX_VERTEX_COUNT * 3 * sizeof(byte));
+	texcoords = (float*)malloc(MAX_VERTEX_COUNT * 2 * sizeof(float));
+	materials = (ushort*)malloc(MAX_VERTEX_COUNT * sizeof(ushort));
 	objectids = (byte*)malloc(MAX_VERTEX_COUNT * sizeof(byte));
 	indices = (uint*)malloc(MAX_INDEX_COUNT * sizeof(uint));
 	matrices = (float*)malloc(MAX_OBJECT_COUNT * 12 * sizeof(float));
@@ -22,8 +21,7 @@ BatchData::~BatchData() {
 	free(normals);
 	free(tangents);
 	free(texcoords);
-	free(texids);
-	free(colors);
+	free(materials);
 	free(objectids);
 	free(indices);
 	free(matrices);
@@ -40,15 +38,11 @@ void BatchData::addObject(Object* object, Mesh* mesh) {
 	int baseVertex = vertexCount;
 	int currentObject = objectCount++;
 
-	Material* mat = NULL;
-	if (object->material >= 0)
-		mat = MaterialManager::materials->find(object->material);
-	if (!mat) mat = MaterialManager::materials->find(0);
+	int mid = 0;
+	if (object->material >= 0 && MaterialManager::materials->find(object->material))
+		mid = object->material;
 
 	for (int i = 0; i < mesh->vertexCount; i++) {
-		if (mesh->materialids)
-			mat = MaterialManager::materials->find(mesh->materialids[i]);
-
 		vec3 vertex3 = mesh->vertices3[i];
 		vertices[vertexCount * 3 + 0] = vertex3.x;
 		vertices[vertexCount * 3 + 1] = vertex3.y;
@@ -62,19 +56,9 @@ void BatchData::addObject(Object* object, Mesh* mesh) {
 		tangents[vertexCount * 3 + 1] = mesh->tangents[i].y;
 		tangents[vertexCount * 3 + 2] = mesh->tangents[i].z;
 
-		texcoords[vertexCount * 4 + 0] = mesh->texcoords[i].x;
-		texcoords[vertexCount * 4 + 1] = mesh->texcoords[i].y;
-		texcoords[vertexCount * 4 + 2] = mat->exTexids.x;
-		texcoords[vertexCount * 4 + 3] = mat->exTexids.y;
-
-		texids[vertexCount * 4 + 0] = mat->texids.x;
-		texids[vertexCount * 4 + 1] = mat->texids.y;
-		texids[vertexCount * 4 + 2] = mat->texids.z;
-		texids[vertexCount * 4 + 3] = mat->texids.w;
-
-		colors[vertexCount * 3 + 0] = (byte)(mat->ambient.x * 255);
-		colors[vertexCount * 3 + 1] = (byte)(mat->diffuse.x * 255);
-		colors[vertexCount * 3 + 2] = (byte)(mat->specular.x * 255);
+		texcoords[vertexCount * 2 + 0] = mesh->texcoords[i].x;
+		texcoords[vertexCount * 2 + 1] = mesh->texcoords[i].y;
+		materials[vertexCount] = (ushort)(mesh->materialids ? mesh->materialids[i] : mid);
 
 		objectids[vertexCount++] = currentObject;
 	}
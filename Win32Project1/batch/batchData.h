@@ -13,8 +13,7 @@ public:
 	float* normals;
 	float* tangents;
 	float* texcoords;
-	float* texids;
-	byte* colors;
+	ushort* materials; // Index of MaterialBuffer table
 	byte* objectids;
 	uint* indices;
 	float* matrices;
@@ -0,0 +1,207 @@
+#include "animReport.h"
+#include "../animation/animFile.h"
+#include "benchUtil.h"
+#include <io.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <string>
+using namespace std;
+
+static double FileKB(const char* path) {
+	struct stat info;
+	return stat(path, &info) == 0 ? info.st_size / 1024.0 : 0.0;
+}
+
+// Text load as FrameMgr did it, parsed into Frames & joined into one texture buffer
+static double LoadText(const char* path, AnimFrame* animation, float*& texData) {
+	double start = NowMs();
+	if (!ReadAnimText(path, animation)) return -1.0;
+	int boneCount = animation->frames[0]->boneCount, frameCount = animation->frames.size();
+	texData = (float*)malloc(frameCount * boneCount * ANIM_BONE_FLOATS * sizeof(float));
+	for (int f = 0; f < frameCount; f++)
+		memcpy(texData + f * boneCount * ANIM_BONE_FLOATS, animation->frames[f]->data, boneCount * ANIM_BONE_FLOATS * sizeof(float));
+	return NowMs() - start;
+}
+
+static double LoadBinary(const char* path, AnimFile& file) {
+	double best = -1.0;
+	for (int run = 0; run < ANIM_REPORT_RUNS; run++) {
+		double start = NowMs();
+		if (!file.load(path)) return -1.0;
+		double time = NowMs() - start;
+		best = best < 0.0 || time < best ? time : best;
+	}
+	return best;
+}
+
+static float MaxError(const float* a, const float* b, int count) {
+	float error = 0.0;
+	for (int i = 0; i < count; i++) {
+		float diff = fabsf(a[i] - b[i]);
+		error = diff > error ? diff : error;
+	}
+	return error;
+}
+
+int RunAnimFormatReport(bool convert) {
+	FILE* report = fopen(ANIM_REPORT_FILE, "w");
+	ReportPrint(report, "%-32s %9s %9s %9s %9s %9s %9s %10s %9s\n", "clip", "text KB", "f32 KB", "q16 KB",
+		"text ms", "f32 ms", "q16 ms", "q16 error", "f32 same");
+	double totals[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+	bool allSame = true;
+	_finddata_t found;
+	intptr_t handle = _findfirst(ANIM_REPORT_DIR "/*.t3a", &found);
+	if (handle != -1) {
+		do {
+			string path = string(ANIM_REPORT_DIR) + "/" + found.name;
+			if (IsAnimFile(path.data())) {
+				// Already converted, only its own size & load time are known
+				AnimFile file;
+				double time = LoadBinary(path.data(), file);
+				bool quantized = file.format == ANIM_FORMAT_QUANTIZED;
+				char size[16], load[16];
+				snprintf(size, sizeof(size), "%.1f", FileKB(path.data()));
+				snprintf(load, sizeof(load), "%.3f", time);
+				ReportPrint(report, "%-32s %9s %9s %9s %9s %9s %9s %10s %9s\n", found.name, "-", quantized ? "-" : size,
+					quantized ? size : "-", "-", quantized ? "-" : load, quantized ? load : "-", "-", "-");
+				continue;
+			}
+
+			double textTime = -1.0;
+			float* texData = NULL;
+			AnimFrame* animation = NULL;
+			for (int run = 0; run < ANIM_REPORT_RUNS; run++) {
+				if (animation) delete animation;
+				if (texData) free(texData);
+				animation = new AnimFrame(found.name), texData = NULL;
+				double time = LoadText(path.data(), animation, texData);
+				if (time < 0.0) break;
+				textTime = textTime < 0.0 || time < textTime ? time : textTime;
+			}
+			if (textTime < 0.0) {
+				delete animation;
+				continue;
+			}
+
+			string floatPath = path + ".f32", quantPath = path + ".q16";
+			SaveAnimFile(animation, floatPath.data(), false);
+			SaveAnimFile(animation, quantPath.data(), true);
+			int count = animation->frames.size() * animation->frames[0]->boneCount * ANIM_BONE_FLOATS;
+			AnimFile floatFile, quantFile;
+			double floatTime = LoadBinary(floatPath.data(), floatFile);
+			double quantTime = LoadBinary(quantPath.data(), quantFile);
+			bool same = floatTime >= 0.0 && memcmp(floatFile.data, texData, count * sizeof(float)) == 0;
+			float error = quantTime >= 0.0 ? MaxError(quantFile.data, texData, count) : -1.0;
+			double sizes[3] = { FileKB(path.data()), FileKB(floatPath.data()), FileKB(quantPath.data()) };
+			ReportPrint(report, "%-32s %9.1f %9.1f %9.1f %9.3f %9.3f %9.3f %10.2e %9s\n", found.name, sizes[0], sizes[1], sizes[2],
+				textTime, floatTime, quantTime, error, same ? "yes" : "NO");
+			totals[0] += sizes[0], totals[1] += sizes[1], totals[2] += sizes[2];
+			totals[3] += textTime, totals[4] += floatTime, totals[5] += quantTime;
+			allSame = allSame && same && quantTime >= 0.0;
+			floatFile.release(), quantFile.release();
+			free(texData);
+			delete animation;
+
+			remove(floatPath.data());
+			if (convert && quantTime >= 0.0) {
+				string backup = path + ANIM_TEXT_BACKUP;
+				remove(backup.data());
+				rename(path.data(), backup.data());
+				rename(quantPath.data(), path.data());
+			} else remove(quantPath.data());
+		} while (_findnext(handle, &found) == 0);
+		_findclose(handle);
+	}
+	ReportPrint(report, "%-32s %9.1f %9.1f %9.1f %9.3f %9.3f %9.3f %10s %9s\n", "total", totals[0], totals[1], totals[2],
+		totals[3], totals[4], totals[5], "", allSame ? "yes" : "NO");
+	if (convert) ReportPrint(report, "text files replaced by binary q16, originals kept as *.t3a%s\n", ANIM_TEXT_BACKUP);
+	if (report) fclose(report);
+	return allSame ? 0 : 1;
+}
+
+// Frames of any .t3a, binary ones are copied into Frame objects for the compressor
+static bool LoadFrames(const char* path, AnimFrame* animation, const char*& source) {
+	AnimFile file;
+	if (!file.load(path)) {
+		source = "text";
+		return ReadAnimText(path, animation);
+	}
+	source = file.format == ANIM_FORMAT_FLOAT ? "f32" : (file.format == ANIM_FORMAT_QUANTIZED ? "q16" : "keys");
+	for (int f = 0; f < file.frameCount; f++) {
+		Frame* frame = new Frame(file.boneCount);
+		memcpy(frame->data, file.data + f * file.boneCount * ANIM_BONE_FLOATS, file.boneCount * ANIM_BONE_FLOATS * sizeof(float));
+		animation->frames.push_back(frame);
+	}
+	animation->setDuration(file.duration);
+	animation->setTicksPerSecond(file.ticksPerSecond);
+	return true;
+}
+
+int RunAnimKeyReport(float error) {
+	if (error <= 0.0) error = ANIM_KEY_ERROR;
+	FILE* report = fopen(ANIM_KEY_REPORT_FILE, "w");
+	ReportPrint(report, "tolerance %g of shell\n", error);
+	ReportPrint(report, "%-32s %5s %6s %6s %7s %9s %9s %7s %10s %10s %9s %9s\n", "clip", "src", "bones", "frames", "keys %",
+		"frame KB", "key KB", "ratio", "shell", "max error", "decode ms", "sample us");
+	double totalFrames = 0.0, totalKeys = 0.0;
+	bool allFit = true;
+	_finddata_t found;
+	intptr_t handle = _findfirst(ANIM_REPORT_DIR "/*.t3a", &found);
+	if (handle != -1) {
+		do {
+			string path = string(ANIM_REPORT_DIR) + "/" + found.name, keyPath = path + ".key";
+			AnimFrame* animation = new AnimFrame(found.name);
+			const char* source = "";
+			AnimCompressor compressor;
+			if (!LoadFrames(path.data(), animation, source) || animation->frames.size() <= 0 ||
+				!compressor.compress(animation, error) || !SaveAnimKeyFile(animation, keyPath.data(), &compressor)) {
+				delete animation;
+				continue;
+			}
+
+			// Decoded texture is checked against source frames at shell points
+			AnimFile decoded, sampled;
+			double decodeTime = LoadBinary(keyPath.data(), decoded);
+			bool loaded = decodeTime >= 0.0 && sampled.load(keyPath.data(), true);
+			int boneCount = compressor.boneCount, frameCount = compressor.frameCount;
+			float maxError = loaded ? 0.0 : -1.0;
+			for (int f = 0; loaded && f < frameCount; f++) {
+				for (int b = 0; b < boneCount; b++) {
+					float e = GetBoneError(decoded.data + (f * boneCount + b) * ANIM_BONE_FLOATS,
+						animation->frames[f]->data + b * ANIM_BONE_FLOATS, compressor.shell);
+					maxError = e > maxError ? e : maxError;
+				}
+			}
+
+			// Sampling between frames walks keys of every bone, time is per sampled frame
+			double sampleTime = 0.0;
+			if (loaded) {
+				float* bones = (float*)malloc(boneCount * ANIM_BONE_FLOATS * sizeof(float));
+				double start = NowMs();
+				for (int f = 0; f < frameCount; f++)
+					sampled.sample(f + 0.5f, bones);
+				sampleTime = (NowMs() - start) * 1000.0 / frameCount;
+				free(bones);
+			}
+
+			double frameKB = (double)frameCount * boneCount * ANIM_BONE_FLOATS * sizeof(float) / 1024.0;
+			double keyKB = FileKB(keyPath.data());
+			bool fits = loaded && maxError <= compressor.tolerance * 1.01;
+			ReportPrint(report, "%-32s %5s %6d %6d %6.1f%% %9.1f %9.1f %6.1fx %10.3g %10.3g %9.3f %9.2f%s\n", found.name, source,
+				boneCount, frameCount, 100.0 * compressor.frames.size() / ((double)boneCount * frameCount), frameKB, keyKB,
+				frameKB / keyKB, compressor.shell, maxError, decodeTime, sampleTime, fits ? "" : " over");
+			totalFrames += frameKB, totalKeys += keyKB;
+			allFit = allFit && fits;
+			decoded.release(), sampled.release();
+			remove(keyPath.data());
+			delete animation;
+		} while (_findnext(handle, &found) == 0);
+		_findclose(handle);
+	}
+	ReportPrint(report, "%-32s %5s %6s %6s %7s %9.1f %9.1f %6.1fx\n", "total", "", "", "", "",
+		totalFrames, totalKeys, totalKeys > 0.0 ? totalFrames / totalKeys : 0.0);
+	if (report) fclose(report);
+	return allFit ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+#ifndef ANIM_REPORT_H_
+#define ANIM_REPORT_H_
+
+#define ANIM_REPORT_DIR "animation"
+#define ANIM_REPORT_FILE "animformat.txt"
+#define ANIM_REPORT_RUNS 3 // Best load of each format is reported
+#define ANIM_TEXT_BACKUP ".v1" // Converted text files are kept with this added to their name
+#define ANIM_KEY_REPORT_FILE "animkeys.txt"
+
+// Write every text .t3a in ANIM_REPORT_DIR as float & quantized binary, print sizes, load ms & quantization error
+// With convert the quantized file replaces the text one, table is saved to ANIM_REPORT_FILE too
+int RunAnimFormatReport(bool convert);
+// Compress every .t3a in ANIM_REPORT_DIR with AnimCompressor, error is tolerance as fraction of clip shell distance
+// Print key count, compression ratio against float frames & largest joint position error of each clip
+int RunAnimKeyReport(float error);
+
+#endif
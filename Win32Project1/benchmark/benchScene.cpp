@@ -0,0 +1,170 @@
+#include "benchScene.h"
+#include "../assets/assetManager.h"
+#include "../object/staticObject.h"
+#include "../node/staticNode.h"
+#include "../node/instanceNode.h"
+#include "../node/animationNode.h"
+#include <math.h>
+using namespace std;
+
+BenchAnimation::BenchAnimation(Material* material) :Animation() {
+	// 6 faces with their own normals, 4 vertices each
+	static const float normals[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	for (int f = 0; f < 6; f++) {
+		vec3 n(normals[f][0], normals[f][1], normals[f][2]);
+		vec3 u(n.y, n.z, n.x), v = n.CrossProduct(u);
+		int base = aVertices.size();
+		for (int i = 0; i < 4; i++) {
+			float su = (i & 1) ? 1.0 : -1.0, sv = (i & 2) ? 1.0 : -1.0;
+			aVertices.push_back(n + u * su + v * sv);
+			aNormals.push_back(n);
+			aTangents.push_back(u);
+			aTexcoords.push_back(vec2((i & 1) ? 1.0 : 0.0, (i & 2) ? 1.0 : 0.0));
+			aTextures.push_back(material);
+			aAmbients.push_back(material->ambient);
+			aDiffuses.push_back(material->diffuse);
+			aSpeculars.push_back(material->specular);
+			aBoneids.push_back(vec4(0, 0, 0, 0));
+			aWeights.push_back(vec4(1, 0, 0, 0));
+		}
+		aIndices.push_back(base + 0); aIndices.push_back(base + 1); aIndices.push_back(base + 3);
+		aIndices.push_back(base + 0); aIndices.push_back(base + 3); aIndices.push_back(base + 2);
+	}
+	vertCount = aVertices.size();
+	faceCount = aIndices.size() / 3;
+	boneCount = 1;
+}
+
+void CreateBenchAssets() {
+	AssetManager* assetMgr = AssetManager::assetManager;
+	MaterialManager* mtlMgr = MaterialManager::materials;
+	if (assetMgr->animations.find(BENCH_ANIM_NAME) != assetMgr->animations.end()) return;
+
+	Material* benchMat = new Material("bench_mat");
+	mtlMgr->add(benchMat);
+
+	Animation* anim = new BenchAnimation(benchMat);
+	anim->setName(BENCH_ANIM_NAME);
+	assetMgr->animations[BENCH_ANIM_NAME] = anim;
+
+	// Identity bone in every frame, only frame stepping cost matters here
+	AnimFrame* animData = new AnimFrame(BENCH_ANIM_DATA);
+	for (int f = 0; f < BENCH_ANIM_FRAMES; f++) {
+		Frame* frame = new Frame(1);
+		memset(frame->data, 0, 12 * sizeof(float));
+		frame->data[0] = 1.0, frame->data[5] = 1.0, frame->data[10] = 1.0;
+		animData->frames.push_back(frame);
+	}
+	animData->setDuration(BENCH_ANIM_FRAMES);
+	animData->setTicksPerSecond(25.0);
+	assetMgr->animationDatas[animData->getName()] = animData;
+}
+
+float GetBenchSceneRadius(int objectCount) {
+	int side = (int)ceilf(sqrtf((float)objectCount));
+	return side * BENCH_SPACE * 0.5;
+}
+
+static float RandomFloat() {
+	return (rand() % 1000) * 0.001;
+}
+
+// Place i-th object of a shared jittered grid, so every kind of node spreads on the whole scene
+static vec3 GridPosition(int i, int side, float radius) {
+	float x = (i % side) * BENCH_SPACE - radius + BENCH_SPACE * RandomFloat();
+	float z = (i / side) * BENCH_SPACE - radius + BENCH_SPACE * RandomFloat();
+	return vec3(x, 0, z);
+}
+
+void CreateBenchScene(Scene* scene, const BenchSceneDesc& desc) {
+	AssetManager* assetMgr = AssetManager::assetManager;
+	MaterialManager* mtlMgr = MaterialManager::materials;
+	map<string, Mesh*> meshes = assetMgr->meshes;
+
+	srand(desc.seed);
+	int staticCount = (int)(desc.objectCount * desc.staticRatio);
+	int dynamicCount = (int)(desc.objectCount * desc.dynamicRatio);
+	int animCount = (int)(desc.objectCount * desc.animRatio);
+	int treeCount = desc.objectCount - staticCount - dynamicCount - animCount;
+	if (treeCount < 0) treeCount = 0;
+
+	int side = (int)ceilf(sqrtf((float)desc.objectCount));
+	float radius = GetBenchSceneRadius(desc.objectCount);
+	int placed = 0;
+
+	StaticObject tree(meshes["sphere"], meshes["box"], meshes["billboard"]);
+	tree.detailLevel = 4;
+	tree.setBillboard(5, 10, mtlMgr->find("bench_mat"));
+	StaticObject box(meshes["box"]);
+	box.bindMaterial(mtlMgr->find("bench_mat"));
+
+	// Instanced trees, grouped in grids as SimpleApplication does
+	int perNode = BENCH_GRID_SIZE * BENCH_GRID_SIZE;
+	for (int n = 0; n < treeCount; n += perNode) {
+		InstanceNode* node = new InstanceNode(vec3(0, 0, 0));
+		node->detailLevel = 4;
+		for (int i = n; i < n + perNode && i < treeCount; i++) {
+			StaticObject* object = tree.clone();
+			float size = RandomFloat() * 2 + 3;
+			vec3 position = GridPosition(placed++, side, radius);
+			object->setSize(size, size, size);
+			object->setRotation(0, 360 * RandomFloat(), 0);
+			object->setPosition(position.x, position.y, position.z);
+			node->addObject(scene, object);
+		}
+		scene->staticRoot->attachChild(scene, node);
+	}
+
+	// Static nodes batch their boxes
+	for (int n = 0; n < staticCount; n += 4) {
+		StaticNode* node = new StaticNode(vec3(0, 0, 0));
+		for (int i = n; i < n + 4 && i < staticCount; i++) {
+			StaticObject* object = box.clone();
+			vec3 position = GridPosition(placed++, side, radius);
+			object->setSize(4, 4, 4);
+			object->setPosition(position.x, 2, position.z);
+			node->addObject(scene, object);
+		}
+		scene->staticRoot->attachChild(scene, node);
+	}
+
+	// Dynamic boxes are updated from physics every frame
+	for (int n = 0; n < dynamicCount; n += perNode) {
+		InstanceNode* node = new InstanceNode(vec3(0, 0, 0));
+		for (int i = n; i < n + perNode && i < dynamicCount; i++) {
+			StaticObject* object = box.clone();
+			vec3 position = GridPosition(placed++, side, radius);
+			object->setSize(6, 6, 6);
+			object->setRotation(0, 360 * RandomFloat(), 0);
+			object->setPosition(position.x, 3, position.z);
+			object->setDynamic(true);
+			node->addObject(scene, object);
+		}
+		scene->staticRoot->attachChild(scene, node);
+	}
+
+	// Animation nodes under a few group nodes, like SimpleApplication's animation root
+	Animation* anim = assetMgr->animations[BENCH_ANIM_NAME];
+	vector<Node*> animGroups;
+	Node* animGroup = NULL;
+	for (int i = 0; i < animCount; i++) {
+		if (i % perNode == 0) {
+			animGroup = new StaticNode(vec3(0, 0, 0));
+			animGroups.push_back(animGroup);
+		}
+		AnimationNode* node = new AnimationNode(vec3(5, 10, 5));
+		vec3 position = GridPosition(placed++, side, radius);
+		node->translateNode(scene, position.x, 5, position.z); // Before its body is added
+		node->setAnimation(scene, anim);
+		node->scaleNodeObject(scene, 2.5, 5, 2.5);
+		node->rotateNodeObject(scene, 0, 360 * RandomFloat(), 0);
+		node->getObject()->setDefaultAnim(BENCH_ANIM_DATA);
+		node->getObject()->setLoop(true);
+		animGroup->attachChild(scene, node);
+	}
+	for (uint i = 0; i < animGroups.size(); i++)
+		scene->animationRoot->attachChild(scene, animGroups[i]);
+
+	scene->updateNodes();
+	scene->initAnimNodes();
+}
@@ -0,0 +1,36 @@
+#ifndef BENCH_SCENE_H_
+#define BENCH_SCENE_H_
+
+#include "../scene/scene.h"
+#include "../animation/animation.h"
+
+#define BENCH_GRID_SIZE 16 // Objects per instance node is BENCH_GRID_SIZE^2, like tree grids in SimpleApplication
+#define BENCH_SPACE 20.0f
+#define BENCH_ANIM_NAME "bench"
+#define BENCH_ANIM_DATA "bench_idle"
+#define BENCH_ANIM_FRAMES 30
+
+// Share of objects for each kind of node, instanced trees take the rest
+struct BenchSceneDesc {
+	int objectCount;
+	float staticRatio; // Boxes batched in static nodes
+	float dynamicRatio; // Boxes driven by physics
+	float animRatio; // Animation nodes
+	uint seed;
+};
+
+// Skinned box with one bone, so animation nodes need no model file and no bone texture
+class BenchAnimation : public Animation {
+public:
+	BenchAnimation(Material* material);
+	virtual ~BenchAnimation() {}
+};
+
+// Meshes, materials and animation used by bench scenes, all created on cpu
+void CreateBenchAssets();
+// Build scene with real node & object apis, objects spread on a square around origin
+void CreateBenchScene(Scene* scene, const BenchSceneDesc& desc);
+// Half size of the square objects are spread on
+float GetBenchSceneRadius(int objectCount);
+
+#endif
@@ -0,0 +1,35 @@
+#include "benchUtil.h"
+#include <stdarg.h>
+#include <string.h>
+#include <chrono>
+using namespace std;
+
+double NowMs() {
+	return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int GetObjTexcoordSize(const char* path) {
+	FILE* file = fopen(path, "r");
+	if (!file) return 2;
+	char line[256];
+	int size = 2;
+	while (fgets(line, sizeof(line), file)) {
+		if (strncmp(line, "vt ", 3) != 0) continue;
+		float u, v, w;
+		size = sscanf(line + 3, "%f %f %f", &u, &v, &w) == 3 ? 3 : 2;
+		break;
+	}
+	fclose(file);
+	return size;
+}
+
+void ReportPrint(FILE* report, const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	if (!report) return;
+	va_start(args, format);
+	vfprintf(report, format, args);
+	va_end(args);
+}
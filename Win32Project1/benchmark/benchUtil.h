@@ -0,0 +1,13 @@
+#ifndef BENCH_UTIL_H_
+#define BENCH_UTIL_H_
+
+#include <stdio.h>
+
+// Steady clock in ms, for timed runs of benchmark & reports
+double NowMs();
+// Obj files with 3 numbers on vt lines need vt 3 in Model
+int GetObjTexcoordSize(const char* path);
+// Print to stdout & to report file when it could be opened
+void ReportPrint(FILE* report, const char* format, ...);
+
+#endif
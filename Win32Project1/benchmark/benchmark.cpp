@@ -0,0 +1,179 @@
+#include "benchmark.h"
+#include "../util/profiler.h"
+#include "../render/commandList.h"
+#include "benchUtil.h"
+#include <algorithm>
+using namespace std;
+
+static const char* StageNames[STAGE_COUNT] = {
+	"act", "updateNodes", "physics", "updateDynamicNodes", "updateAnimNodes",
+	"updateData", "prepare", "swapData", "animate", "radixSort"
+};
+
+BenchmarkApplication::BenchmarkApplication(const BenchSceneDesc& sceneDesc) : Application() {
+	desc = sceneDesc;
+	radius = GetBenchSceneRadius(desc.objectCount);
+	cfgs->headless = true;
+	cfgs->dualthread = true; // Use frame ring like the game, stages just run in order on this thread
+	cfgs->shadowQuality = cfgs->shadowQuality < 1 ? 1 : cfgs->shadowQuality;
+}
+
+// Same as Application::init but without Render, so no gl call is made
+void BenchmarkApplication::init() {
+	AssetManager::Init();
+	MaterialManager::Init();
+	JobSystem::Init(cfgs->workers);
+	if (cfgs->profile) Profiler::Init();
+	scene = new Scene();
+	input = new Input();
+
+	float lowDist = cfgs->graphQuality > 4 ? 600 : 200;
+	float farDist = cfgs->graphQuality > 4 ? 1200 : 800;
+	renderMgr = new RenderManager(cfgs, scene, lowDist, farDist, vec3(-1, -1, -1));
+
+	scene->actCamera->initPerspectCamera(60.0, (float)windowWidth / windowHeight, 1.0, 2000.0);
+	renderMgr->updateShadowCamera(scene->actCamera);
+	initScene();
+}
+
+void BenchmarkApplication::initScene() {
+	CreateBenchAssets();
+	CreateBenchScene(scene, desc);
+	Application::initScene();
+}
+
+// Orbit around scene center and look along the path, one lap every BENCH_FRAMES frames
+void BenchmarkApplication::moveCamera(int frame) {
+	float angle = 360.0 * frame / BENCH_FRAMES;
+	float radian = angleToRadian(angle);
+	float orbit = radius * 0.5;
+	scene->actCamera->moveTo(vec3(orbit * sinf(radian), 20.0, orbit * cosf(radian)));
+	scene->actCamera->turnDX(360.0 / BENCH_FRAMES);
+	scene->actCamera->updateMoveable(TRANS_ROTATE_X | TRANS_ROTATE_Y | TRANS_TRANSLATE);
+}
+
+// Render thread creates queue instances at first draw, records are only culled once they exist
+// Here they get ids the way MultiInstance::initBuffers gives them, but no gl buffer
+void BenchmarkApplication::createInstances() {
+	Renderable* frame = renderMgr->currentQueue;
+	for (uint q = 0; q < frame->queues.size(); q++) {
+		RenderQueue* queue = frame->queues[q];
+		for (uint i = 0; i < queue->instanceQueue.size(); i++) {
+			InstanceData* data = queue->instanceQueue[i];
+			if (data->instance) continue;
+			Instance* instance = new Instance(data);
+			if (instance->hasNormal) instance->insId = i;
+			if (instance->hasSingle) instance->insSingleId = i;
+			if (instance->isBillboard) instance->insBillId = i;
+			data->instance = instance;
+		}
+	}
+}
+
+#define BENCH_STAGE(index, call) { \
+	double stageStart = NowMs(); \
+	call; \
+	if (measure) stages[index].samples.push_back((float)(NowMs() - stageStart)); }
+
+void BenchmarkApplication::runFrame(int frame, BenchStage* stages, bool measure) {
+	float dTime = BENCH_STEP;
+	float velocity = D_DISTANCE * dTime;
+	long currentTime = (long)(frame * BENCH_STEP);
+
+	BENCH_STAGE(STAGE_ACT, moveCamera(frame); Application::act(0, currentTime, dTime * 0.001, velocity));
+	BENCH_STAGE(STAGE_UPDATE_NODES, scene->updateNodes());
+	BENCH_STAGE(STAGE_PHYSICS, scene->collisionWorld->act(dTime * 0.001));
+	BENCH_STAGE(STAGE_DYNAMIC, scene->updateDynamicNodes());
+	BENCH_STAGE(STAGE_ANIM_NODES, scene->updateAnimNodes());
+	BENCH_STAGE(STAGE_UPDATE_DATA, updateData());
+	BENCH_STAGE(STAGE_PREPARE, prepare());
+	BENCH_STAGE(STAGE_SWAP, swapData(true));
+	BENCH_STAGE(STAGE_ANIMATE, animate(velocity));
+	createInstances();
+}
+
+static void SummarizeStage(BenchStage* stage) {
+	stage->minTime = 0, stage->avgTime = 0, stage->p99Time = 0;
+	int count = stage->samples.size();
+	if (count <= 0) return;
+	vector<float> sorted = stage->samples;
+	sort(sorted.begin(), sorted.end());
+	float sum = 0;
+	for (int i = 0; i < count; i++)
+		sum += sorted[i];
+	stage->minTime = sorted[0];
+	stage->avgTime = sum / count;
+	stage->p99Time = sorted[(count * 99 + 99) / 100 - 1];
+}
+
+// Random keys with few shaders & materials, as a frame of node draws looks like
+static void BenchSort(int count, int frames, BenchStage* stage) {
+	srand(count);
+	DrawCommand* keys = (DrawCommand*)malloc(count * sizeof(DrawCommand));
+	DrawCommand* commands = (DrawCommand*)malloc(count * sizeof(DrawCommand));
+	DrawCommand* tmp = (DrawCommand*)malloc(count * sizeof(DrawCommand));
+	for (int i = 0; i < count; i++) {
+		keys[i].key = MakeSortKey(COLOR_PASS, rand() % 4, rand() % 64, rand() % 256, (float)(rand() % 10000), 10000.0);
+		keys[i].data = NULL;
+	}
+	for (int f = 0; f < frames; f++) {
+		memcpy(commands, keys, count * sizeof(DrawCommand));
+		double start = NowMs();
+		RadixSortCommands(commands, tmp, count);
+		stage->samples.push_back((float)(NowMs() - start));
+	}
+	free(keys);
+	free(commands);
+	free(tmp);
+}
+
+int RunBenchmark(int frames) {
+	static const int objectCounts[] = { 1000, 10000, 100000 };
+	if (frames <= 0) frames = BENCH_FRAMES;
+	FILE* report = fopen(BENCH_REPORT_FILE, "w");
+
+	for (int s = 0; s < 3; s++) {
+		BenchSceneDesc desc;
+		desc.objectCount = objectCounts[s];
+		desc.staticRatio = 0.05;
+		desc.dynamicRatio = 0.01;
+		desc.animRatio = 0.01;
+		desc.seed = 100;
+
+		BenchStage stages[STAGE_COUNT];
+		for (int i = 0; i < STAGE_COUNT; i++)
+			stages[i].name = StageNames[i];
+
+		double initStart = NowMs();
+		BenchmarkApplication* app = new BenchmarkApplication(desc);
+		app->init();
+		double initTime = NowMs() - initStart;
+
+		for (int f = 0; f < BENCH_WARMUP; f++)
+			app->runFrame(f, stages, false);
+		for (int f = 0; f < frames; f++)
+			app->runFrame(BENCH_WARMUP + f, stages, true);
+		u64 written = 0, copied = 0;
+		app->renderMgr->getInstanceTraffic(written, copied);
+		RenderRingStats ring = app->renderMgr->getRingStats();
+		int totalFrames = BENCH_WARMUP + frames;
+		delete app;
+		BenchSort(desc.objectCount, frames, &stages[STAGE_SORT]);
+
+		ReportPrint(report, "objects %d, frames %d, init %.1f ms\n", desc.objectCount, frames, initTime);
+		ReportPrint(report, "instance records per frame: culled %.1f KB, copied %.1f KB\n",
+			written / 1024.0 / totalFrames, copied / 1024.0 / totalFrames);
+		ReportPrint(report, "frame ring: published %llu, consumed %llu, dropped %llu, latency avg %.3f ms, max %.3f ms\n",
+			ring.published, ring.consumed, ring.dropped, ring.latencyAvg, ring.latencyMax);
+		ReportPrint(report, "%-20s %10s %10s %10s\n", "stage", "min(ms)", "avg(ms)", "p99(ms)");
+		for (int i = 0; i < STAGE_COUNT; i++) {
+			SummarizeStage(&stages[i]);
+			ReportPrint(report, "%-20s %10.3f %10.3f %10.3f\n", stages[i].name, stages[i].minTime, stages[i].avgTime, stages[i].p99Time);
+		}
+		ReportPrint(report, "\n");
+	}
+
+	if (!report) return 1; // Timings were printed, but nothing is saved for comparison
+	fclose(report);
+	return 0;
+}
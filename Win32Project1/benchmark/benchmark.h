@@ -0,0 +1,51 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "../application/application.h"
+#include "benchScene.h"
+
+#define BENCH_FRAMES 300
+#define BENCH_WARMUP 10
+#define BENCH_STEP 16.6667f // Fixed frame time in ms
+#define BENCH_REPORT_FILE "benchmark.txt"
+
+#define STAGE_ACT          0
+#define STAGE_UPDATE_NODES 1
+#define STAGE_PHYSICS      2
+#define STAGE_DYNAMIC      3
+#define STAGE_ANIM_NODES   4
+#define STAGE_UPDATE_DATA  5
+#define STAGE_PREPARE      6
+#define STAGE_SWAP         7
+#define STAGE_ANIMATE      8
+#define STAGE_SORT         9
+#define STAGE_COUNT        10
+
+struct BenchStage {
+	const char* name;
+	std::vector<float> samples; // ms of each measured frame
+	float minTime, avgTime, p99Time;
+};
+
+// Runs cpu side of a frame without window & gl context, camera follows a fixed orbit
+class BenchmarkApplication : public Application {
+private:
+	BenchSceneDesc desc;
+	float radius;
+public:
+	BenchmarkApplication(const BenchSceneDesc& sceneDesc);
+	virtual ~BenchmarkApplication() {}
+public:
+	virtual void init();
+	virtual void initScene();
+	virtual void draw() {}
+	void moveCamera(int frame);
+	void createInstances();
+	void runFrame(int frame, BenchStage* stages, bool measure);
+};
+
+// Run bench scenes of 1k/10k/100k objects, print per stage timings and save them to BENCH_REPORT_FILE
+// Return 1 if report could not be saved
+int RunBenchmark(int frames);
+
+#endif
@@ -0,0 +1,35 @@
+#include "cacheReport.h"
+#include "../mesh/model.h"
+#include "../mesh/vertexCache.h"
+#include "../animation/assanim.h"
+#include "../animation/fbxloader.h"
+#include "../material/materialManager.h"
+#include "benchUtil.h"
+#include <io.h>
+#include <string>
+using namespace std;
+
+int RunVertexCacheReport() {
+	MaterialManager::Init();
+	BeginVertexCacheLog();
+
+	_finddata_t found;
+	intptr_t handle = _findfirst(CACHE_REPORT_MODELS "/*", &found);
+	if (handle != -1) {
+		do {
+			string file = found.name;
+			size_t dot = file.find_last_of('.');
+			if (dot == string::npos) continue;
+			string base = string(CACHE_REPORT_MODELS) + "/" + file.substr(0, dot), ext = file.substr(dot + 1);
+			string path = string(CACHE_REPORT_MODELS) + "/" + file;
+			if (ext == "obj") delete new Model(path.data(), (base + ".mtl").data(), GetObjTexcoordSize(path.data()));
+			else if (ext == "fbx") delete new FBXLoader(path.data());
+			else if (ext == "mesh" || ext == "dae") delete new AssAnim(path.data());
+		} while (_findnext(handle, &found) == 0);
+		_findclose(handle);
+	}
+
+	EndVertexCacheLog(VERTEX_CACHE_REPORT_FILE);
+	MaterialManager::Release();
+	return 0;
+}
@@ -0,0 +1,10 @@
+#ifndef CACHE_REPORT_H_
+#define CACHE_REPORT_H_
+
+#define CACHE_REPORT_MODELS "models"
+
+// Load every obj, fbx & ogre mesh in CACHE_REPORT_MODELS, print ACMR/ATVR before and after vertex reorder
+// Table is saved to VERTEX_CACHE_REPORT_FILE too
+int RunVertexCacheReport();
+
+#endif
@@ -0,0 +1,221 @@
+#include "objReport.h"
+#include "../model/objloader.h"
+#include "../material/materialManager.h"
+#include "../thread/jobSystem.h"
+#include "benchUtil.h"
+#include <io.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+// Obj & mtl parsers as they were before mapped parsing, kept as reference of expected output
+struct ReferenceObj {
+	int vCount, vtCount, vnCount, faceCount;
+	vector<float> vArr, vtArr, vnArr;
+	vector<int> fvArr, ftArr, fnArr;
+	vector<string> mtArr;
+};
+
+static void ReadObjReference(const char* path, int vtNumber, ReferenceObj& obj) {
+	obj.vCount = 0, obj.vtCount = 0, obj.vnCount = 0, obj.faceCount = 0;
+	ifstream infile(path);
+	string sline;
+	while (getline(infile, sline)) {
+		if (sline[0] == 'v') {
+			if (sline[1] == 'n') obj.vnCount++;
+			else if (sline[1] == 't') obj.vtCount++;
+			else obj.vCount++;
+		}
+		if (sline[0] == 'f') obj.faceCount++;
+	}
+	infile.close();
+
+	obj.vArr.assign(obj.vCount * 3, 0.0), obj.vtArr.assign(obj.vtCount * vtNumber, 0.0), obj.vnArr.assign(obj.vnCount * 3, 0.0);
+	obj.fvArr.assign(obj.faceCount * 3, 0), obj.ftArr.assign(obj.faceCount * 3, 0), obj.fnArr.assign(obj.faceCount * 3, 0);
+	obj.mtArr.assign(obj.faceCount, "");
+	infile.open(path);
+	int ii = 0, tt = 0, jj = 0, kk = 0;
+	string s1, mtl("");
+	float f2, f3, f4;
+	while (getline(infile, sline)) {
+		if (sline[0] == 'v') {
+			istringstream ins(sline);
+			if (sline[1] == 'n') {
+				ins >> s1 >> f2 >> f3 >> f4;
+				obj.vnArr[ii * 3] = f2, obj.vnArr[ii * 3 + 1] = f3, obj.vnArr[ii * 3 + 2] = f4;
+				ii++;
+			} else if (sline[1] == 't') {
+				if (vtNumber == 3) {
+					ins >> s1 >> f2 >> f3 >> f4;
+					obj.vtArr[tt * 3] = f2, obj.vtArr[tt * 3 + 1] = f3, obj.vtArr[tt * 3 + 2] = f4;
+				} else {
+					ins >> s1 >> f2 >> f3;
+					obj.vtArr[tt * 2] = f2, obj.vtArr[tt * 2 + 1] = f3;
+				}
+				tt++;
+			} else {
+				ins >> s1 >> f2 >> f3 >> f4;
+				obj.vArr[jj * 3] = f2, obj.vArr[jj * 3 + 1] = f3, obj.vArr[jj * 3 + 2] = f4;
+				jj++;
+			}
+		} else if (sline[0] == 'f') {
+			istringstream ins(sline);
+			ins >> s1;
+			for (int i = 0; i < 3; i++) {
+				ins >> s1;
+				float a = 0;
+				int k;
+				for (k = 0; s1[k] != '/'; k++) a = a * 10 + (s1[k] - 48);
+				obj.fvArr[kk * 3 + i] = a;
+				a = 0;
+				for (k = k + 1; s1[k] != '/'; k++) a = a * 10 + (s1[k] - 48);
+				obj.ftArr[kk * 3 + i] = a;
+				a = 0;
+				for (k = k + 1; s1[k]; k++) a = a * 10 + (s1[k] - 48);
+				obj.fnArr[kk * 3 + i] = a;
+			}
+			obj.mtArr[kk] = mtl;
+			kk++;
+		} else if (sline[0] == 'u' && sline[1] == 's') {
+			istringstream ins(sline);
+			ins >> s1 >> mtl;
+		}
+	}
+	infile.close();
+}
+
+static void ReadMtlReference(const char* path, vector<Material*>& mtls) {
+	ifstream infile(path);
+	string sline, value, name, texture;
+	float red = 0, green = 0, blue = 0, single = 0;
+	Material* mtl = NULL;
+	while (getline(infile, sline)) {
+		if (sline == "") continue;
+		istringstream ins(sline);
+		ins >> value;
+		if (value == "newmtl") {
+			ins >> name;
+			mtl = new Material(name.c_str());
+			mtls.push_back(mtl);
+		} else if (value == "map_Kd") {
+			ins >> texture;
+			if (mtl) mtl->tex1 = texture, mtl->srgb1 = true;
+		} else if (value == "map_Kn") {
+			ins >> texture;
+			if (mtl) mtl->tex2 = texture, mtl->srgb2 = false;
+		} else if (value == "map_Km") {
+			ins >> texture;
+			if (mtl) mtl->tex3 = texture, mtl->srgb3 = false;
+		} else if (value == "map_Kr") {
+			ins >> texture;
+			if (mtl) mtl->tex4 = texture, mtl->srgb4 = false;
+		} else if (value == "Kd") {
+			ins >> red >> green >> blue;
+			if (mtl) mtl->diffuse = vec3(red, green, blue);
+		} else if (value == "Ka") {
+			ins >> red >> green >> blue;
+			if (mtl) mtl->ambient = vec3(red, green, blue);
+		} else if (value == "Ks") {
+			ins >> red >> green >> blue;
+			if (mtl) mtl->specular = vec3(red, green, blue);
+		} else if (value == "single") {
+			ins >> single;
+			if (mtl) mtl->singleFace = true;
+		}
+	}
+	infile.close();
+}
+
+static bool SameVec3(const vec3& a, const vec3& b) {
+	return memcmp(&a, &b, sizeof(vec3)) == 0;
+}
+
+static bool SameMaterial(const Material* a, const Material* b) {
+	return a->name == b->name && a->tex1 == b->tex1 && a->tex2 == b->tex2 && a->tex3 == b->tex3 && a->tex4 == b->tex4 &&
+		a->srgb1 == b->srgb1 && a->srgb2 == b->srgb2 && a->srgb3 == b->srgb3 && a->srgb4 == b->srgb4 &&
+		SameVec3(a->ambient, b->ambient) && SameVec3(a->diffuse, b->diffuse) && SameVec3(a->specular, b->specular) &&
+		a->singleFace == b->singleFace;
+}
+
+template<typename T>
+static bool SameArray(const vector<T>& reference, const T* data, int count) {
+	if ((int)reference.size() != count) return false;
+	return count == 0 || memcmp(&reference[0], data, count * sizeof(T)) == 0;
+}
+
+int RunObjParseReport() {
+	MaterialManager::Init();
+	JobSystem::Init(-1);
+	FILE* report = fopen(OBJ_REPORT_FILE, "w");
+	ReportPrint(report, "workers %d\n", JobSystem::jobSystem->getWorkerCount());
+	ReportPrint(report, "%-24s %8s %12s %12s %8s %10s\n", "asset", "MB", "stream MB/s", "mapped MB/s", "speedup", "identical");
+
+	double totalMB = 0.0, totalStream = 0.0, totalMapped = 0.0;
+	bool allSame = true;
+	_finddata_t found;
+	intptr_t handle = _findfirst(OBJ_REPORT_MODELS "/*.obj", &found);
+	if (handle != -1) {
+		do {
+			string file = found.name;
+			string base = string(OBJ_REPORT_MODELS) + "/" + file.substr(0, file.find_last_of('.'));
+			string obj = base + ".obj", mtl = base + ".mtl";
+			int vt = GetObjTexcoordSize(obj.data());
+
+			double streamTime = 0.0, mappedTime = 0.0;
+			ReferenceObj reference;
+			ObjLoader* loader = NULL;
+			for (int run = 0; run < OBJ_REPORT_RUNS; run++) {
+				double start = NowMs();
+				ReadObjReference(obj.data(), vt, reference);
+				double time = NowMs() - start;
+				streamTime = run == 0 || time < streamTime ? time : streamTime;
+
+				// Each run registers into a fresh manager, so materials checked below are the only copies
+				if (loader) delete loader;
+				MaterialManager::Release();
+				MaterialManager::Init();
+				start = NowMs();
+				loader = new ObjLoader(obj.data(), mtl.data(), vt);
+				time = NowMs() - start;
+				mappedTime = run == 0 || time < mappedTime ? time : mappedTime;
+			}
+
+			bool same = loader->vCount == reference.vCount && loader->faceCount == reference.faceCount &&
+				SameArray(reference.vArr, loader->vArr, reference.vCount * 3) &&
+				SameArray(reference.vtArr, loader->vtArr, reference.vtCount * vt) &&
+				SameArray(reference.vnArr, loader->vnArr, reference.vnCount * 3) &&
+				SameArray(reference.fvArr, loader->fvArr, loader->faceCount * 3) &&
+				SameArray(reference.ftArr, loader->ftArr, loader->faceCount * 3) &&
+				SameArray(reference.fnArr, loader->fnArr, loader->faceCount * 3);
+			for (int i = 0; same && i < loader->faceCount; i++)
+				same = reference.mtArr[i] == loader->mtNames[loader->mtArr[i]];
+
+			vector<Material*> mtls;
+			ReadMtlReference(mtl.data(), mtls);
+			same = same && mtls.size() == loader->mtlLoader->objMtls.size();
+			for (uint m = 0; m < mtls.size(); m++) {
+				map<string, int>::iterator it = loader->mtlLoader->objMtls.find(mtls[m]->name);
+				same = same && it != loader->mtlLoader->objMtls.end() && SameMaterial(mtls[m], MaterialManager::materials->find(it->second));
+				delete mtls[m];
+			}
+
+			double mb = loader->fileSize / (1024.0 * 1024.0);
+			ReportPrint(report, "%-24s %8.2f %12.1f %12.1f %7.1fx %10s\n", file.data(), mb,
+				mb / (streamTime * 0.001), mb / (mappedTime * 0.001), streamTime / mappedTime, same ? "yes" : "NO");
+			totalMB += mb, totalStream += streamTime, totalMapped += mappedTime;
+			allSame = allSame && same;
+			delete loader;
+		} while (_findnext(handle, &found) == 0);
+		_findclose(handle);
+	}
+
+	ReportPrint(report, "%-24s %8.2f %12.1f %12.1f %7.1fx %10s\n", "total", totalMB,
+		totalMB / (totalStream * 0.001), totalMB / (totalMapped * 0.001), totalStream / totalMapped, allSame ? "yes" : "NO");
+	if (report) fclose(report);
+	JobSystem::Release();
+	MaterialManager::Release();
+	return allSame ? 0 : 1;
+}
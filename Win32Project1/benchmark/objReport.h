@@ -0,0 +1,12 @@
+#ifndef OBJ_REPORT_H_
+#define OBJ_REPORT_H_
+
+#define OBJ_REPORT_MODELS "models"
+#define OBJ_REPORT_FILE "objparse.txt"
+#define OBJ_REPORT_RUNS 3 // Best run of each parser is reported
+
+// Parse every obj & mtl in OBJ_REPORT_MODELS with ObjLoader and with the old iostream parser
+// Print MB/s of both and whether arrays & materials are identical, table is saved to OBJ_REPORT_FILE too
+int RunObjParseReport();
+
+#endif
@@ -1,4 +1,5 @@
 #include "aabb.h"
+#include "frustumCull.h"
 
 AABB::AABB(const vec3& min,const vec3& max) :BoundingBox() {
 	minVertex.x=min.x; minVertex.y=min.y; minVertex.z=min.z;
@@ -159,10 +160,8 @@ bool AABB::cameraVertexInside(const vec3& vertex) {
 bool AABB::checkWithCamera(Frustum* frustum, int checkLevel) {
 	if (checkLevel < 1) return true;
 
-	for (int i = 0; i < 8; i++) {
-		if (vertexInsideCamera(vertices[i], frustum))
-			return true;
-	}
+	if (CheckCornersInFrustum(frustum, minVertex, maxVertex))
+		return true;
 
 	if (checkLevel >= 2) {
 		for (int i = 0; i < 8; i++) {
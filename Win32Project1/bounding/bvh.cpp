@@ -0,0 +1,149 @@
+#include "bvh.h"
+#include "../node/node.h"
+
+#define UNBOUNDED 1e30f
+
+BVH::BVH(Node* rootNode) {
+	root = rootNode;
+	version = 0;
+	clear();
+}
+
+BVH::~BVH() {
+	clear();
+}
+
+void BVH::clear() {
+	nodeCount = 0, objectCount = 0;
+	nodeMinX.clear(); nodeMinY.clear(); nodeMinZ.clear();
+	nodeMaxX.clear(); nodeMaxY.clear(); nodeMaxZ.clear();
+	nodeSkip.clear(); nodeObjStart.clear(); nodeObjCount.clear();
+	nodeShadow.clear();
+	nodeRefs.clear();
+
+	objMinX.clear(); objMinY.clear(); objMinZ.clear();
+	objMaxX.clear(); objMaxY.clear(); objMaxZ.clear();
+	objRefs.clear();
+}
+
+void BVH::build() {
+	clear();
+	if (root) flattenNode(root, true);
+	version = Node::structureVersion;
+}
+
+bool BVH::needRebuild() {
+	return version != Node::structureVersion;
+}
+
+void BVH::flattenNode(Node* node, bool isRoot) {
+	int i = nodeCount++;
+	nodeMinX.push_back(0); nodeMinY.push_back(0); nodeMinZ.push_back(0);
+	nodeMaxX.push_back(0); nodeMaxY.push_back(0); nodeMaxZ.push_back(0);
+	nodeSkip.push_back(0); nodeObjStart.push_back(objectCount); nodeObjCount.push_back(0);
+	nodeShadow.push_back(node->shadowLevel);
+	nodeRefs.push_back(node);
+	node->bvhIndex = i;
+	node->needRefit = false;
+
+	// Node with objects is treated as leaf, its children are not culled
+	if (!isRoot && node->objects.size() > 0) {
+		nodeObjCount[i] = node->objects.size();
+		for (uint j = 0; j < node->objects.size(); ++j) {
+			objMinX.push_back(0); objMinY.push_back(0); objMinZ.push_back(0);
+			objMaxX.push_back(0); objMaxY.push_back(0); objMaxZ.push_back(0);
+			objRefs.push_back(node->objects[j]);
+			objectCount++;
+		}
+	} else {
+		for (uint c = 0; c < node->children.size(); ++c)
+			flattenNode(node->children[c], false);
+	}
+	nodeSkip[i] = nodeCount;
+	setNodeBounding(i, node);
+}
+
+void BVH::setNodeBounding(int i, Node* node) {
+	AABB* aabb = (AABB*)node->boundingBox;
+	if (aabb && node->detailLevel >= 1) {
+		nodeMinX[i] = aabb->minVertex.x; nodeMinY[i] = aabb->minVertex.y; nodeMinZ[i] = aabb->minVertex.z;
+		nodeMaxX[i] = aabb->maxVertex.x; nodeMaxY[i] = aabb->maxVertex.y; nodeMaxZ[i] = aabb->maxVertex.z;
+	} else {
+		nodeMinX[i] = -UNBOUNDED; nodeMinY[i] = -UNBOUNDED; nodeMinZ[i] = -UNBOUNDED;
+		nodeMaxX[i] = UNBOUNDED; nodeMaxY[i] = UNBOUNDED; nodeMaxZ[i] = UNBOUNDED;
+	}
+	nodeShadow[i] = node->shadowLevel;
+
+	int start = nodeObjStart[i];
+	for (int j = 0; j < nodeObjCount[i]; ++j)
+		setObjectBounding(start + j, node->objects[j]);
+}
+
+void BVH::setObjectBounding(int i, Object* object) {
+	AABB* aabb = (AABB*)object->bounding;
+	if (aabb && object->detailLevel >= 1) {
+		objMinX[i] = aabb->minVertex.x; objMinY[i] = aabb->minVertex.y; objMinZ[i] = aabb->minVertex.z;
+		objMaxX[i] = aabb->maxVertex.x; objMaxY[i] = aabb->maxVertex.y; objMaxZ[i] = aabb->maxVertex.z;
+	} else {
+		objMinX[i] = -UNBOUNDED; objMinY[i] = -UNBOUNDED; objMinZ[i] = -UNBOUNDED;
+		objMaxX[i] = UNBOUNDED; objMaxY[i] = UNBOUNDED; objMaxZ[i] = UNBOUNDED;
+	}
+}
+
+// Refit node's own bounding and its objects' boundings
+void BVH::refit(Node* node) {
+	int i = node->bvhIndex;
+	if (i < 0 || i >= nodeCount || nodeRefs[i] != node) return;
+	setNodeBounding(i, node);
+}
+
+bool BVH::checkNode(int i, const Frustum* frustum) const {
+	return CheckBoxWithFrustum(frustum, nodeMinX[i], nodeMinY[i], nodeMinZ[i], nodeMaxX[i], nodeMaxY[i], nodeMaxZ[i]);
+}
+
+bool BVH::checkNode(int i, const Frustum* frustum, uint& planeMask) const {
+	return CheckBoxWithFrustumPlanes(frustum, nodeMinX[i], nodeMinY[i], nodeMinZ[i], nodeMaxX[i], nodeMaxY[i], nodeMaxZ[i], planeMask);
+}
+
+bool BVH::checkObject(int i, const Frustum* frustum) const {
+	return CheckBoxWithFrustum(frustum, objMinX[i], objMinY[i], objMinZ[i], objMaxX[i], objMaxY[i], objMaxZ[i]);
+}
+
+// Objects of whole subtree of node i, they are stored together in depth-first order
+int BVH::getObjectCount(int i) const {
+	int end = nodeSkip[i];
+	return (end < nodeCount ? nodeObjStart[end] : objectCount) - nodeObjStart[i];
+}
+
+// Cut tree into at most parts node ranges [starts[k], ends[k]) of whole subtrees with close object counts
+// Inner nodes above the cut are left out, they hold no objects & a subtree root culls whatever they would
+// So culling each range alone gives the same result as culling whole tree, return range count
+int BVH::splitRanges(int parts, int* starts, int* ends) const {
+	if (nodeCount == 0 || parts < 1) return 0;
+	int target = objectCount / (parts * 4) + 1; // Finer subtrees than ranges for a better balance
+	int range = 0, rangeObjects = 0, done = 0;
+	int i = 0;
+	while (i < nodeCount) {
+		// Descend into inner nodes holding too many objects
+		if (nodeObjCount[i] == 0 && nodeSkip[i] > i + 1 && getObjectCount(i) > target) {
+			++i;
+			continue;
+		}
+		if (rangeObjects == 0) starts[range] = i;
+		ends[range] = nodeSkip[i];
+		rangeObjects += getObjectCount(i);
+		i = nodeSkip[i];
+		if (range + 1 < parts && (done + rangeObjects) * (u64)parts >= (u64)objectCount * (range + 1)) {
+			done += rangeObjects;
+			rangeObjects = 0;
+			++range;
+		}
+	}
+	return rangeObjects > 0 ? range + 1 : range;
+}
+
+// Bit j of visibility is set when object start + j is visible
+void BVH::checkObjects(int start, int count, const Frustum* frustum, uint* visibility) const {
+	CheckBoxesWithFrustum(frustum, count, &objMinX[start], &objMinY[start], &objMinZ[start],
+		&objMaxX[start], &objMaxY[start], &objMaxZ[start], visibility);
+}
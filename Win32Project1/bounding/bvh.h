@@ -0,0 +1,49 @@
+#ifndef BVH_H_
+#define BVH_H_
+
+#include "aabb.h"
+#include "frustumCull.h"
+#include <vector>
+
+class Node;
+class Object;
+
+// Flattened bounding volume hierarchy of a Node tree
+// Nodes are stored in depth-first order, a subtree of node i is [i, nodeSkip[i])
+// Nodes with objects are leaves, their objects are stored in [nodeObjStart, nodeObjStart + nodeObjCount)
+// Boxes which never need culling are stored as unbounded boxes so every box can go through the same test
+class BVH {
+public:
+	int nodeCount, objectCount;
+	std::vector<float> nodeMinX, nodeMinY, nodeMinZ;
+	std::vector<float> nodeMaxX, nodeMaxY, nodeMaxZ;
+	std::vector<int> nodeSkip, nodeObjStart, nodeObjCount;
+	std::vector<int> nodeShadow;
+	std::vector<Node*> nodeRefs;
+
+	std::vector<float> objMinX, objMinY, objMinZ;
+	std::vector<float> objMaxX, objMaxY, objMaxZ;
+	std::vector<Object*> objRefs;
+private:
+	Node* root;
+	uint version;
+private:
+	void clear();
+	void flattenNode(Node* node, bool isRoot);
+	void setNodeBounding(int i, Node* node);
+	void setObjectBounding(int i, Object* object);
+public:
+	BVH(Node* rootNode);
+	~BVH();
+	void build();
+	bool needRebuild();
+	void refit(Node* node);
+	bool checkNode(int i, const Frustum* frustum) const;
+	bool checkNode(int i, const Frustum* frustum, uint& planeMask) const;
+	bool checkObject(int i, const Frustum* frustum) const;
+	int getObjectCount(int i) const;
+	int splitRanges(int parts, int* starts, int* ends) const;
+	void checkObjects(int start, int count, const Frustum* frustum, uint* visibility) const;
+};
+
+#endif
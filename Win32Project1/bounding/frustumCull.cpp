@@ -0,0 +1,115 @@
+#include "frustumCull.h"
+#include <string.h>
+
+#ifdef CULL_SSE
+#include <immintrin.h>
+#endif
+
+void CheckBoxesWithFrustum(const Frustum* frustum, int count,
+		const float* minx, const float* miny, const float* minz,
+		const float* maxx, const float* maxy, const float* maxz, uint* visibility) {
+	memset(visibility, 0, ((count + CULL_MASK_BITS - 1) / CULL_MASK_BITS) * sizeof(uint));
+	int i = 0;
+
+#ifdef CULL_AVX2
+	const __m256 half8 = _mm256_set1_ps(0.5f);
+	const __m256 zero8 = _mm256_setzero_ps();
+	for (; i + 8 <= count; i += 8) {
+		__m256 minX = _mm256_loadu_ps(minx + i), maxX = _mm256_loadu_ps(maxx + i);
+		__m256 minY = _mm256_loadu_ps(miny + i), maxY = _mm256_loadu_ps(maxy + i);
+		__m256 minZ = _mm256_loadu_ps(minz + i), maxZ = _mm256_loadu_ps(maxz + i);
+		__m256 cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half8);
+		__m256 cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half8);
+		__m256 cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half8);
+		__m256 ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half8);
+		__m256 ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half8);
+		__m256 ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half8);
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; p++) {
+			const vec3& n = frustum->normals[p];
+			__m256 dist = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(_mm256_set1_ps(n.x), cx),
+				_mm256_mul_ps(_mm256_set1_ps(n.y), cy)),
+				_mm256_mul_ps(_mm256_set1_ps(n.z), cz)),
+				_mm256_set1_ps(frustum->ds[p]));
+			__m256 radius = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(_mm256_set1_ps(fabsf(n.x)), ex),
+				_mm256_mul_ps(_mm256_set1_ps(fabsf(n.y)), ey)),
+				_mm256_mul_ps(_mm256_set1_ps(fabsf(n.z)), ez));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(dist, radius), zero8, _CMP_GE_OQ));
+		}
+		uint bits = (uint)_mm256_movemask_ps(inside);
+		visibility[i / CULL_MASK_BITS] |= bits << (i % CULL_MASK_BITS);
+	}
+#endif
+
+#ifdef CULL_SSE
+	const __m128 half4 = _mm_set1_ps(0.5f);
+	const __m128 zero4 = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4) {
+		__m128 minX = _mm_loadu_ps(minx + i), maxX = _mm_loadu_ps(maxx + i);
+		__m128 minY = _mm_loadu_ps(miny + i), maxY = _mm_loadu_ps(maxy + i);
+		__m128 minZ = _mm_loadu_ps(minz + i), maxZ = _mm_loadu_ps(maxz + i);
+		__m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half4);
+		__m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half4);
+		__m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half4);
+		__m128 ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half4);
+		__m128 ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half4);
+		__m128 ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half4);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++) {
+			const vec3& n = frustum->normals[p];
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(n.x), cx),
+				_mm_mul_ps(_mm_set1_ps(n.y), cy)),
+				_mm_mul_ps(_mm_set1_ps(n.z), cz)),
+				_mm_set1_ps(frustum->ds[p]));
+			__m128 radius = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(fabsf(n.x)), ex),
+				_mm_mul_ps(_mm_set1_ps(fabsf(n.y)), ey)),
+				_mm_mul_ps(_mm_set1_ps(fabsf(n.z)), ez));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), zero4));
+		}
+		uint bits = (uint)_mm_movemask_ps(inside);
+		visibility[i / CULL_MASK_BITS] |= bits << (i % CULL_MASK_BITS);
+	}
+#endif
+
+	for (; i < count; i++) {
+		if (CheckBoxWithFrustum(frustum, minx[i], miny[i], minz[i], maxx[i], maxy[i], maxz[i]))
+			visibility[i / CULL_MASK_BITS] |= 1u << (i % CULL_MASK_BITS);
+	}
+}
+
+bool CheckCornersInFrustum(const Frustum* frustum, const vec3& minVertex, const vec3& maxVertex) {
+#ifdef CULL_SSE
+	// Corners 0-3 lie on min z and corners 4-7 on max z, x and y are shared
+	const __m128 xs = _mm_setr_ps(minVertex.x, maxVertex.x, minVertex.x, maxVertex.x);
+	const __m128 ys = _mm_setr_ps(minVertex.y, minVertex.y, maxVertex.y, maxVertex.y);
+	const __m128 zMin = _mm_set1_ps(minVertex.z), zMax = _mm_set1_ps(maxVertex.z);
+	const __m128 zero = _mm_setzero_ps();
+	__m128 insideLow = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	__m128 insideHigh = insideLow;
+	for (int p = 0; p < 6; p++) {
+		const vec3& n = frustum->normals[p];
+		__m128 nz = _mm_set1_ps(n.z), d = _mm_set1_ps(frustum->ds[p]);
+		__m128 xy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(n.x), xs), _mm_mul_ps(_mm_set1_ps(n.y), ys));
+		__m128 distLow = _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(nz, zMin)), d);
+		__m128 distHigh = _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(nz, zMax)), d);
+		insideLow = _mm_and_ps(insideLow, _mm_cmpge_ps(distLow, zero));
+		insideHigh = _mm_and_ps(insideHigh, _mm_cmpge_ps(distHigh, zero));
+	}
+	return _mm_movemask_ps(_mm_or_ps(insideLow, insideHigh)) != 0;
+#else
+	for (int i = 0; i < 8; i++) {
+		vec3 corner((i & 1) ? maxVertex.x : minVertex.x, (i & 2) ? maxVertex.y : minVertex.y, (i & 4) ? maxVertex.z : minVertex.z);
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++)
+			inside = frustum->normals[p].DotProduct(corner) + frustum->ds[p] >= 0;
+		if (inside) return true;
+	}
+	return false;
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef FRUSTUM_CULL_H_
+#define FRUSTUM_CULL_H_
+
+#include "../camera/frustum.h"
+
+#if defined(__AVX2__)
+#define CULL_AVX2
+#define CULL_SSE
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULL_SSE
+#endif
+
+#define CULL_MASK_BITS 32
+#define CULL_BATCH_SIZE 256
+#define CULL_ALL_PLANES 0x3f
+
+// Box test in center/extent form, reject box only when it is totally outside one of frustum planes
+// Boundary differs from AABB::checkWithCamera: a box crossing a plane is kept even when none of its
+// corners is inside (level 1 drops it), and a box near a frustum edge that no single plane separates
+// is kept too (level 2 drops it). Nothing levels 1 & 2 keep is culled here
+inline bool CheckBoxWithFrustum(const Frustum* frustum, float minx, float miny, float minz, float maxx, float maxy, float maxz) {
+	float cx = (minx + maxx) * 0.5f, cy = (miny + maxy) * 0.5f, cz = (minz + maxz) * 0.5f;
+	float ex = (maxx - minx) * 0.5f, ey = (maxy - miny) * 0.5f, ez = (maxz - minz) * 0.5f;
+	for (int p = 0; p < 6; p++) {
+		const vec3& n = frustum->normals[p];
+		float dist = n.x * cx + n.y * cy + n.z * cz + frustum->ds[p];
+		float radius = fabsf(n.x) * ex + fabsf(n.y) * ey + fabsf(n.z) * ez;
+		if (dist + radius < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+// Same test restricted to planes in planeMask
+// Planes which contain the whole box are removed from planeMask, so boxes inside this one can skip them
+inline bool CheckBoxWithFrustumPlanes(const Frustum* frustum, float minx, float miny, float minz, float maxx, float maxy, float maxz, uint& planeMask) {
+	float cx = (minx + maxx) * 0.5f, cy = (miny + maxy) * 0.5f, cz = (minz + maxz) * 0.5f;
+	float ex = (maxx - minx) * 0.5f, ey = (maxy - miny) * 0.5f, ez = (maxz - minz) * 0.5f;
+	for (int p = 0; p < 6; p++) {
+		if (!(planeMask & (1 << p))) continue;
+		const vec3& n = frustum->normals[p];
+		float dist = n.x * cx + n.y * cy + n.z * cz + frustum->ds[p];
+		float radius = fabsf(n.x) * ex + fabsf(n.y) * ey + fabsf(n.z) * ez;
+		if (dist + radius < 0.0f)
+			return false;
+		else if (dist - radius >= 0.0f)
+			planeMask &= ~(1 << p);
+	}
+	return true;
+}
+
+// Test boxes [0, count) with frustum, 4 (SSE) or 8 (AVX2) boxes at once
+// Bit i of visibility is set when box i is visible, visibility needs (count + 31) / 32 words
+void CheckBoxesWithFrustum(const Frustum* frustum, int count,
+	const float* minx, const float* miny, const float* minz,
+	const float* maxx, const float* maxy, const float* maxz, uint* visibility);
+
+// Whether any of 8 corners of box lies inside all frustum planes, corners are tested 4 at once
+bool CheckCornersInFrustum(const Frustum* frustum, const vec3& minVertex, const vec3& maxVertex);
+
+inline bool CheckVisibleBit(const uint* visibility, int i) {
+	return (visibility[i / CULL_MASK_BITS] >> (i % CULL_MASK_BITS)) & 1;
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include "cameraPath.h"
+#include "../constants/constants.h"
+#include <stdio.h>
+#include <algorithm>
+using namespace std;
+
+CameraPath::CameraPath() {
+	frames.clear();
+	frameTimes.clear();
+	path = "";
+	cursor = 0;
+	mode = CAMERA_PATH_IDLE;
+}
+
+CameraPath::~CameraPath() {
+	stop();
+}
+
+bool CameraPath::startRecord(const char* file) {
+	stop();
+	frames.clear();
+	path = file;
+	mode = CAMERA_PATH_RECORD;
+	return true;
+}
+
+bool CameraPath::startReplay(const char* file) {
+	stop();
+	if (!load(file)) return false;
+	path = file;
+	cursor = 0;
+	frameTimes.clear();
+	mode = CAMERA_PATH_REPLAY;
+	return true;
+}
+
+// Flush recorded path or replay timings to disk
+void CameraPath::stop() {
+	if (mode == CAMERA_PATH_RECORD) {
+		if (save(path.c_str())) printf("Camera path saved to %s, %d frames\n", path.c_str(), (int)frames.size());
+	} else if (mode == CAMERA_PATH_REPLAY) {
+		std::string timingPath = path + CAMERA_PATH_TIMING;
+		if (saveTimings(timingPath.c_str())) printf("Replay timings saved to %s\n", timingPath.c_str());
+	}
+	mode = CAMERA_PATH_IDLE;
+}
+
+void CameraPath::record(Camera* camera, float time, float dTime, float velocity) {
+	if (mode != CAMERA_PATH_RECORD) return;
+	CameraFrame frame;
+	frame.position[0] = camera->position.x, frame.position[1] = camera->position.y, frame.position[2] = camera->position.z;
+	frame.lookDir[0] = camera->lookDir.x, frame.lookDir[1] = camera->lookDir.y, frame.lookDir[2] = camera->lookDir.z;
+	frame.fovy = camera->fovy;
+	frame.time = time;
+	frame.dTime = dTime;
+	frame.velocity = velocity;
+	frames.push_back(frame);
+}
+
+// Return false when path ended
+bool CameraPath::next(CameraFrame& frame) {
+	if (mode != CAMERA_PATH_REPLAY || cursor >= frames.size()) return false;
+	frame = frames[cursor];
+	frame.time = cursor * CAMERA_PATH_STEP;
+	frame.dTime = CAMERA_PATH_STEP;
+	frame.velocity = D_DISTANCE * CAMERA_PATH_STEP;
+	cursor++;
+	return true;
+}
+
+bool CameraPath::save(const char* file) {
+	FILE* out = fopen(file, "wb");
+	if (!out) return false;
+	CameraPathHeader header;
+	header.magic = CAMERA_PATH_MAGIC;
+	header.version = CAMERA_PATH_VERSION;
+	header.frameCount = frames.size();
+	header.frameSize = sizeof(CameraFrame);
+	fwrite(&header, sizeof(CameraPathHeader), 1, out);
+	if (frames.size() > 0) fwrite(&frames[0], sizeof(CameraFrame), frames.size(), out);
+	fclose(out);
+	return true;
+}
+
+bool CameraPath::load(const char* file) {
+	FILE* in = fopen(file, "rb");
+	if (!in) {
+		printf("Can not open camera path %s\n", file);
+		return false;
+	}
+	CameraPathHeader header;
+	bool valid = fread(&header, sizeof(CameraPathHeader), 1, in) == 1 &&
+		header.magic == CAMERA_PATH_MAGIC && header.version == CAMERA_PATH_VERSION &&
+		header.frameSize == sizeof(CameraFrame);
+	if (valid) {
+		frames.resize(header.frameCount);
+		if (header.frameCount > 0)
+			valid = fread(&frames[0], sizeof(CameraFrame), header.frameCount, in) == header.frameCount;
+	}
+	fclose(in);
+	if (!valid) {
+		printf("Bad camera path %s\n", file);
+		frames.clear();
+	}
+	return valid;
+}
+
+// Frame index & ms per line, summary at the end
+bool CameraPath::saveTimings(const char* file) {
+	if (frameTimes.size() == 0) return false;
+	FILE* out = fopen(file, "w");
+	if (!out) return false;
+	float sum = 0;
+	for (uint i = 0; i < frameTimes.size(); i++) {
+		fprintf(out, "%d %.3f\n", i, frameTimes[i]);
+		sum += frameTimes[i];
+	}
+	vector<float> sorted = frameTimes;
+	sort(sorted.begin(), sorted.end());
+	uint p99 = (sorted.size() * 99 + 99) / 100 - 1;
+	fprintf(out, "# frames %d avg %.3f min %.3f p99 %.3f max %.3f\n", (int)sorted.size(),
+		sum / sorted.size(), sorted[0], sorted[p99], sorted[sorted.size() - 1]);
+	fclose(out);
+	return true;
+}
+
+void CameraPath::Apply(const CameraFrame& frame, Camera* camera) {
+	if (frame.fovy != camera->fovy)
+		camera->initPerspectCamera(frame.fovy, camera->aspect, camera->zNear, camera->zFar);
+	vec3 position(frame.position[0], frame.position[1], frame.position[2]);
+	vec3 lookDir(frame.lookDir[0], frame.lookDir[1], frame.lookDir[2]);
+	camera->setView(position, lookDir);
+}
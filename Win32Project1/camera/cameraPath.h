@@ -0,0 +1,60 @@
+#ifndef CAMERA_PATH_H_
+#define CAMERA_PATH_H_
+
+#include "camera.h"
+#include <vector>
+#include <string>
+
+#define CAMERA_PATH_MAGIC 0x48545043 // "CPTH"
+#define CAMERA_PATH_VERSION 1
+#define CAMERA_PATH_IDLE   0
+#define CAMERA_PATH_RECORD 1
+#define CAMERA_PATH_REPLAY 2
+#define CAMERA_PATH_TIMING ".times.txt" // Appended to path file name
+#define CAMERA_PATH_STEP 16.0f // Ms of each replayed step, recorded frame rate does not change the replay
+
+// One act step, 40 bytes in file
+struct CameraFrame {
+	float position[3];
+	float lookDir[3];
+	float fovy;
+	float time; // Ms since start, fed to Scene::act
+	float dTime; // Ms of this step
+	float velocity; // Replay uses CAMERA_PATH_STEP for these three, only camera is taken from file
+};
+
+struct CameraPathHeader {
+	uint magic;
+	uint version;
+	uint frameCount;
+	uint frameSize;
+};
+
+// Record camera & scene time of every act step, replay them later at the same steps
+// Replay also keeps the real time of each drawn frame, so two builds can be compared frame by frame
+// Replayed steps are CAMERA_PATH_STEP long & input is ignored, so every run does the same work
+class CameraPath {
+private:
+	std::vector<CameraFrame> frames;
+	std::vector<float> frameTimes;
+	std::string path;
+	uint cursor;
+	int mode;
+public:
+	CameraPath();
+	~CameraPath();
+	bool startRecord(const char* file);
+	bool startReplay(const char* file);
+	void stop();
+	void record(Camera* camera, float time, float dTime, float velocity);
+	bool next(CameraFrame& frame);
+	void addFrameTime(float ms) { if (mode == CAMERA_PATH_REPLAY) frameTimes.push_back(ms); }
+	bool isRecording() { return mode == CAMERA_PATH_RECORD; }
+	bool isReplaying() { return mode == CAMERA_PATH_REPLAY; }
+	bool save(const char* file);
+	bool load(const char* file);
+	bool saveTimings(const char* file);
+	static void Apply(const CameraFrame& frame, Camera* camera);
+};
+
+#endif
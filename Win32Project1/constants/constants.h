@@ -43,6 +43,7 @@
 #endif
 
 const int InvalidInsId = 1024;
+const int LodIdRange = 2048; // Two 11 bit instance ids are packed in one float of lod records, still exact
 
 typedef unsigned int uint;
 typedef unsigned char byte;
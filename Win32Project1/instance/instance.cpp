@@ -17,6 +17,8 @@ Instance::Instance(Mesh* mesh) : DataBuffer(STATICS_BUFFER) {
 
 void Instance::create(Mesh* mesh) {
 	insId = InvalidInsId, insSingleId = InvalidInsId, insBillId = InvalidInsId;
+	packedVertexBuffer = NULL, packedFrameBuffer = NULL;
+	packedTexcoordBuffer = NULL;
 	instanceMesh = mesh;
 
 	isBillboard = instanceMesh->isBillboard;
@@ -30,63 +32,44 @@ Instance::~Instance() {
 
 void Instance::releaseDatas() {
 	DataBuffer::releaseDatas();
+	if (packedVertexBuffer) free(packedVertexBuffer); packedVertexBuffer = NULL;
+	if (packedFrameBuffer) free(packedFrameBuffer); packedFrameBuffer = NULL;
+	if (packedTexcoordBuffer) free(packedTexcoordBuffer); packedTexcoordBuffer = NULL;
 }
 
 void Instance::initInstanceBuffers(Object* object,int vertices,int indices,int cnt,bool copy) {
 	vertexCount = vertices;
-	vertexBuffer = (float*)malloc(vertexCount * 3 * sizeof(float));
-	normalBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
-	tangentBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
-	texcoordBuffer = (float*)malloc(vertexCount * 4 * sizeof(float));
-	texidBuffer = (float*)malloc(vertexCount * 2 * sizeof(float));
-	colorBuffer = (byte*)malloc(vertexCount * 3 * sizeof(byte));
+	packedVertexBuffer = (ushort*)malloc(vertexCount * 4 * sizeof(ushort));
+	packedFrameBuffer = (uint*)malloc(vertexCount * sizeof(uint));
+	packedTexcoordBuffer = (ushort*)malloc(vertexCount * 2 * sizeof(ushort));
+	materialBuffer = (ushort*)malloc(vertexCount * sizeof(ushort));
+	packBounds = GetPackBounds(instanceMesh->vertices3, instanceMesh->texcoords, vertexCount);
 
 	indexCount=indices;
 	if (indexCount > 0)
-		indexBuffer = (ushort*)malloc(indexCount*sizeof(ushort));
+		indexBuffer = (uint*)malloc(indexCount*sizeof(uint));
 
 	int mid = object->material;
 	if (isBillboard) mid = object->billboard->material;
 	for(int i=0;i<vertexCount;i++) {
-		vec4 vertex=instanceMesh->vertices[i];
-		vec3 normal=instanceMesh->normals[i];
-		vec3 tangent = instanceMesh->tangents[i];
-		vec2 texcoord=instanceMesh->texcoords[i];
-
-		Material* mat = NULL;
+		int matid = 0;
 		if (!instanceMesh->materialids && mid >= 0)
-			mat = MaterialManager::materials->find(mid);
+			matid = mid;
 		else if (instanceMesh->materialids)
-			mat = MaterialManager::materials->find(instanceMesh->materialids[i]);
-		if (!mat) mat = MaterialManager::materials->find(0);
-		vec3 ambient = mat->ambient;
-		vec3 diffuse = mat->diffuse;
-		vec3 specular = mat->specular;
-		vec4 texids = mat->texids;
-
-		for (int v = 0; v < 3; v++) {
-			vertexBuffer[i * 3 + v] = GetVec4(&vertex, v);
-			normalBuffer[i * 3 + v] = Float2Half(GetVec3(&normal, v));
-			tangentBuffer[i * 3 + v] = Float2Half(GetVec3(&tangent, v));
-		}
-
-		texcoordBuffer[i * 4 + 0] = (texcoord.x);
-		texcoordBuffer[i * 4 + 1] = (texcoord.y);
-		texcoordBuffer[i * 4 + 2] = (texids.x);
-		texcoordBuffer[i * 4 + 3] = (texids.y);
-
-		texidBuffer[i * 2 + 0] = (texids.z);
-		texidBuffer[i * 2 + 1] = (texids.w);
-
-		colorBuffer[i * 3 + 0] = (byte)(ambient.x * 255);
-		colorBuffer[i * 3 + 1] = (byte)(diffuse.x * 255);
-		colorBuffer[i * 3 + 2] = (byte)(specular.x * 255);
+			matid = instanceMesh->materialids[i];
+		if (!MaterialManager::materials->find(matid)) matid = 0;
+
+		PackPosition(instanceMesh->vertices3[i], packBounds, packedVertexBuffer + i * 4);
+		packedVertexBuffer[i * 4 + 3] = 0;
+		packedFrameBuffer[i] = PackFrame(instanceMesh->normals[i], instanceMesh->tangents[i]);
+		PackTexcoord(instanceMesh->texcoords[i], packBounds, packedTexcoordBuffer + i * 2);
+		materialBuffer[i] = (ushort)matid;
 	}
 
 	if(instanceMesh->indices) {
 		for(int i=0;i<indexCount;i++) {
 			int index=instanceMesh->indices[i];
-			indexBuffer[i]=(ushort)index;
+			indexBuffer[i]=(uint)index;
 		}
 	}
 
@@ -10,6 +10,7 @@
 
 #include "instanceData.h"
 #include "../render/dataBuffer.h"
+#include "../mesh/vertexPack.h"
 
 class Instance: public DataBuffer {
 public:
@@ -19,6 +20,11 @@ public:
 	Mesh* instanceMesh;
 	int insId, insSingleId, insBillId;
 	bool isBillboard, hasNormal, hasSingle;
+public:
+	ushort* packedVertexBuffer; // 4 per vertex, w is left for MultiInstance mesh slot
+	uint* packedFrameBuffer;
+	ushort* packedTexcoordBuffer;
+	PackBounds packBounds;
 public:
 	Instance(InstanceData* data);
 	Instance(Mesh* mesh);
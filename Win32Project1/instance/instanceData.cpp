@@ -3,42 +3,93 @@
 InstanceData::InstanceData(Mesh* mesh, Object* obj, int maxCount) {
 	insMesh = mesh;
 	count = 0, maxInsCount = maxCount;
-	transformsFull = NULL;
+	recordGroup = GetRecordGroup(mesh);
+	stream = NULL;
+	meshletMask = NULL;
 	object = obj;
 	instance = NULL;
-
-	transformsFull = (buff*)malloc(maxCount * 16 * sizeof(buff));
-	memset(transformsFull, 0, maxCount * 16 * sizeof(buff));
 }
 
 InstanceData::~InstanceData() {
-	if (transformsFull) free(transformsFull);
 	if (instance) delete instance;
+	if (meshletMask) delete[] meshletMask;
 }
 
 void InstanceData::resetInstance() {
 	count = 0;
+	if (meshletMask) {
+		int words = MeshletMaskWords(insMesh->meshlets.size());
+		for (int w = 0; w < words; ++w)
+			meshletMask[w] = 0;
+	}
+}
+
+void InstanceData::cullMeshlets(Object* object, const Frustum* frustum, const vec3& eye) {
+	if (meshletMask) CullMeshlets(insMesh, object->transformMatrix, frustum, eye, meshletMask);
 }
 
-void InstanceData::addInstance(Object* object) {
-	if (transformsFull && instance) {
+// Lod ids replace this instance's ids when given, record then goes to whichever lod shader picks
+// Spans of a parallel cull task take the record when given, it reaches stream when spans are merged
+bool InstanceData::addInstance(Object* object, const buff* lodIds, RecordSpans* spans) {
+	if (stream && instance) {
 		bool valid = instance->insId != InvalidInsId || instance->insSingleId != InvalidInsId || instance->insBillId != InvalidInsId;
-		if (valid) {
-			memcpy(transformsFull + (count * 16), object->transformsFull, 12 * sizeof(buff));
-			transformsFull[count * 16 + 12] = instance->insId;
-			transformsFull[count * 16 + 13] = instance->insSingleId;
-			transformsFull[count * 16 + 14] = instance->insBillId;
-			transformsFull[count * 16 + 15] = InvalidInsId;
-			if (instance->isBillboard) {
-				if (object->billboard->data[2] < 0) {
-					Material* mat = NULL;
-					if (MaterialManager::materials)
-						mat = MaterialManager::materials->find(object->billboard->material);
-					object->billboard->data[2] = mat ? mat->texids.x : 0.0;
-				}
-				memcpy(transformsFull + (count * 16) + 4, object->billboard->data, 3 * sizeof(buff));
+		if (!valid) return false;
+		buff* record = spans ? spans->push(recordGroup) : stream->push(recordGroup);
+		if (!record) return false;
+
+		// Record may be write combined gpu memory, so write it once in order and never read it back
+		memcpy(record, object->transformsFull, 4 * sizeof(buff));
+		if (instance->isBillboard) {
+			if (object->billboard->data[2] < 0) {
+				Material* mat = NULL;
+				if (MaterialManager::materials)
+					mat = MaterialManager::materials->find(object->billboard->material);
+				object->billboard->data[2] = mat ? mat->texids.x : 0.0;
 			}
-			count++;
+			memcpy(record + 4, object->billboard->data, 3 * sizeof(buff));
+			record[7] = object->transformsFull[7];
+		} else
+			memcpy(record + 4, object->transformsFull + 4, 4 * sizeof(buff));
+		memcpy(record + 8, object->transformsFull + 8, 4 * sizeof(buff));
+		if (lodIds)
+			memcpy(record + 12, lodIds, 4 * sizeof(buff));
+		else {
+			record[12] = instance->insId;
+			record[13] = instance->insSingleId;
+			record[14] = instance->insBillId;
+			record[15] = InvalidInsId;
 		}
-	} 
+		count++;
+		return true;
+	}
+	return false;
+}
+
+int GetRecordGroup(const Mesh* mesh) {
+	if (mesh->isBillboard) return RECORD_GROUP_BILL;
+	bool normal = mesh->normalFaces.size() > 0, single = mesh->singleFaces.size() > 0;
+	if (normal && single) return RECORD_GROUP_BOTH;
+	return single ? RECORD_GROUP_SINGLE : RECORD_GROUP_NORMAL;
+}
+
+int SelectLod(const vec3& center, const vec3& eye, float midDistSqr, float lowDistSqr) {
+	float dist = (eye - center).GetSquaredLength();
+	if (dist > lowDistSqr) return LOD_LOW;
+	else if (dist > midDistSqr) return LOD_MID;
+	return LOD_HIGH;
+}
+
+void PackLodIds(const Instance* high, const Instance* mid, const Instance* low, buff* ids) {
+	ids[0] = high->insId + mid->insId * LodIdRange;
+	ids[1] = low->insId + high->insSingleId * LodIdRange;
+	ids[2] = mid->insSingleId + low->insSingleId * LodIdRange;
+	ids[3] = LOD_RECORD;
+}
+
+void DecodeLodIds(const buff* ids, int lod, int* normalId, int* singleId) {
+	uint x = (uint)ids[0], y = (uint)ids[1], z = (uint)ids[2];
+	uint normals[3] = { x % LodIdRange, x / LodIdRange, y % LodIdRange };
+	uint singles[3] = { y / LodIdRange, z % LodIdRange, z / LodIdRange };
+	*normalId = normals[lod];
+	*singleId = singles[lod];
 }
\ No newline at end of file
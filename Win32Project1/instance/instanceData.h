@@ -3,21 +3,42 @@
 
 #include "../mesh/mesh.h"
 #include "../object/object.h"
+#include "../render/instanceStream.h"
+#include <atomic>
+
+#define LOD_RECORD -1.0f // Last id of records which carry ids of all lods, shader picks one of them
+#define LOD_HIGH 0
+#define LOD_MID  1
+#define LOD_LOW  2
 
 class Instance;
 
 class InstanceData {
 public:
 	Mesh* insMesh;
-	buff* transformsFull;
-	int count, maxInsCount;
+	InstanceStream* stream; // Records are appended to queue's stream or spans of a cull task, only their count is kept here
+	std::atomic<int> count; // Several cull tasks may add instances at once
+	int maxInsCount;
+	int recordGroup; // Stream group of mesh's records, RECORD_GROUP_*
+	std::atomic<uint>* meshletMask; // Meshlets visible from any instance this frame, only main view queue has it
 	Object* object;
 	Instance* instance;
 public:
 	InstanceData(Mesh* mesh, Object* obj, int maxCount);
 	~InstanceData();
 	void resetInstance();
-	void addInstance(Object* object);
+	bool addInstance(Object* object, const buff* lodIds = NULL, RecordSpans* spans = NULL);
+	void cullMeshlets(Object* object, const Frustum* frustum, const vec3& eye);
 };
 
+// Stream group by faces mesh has, matches pass split of MultiInstance
+int GetRecordGroup(const Mesh* mesh);
+// Lod chosen for an object at center, multiCull.comp does the same test with record's center
+int SelectLod(const vec3& center, const vec3& eye, float midDistSqr, float lowDistSqr);
+inline vec3 GetLodCenter(const buff* transforms) { return vec3(transforms[0], transforms[11], transforms[2]); }
+// Pack normal & single ids of high, mid & low instances into 4 record ids
+void PackLodIds(const Instance* high, const Instance* mid, const Instance* low, buff* ids);
+// Cpu reference of shader's lod path, ids of chosen lod are returned
+void DecodeLodIds(const buff* ids, int lod, int* normalId, int* singleId);
+
 #endif
\ No newline at end of file
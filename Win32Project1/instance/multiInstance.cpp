@@ -1,13 +1,15 @@
 #include "multiInstance.h"
 
-const int MaxInstance = 4096;
+const int InitInstance = 4096; // Per mesh instance capacity at start, drawcall grows its buffers when more are visible
+const int MaxShortVertex = 65536;
 
 MultiInstance::MultiInstance() {
 	vertexBuffer = NULL, normalBuffer = NULL, tangentBuffer = NULL;
-	texcoordBuffer = NULL, texidBuffer = NULL, colorBuffer = NULL;
+	texcoordBuffer = NULL, materialBuffer = NULL;
 	boneidBuffer = NULL, weightBuffer = NULL;
+	packedVertexBuffer = NULL, packedFrameBuffer = NULL;
+	packedTexcoordBuffer = NULL, meshTable = NULL;
 	indexBuffer = NULL;
-	transforms = NULL;
 
 	bufferDatas.clear();
 
@@ -27,6 +29,7 @@ MultiInstance::MultiInstance() {
 	vertexCount = 0, indexCount = 0, maxInstance = 0, instanceCount = 0;
 
 	hasAnim = false;
+	wideIndex = false;
 	bufferInited = false;
 	drawcall = NULL;
 }
@@ -36,10 +39,13 @@ void MultiInstance::releaseInstanceData() {
 	if (normalBuffer) free(normalBuffer); normalBuffer = NULL;
 	if (tangentBuffer) free(tangentBuffer); tangentBuffer = NULL;
 	if (texcoordBuffer) free(texcoordBuffer); texcoordBuffer = NULL;
-	if (texidBuffer) free(texidBuffer); texidBuffer = NULL;
-	if (colorBuffer) free(colorBuffer); colorBuffer = NULL;
+	if (materialBuffer) free(materialBuffer); materialBuffer = NULL;
 	if (boneidBuffer) free(boneidBuffer); boneidBuffer = NULL;
 	if (weightBuffer) free(weightBuffer); weightBuffer = NULL;
+	if (packedVertexBuffer) free(packedVertexBuffer); packedVertexBuffer = NULL;
+	if (packedFrameBuffer) free(packedFrameBuffer); packedFrameBuffer = NULL;
+	if (packedTexcoordBuffer) free(packedTexcoordBuffer); packedTexcoordBuffer = NULL;
+	if (meshTable) free(meshTable); meshTable = NULL;
 	if (indexBuffer) free(indexBuffer); indexBuffer = NULL;
 
 	for (uint i = 0; i < normals.size(); i++) free(normals[i]);
@@ -57,7 +63,6 @@ void MultiInstance::releaseInstanceData() {
 
 MultiInstance::~MultiInstance() {
 	releaseInstanceData();
-	if (transforms) free(transforms);
 
 	bufferDatas.clear();
 
@@ -67,6 +72,9 @@ MultiInstance::~MultiInstance() {
 	billIns.clear();
 
 	if (bases) free(bases);
+	for (uint i = 0; i < meshletRanges.size(); i++)
+		free(meshletRanges[i].lastMask);
+	meshletRanges.clear();
 	if (drawcall) delete drawcall;
 }
 
@@ -104,6 +112,7 @@ void MultiInstance::initBuffers(int pass) {
 	indirects = (Indirect*)malloc(indirectCount * sizeof(Indirect));
 
 	vertexCount = 0, indexCount = 0, maxInstance = 0;
+	wideIndex = false;
 	for (uint i = 0; i < indirectCount; ++i) {
 		if (!hasAnim) {
 			Instance* ins = (Instance*)bufferDatas[i];
@@ -124,6 +133,7 @@ void MultiInstance::initBuffers(int pass) {
 					idNorm->firstIndex = indexCount + buf->start;
 					normals.push_back(idNorm);
 					ins->insId = normals.size() - 1;
+					addMeshletRange(ins, false, ins->insId, idNorm->firstIndex, buf);
 					pushed = true;
 				}
 				if (ins->hasSingle && (bufferPass == ALL_PASS || bufferPass == SINGLE_PASS)) {
@@ -135,6 +145,7 @@ void MultiInstance::initBuffers(int pass) {
 					idSing->firstIndex = indexCount + buf->start;
 					singles.push_back(idSing);
 					ins->insSingleId = singles.size() - 1;
+					addMeshletRange(ins, true, ins->insSingleId, idSing->firstIndex, buf);
 					pushed = true;
 				}
 			} else if (ins->isBillboard && (bufferPass == ALL_PASS || bufferPass == BILL_PASS)) {
@@ -148,7 +159,8 @@ void MultiInstance::initBuffers(int pass) {
 
 			if (pushed) {
 				vertexCount += ins->vertexCount, indexCount += ins->indexCount;
-				maxInstance += ins->maxCount > MaxInstance ? MaxInstance : ins->maxCount;
+				maxInstance += ins->maxCount > InitInstance ? InitInstance : ins->maxCount;
+				if (ins->vertexCount > MaxShortVertex) wideIndex = true;
 			}
 		} else {
 			AnimationData* anim = (AnimationData*)bufferDatas[i];
@@ -164,7 +176,8 @@ void MultiInstance::initBuffers(int pass) {
 			anim->animId = anims.size() - 1;
 
 			vertexCount += anim->vertexCount, indexCount += anim->indexCount;
-			maxInstance += anim->maxCount > MaxInstance ? MaxInstance : anim->maxCount;
+			maxInstance += anim->maxCount > InitInstance ? InitInstance : anim->maxCount;
+			if (anim->vertexCount > MaxShortVertex) wideIndex = true;
 		}
 	}
 
@@ -191,29 +204,49 @@ void MultiInstance::initBuffers(int pass) {
 	bases = (uint*)malloc(meshCount * 4 * sizeof(uint));
 	memset(bases, 0, meshCount * 4 * sizeof(uint));
 
-	vertexBuffer = (float*)malloc(vertexCount * 3 * sizeof(float));
-	normalBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
-	tangentBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
-	texcoordBuffer = (float*)malloc(vertexCount * 4 * sizeof(float));
-	texidBuffer = (float*)malloc(vertexCount * 2 * sizeof(float));
-	colorBuffer = (byte*)malloc(vertexCount * 3 * sizeof(byte));
-	if (hasAnim) {
+	materialBuffer = (ushort*)malloc(vertexCount * sizeof(ushort));
+	if (!hasAnim) {
+		packedVertexBuffer = (ushort*)malloc(vertexCount * 4 * sizeof(ushort));
+		packedFrameBuffer = (uint*)malloc(vertexCount * sizeof(uint));
+		packedTexcoordBuffer = (ushort*)malloc(vertexCount * 2 * sizeof(ushort));
+		meshTable = (float*)malloc((indirectCount > 0 ? indirectCount : 1) * PACK_MESH_FLOATS * sizeof(float));
+	} else {
+		vertexBuffer = (float*)malloc(vertexCount * 3 * sizeof(float));
+		normalBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
+		tangentBuffer = (half*)malloc(vertexCount * 3 * sizeof(half));
+		texcoordBuffer = (float*)malloc(vertexCount * 2 * sizeof(float));
 		boneidBuffer = (byte*)malloc(vertexCount * 4 * sizeof(byte));
 		weightBuffer = (half*)malloc(vertexCount * 4 * sizeof(half));
 	}
-	indexBuffer = (ushort*)malloc(indexCount * sizeof(ushort));
-	transforms = (buff*)malloc(maxInstance * 16 * sizeof(buff));
+	// Indices stay mesh local as every mesh has its own baseVertex, so only mesh size decides index width
+	indexBuffer = malloc(indexCount * (wideIndex ? sizeof(uint) : sizeof(ushort)));
 
 	uint curVertex = 0, curIndex = 0;
 	for (uint i = 0; i < indirectCount; ++i) {
 		DataBuffer* db = bufferDatas[i];
-		memcpy(vertexBuffer + curVertex * 3, db->vertexBuffer, db->vertexCount * 3 * sizeof(float));
-		memcpy(normalBuffer + curVertex * 3, db->normalBuffer, db->vertexCount * 3 * sizeof(half));
-		memcpy(tangentBuffer + curVertex * 3, db->tangentBuffer, db->vertexCount * 3 * sizeof(half));
-		memcpy(texcoordBuffer + curVertex * 4, db->texcoordBuffer, db->vertexCount * 4 * sizeof(float));
-		memcpy(texidBuffer + curVertex * 2, db->texidBuffer, db->vertexCount * 2 * sizeof(float));
-		memcpy(colorBuffer + curVertex * 3, db->colorBuffer, db->vertexCount * 3 * sizeof(byte));
-		memcpy(indexBuffer + curIndex, db->indexBuffer, db->indexCount * sizeof(ushort));
+		if (!hasAnim) {
+			// Mesh slot rides in position w, so shader finds bounds of its mesh without a per draw id
+			Instance* ins = (Instance*)db;
+			WritePackBounds(ins->packBounds, meshTable + i * PACK_MESH_FLOATS);
+			memcpy(packedVertexBuffer + curVertex * 4, ins->packedVertexBuffer, ins->vertexCount * 4 * sizeof(ushort));
+			memcpy(packedFrameBuffer + curVertex, ins->packedFrameBuffer, ins->vertexCount * sizeof(uint));
+			memcpy(packedTexcoordBuffer + curVertex * 2, ins->packedTexcoordBuffer, ins->vertexCount * 2 * sizeof(ushort));
+			for (int k = 0; k < ins->vertexCount; k++)
+				packedVertexBuffer[(curVertex + k) * 4 + 3] = (ushort)i;
+		} else {
+			memcpy(vertexBuffer + curVertex * 3, db->vertexBuffer, db->vertexCount * 3 * sizeof(float));
+			memcpy(normalBuffer + curVertex * 3, db->normalBuffer, db->vertexCount * 3 * sizeof(half));
+			memcpy(tangentBuffer + curVertex * 3, db->tangentBuffer, db->vertexCount * 3 * sizeof(half));
+			memcpy(texcoordBuffer + curVertex * 2, db->texcoordBuffer, db->vertexCount * 2 * sizeof(float));
+		}
+		memcpy(materialBuffer + curVertex, db->materialBuffer, db->vertexCount * sizeof(ushort));
+		if (wideIndex)
+			memcpy((uint*)indexBuffer + curIndex, db->indexBuffer, db->indexCount * sizeof(uint));
+		else {
+			ushort* shortIndex = (ushort*)indexBuffer + curIndex;
+			for (int k = 0; k < db->indexCount; k++)
+				shortIndex[k] = (ushort)db->indexBuffer[k];
+		}
 		if (hasAnim) {
 			AnimationData* anim = (AnimationData*)db;
 			memcpy(boneidBuffer + curVertex * 4, anim->boneids, anim->vertexCount * 4 * sizeof(byte));
@@ -224,9 +257,24 @@ void MultiInstance::initBuffers(int pass) {
 	bufferInited = true;
 }
 
-int MultiInstance::updateTransform(buff* targetBuffer) {
+void MultiInstance::addMeshletRange(Instance* ins, bool single, uint drawId, int firstIndex, FaceBuf* buf) {
+	int meshletCount = ins->instanceMesh->meshlets.size();
+	if (meshletCount <= 0) return;
+	MeshletRange range;
+	range.instance = ins;
+	range.single = single;
+	range.drawId = drawId;
+	range.firstIndex = firstIndex;
+	range.start = buf->start, range.count = buf->count;
+	// All bits set, as merged buffer starts with whole mesh
+	range.lastMask = (uint*)malloc(MeshletMaskWords(meshletCount) * sizeof(uint));
+	memset(range.lastMask, 0xff, MeshletMaskWords(meshletCount) * sizeof(uint));
+	meshletRanges.push_back(range);
+}
+
+// Set per mesh bases of output transforms and return their total
+int MultiInstance::updateTransform() {
 	instanceCount = 0;
-	buff* target = targetBuffer ? targetBuffer : transforms;
 	for (uint i = 0; i < indirectCount; ++i) {
 		if (!hasAnim) {
 			Instance* ins = (Instance*)bufferDatas[i];
@@ -244,17 +292,15 @@ int MultiInstance::updateTransform(buff* targetBuffer) {
 				pushed = true;
 			}
 
-			if (ins->insData->count > 0 && pushed) {
-				memcpy(target + instanceCount * 16, ins->insData->transformsFull, ins->insData->count * 16 * sizeof(buff));
+			// Records are read in place from queue's InstanceStream, only output ranges are set here
+			if (ins->insData->count > 0 && pushed)
 				instanceCount += ins->insData->count;
-			}
 		} else {
 			AnimationData* anim = (AnimationData*)bufferDatas[i];
 			bases[anim->animId * 4 + 3] = instanceCount;
-			if (anim->animCount > 0) {
-				memcpy(target + instanceCount * 16, anim->transformsFull, anim->animCount * 16 * sizeof(buff));
+			// Transforms are read in place from queue's InstanceStream too
+			if (anim->animCount > 0)
 				instanceCount += anim->animCount;
-			}
 		}
 	}
 	return instanceCount;
@@ -13,20 +13,33 @@
 #define SINGLE_PASS 2
 #define BILL_PASS   3
 
+// Face range of a meshlet mesh in merged index buffer, drawcall rewrites it with visible meshlets only
+struct MeshletRange {
+	Instance* instance;
+	bool single; // Indirect is in single list, else in normal list
+	uint drawId; // Indirect index in its list
+	int firstIndex; // Range start in merged index buffer
+	int start, count; // Range in Mesh::indices
+	uint* lastMask; // Mask the range was last built with
+};
+
 class MultiInstance {
 public:
 	float* vertexBuffer;
 	half* normalBuffer;
 	half* tangentBuffer;
 	float* texcoordBuffer;
-	float* texidBuffer;
-	byte* colorBuffer;
+	ushort* materialBuffer; // Index of MaterialBuffer table
 	byte* boneidBuffer;
 	half* weightBuffer;
-	ushort* indexBuffer;
-	buff* transforms;
+	ushort* packedVertexBuffer; // Static meshes use packed streams, see vertexPack.h
+	uint* packedFrameBuffer;
+	ushort* packedTexcoordBuffer;
+	float* meshTable; // Pack bounds of each mesh slot
+	void* indexBuffer; // ushort, or uint when wideIndex
 	int vertexCount, indexCount, instanceCount, maxInstance;
 	bool hasAnim;
+	bool wideIndex; // Some mesh has more vertices than 16 bit indices can address
 	int bufferPass;
 private:
 	std::vector<DataBuffer*> bufferDatas;
@@ -50,6 +63,7 @@ public:
 	Indirect* indirectsAnim;
 	uint normalCount, singleCount, billCount, animCount, meshCount;
 	uint* bases;
+	std::vector<MeshletRange> meshletRanges;
 	MultiDrawcall* drawcall;
 public:
 	MultiInstance();
@@ -57,7 +71,8 @@ public:
 	void releaseInstanceData();
 	void add(DataBuffer* dataBuffer);
 	void initBuffers(int pass = ALL_PASS);
-	int updateTransform(buff* targetBuffer = NULL);
+	void addMeshletRange(Instance* ins, bool single, uint drawId, int firstIndex, FaceBuf* buf);
+	int updateTransform();
 	void createDrawcall() { drawcall = new MultiDrawcall(this); }
 	bool inited() { return bufferInited; }
 };
@@ -1,6 +1,11 @@
 #include <windows.h>
 #include <windowsx.h>
 #include "simpleApplication.h"
+#include "util/profiler.h"
+#include "benchmark/benchmark.h"
+#include "benchmark/cacheReport.h"
+#include "benchmark/objReport.h"
+#include "benchmark/animReport.h"
 
 typedef void (APIENTRY *PFNWGLEXTSWAPCONTROLPROC) (int);
 PFNWGLEXTSWAPCONTROLPROC wglSwapIntervalEXT = NULL;
@@ -12,17 +17,12 @@ HGLRC hrc;
 HINSTANCE hInstance;
 const TCHAR szName[]=TEXT("win");
 
-HANDLE frameThread = NULL;
-bool threadEnd;
-DWORD WINAPI FrameThreadRun(LPVOID param);
-void CreateThreads();
-void ReleaseThreads();
-HANDLE mutex = NULL;
-void InitMutex();
-void DeleteMutex();
+Job actJob, updateJob, prepareJob;
+bool frameSubmitted = false;
+void SubmitFrame();
+void WaitFrame();
 DWORD currentTime = 0, lastTime = 0, startTime = 0;
 float dTime = 0.0;
-bool dataPrepared = false;
 CirQueue<float>* dTimes = NULL;
 float velocity = 0.0;
 DWORD screenLeft, screenTop;
@@ -35,6 +35,7 @@ bool windowResized = false;
 
 SimpleApplication* app = NULL;
 void CreateApplication();
+void ParsePathArgs(const char* cmdLine);
 void ReleaseApplication();
 
 bool fullscreen = false;
@@ -52,8 +53,6 @@ void SwitchMouse() {
 
 void KillWindow() {
 	if (dTimes) delete dTimes;
-	DeleteMutex();
-	ReleaseThreads();
 	ReleaseApplication();
 	ShowCursor(true);
 	if (fullscreen)
@@ -74,6 +73,7 @@ void TimeRun() {
 	currentTime = timeGetTime();
 	dTime = (float)(currentTime - lastTime);
 	lastTime = currentTime;
+	app->cameraPath->addFrameTime(dTime);
 	if (app->cfgs->dualthread) {
 		dTimes->push(dTime);
 		float dSum = 0.0;
@@ -88,7 +88,22 @@ void TimeRun() {
 	velocity = D_DISTANCE * velo;
 }
 
+// Replay drives act with fixed steps & recorded camera instead of input & clock
+void ReplayRun() {
+	CameraFrame frame;
+	if (!app->cameraPath->next(frame)) {
+		app->willExit = true;
+		return;
+	}
+	app->act(0, (long)frame.time, frame.dTime * 0.001, frame.velocity);
+	CameraPath::Apply(frame, app->scene->actCamera);
+}
+
 void ActRun() {
+	if (app->cameraPath->isReplaying()) {
+		ReplayRun();
+		return;
+	}
 	if (app->pressed || app->input->getControl() >= 0) {
 		GetCursorPos(&mPoint);
 		app->moveMouse(mPoint.x, mPoint.y, centerX, centerY);
@@ -97,6 +112,7 @@ void ActRun() {
 	}
 	else app->showMouse();
 	app->act(startTime, currentTime, dTime * 0.001, velocity);
+	app->cameraPath->record(app->scene->actCamera, (float)(currentTime - startTime), dTime, velocity);
 }
 
 bool DrawWindow() {
@@ -107,41 +123,55 @@ bool DrawWindow() {
 		app->prepare();
 		app->swapData(false);
 	} else {
-		if (dataPrepared) {
-			WaitForSingleObject(mutex, INFINITE);
-			{
-				app->swapData(true);
-				dataPrepared = false;
-			}
-			ReleaseMutex(mutex);
-			TimeRun();
+		JobSystem* jobSystem = JobSystem::jobSystem;
+		if (jobSystem->getWorkerCount() == 0) 
+			WaitFrame(); // No worker to run frame jobs, do them here
+		bool newFrame = app->swapData(true);
+		if (!frameSubmitted || jobSystem->finished(&prepareJob)) { // Producer never waits for renderer
+			frameSubmitted = false;
+			if (app->canPrepare()) SubmitFrame();
 		}
-		else return false;
+		if (!newFrame) return false;
+		TimeRun();
 	}
 
 	if (windowResized) windowResized = false;
 	app->draw();
+	PROFILE_FRAME();
 	SwitchMouse();
 
 	return true;
 }
 
-DWORD WINAPI FrameThreadRun(LPVOID param) {
-	while (!app->willExit && app->cfgs->dualthread) {
-		if (!inited) continue;
-		if (!dataPrepared) {
-			WaitForSingleObject(mutex, INFINITE);
-			{
-				ActRun();
-				app->updateData();
-				app->prepare();
-				dataPrepared = true;
-			}
-			ReleaseMutex(mutex);
-		}
-	}
-	threadEnd = true;
-	return 1;
+void ActJobRun(void* param) {
+	ActRun();
+}
+
+void UpdateJobRun(void* param) {
+	app->updateData();
+}
+
+void PrepareJobRun(void* param) {
+	app->prepare();
+}
+
+// Frame graph: act -> updateData -> prepare, runs on job workers while render thread draws last frame
+void SubmitFrame() {
+	JobSystem* jobSystem = JobSystem::jobSystem;
+	jobSystem->prepare(&actJob, ActJobRun, NULL);
+	jobSystem->prepare(&updateJob, UpdateJobRun, NULL);
+	jobSystem->prepare(&prepareJob, PrepareJobRun, NULL);
+	jobSystem->depend(&updateJob, &actJob);
+	jobSystem->depend(&prepareJob, &updateJob);
+	jobSystem->submit(&prepareJob);
+	jobSystem->submit(&updateJob);
+	jobSystem->submit(&actJob);
+	frameSubmitted = true;
+}
+
+void WaitFrame() {
+	if (frameSubmitted) JobSystem::jobSystem->wait(&prepareJob);
+	frameSubmitted = false;
 }
 
 void InitGLWin() {
@@ -174,29 +204,10 @@ void InitGL() {
 	if (wglSwapIntervalEXT) 
 		wglSwapIntervalEXT(app->cfgs->vsync ? 1 : 0);
 	dTimes = new CirQueue<float>(app->cfgs->smoothframe);
-	InitMutex();
-	CreateThreads();
+	if (app->cfgs->dualthread) SubmitFrame();
 	inited = true;
 }
 
-void CreateThreads() {
-	frameThread = CreateThread(NULL, 0, FrameThreadRun, NULL, 0, NULL);
-	threadEnd = false;
-}
-
-void ReleaseThreads() {
-	CloseHandle(frameThread);
-}
-
-void InitMutex() {
-	mutex = CreateMutex(NULL, FALSE, NULL);
-}
-
-void DeleteMutex() {
-	ReleaseMutex(mutex);
-	CloseHandle(mutex);
-}
-
 void CreateApplication() {
 	app = new SimpleApplication();
 	fullscreen = app->cfgs->fullscreen;
@@ -205,6 +216,17 @@ void CreateApplication() {
 	lastTime = startTime;
 }
 
+// -record file or -replay file
+void ParsePathArgs(const char* cmdLine) {
+	char file[MAX_PATH];
+	const char* arg = strstr(cmdLine, "-record");
+	if (arg && sscanf(arg + strlen("-record"), "%259s", file) == 1)
+		app->cameraPath->startRecord(file);
+	arg = strstr(cmdLine, "-replay");
+	if (arg && sscanf(arg + strlen("-replay"), "%259s", file) == 1)
+		app->cameraPath->startReplay(file);
+}
+
 void ReleaseApplication() {
 	if (app) delete app;
 	app = NULL;
@@ -215,6 +237,21 @@ int WINAPI WinMain(HINSTANCE hInst,HINSTANCE hPrevInstance,PSTR szCmdLine,int iC
 	WNDCLASS wndClass;
 	hInstance=hInst;
 
+	const char* benchArg = strstr(szCmdLine, "-benchmark");
+	if (benchArg) // Headless run, no window or gl context is created
+		return RunBenchmark(atoi(benchArg + strlen("-benchmark")));
+	if (strstr(szCmdLine, "-cachereport")) // Vertex cache stats of all models, also headless
+		return RunVertexCacheReport();
+	if (strstr(szCmdLine, "-objreport")) // Obj & mtl parse speed against old parser, also headless
+		return RunObjParseReport();
+	if (strstr(szCmdLine, "-animconvert")) // Text .t3a to quantized binary, with size & load time report, also headless
+		return RunAnimFormatReport(true);
+	if (strstr(szCmdLine, "-animreport")) // Same report, text files are kept
+		return RunAnimFormatReport(false);
+	const char* keyArg = strstr(szCmdLine, "-animkeys");
+	if (keyArg) // Keyframe compression of all clips, tolerance may follow flag
+		return RunAnimKeyReport(atof(keyArg + strlen("-animkeys")));
+
 	wndClass.style=CS_HREDRAW|CS_VREDRAW|CS_OWNDC;
 	wndClass.lpfnWndProc=WndProc;
 	wndClass.cbClsExtra=0;
@@ -232,6 +269,7 @@ int WINAPI WinMain(HINSTANCE hInst,HINSTANCE hPrevInstance,PSTR szCmdLine,int iC
 	}
 
 	CreateApplication();
+	ParsePathArgs(szCmdLine);
 
 	DWORD style=WS_OVERLAPPEDWINDOW;
 	DWORD styleEX=WS_EX_APPWINDOW|WS_EX_WINDOWEDGE;
@@ -288,7 +326,7 @@ int WINAPI WinMain(HINSTANCE hInst,HINSTANCE hPrevInstance,PSTR szCmdLine,int iC
 		}
 	}
 
-	while (!threadEnd) Sleep(0);
+	WaitFrame();
 	KillWindow();
 	return msg.wParam;
 }
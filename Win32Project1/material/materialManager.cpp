@@ -6,6 +6,7 @@ MaterialManager* MaterialManager::materials = NULL;
 MaterialManager::MaterialManager() {
 	materialList.clear();
 	materialMap.clear();
+	version = 0;
 	Material* defaultMat = new Material(DEFAULT_MAT);
 	add(defaultMat);
 	Material* blackMat = new Material(BLACK_MAT);
@@ -26,6 +27,7 @@ unsigned int MaterialManager::add(Material* material) {
 	materialMap[material->name] = material;
 	int mid = materialList.size() - 1; // Start from 0
 	material->id = mid;
+	version++;
 	return mid;
 }
 
@@ -38,6 +40,7 @@ void MaterialManager::remove(unsigned int i) {
 	mtlEmp->id = oldMid;
 	materialList[i] = mtlEmp;
 	materialMap[oldName] = mtlEmp;
+	version++;
 }
 
 Material* MaterialManager::find(unsigned int i) {
@@ -46,6 +46,7 @@ public:
 private:
 	std::vector<Material*> materialList;
 	std::map<std::string, Material*> materialMap;
+	unsigned int version; // Bumped on every change, MaterialBuffer uploads its table again when it moves
 private:
 	MaterialManager();
 	~MaterialManager();
@@ -55,6 +56,8 @@ public:
 	Material* find(unsigned int i);
 	int find(std::string name);
 	unsigned int size();
+	void setChanged() { version++; } // Call after editing a material in place
+	unsigned int getVersion() { return version; }
 };
 
 #endif
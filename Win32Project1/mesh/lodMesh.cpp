@@ -0,0 +1,464 @@
+#include "lodMesh.h"
+#include "vertexCache.h"
+#include "../constants/constants.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <map>
+#include <set>
+#include <algorithm>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+using namespace std;
+
+LodMesh::LodMesh(const Mesh* source, const int* sourceVerts, int vertCount, const int* lodIndices, int idxCount,
+		const vector<FaceBuf>& singleRanges, const vector<FaceBuf>& normalRanges) :Mesh() {
+	vertexCount = vertCount;
+	vertices = new vec4[vertexCount];
+	normals = new vec3[vertexCount];
+	tangents = new vec3[vertexCount];
+	texcoords = new vec2[vertexCount];
+	materialids = source->materialids ? new int[vertexCount] : NULL;
+	for (int i = 0; i < vertexCount; i++) {
+		int src = sourceVerts[i];
+		vertices[i] = source->vertices[src];
+		normals[i] = source->normals[src];
+		tangents[i] = source->tangents[src];
+		texcoords[i] = source->texcoords[src];
+		if (materialids) materialids[i] = source->materialids[src];
+		sourceVertices.push_back(src);
+	}
+	indexCount = idxCount;
+	indices = (int*)malloc(indexCount * sizeof(int));
+	memcpy(indices, lodIndices, indexCount * sizeof(int));
+
+	for (uint i = 0; i < singleRanges.size(); i++)
+		singleFaces.push_back(new FaceBuf(singleRanges[i].start, singleRanges[i].count));
+	for (uint i = 0; i < normalRanges.size(); i++)
+		normalFaces.push_back(new FaceBuf(normalRanges[i].start, normalRanges[i].count));
+	drawShadow = source->drawShadow;
+	setBoundScale(((Mesh*)source)->getBoundScale());
+	caculateExData();
+	BuildMeshlets(this);
+}
+
+// Symmetric 4x4 error matrix of planes, error of a point is its summed squared distance to them
+struct Quadric {
+	double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+	void reset() {
+		a00 = a01 = a02 = a03 = a11 = a12 = a13 = a22 = a23 = a33 = 0.0;
+	}
+	void addPlane(const vec3& n, double d, double weight) {
+		a00 += weight * n.x * n.x, a01 += weight * n.x * n.y, a02 += weight * n.x * n.z, a03 += weight * n.x * d;
+		a11 += weight * n.y * n.y, a12 += weight * n.y * n.z, a13 += weight * n.y * d;
+		a22 += weight * n.z * n.z, a23 += weight * n.z * d;
+		a33 += weight * d * d;
+	}
+	void add(const Quadric& q) {
+		a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+		a11 += q.a11, a12 += q.a12, a13 += q.a13;
+		a22 += q.a22, a23 += q.a23, a33 += q.a33;
+	}
+	double error(const vec3& p) const {
+		double x = p.x, y = p.y, z = p.z;
+		return a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+			+ a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+			+ a22 * z * z + 2.0 * a23 * z + a33;
+	}
+};
+
+struct PositionKey {
+	float x, y, z;
+	bool operator<(const PositionKey& rhs) const {
+		if (x != rhs.x) return x < rhs.x;
+		if (y != rhs.y) return y < rhs.y;
+		return z < rhs.z;
+	}
+};
+
+struct Collapse {
+	int from, to;
+	double cost;
+	bool operator<(const Collapse& rhs) const { return cost < rhs.cost; }
+};
+
+static inline int FindVertex(const int* tri, int v) {
+	return tri[0] == v ? 0 : (tri[1] == v ? 1 : (tri[2] == v ? 2 : -1));
+}
+
+static vec3 FaceNormal(const vec3& p0, const vec3& p1, const vec3& p2) {
+	return (p1 - p0).CrossProduct(p2 - p0);
+}
+
+struct EdgeInfo {
+	int count, faceKey;
+	bool feature;
+};
+
+// Vertices at the same position form a group, seam vertices are split by uv or normal
+// Feature edges are open borders and edges between materials or face kinds,
+// a group on exactly two of them may only slide along them, other feature groups never move
+static void FindVertexGroups(const Mesh* source, const vector<int>& triangles, const vector<int>& triKinds,
+		vector<int>& groupOf, vector<bool>& locked, vector<bool>& sliding, set<pair<int, int> >& featureEdges) {
+	const int vertexCount = source->vertexCount;
+	map<PositionKey, int> positions;
+	groupOf.assign(vertexCount, -1);
+	for (int i = 0; i < vertexCount; i++) {
+		const vec3& p = source->vertices3[i];
+		PositionKey key = { p.x, p.y, p.z };
+		map<PositionKey, int>::iterator it = positions.find(key);
+		if (it == positions.end()) positions[key] = i, groupOf[i] = i;
+		else groupOf[i] = it->second;
+	}
+	locked.assign(vertexCount, false);
+	sliding.assign(vertexCount, false);
+	featureEdges.clear();
+
+	map<pair<int, int>, EdgeInfo> edges;
+	for (uint t = 0; t < triangles.size(); t += 3) {
+		const int* tri = &triangles[t];
+		int material = source->materialids ? source->materialids[tri[0]] : 0;
+		if (source->materialids && (source->materialids[tri[1]] != material || source->materialids[tri[2]] != material))
+			locked[groupOf[tri[0]]] = locked[groupOf[tri[1]]] = locked[groupOf[tri[2]]] = true;
+		int faceKey = triKinds[t / 3] * 65536 + material;
+		for (int k = 0; k < 3; k++) {
+			int a = groupOf[tri[k]], b = groupOf[tri[(k + 1) % 3]];
+			pair<int, int> key = a < b ? make_pair(a, b) : make_pair(b, a);
+			map<pair<int, int>, EdgeInfo>::iterator it = edges.find(key);
+			if (it == edges.end()) {
+				EdgeInfo info = { 1, faceKey, false };
+				edges[key] = info;
+			} else {
+				it->second.count++;
+				if (it->second.faceKey != faceKey) it->second.feature = true;
+			}
+		}
+	}
+
+	// Non manifold edges lock both ends, a group with one or more than two feature edges is a corner
+	vector<int> featureCount(vertexCount, 0);
+	for (map<pair<int, int>, EdgeInfo>::iterator it = edges.begin(); it != edges.end(); ++it) {
+		int a = it->first.first, b = it->first.second;
+		if (it->second.count > 2) locked[a] = locked[b] = true;
+		else if (it->second.count == 1 || it->second.feature) {
+			featureEdges.insert(it->first);
+			featureCount[a]++, featureCount[b]++;
+		}
+	}
+	for (int i = 0; i < vertexCount; i++) {
+		if (featureCount[i] == 2) sliding[i] = true;
+		else if (featureCount[i] > 0) locked[i] = true;
+	}
+}
+
+// Every used vertex of a group needs exactly one neighbor in target group to move onto,
+// so uv & normal seams slide along themselves instead of blocking the collapse
+static bool FindCollapseTargets(const vector<int>& triangles, const vector<int>& triStart, const vector<int>& triList,
+		const vector<int>& groupOf, const vector<int>& members, int to, vector<int>& targets) {
+	targets.clear();
+	for (uint m = 0; m < members.size(); m++) {
+		int v = members[m], target = -1;
+		for (int r = triStart[v]; r < triStart[v + 1]; r++) {
+			const int* tri = &triangles[triList[r] * 3];
+			for (int k = 0; k < 3; k++) {
+				if (groupOf[tri[k]] != to) continue;
+				if (target >= 0 && target != tri[k]) return false;
+				target = tri[k];
+			}
+		}
+		if (triStart[v] == triStart[v + 1]) continue;
+		if (target < 0) return false;
+		targets.push_back(v);
+		targets.push_back(target);
+	}
+	return targets.size() > 0;
+}
+
+LodMesh* SimplifyMesh(const Mesh* source, float ratio) {
+	if (!source->indices || !source->vertices3 || source->indexCount < 3) return NULL;
+
+	// Collapse all face ranges together, each triangle remembers its range so ranges can be rebuilt after
+	vector<int> triangles, triKinds;
+	vector<int> rangeCounts;
+	for (uint i = 0; i < source->singleFaces.size() + source->normalFaces.size(); i++) {
+		bool single = i < source->singleFaces.size();
+		FaceBuf* buf = single ? source->singleFaces[i] : source->normalFaces[i - source->singleFaces.size()];
+		for (int k = 0; k < buf->count - 2; k += 3) {
+			triangles.push_back(source->indices[buf->start + k]);
+			triangles.push_back(source->indices[buf->start + k + 1]);
+			triangles.push_back(source->indices[buf->start + k + 2]);
+			triKinds.push_back(i);
+		}
+		rangeCounts.push_back(0);
+	}
+	const int vertexCount = source->vertexCount;
+	const vec3* positions = source->vertices3;
+	int sourceTriangles = triangles.size() / 3;
+	int targetTriangles = (int)(sourceTriangles * ratio);
+
+	// Locks, quadrics & collapses work on position groups, triangles keep real vertices
+	vector<int> groupOf;
+	vector<bool> locked, sliding;
+	set<pair<int, int> > featureEdges;
+	FindVertexGroups(source, triangles, triKinds, groupOf, locked, sliding, featureEdges);
+	vector<vector<int> > groupMembers(vertexCount);
+	for (int i = 0; i < vertexCount; i++) groupMembers[groupOf[i]].push_back(i);
+
+	vector<Quadric> quadrics(vertexCount);
+	for (int i = 0; i < vertexCount; i++) quadrics[i].reset();
+	for (uint t = 0; t < triangles.size(); t += 3) {
+		const vec3& p0 = positions[triangles[t]];
+		vec3 normal = FaceNormal(p0, positions[triangles[t + 1]], positions[triangles[t + 2]]);
+		float area = normal.GetLength();
+		if (area <= 0.0) continue;
+		normal /= area;
+		for (int k = 0; k < 3; k++)
+			quadrics[groupOf[triangles[t + k]]].addPlane(normal, -normal.DotProduct(p0), area);
+
+		// Plane standing on each feature edge keeps sliding groups close to their outline
+		for (int k = 0; k < 3; k++) {
+			int a = groupOf[triangles[t + k]], b = groupOf[triangles[t + (k + 1) % 3]];
+			if (!featureEdges.count(a < b ? make_pair(a, b) : make_pair(b, a))) continue;
+			vec3 edge = positions[b] - positions[a];
+			vec3 side = edge.CrossProduct(normal);
+			float length = side.GetLength();
+			if (length <= 0.0) continue;
+			side /= length;
+			float weight = length * length * LOD_FEATURE_WEIGHT;
+			quadrics[a].addPlane(side, -side.DotProduct(positions[a]), weight);
+			quadrics[b].addPlane(side, -side.DotProduct(positions[a]), weight);
+		}
+	}
+
+	// Each pass collapses cheapest edges whose neighborhoods do not overlap, then drops degenerate triangles
+	vector<int> collapseTo(vertexCount), targets;
+	vector<bool> touched(vertexCount);
+	vector<int> triStart(vertexCount + 1), triList;
+	vector<Collapse> collapses;
+	while ((int)triangles.size() / 3 > targetTriangles) {
+		int triCount = triangles.size() / 3;
+		fill(triStart.begin(), triStart.end(), 0);
+		for (uint i = 0; i < triangles.size(); i++) triStart[triangles[i] + 1]++;
+		for (int i = 0; i < vertexCount; i++) triStart[i + 1] += triStart[i];
+		triList.resize(triangles.size());
+		vector<int> fillCount(triStart.begin(), triStart.end() - 1);
+		for (uint i = 0; i < triangles.size(); i++) triList[fillCount[triangles[i]]++] = i / 3;
+
+		collapses.clear();
+		for (uint t = 0; t < triangles.size(); t += 3) {
+			for (int k = 0; k < 3; k++) {
+				int a = groupOf[triangles[t + k]], b = groupOf[triangles[t + (k + 1) % 3]];
+				if (!locked[a]) {
+					Collapse c = { a, b, quadrics[a].error(positions[b]) };
+					collapses.push_back(c);
+				}
+				if (!locked[b]) {
+					Collapse c = { b, a, quadrics[b].error(positions[a]) };
+					collapses.push_back(c);
+				}
+			}
+		}
+		sort(collapses.begin(), collapses.end());
+
+		for (int i = 0; i < vertexCount; i++) collapseTo[i] = i;
+		fill(touched.begin(), touched.end(), false);
+		int wanted = (triCount - targetTriangles + 1) / 2, done = 0;
+		for (uint c = 0; c < collapses.size() && done < wanted; c++) {
+			int from = collapses[c].from, to = collapses[c].to;
+			if (touched[from] || touched[to]) continue;
+			if (sliding[from] && !featureEdges.count(from < to ? make_pair(from, to) : make_pair(to, from))) continue;
+			if (!FindCollapseTargets(triangles, triStart, triList, groupOf, groupMembers[from], to, targets)) continue;
+
+			// Moving from onto to must not turn any remaining triangle around, nor near its edge on,
+			// as small turns summed over passes would fold slivers over too
+			bool flipped = false;
+			for (uint m = 0; m < targets.size() && !flipped; m += 2) {
+				int v = targets[m];
+				for (int r = triStart[v]; r < triStart[v + 1] && !flipped; r++) {
+					const int* tri = &triangles[triList[r] * 3];
+					if (FindVertex(tri, targets[m + 1]) >= 0) continue;
+					int k = FindVertex(tri, v);
+					const vec3& p1 = positions[tri[(k + 1) % 3]];
+					const vec3& p2 = positions[tri[(k + 2) % 3]];
+					vec3 before = FaceNormal(positions[v], p1, p2);
+					vec3 after = FaceNormal(positions[to], p1, p2);
+					flipped = before.DotProduct(after) <= LOD_MIN_TURN_COS * before.GetLength() * after.GetLength();
+				}
+			}
+			if (flipped) continue;
+
+			quadrics[to].add(quadrics[from]);
+			touched[to] = true;
+			if (sliding[from]) {
+				// Other feature edge of from now ends at to
+				for (uint m = 0; m < groupMembers[from].size(); m++) {
+					int v = groupMembers[from][m];
+					for (int r = triStart[v]; r < triStart[v + 1]; r++) {
+						const int* tri = &triangles[triList[r] * 3];
+						for (int k = 0; k < 3; k++) {
+							int g = groupOf[tri[k]];
+							if (g == from || g == to || !featureEdges.count(from < g ? make_pair(from, g) : make_pair(g, from))) continue;
+							featureEdges.insert(to < g ? make_pair(to, g) : make_pair(g, to));
+						}
+					}
+				}
+			}
+			for (uint m = 0; m < targets.size(); m += 2) {
+				int v = targets[m];
+				collapseTo[v] = targets[m + 1];
+				for (int r = triStart[v]; r < triStart[v + 1]; r++) {
+					const int* tri = &triangles[triList[r] * 3];
+					touched[groupOf[tri[0]]] = touched[groupOf[tri[1]]] = touched[groupOf[tri[2]]] = true;
+				}
+			}
+			done++;
+		}
+		if (done == 0) break;
+
+		uint write = 0;
+		for (uint t = 0; t < triangles.size(); t += 3) {
+			int a = collapseTo[triangles[t]], b = collapseTo[triangles[t + 1]], c = collapseTo[triangles[t + 2]];
+			if (groupOf[a] == groupOf[b] || groupOf[b] == groupOf[c] || groupOf[a] == groupOf[c]) continue;
+			triangles[write] = a, triangles[write + 1] = b, triangles[write + 2] = c;
+			triKinds[write / 3] = triKinds[t / 3];
+			write += 3;
+		}
+		triangles.resize(write);
+		triKinds.resize(write / 3);
+	}
+
+	int lodTriangles = triangles.size() / 3;
+	if (lodTriangles == 0 || lodTriangles > sourceTriangles * LOD_MIN_REDUCTION) return NULL;
+
+	// Triangles never left their range and kept their order, so ranges are just recounted, then each is reordered for cache
+	for (uint t = 0; t < triKinds.size(); t++) rangeCounts[triKinds[t]] += 3;
+	vector<FaceBuf> singleRanges, normalRanges;
+	int start = 0;
+	for (uint i = 0; i < rangeCounts.size(); i++) {
+		if (rangeCounts[i] <= 0) continue;
+		OptimizeVertexCache(&triangles[start], rangeCounts[i], vertexCount);
+		if (i < source->singleFaces.size()) singleRanges.push_back(FaceBuf(start, rangeCounts[i]));
+		else normalRanges.push_back(FaceBuf(start, rangeCounts[i]));
+		start += rangeCounts[i];
+	}
+
+	// Keep used vertices only, in order of first use for vertex fetch
+	vector<int> lodVertex(vertexCount), sourceVerts(vertexCount);
+	OptimizeVertexFetch(&triangles[0], triangles.size(), vertexCount, &lodVertex[0]);
+	for (int i = 0; i < vertexCount; i++) sourceVerts[lodVertex[i]] = i;
+	int lodVertexCount = 0;
+	for (uint i = 0; i < triangles.size(); i++)
+		lodVertexCount = triangles[i] >= lodVertexCount ? triangles[i] + 1 : lodVertexCount;
+	sourceVerts.resize(lodVertexCount);
+
+	return new LodMesh(source, &sourceVerts[0], lodVertexCount, &triangles[0], triangles.size(), singleRanges, normalRanges);
+}
+
+// FNV-1a of source positions & indices, lods made from another version of a model are not reused
+static uint HashSource(const Mesh* source) {
+	uint hash = 2166136261u;
+	const unsigned char* data[2] = { (const unsigned char*)source->vertices3, (const unsigned char*)source->indices };
+	uint sizes[2] = { source->vertexCount * sizeof(vec3), source->indexCount * sizeof(int) };
+	for (int d = 0; d < 2; d++) {
+		for (uint i = 0; i < sizes[d]; i++) {
+			hash ^= data[d][i];
+			hash *= 16777619u;
+		}
+	}
+	return hash;
+}
+
+// Cached is set when file matches source, lod may still be NULL as failed simplifications are cached too
+static LodMesh* LoadLodCache(const Mesh* source, uint hash, float ratio, const char* path, bool& cached) {
+	cached = false;
+	FILE* in = fopen(path, "rb");
+	if (!in) return NULL;
+	LodCacheHeader header;
+	bool valid = fread(&header, sizeof(LodCacheHeader), 1, in) == 1 &&
+		header.magic == LOD_CACHE_MAGIC && header.version == LOD_CACHE_VERSION && header.sourceHash == hash &&
+		header.ratio == ratio && header.sourceVertexCount == source->vertexCount && header.sourceIndexCount == source->indexCount;
+	cached = valid && (header.vertexCount <= 0 || header.indexCount <= 0);
+	LodMesh* lod = NULL;
+	if (valid && !cached) {
+		int rangeCount = header.singleCount + header.normalCount;
+		vector<int> sourceVerts(header.vertexCount), lodIndices(header.indexCount), ranges(rangeCount * 2 + 1);
+		valid = fread(&sourceVerts[0], sizeof(int), header.vertexCount, in) == header.vertexCount &&
+			fread(&lodIndices[0], sizeof(int), header.indexCount, in) == header.indexCount &&
+			(rangeCount == 0 || fread(&ranges[0], sizeof(int), rangeCount * 2, in) == rangeCount * 2);
+		for (int i = 0; i < header.vertexCount && valid; i++)
+			valid = sourceVerts[i] >= 0 && sourceVerts[i] < source->vertexCount;
+		for (int i = 0; i < header.indexCount && valid; i++)
+			valid = lodIndices[i] >= 0 && lodIndices[i] < header.vertexCount;
+		if (valid) {
+			vector<FaceBuf> singleRanges, normalRanges;
+			for (int i = 0; i < rangeCount; i++) {
+				if (i < header.singleCount) singleRanges.push_back(FaceBuf(ranges[i * 2], ranges[i * 2 + 1]));
+				else normalRanges.push_back(FaceBuf(ranges[i * 2], ranges[i * 2 + 1]));
+			}
+			lod = new LodMesh(source, &sourceVerts[0], header.vertexCount, &lodIndices[0], header.indexCount, singleRanges, normalRanges);
+			cached = true;
+		}
+	}
+	fclose(in);
+	return lod;
+}
+
+// Directory of path is created if missing, an existing one is left as it is
+void MakeParentDir(const char* path) {
+	string dir(path);
+	size_t slash = dir.find_last_of("/\\");
+	if (slash == string::npos || slash == 0) return;
+	dir = dir.substr(0, slash);
+#ifdef _WIN32
+	_mkdir(dir.data());
+#else
+	mkdir(dir.data(), 0755);
+#endif
+}
+
+static void SaveLodCache(const LodMesh* lod, const Mesh* source, uint hash, float ratio, const char* path) {
+	MakeParentDir(path);
+	FILE* out = fopen(path, "wb");
+	if (!out) return;
+	LodCacheHeader header;
+	memset(&header, 0, sizeof(LodCacheHeader));
+	header.magic = LOD_CACHE_MAGIC;
+	header.version = LOD_CACHE_VERSION;
+	header.sourceHash = hash;
+	header.ratio = ratio;
+	header.sourceVertexCount = source->vertexCount;
+	header.sourceIndexCount = source->indexCount;
+	if (lod) {
+		header.vertexCount = lod->vertexCount;
+		header.indexCount = lod->indexCount;
+		header.singleCount = lod->singleFaces.size();
+		header.normalCount = lod->normalFaces.size();
+	}
+	fwrite(&header, sizeof(LodCacheHeader), 1, out);
+	if (!lod) {
+		fclose(out);
+		return;
+	}
+	fwrite(&lod->sourceVertices[0], sizeof(int), lod->vertexCount, out);
+	fwrite(lod->indices, sizeof(int), lod->indexCount, out);
+	for (int i = 0; i < header.singleCount + header.normalCount; i++) {
+		FaceBuf* buf = i < header.singleCount ? lod->singleFaces[i] : lod->normalFaces[i - header.singleCount];
+		fwrite(&buf->start, sizeof(int), 1, out);
+		fwrite(&buf->count, sizeof(int), 1, out);
+	}
+	fclose(out);
+}
+
+LodMesh* CreateLodMesh(const Mesh* source, float ratio, const char* cachePath) {
+	uint hash = HashSource(source);
+	bool cached = false;
+	LodMesh* lod = LoadLodCache(source, hash, ratio, cachePath, cached);
+	if (cached) return lod;
+
+	lod = SimplifyMesh(source, ratio);
+	SaveLodCache(lod, source, hash, ratio, cachePath);
+	return lod;
+}
@@ -0,0 +1,47 @@
+#ifndef LOD_MESH_H_
+#define LOD_MESH_H_
+
+#include "mesh.h"
+
+#define LOD_MIN_TRIANGLES 800 // Smaller meshes get no generated lods
+#define LOD_MID_RATIO 0.5f
+#define LOD_LOW_RATIO 0.2f
+#define LOD_MIN_REDUCTION 0.8f // Lod is dropped if simplifier can not get below this ratio
+#define LOD_FEATURE_WEIGHT 10.0f // Quadric weight of border & material edges
+#define LOD_MIN_TURN_COS 0.25f // Collapse is skipped if it turns a triangle normal further, about 75 degrees
+#define LOD_CACHE_DIR "cache" // Lod & mesh caches are generated at run time, so kept apart from shipped models
+#define LOD_CACHE_MAGIC 0x4C334554 // "TE3L"
+#define LOD_CACHE_VERSION 1
+
+// Simplifier only collapses vertices onto other vertices, so a lod keeps a subset of source vertices
+// Cache stores that subset with new indices & face ranges, attributes are copied from source at load
+struct LodCacheHeader {
+	uint magic;
+	uint version;
+	uint sourceHash; // Positions & indices of source mesh
+	float ratio;
+	int sourceVertexCount, sourceIndexCount;
+	int vertexCount, indexCount; // Zero if source could not be simplified enough
+	int singleCount, normalCount; // FaceBuf count of each kind
+};
+
+class LodMesh: public Mesh {
+private:
+	virtual void initFaces() {}
+public:
+	std::vector<int> sourceVertices; // Source vertex of each lod vertex
+public:
+	LodMesh(const Mesh* source, const int* sourceVertices, int vertCount, const int* lodIndices, int idxCount,
+		const std::vector<FaceBuf>& singleRanges, const std::vector<FaceBuf>& normalRanges);
+	virtual ~LodMesh() {}
+};
+
+// Quadric edge collapse down to ratio of source triangles
+// Uv & normal seams, open borders, material & face kind boundaries only collapse along themselves
+LodMesh* SimplifyMesh(const Mesh* source, float ratio);
+// Load lod from cache when it was made from the same source, otherwise simplify & save it
+LodMesh* CreateLodMesh(const Mesh* source, float ratio, const char* cachePath);
+// Create directory a cache file goes to, its parent must exist
+void MakeParentDir(const char* path);
+
+#endif
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../bounding/aabb.h"
+#include "vertexCache.h"
 
 Mesh::Mesh() {
 	vertexCount = 0;
@@ -18,9 +19,13 @@ Mesh::Mesh() {
 	isBillboard = false;
 	drawShadow = true;
 	bounding = NULL;
+	meshId = -1;
 
 	singleFaces.clear();
 	normalFaces.clear();
+	meshlets.clear();
+	lodMid = NULL;
+	lodLow = NULL;
 
 	boundScale = vec3(1.0, 1.0, 1.0);
 }
@@ -28,11 +33,15 @@ Mesh::Mesh() {
 Mesh::Mesh(const Mesh& rhs) {
 	isBillboard = rhs.isBillboard;
 	boundScale = rhs.boundScale;
+	meshId = -1;
 
 	for (uint i = 0; i < rhs.singleFaces.size(); i++)
 		singleFaces.push_back(rhs.singleFaces[i]->copy());
 	for (uint i = 0; i < rhs.normalFaces.size(); i++)
 		normalFaces.push_back(rhs.normalFaces[i]->copy());
+	meshlets = rhs.meshlets;
+	lodMid = rhs.lodMid;
+	lodLow = rhs.lodLow;
 }
 
 Mesh::~Mesh() {
@@ -71,6 +80,30 @@ void Mesh::caculateExData() {
 	caculateBounding();
 }
 
+// Reorder triangles of each face range for post transform cache, then vertices for fetch
+void Mesh::optimizeVertexOrder(const char* name) {
+	if (!indices || indexCount < 3 || vertexCount <= 0) return;
+	VertexCacheStats before = AnalyzeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_FIFO);
+	for (uint i = 0; i < singleFaces.size(); i++)
+		OptimizeVertexCache(indices + singleFaces[i]->start, singleFaces[i]->count, vertexCount);
+	for (uint i = 0; i < normalFaces.size(); i++)
+		OptimizeVertexCache(indices + normalFaces[i]->start, normalFaces[i]->count, vertexCount);
+
+	int* remap = (int*)malloc(vertexCount * sizeof(int));
+	OptimizeVertexFetch(indices, indexCount, vertexCount, remap);
+	RemapVertexData(vertices, remap, vertexCount);
+	RemapVertexData(vertices3, remap, vertexCount);
+	RemapVertexData(normals, remap, vertexCount);
+	RemapVertexData(normals4, remap, vertexCount);
+	RemapVertexData(tangents, remap, vertexCount);
+	RemapVertexData(texcoords, remap, vertexCount);
+	RemapVertexData(materialids, remap, vertexCount);
+	free(remap);
+
+	VertexCacheStats after = AnalyzeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_FIFO);
+	LogVertexCache(name, indexCount / 3, before, after);
+}
+
 void Mesh::caculateBounding() {
 	if (vertexCount <= 0) return;
 	vec3 first3 = vertices3[0];
@@ -109,8 +142,11 @@ void Mesh::clearFaceBuf() {
 
 void Mesh::setIsBillboard(bool billboard) {
 	isBillboard = billboard;
-	if (isBillboard) setAllSingle();
-	else setAllNormal();
+	if (isBillboard) {
+		setAllSingle(); // Faces changed, meshlets must follow them
+		if (meshlets.size() > 0) BuildMeshlets(this);
+	} else
+		setAllNormal(); // Only fills meshes without faces, meshlets from cache are kept
 }
 
 void Mesh::setAllSingle() {
@@ -9,6 +9,7 @@
 #define MESH_H_
 
 #include "../maths/Maths.h"
+#include "meshlet.h"
 #include <vector>
 #include <string>
 
@@ -37,13 +38,18 @@ public:
 	int* indices;
 	bool isBillboard, drawShadow;
 	float* bounding;
+	int meshId; // Dense id in scene, assigned by Scene::addObject
 	std::vector<FaceBuf*> singleFaces;
 	std::vector<FaceBuf*> normalFaces;
+	std::vector<Meshlet> meshlets; // Empty for meshes too small to cull by parts
+	Mesh* lodMid; // Generated lods, owned by AssetManager
+	Mesh* lodLow;
 public:
 	Mesh();
 	Mesh(const Mesh& rhs);
 	virtual ~Mesh();
 	void caculateExData();
+	void optimizeVertexOrder(const char* name);
 	void setIsBillboard(bool billboard);
 	void setAllSingle();
 	void setAllNormal();
@@ -0,0 +1,205 @@
+#include "meshCache.h"
+#include "../util/mappedFile.h"
+#include "../material/materialManager.h"
+#include "../model/mtlloader.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <map>
+#include <vector>
+using namespace std;
+
+// models/tree.obj becomes cache/models_tree.t3m, so objs of same name in other directories keep their own caches
+string GetMeshCachePath(const char* obj) {
+	string path(obj);
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of("/\\");
+	if (dot != string::npos && (slash == string::npos || dot > slash)) path = path.substr(0, dot);
+	while (path.size() > 0 && (path[0] == '/' || path[0] == '\\')) path = path.substr(1);
+	for (uint i = 0; i < path.size(); i++)
+		if (path[i] == '/' || path[i] == '\\' || path[i] == ':') path[i] = '_';
+	return string(LOD_CACHE_DIR) + "/" + path + MESH_CACHE_EXT;
+}
+
+// A missing source does not outdate the cache, so models may ship as caches only
+static bool IsNewer(const char* path, const char* source) {
+	struct stat cacheInfo, sourceInfo;
+	if (stat(path, &cacheInfo) != 0) return false;
+	if (!source || stat(source, &sourceInfo) != 0) return true;
+	return cacheInfo.st_mtime >= sourceInfo.st_mtime;
+}
+
+static void GetSectionSizes(int vertexCount, int indexCount, int faceCount, int meshletCount, uint* sizes) {
+	sizes[CACHE_VERTICES] = vertexCount * sizeof(vec4);
+	sizes[CACHE_VERTICES3] = vertexCount * sizeof(vec3);
+	sizes[CACHE_NORMALS] = vertexCount * sizeof(vec3);
+	sizes[CACHE_NORMALS4] = vertexCount * sizeof(vec4);
+	sizes[CACHE_TANGENTS] = vertexCount * sizeof(vec3);
+	sizes[CACHE_TEXCOORDS] = vertexCount * sizeof(vec2);
+	sizes[CACHE_MATERIALIDS] = vertexCount * sizeof(int);
+	sizes[CACHE_INDICES] = indexCount * sizeof(int);
+	sizes[CACHE_BOUNDING] = 6 * sizeof(float);
+	sizes[CACHE_FACES] = faceCount * 2 * sizeof(int);
+	sizes[CACHE_MESHLETS] = meshletCount * sizeof(Meshlet);
+}
+
+static bool CheckCache(const MappedFile* file, int vt) {
+	const MeshCacheHeader* header = (const MeshCacheHeader*)file->data;
+	if (header->magic != MESH_CACHE_MAGIC || header->version != MESH_CACHE_VERSION || header->meshletSize != sizeof(Meshlet))
+		return false;
+	if (header->vt != vt) return false;
+	if (header->vertexCount <= 0 || header->indexCount <= 0 || header->singleCount < 0 || header->normalCount < 0 ||
+		header->meshletCount < 0 || header->materialCount <= 0)
+		return false;
+
+	uint sizes[CACHE_SECTION_COUNT];
+	GetSectionSizes(header->vertexCount, header->indexCount, header->singleCount + header->normalCount, header->meshletCount, sizes);
+	for (int s = 0; s < CACHE_SECTION_COUNT; s++) {
+		if (s != CACHE_MATERIALS && header->sizes[s] != sizes[s]) return false;
+		if (header->offsets[s] % MESH_CACHE_ALIGN != 0 || header->offsets[s] < sizeof(MeshCacheHeader)) return false;
+		if ((size_t)header->offsets[s] + header->sizes[s] > file->size) return false;
+	}
+
+	const int* indices = (const int*)(file->data + header->offsets[CACHE_INDICES]);
+	for (int i = 0; i < header->indexCount; i++)
+		if (indices[i] < 0 || indices[i] >= header->vertexCount) return false;
+	const int* materialids = (const int*)(file->data + header->offsets[CACHE_MATERIALIDS]);
+	for (int i = 0; i < header->vertexCount; i++)
+		if (materialids[i] < 0 || materialids[i] >= header->materialCount) return false;
+	const int* faces = (const int*)(file->data + header->offsets[CACHE_FACES]);
+	for (int i = 0; i < header->singleCount + header->normalCount; i++)
+		if (faces[i * 2] < 0 || faces[i * 2 + 1] < 0 || faces[i * 2] + faces[i * 2 + 1] > header->indexCount) return false;
+
+	const char* names = file->data + header->offsets[CACHE_MATERIALS];
+	int nameCount = 0;
+	for (uint i = 0; i < header->sizes[CACHE_MATERIALS]; i++)
+		if (names[i] == '\0') nameCount++;
+	return nameCount == header->materialCount && header->sizes[CACHE_MATERIALS] > 0 && names[header->sizes[CACHE_MATERIALS] - 1] == '\0';
+}
+
+Model* LoadMeshCache(const char* path, const char* obj, const char* mtl, int vt) {
+	if (!IsNewer(path, obj) || !IsNewer(path, mtl)) return NULL;
+	MappedFile* file = new MappedFile();
+	if (!file->open(path) || file->size < sizeof(MeshCacheHeader) || !CheckCache(file, vt)) {
+		delete file;
+		return NULL;
+	}
+
+	const MeshCacheHeader* header = (const MeshCacheHeader*)file->data;
+	Model* model = new Model(file);
+	char* data = file->data;
+	model->vertexCount = header->vertexCount;
+	model->indexCount = header->indexCount;
+	model->vertices = (vec4*)(data + header->offsets[CACHE_VERTICES]);
+	model->vertices3 = (vec3*)(data + header->offsets[CACHE_VERTICES3]);
+	model->normals = (vec3*)(data + header->offsets[CACHE_NORMALS]);
+	model->normals4 = (vec4*)(data + header->offsets[CACHE_NORMALS4]);
+	model->tangents = (vec3*)(data + header->offsets[CACHE_TANGENTS]);
+	model->texcoords = (vec2*)(data + header->offsets[CACHE_TEXCOORDS]);
+	model->materialids = (int*)(data + header->offsets[CACHE_MATERIALIDS]);
+	model->indices = (int*)(data + header->offsets[CACHE_INDICES]);
+	model->bounding = (float*)(data + header->offsets[CACHE_BOUNDING]);
+
+	const int* faces = (const int*)(data + header->offsets[CACHE_FACES]);
+	for (int i = 0; i < header->singleCount + header->normalCount; i++) {
+		FaceBuf* buf = new FaceBuf(faces[i * 2], faces[i * 2 + 1]);
+		if (i < header->singleCount) model->singleFaces.push_back(buf);
+		else model->normalFaces.push_back(buf);
+	}
+	const Meshlet* meshlets = (const Meshlet*)(data + header->offsets[CACHE_MESHLETS]);
+	model->meshlets.assign(meshlets, meshlets + header->meshletCount);
+
+	// Mtl still registers its materials, cached names are then matched to their ids
+	MtlLoader mtlLoader(mtl);
+	vector<int> ids;
+	const char* name = data + header->offsets[CACHE_MATERIALS];
+	for (int m = 0; m < header->materialCount; m++) {
+		map<string, int>::iterator it = mtlLoader.objMtls.find(name);
+		ids.push_back(it != mtlLoader.objMtls.end() ? it->second : MaterialManager::materials->find(string(name)));
+		name += strlen(name) + 1;
+	}
+	for (int i = 0; i < model->vertexCount; i++)
+		model->materialids[i] = ids[model->materialids[i]];
+	return model;
+}
+
+static void WriteSection(FILE* out, const void* data, uint offset, uint size, uint& written) {
+	static const char padding[MESH_CACHE_ALIGN] = { 0 };
+	if (offset > written) fwrite(padding, 1, offset - written, out);
+	if (size > 0) fwrite(data, 1, size, out);
+	written = offset + size;
+}
+
+bool SaveMeshCache(const Model* model, const char* path, int vt) {
+	if (model->vertexCount <= 0 || model->indexCount <= 0 || !model->vertices3 || !model->normals4 || !model->bounding)
+		return false;
+
+	// Material ids become indices of names used by this model
+	map<int, int> localIds;
+	vector<int> materialids(model->vertexCount);
+	string names;
+	for (int i = 0; i < model->vertexCount; i++) {
+		int mid = model->materialids ? model->materialids[i] : 0;
+		map<int, int>::iterator it = localIds.find(mid);
+		if (it == localIds.end()) {
+			it = localIds.insert(pair<int, int>(mid, (int)localIds.size())).first;
+			Material* mat = MaterialManager::materials->find(mid);
+			names += mat ? mat->name : string(DEFAULT_MAT);
+			names += '\0';
+		}
+		materialids[i] = it->second;
+	}
+	vector<int> faces;
+	for (uint i = 0; i < model->singleFaces.size(); i++)
+		faces.push_back(model->singleFaces[i]->start), faces.push_back(model->singleFaces[i]->count);
+	for (uint i = 0; i < model->normalFaces.size(); i++)
+		faces.push_back(model->normalFaces[i]->start), faces.push_back(model->normalFaces[i]->count);
+
+	MeshCacheHeader header;
+	memset(&header, 0, sizeof(MeshCacheHeader));
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.meshletSize = sizeof(Meshlet);
+	header.vt = vt;
+	header.vertexCount = model->vertexCount;
+	header.indexCount = model->indexCount;
+	header.singleCount = model->singleFaces.size();
+	header.normalCount = model->normalFaces.size();
+	header.meshletCount = model->meshlets.size();
+	header.materialCount = localIds.size();
+	GetSectionSizes(header.vertexCount, header.indexCount, header.singleCount + header.normalCount, header.meshletCount, header.sizes);
+	header.sizes[CACHE_MATERIALS] = names.size();
+	uint offset = sizeof(MeshCacheHeader);
+	for (int s = 0; s < CACHE_SECTION_COUNT; s++) {
+		offset = (offset + MESH_CACHE_ALIGN - 1) / MESH_CACHE_ALIGN * MESH_CACHE_ALIGN;
+		header.offsets[s] = offset;
+		offset += header.sizes[s];
+	}
+
+	const void* datas[CACHE_SECTION_COUNT] = { model->vertices, model->vertices3, model->normals, model->normals4,
+		model->tangents, model->texcoords, &materialids[0], model->indices, model->bounding,
+		faces.size() > 0 ? &faces[0] : NULL, model->meshlets.size() > 0 ? &model->meshlets[0] : NULL, names.data() };
+
+	MakeParentDir(path);
+	FILE* out = fopen(path, "wb");
+	if (!out) return false;
+	uint written = 0;
+	WriteSection(out, &header, 0, sizeof(MeshCacheHeader), written);
+	for (int s = 0; s < CACHE_SECTION_COUNT; s++)
+		WriteSection(out, datas[s], header.offsets[s], header.sizes[s], written);
+	fclose(out);
+	return true;
+}
+
+bool BakeMeshCache(const char* obj, const char* mtl, int vt) {
+	Model* model = new Model(obj, mtl, vt);
+	string path = GetMeshCachePath(obj);
+	bool saved = SaveMeshCache(model, path.data(), vt);
+	int cones = 0;
+	for (uint i = 0; i < model->meshlets.size(); i++)
+		cones += model->meshlets[i].coneCutoff < MESHLET_NO_CONE ? 1 : 0;
+	printf("%s: %d triangles, %d meshlets, %d with cones -> %s%s\n", obj, model->indexCount / 3, (int)model->meshlets.size(), cones,
+		path.data(), saved ? "" : " FAILED");
+	delete model;
+	return saved;
+}
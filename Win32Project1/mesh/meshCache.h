@@ -0,0 +1,50 @@
+#ifndef MESH_CACHE_H_
+#define MESH_CACHE_H_
+
+#include "model.h"
+#include "lodMesh.h"
+#include <string>
+
+#define MESH_CACHE_EXT ".t3m"
+#define MESH_CACHE_MAGIC 0x4D334554 // "TE3M"
+#define MESH_CACHE_VERSION 2
+#define MESH_CACHE_ALIGN 16
+
+enum MeshCacheSection {
+	CACHE_VERTICES, // vec4
+	CACHE_VERTICES3, // vec3
+	CACHE_NORMALS, // vec3
+	CACHE_NORMALS4, // vec4
+	CACHE_TANGENTS, // vec3
+	CACHE_TEXCOORDS, // vec2
+	CACHE_MATERIALIDS, // int, index of material names
+	CACHE_INDICES, // int
+	CACHE_BOUNDING, // 6 floats
+	CACHE_FACES, // start & count of single then normal FaceBufs
+	CACHE_MESHLETS, // Meshlet
+	CACHE_MATERIALS, // Null terminated material names
+	CACHE_SECTION_COUNT
+};
+
+// Arrays are stored as Model holds them after loading, so a cached model is used straight from the mapped file
+// Material ids depend on load order, file keeps names & they are turned into ids again at load
+struct MeshCacheHeader {
+	uint magic;
+	uint version;
+	uint meshletSize; // Layout check of raw structs
+	int vt; // Texcoord mode obj was parsed with
+	int vertexCount, indexCount;
+	int singleCount, normalCount, meshletCount, materialCount;
+	uint offsets[CACHE_SECTION_COUNT]; // Byte offset of each section, aligned to MESH_CACHE_ALIGN
+	uint sizes[CACHE_SECTION_COUNT];
+};
+
+// Obj path flattened into a file of LOD_CACHE_DIR with cache extension
+std::string GetMeshCachePath(const char* obj);
+// NULL if cache is missing, older than obj or mtl, parsed with another vt, or does not match this build
+Model* LoadMeshCache(const char* path, const char* obj, const char* mtl, int vt);
+bool SaveMeshCache(const Model* model, const char* path, int vt);
+// Offline builder: parse obj, build its meshlets and write its cache, so game loads only map the result
+bool BakeMeshCache(const char* obj, const char* mtl, int vt);
+
+#endif
@@ -0,0 +1,169 @@
+#include "meshlet.h"
+#include "mesh.h"
+#include <math.h>
+
+static void FinishMeshlet(Mesh* mesh, Meshlet& meshlet, const int* vertexIds, bool twoSided) {
+	const vec3* positions = mesh->vertices3;
+	vec3 minVertex = positions[vertexIds[0]], maxVertex = minVertex;
+	for (int i = 1; i < meshlet.vertexCount; i++) {
+		const vec3& p = positions[vertexIds[i]];
+		minVertex.x = p.x < minVertex.x ? p.x : minVertex.x;
+		minVertex.y = p.y < minVertex.y ? p.y : minVertex.y;
+		minVertex.z = p.z < minVertex.z ? p.z : minVertex.z;
+		maxVertex.x = p.x > maxVertex.x ? p.x : maxVertex.x;
+		maxVertex.y = p.y > maxVertex.y ? p.y : maxVertex.y;
+		maxVertex.z = p.z > maxVertex.z ? p.z : maxVertex.z;
+	}
+	meshlet.center = (minVertex + maxVertex) * 0.5;
+	meshlet.radius = 0.0;
+	for (int i = 0; i < meshlet.vertexCount; i++) {
+		float dist = (positions[vertexIds[i]] - meshlet.center).GetLength();
+		meshlet.radius = dist > meshlet.radius ? dist : meshlet.radius;
+	}
+
+	meshlet.coneApex = meshlet.center;
+	meshlet.coneAxis = vec3(0.0, 1.0, 0.0);
+	meshlet.coneCutoff = MESHLET_NO_CONE;
+	if (twoSided) return;
+
+	// Axis is mean of face normals, cone must hold all of them with some margin to be useful
+	vec3 axis(0.0, 0.0, 0.0);
+	for (int i = meshlet.start; i < meshlet.start + meshlet.count; i += 3) {
+		const vec3& p0 = positions[mesh->indices[i]];
+		vec3 normal = (positions[mesh->indices[i + 1]] - p0).CrossProduct(positions[mesh->indices[i + 2]] - p0);
+		float length = normal.GetLength();
+		if (length > 0.0) axis += normal / length;
+	}
+	float axisLength = axis.GetLength();
+	if (axisLength <= 0.0) return;
+	axis /= axisLength;
+
+	float minDot = 1.0;
+	for (int i = meshlet.start; i < meshlet.start + meshlet.count; i += 3) {
+		const vec3& p0 = positions[mesh->indices[i]];
+		vec3 normal = (positions[mesh->indices[i + 1]] - p0).CrossProduct(positions[mesh->indices[i + 2]] - p0);
+		float length = normal.GetLength();
+		if (length <= 0.0) continue;
+		float dp = axis.DotProduct(normal / length);
+		minDot = dp < minDot ? dp : minDot;
+	}
+	if (minDot <= 0.1) return;
+
+	// Move apex back along axis until it is behind every face plane
+	float maxT = 0.0;
+	for (int i = meshlet.start; i < meshlet.start + meshlet.count; i += 3) {
+		const vec3& p0 = positions[mesh->indices[i]];
+		vec3 normal = (positions[mesh->indices[i + 1]] - p0).CrossProduct(positions[mesh->indices[i + 2]] - p0);
+		float length = normal.GetLength();
+		if (length <= 0.0) continue;
+		normal /= length;
+		float t = (meshlet.center - p0).DotProduct(normal) / axis.DotProduct(normal);
+		maxT = t > maxT ? t : maxT;
+	}
+	meshlet.coneApex = meshlet.center - axis * maxT;
+	meshlet.coneAxis = axis;
+	meshlet.coneCutoff = sqrtf(1.0 - minDot * minDot);
+}
+
+// Greedy scan in index order, a meshlet ends when next triangle would pass vertex or triangle limit
+static void BuildRange(Mesh* mesh, int start, int count, bool twoSided) {
+	int vertexIds[MESHLET_MAX_VERTICES];
+	Meshlet meshlet;
+	meshlet.start = start, meshlet.count = 0, meshlet.vertexCount = 0;
+	for (int i = start; i + 2 < start + count; i += 3) {
+		int newIds[3], newCount = 0;
+		for (int k = 0; k < 3; k++) {
+			int id = mesh->indices[i + k];
+			bool found = false;
+			for (int v = 0; v < meshlet.vertexCount && !found; v++)
+				found = vertexIds[v] == id;
+			for (int v = 0; v < newCount && !found; v++)
+				found = newIds[v] == id;
+			if (!found) newIds[newCount++] = id;
+		}
+		if (meshlet.vertexCount + newCount > MESHLET_MAX_VERTICES || meshlet.count / 3 >= MESHLET_MAX_TRIANGLES) {
+			FinishMeshlet(mesh, meshlet, vertexIds, twoSided);
+			mesh->meshlets.push_back(meshlet);
+			meshlet.start = i, meshlet.count = 0, meshlet.vertexCount = 0;
+			i -= 3; // Scan this triangle again with empty meshlet
+			continue;
+		}
+		for (int v = 0; v < newCount; v++)
+			vertexIds[meshlet.vertexCount++] = newIds[v];
+		meshlet.count += 3;
+	}
+	if (meshlet.count > 0) {
+		FinishMeshlet(mesh, meshlet, vertexIds, twoSided);
+		mesh->meshlets.push_back(meshlet);
+	}
+}
+
+void BuildMeshlets(Mesh* mesh) {
+	mesh->meshlets.clear();
+	if (!mesh->indices || !mesh->vertices3 || mesh->indexCount / 3 < MESHLET_MIN_TRIANGLES) return;
+	for (uint i = 0; i < mesh->singleFaces.size(); i++)
+		BuildRange(mesh, mesh->singleFaces[i]->start, mesh->singleFaces[i]->count, true);
+	for (uint i = 0; i < mesh->normalFaces.size(); i++)
+		BuildRange(mesh, mesh->normalFaces[i]->start, mesh->normalFaces[i]->count, false);
+}
+
+int CullMeshlets(const Mesh* mesh, const mat4& transform, const Frustum* frustum, const vec3& eye, std::atomic<uint>* visibility) {
+	const float* m = transform.entries;
+	vec3 axisX(m[0], m[1], m[2]), axisY(m[4], m[5], m[6]), axisZ(m[8], m[9], m[10]);
+	float sx = axisX.GetLength(), sy = axisY.GetLength(), sz = axisZ.GetLength();
+	float scale = sx > sy ? (sx > sz ? sx : sz) : (sy > sz ? sy : sz);
+	float minScale = sx < sy ? (sx < sz ? sx : sz) : (sy < sz ? sy : sz);
+	// Non-uniform scale bends face normals away from cone, mirroring flips them
+	bool useCones = scale > 0.0 && scale - minScale <= scale * MESHLET_SCALE_EPSILON && axisX.CrossProduct(axisY).DotProduct(axisZ) > 0.0;
+	float invScale = scale > 0.0 ? 1.0 / scale : 0.0;
+
+	int visible = 0;
+	for (uint i = 0; i < mesh->meshlets.size(); i++) {
+		const Meshlet& meshlet = mesh->meshlets[i];
+		if (useCones && meshlet.coneCutoff < MESHLET_NO_CONE) {
+			vec4 apex = transform * vec4(meshlet.coneApex, 1.0);
+			vec4 axis = transform * vec4(meshlet.coneAxis, 0.0);
+			vec3 dir = vec3(apex.x, apex.y, apex.z) - eye;
+			float length = dir.GetLength();
+			if (length > 0.0 && dir.DotProduct(vec3(axis.x, axis.y, axis.z)) * invScale >= meshlet.coneCutoff * length)
+				continue;
+		}
+
+		vec4 center = transform * vec4(meshlet.center, 1.0);
+		float radius = meshlet.radius * scale;
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++) {
+			const vec3& n = frustum->normals[p];
+			inside = n.x * center.x + n.y * center.y + n.z * center.z + frustum->ds[p] >= -radius;
+		}
+		if (!inside) continue;
+
+		uint bit = 1u << (i % 32);
+		if (!(visibility[i / 32].load(std::memory_order_relaxed) & bit)) // Most bits are set by an earlier instance
+			visibility[i / 32].fetch_or(bit, std::memory_order_relaxed);
+		visible++;
+	}
+	return visible;
+}
+
+bool CopyMeshletMask(const std::atomic<uint>* visibility, uint* dst, int words) {
+	bool changed = false;
+	for (int w = 0; w < words; w++) {
+		uint bits = visibility[w].load(std::memory_order_relaxed);
+		if (dst[w] != bits) changed = true;
+		dst[w] = bits;
+	}
+	return changed;
+}
+
+int GatherMeshletIndices(const Mesh* mesh, const uint* visibility, int start, int count, uint* dst) {
+	int gathered = 0;
+	for (uint i = 0; i < mesh->meshlets.size(); i++) {
+		const Meshlet& meshlet = mesh->meshlets[i];
+		if (meshlet.start < start || meshlet.start >= start + count) continue;
+		if (!((visibility[i / 32] >> (i % 32)) & 1)) continue;
+		for (int k = 0; k < meshlet.count; k++)
+			dst[gathered++] = (uint)mesh->indices[meshlet.start + k];
+	}
+	return gathered;
+}
@@ -0,0 +1,47 @@
+#ifndef MESHLET_H_
+#define MESHLET_H_
+
+#include "../maths/Maths.h"
+#include "../camera/frustum.h"
+#include "../constants/constants.h"
+#include <atomic>
+
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+#define MESHLET_MIN_TRIANGLES 2048 // Smaller meshes are always drawn whole
+#define MESHLET_NO_CONE 2.0f // Cone cutoff of clusters which can not be back face culled
+#define MESHLET_SCALE_EPSILON 0.001f // Relative axis scale difference still taken as uniform
+
+class Mesh;
+
+// Cluster of consecutive triangles in mesh's index list, all in mesh space
+struct Meshlet {
+	int start, count; // Index range in Mesh::indices
+	int vertexCount;
+	vec3 center;
+	float radius;
+	vec3 coneApex, coneAxis;
+	float coneCutoff; // Back facing when dot(normalize(coneApex - eye), coneAxis) >= coneCutoff
+};
+
+// Cut single & normal face ranges of mesh into meshlets, each range separately so a meshlet never mixes them
+// Meshlets of single faces get no cone as they are drawn without face culling
+void BuildMeshlets(Mesh* mesh);
+
+// Test meshlets of mesh drawn with transform, bits of visible meshlets are or'ed into visibility
+// Frustum test uses world space spheres. Cones are moved to world space, which only keeps them valid under
+// uniform scale without mirroring, other transforms skip the cone test
+// Cull tasks of different subtrees may or into the same visibility at once
+int CullMeshlets(const Mesh* mesh, const mat4& transform, const Frustum* frustum, const vec3& eye, std::atomic<uint>* visibility);
+
+// Copy culled visibility to dst, return false if dst held the same bits already
+bool CopyMeshletMask(const std::atomic<uint>* visibility, uint* dst, int words);
+
+// Copy indices of meshlets set in visibility and inside [start, start + count) to dst, return index count
+int GatherMeshletIndices(const Mesh* mesh, const uint* visibility, int start, int count, uint* dst);
+
+inline int MeshletMaskWords(int meshletCount) {
+	return (meshletCount + 31) / 32;
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include "../constants/constants.h"
 #include "../material/materialManager.h"
 #include "../util/util.h"
+#include "../util/mappedFile.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -14,12 +15,23 @@ Model::Model(const char* obj, const char* mtl, int vt) :Mesh() {
 	texcoords = NULL;
 	materialids = NULL;
 	indices = NULL;
+	mapped = NULL;
 	mats.clear();
 	loadModel(obj, mtl, vt);
+	optimizeVertexOrder(obj);
 	caculateExData();
+	BuildMeshlets(this);
+}
+
+// Arrays are filled by LoadMeshCache, model owns file from now on
+Model::Model(MappedFile* file) :Mesh() {
+	loader = NULL;
+	mapped = file;
+	mats.clear();
 }
 
 Model::Model(const Model& rhs) :Mesh(rhs) {
+	mapped = NULL;
 	if (rhs.vertexCount > 0) {
 		vertexCount = rhs.vertexCount;
 		vertices = new vec4[vertexCount];
@@ -50,6 +62,19 @@ Model::Model(const Model& rhs) :Mesh(rhs) {
 
 Model::~Model() {
 	mats.clear();
+	if (mapped) {
+		// Keep Mesh from freeing arrays of mapped file
+		vertices = NULL;
+		vertices3 = NULL;
+		normals = NULL;
+		normals4 = NULL;
+		tangents = NULL;
+		texcoords = NULL;
+		materialids = NULL;
+		indices = NULL;
+		bounding = NULL;
+		delete mapped;
+	}
 }
 
 void Model::loadModel(const char* obj,const char* mtl,int vt) {
@@ -103,9 +128,9 @@ void Model::initFaces() {
 	indexCount = loader->faceCount * 3;
 	vertices = new vec4[indexCount];
 	for(int i=0;i<vertexCount;i++) {
-		vertices[i].x=loader->vArr[i][0];
-		vertices[i].y=loader->vArr[i][1];
-		vertices[i].z=loader->vArr[i][2];
+		vertices[i].x=loader->vArr[i*3+0];
+		vertices[i].y=loader->vArr[i*3+1];
+		vertices[i].z=loader->vArr[i*3+2];
 		vertices[i].w=1.0;
 	}
 
@@ -122,28 +147,30 @@ void Model::initFaces() {
 
 	std::map<int, bool> texcoordMap; texcoordMap.clear();
 
+	// Material of each usemtl name, looked up once instead of once per face
+	std::vector<int> mtlIds(loader->mtNames.size());
+	for (uint m = 0; m < loader->mtNames.size(); m++)
+		mtlIds[m] = loader->mtlLoader->objMtls[loader->mtNames[m]];
+
+	const float* vn = loader->vnArr;
+	const float* vt = loader->vtArr;
+	int vts = loader->vtStride();
 	int dupIndex = vertexCount;
 	for (int i=0;i<loader->faceCount;i++) {
-		int index1=loader->fvArr[i][0]-1;
-		int index2=loader->fvArr[i][1]-1;
-		int index3=loader->fvArr[i][2]-1;
-
-		vec3 n1(loader->vnArr[loader->fnArr[i][0]-1][0],
-				loader->vnArr[loader->fnArr[i][0]-1][1],
-				loader->vnArr[loader->fnArr[i][0]-1][2]);
-		vec3 n2(loader->vnArr[loader->fnArr[i][1]-1][0],
-				loader->vnArr[loader->fnArr[i][1]-1][1],
-				loader->vnArr[loader->fnArr[i][1]-1][2]);
-		vec3 n3(loader->vnArr[loader->fnArr[i][2]-1][0],
-				loader->vnArr[loader->fnArr[i][2]-1][1],
-				loader->vnArr[loader->fnArr[i][2]-1][2]);
-
-		vec2 c1(loader->vtArr[loader->ftArr[i][0]-1][0],
-				loader->vtArr[loader->ftArr[i][0]-1][1]);
-		vec2 c2(loader->vtArr[loader->ftArr[i][1]-1][0],
-				loader->vtArr[loader->ftArr[i][1]-1][1]);
-		vec2 c3(loader->vtArr[loader->ftArr[i][2]-1][0],
-				loader->vtArr[loader->ftArr[i][2]-1][1]);
+		const int* fv = loader->fvArr + i * 3;
+		const int* fn = loader->fnArr + i * 3;
+		const int* ft = loader->ftArr + i * 3;
+		int index1=fv[0]-1;
+		int index2=fv[1]-1;
+		int index3=fv[2]-1;
+
+		vec3 n1(vn[(fn[0]-1)*3+0], vn[(fn[0]-1)*3+1], vn[(fn[0]-1)*3+2]);
+		vec3 n2(vn[(fn[1]-1)*3+0], vn[(fn[1]-1)*3+1], vn[(fn[1]-1)*3+2]);
+		vec3 n3(vn[(fn[2]-1)*3+0], vn[(fn[2]-1)*3+1], vn[(fn[2]-1)*3+2]);
+
+		vec2 c1(vt[(ft[0]-1)*vts+0], vt[(ft[0]-1)*vts+1]);
+		vec2 c2(vt[(ft[1]-1)*vts+0], vt[(ft[1]-1)*vts+1]);
+		vec2 c3(vt[(ft[2]-1)*vts+0], vt[(ft[2]-1)*vts+1]);
 		
 		// Duplicate vertex if texcoord not the same
 		if (texcoordMap.find(index1) != texcoordMap.end() && texcoords[index1] != c1) {
@@ -175,7 +202,7 @@ void Model::initFaces() {
 		indices[i * 3 + 1] = index2;
 		indices[i * 3 + 2] = index3;
 
-		int mid = loader->mtlLoader->objMtls[loader->mtArr[i]];
+		int mid = mtlIds[loader->mtArr[i]];
 		materialids[index1] = mid;
 		materialids[index2] = mid;
 		materialids[index3] = mid;
@@ -12,9 +12,12 @@
 #include "../model/objloader.h"
 #include <vector>
 
+class MappedFile;
+
 class Model: public Mesh {
 private:
 	ObjLoader* loader;
+	MappedFile* mapped; // Set when arrays point into a mesh cache file, see meshCache.h
 private:
 	virtual void initFaces();
 	void correctVertices(const char* obj);
@@ -22,6 +25,7 @@ public:
 	std::vector<int> mats;
 public:
 	Model(const char* obj, const char* mtl, int vt);
+	Model(MappedFile* file);
 	Model(const Model& rhs);
 	virtual ~Model();
 	void loadModel(const char* obj,const char* mtl,int vt);
@@ -0,0 +1,171 @@
+#include "vertexCache.h"
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <string>
+using namespace std;
+
+#define FORSYTH_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRI_SCORE 0.75f
+#define FORSYTH_VALENCE_SCALE 2.0f
+#define FORSYTH_VALENCE_POWER 0.5f
+
+VertexCacheStats AnalyzeVertexCache(const int* indices, int indexCount, int vertexCount, int cacheSize) {
+	VertexCacheStats stats = { 0.0, 0.0 };
+	if (indexCount < 3 || vertexCount <= 0) return stats;
+
+	// A vertex is still cached if less than cacheSize misses happened after its own
+	vector<int> stamps(vertexCount, 0);
+	vector<bool> used(vertexCount, false);
+	int time = cacheSize + 1, misses = 0, usedCount = 0;
+	for (int i = 0; i < indexCount; i++) {
+		int v = indices[i];
+		if (time - stamps[v] > cacheSize) stamps[v] = time++, misses++;
+		if (!used[v]) used[v] = true, usedCount++;
+	}
+	stats.acmr = (float)misses / (indexCount / 3);
+	stats.atvr = (float)misses / usedCount;
+	return stats;
+}
+
+// Recently used vertices score high, so do vertices with few triangles left, to finish them off
+static float VertexScore(int cachePos, int remaining) {
+	if (remaining <= 0) return -1.0;
+	float score = 0.0;
+	if (cachePos >= 0) {
+		if (cachePos < 3) score = FORSYTH_LAST_TRI_SCORE;
+		else score = powf(1.0 - (float)(cachePos - 3) / (VERTEX_CACHE_SIZE - 3), FORSYTH_DECAY_POWER);
+	}
+	return score + FORSYTH_VALENCE_SCALE * powf((float)remaining, -FORSYTH_VALENCE_POWER);
+}
+
+void OptimizeVertexCache(int* indices, int indexCount, int vertexCount) {
+	int triCount = indexCount / 3;
+	if (triCount < 2) return;
+
+	// Live triangles of each vertex, emitted ones are swapped past remaining
+	vector<int> triStart(vertexCount + 1, 0), triList(triCount * 3), remaining(vertexCount, 0);
+	for (int i = 0; i < triCount * 3; i++) triStart[indices[i] + 1]++;
+	for (int v = 0; v < vertexCount; v++) triStart[v + 1] += triStart[v];
+	for (int i = 0; i < triCount * 3; i++) {
+		int v = indices[i];
+		triList[triStart[v] + remaining[v]++] = i / 3;
+	}
+
+	vector<int> cachePos(vertexCount, -1);
+	vector<float> vertexScores(vertexCount), triScores(triCount);
+	vector<bool> emitted(triCount, false);
+	for (int v = 0; v < vertexCount; v++) vertexScores[v] = VertexScore(-1, remaining[v]);
+	int best = 0;
+	for (int t = 0; t < triCount; t++) {
+		triScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+		if (triScores[t] > triScores[best]) best = t;
+	}
+
+	vector<int> output(triCount * 3);
+	int cache[VERTEX_CACHE_SIZE + 3], cacheCount = 0, newCache[VERTEX_CACHE_SIZE + 3];
+	int cursor = 0;
+	for (int n = 0; n < triCount; n++) {
+		// Cache holds no live triangle, go on with next one in old order
+		if (best < 0) {
+			while (emitted[cursor]) cursor++;
+			best = cursor;
+		}
+		const int* tri = indices + best * 3;
+		output[n * 3] = tri[0], output[n * 3 + 1] = tri[1], output[n * 3 + 2] = tri[2];
+		emitted[best] = true;
+
+		int count = 0;
+		for (int k = 0; k < 3; k++) {
+			int v = tri[k];
+			newCache[count++] = v;
+			int* list = &triList[triStart[v]];
+			for (int r = 0; r < remaining[v]; r++) {
+				if (list[r] != best) continue;
+				list[r] = list[remaining[v] - 1];
+				list[remaining[v] - 1] = best;
+				break;
+			}
+			remaining[v]--;
+		}
+		for (int i = 0; i < cacheCount; i++) {
+			int v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) newCache[count++] = v;
+		}
+
+		// Evicted vertices lose their cache score too, so their triangles are scored again as well
+		for (int i = 0; i < count; i++) {
+			int v = newCache[i];
+			cachePos[v] = i < VERTEX_CACHE_SIZE ? i : -1;
+			vertexScores[v] = VertexScore(cachePos[v], remaining[v]);
+		}
+		best = -1;
+		float bestScore = -1.0;
+		for (int i = 0; i < count; i++) {
+			int v = newCache[i];
+			for (int r = triStart[v]; r < triStart[v] + remaining[v]; r++) {
+				int t = triList[r];
+				triScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+				if (triScores[t] > bestScore) best = t, bestScore = triScores[t];
+			}
+		}
+		cacheCount = count < VERTEX_CACHE_SIZE ? count : VERTEX_CACHE_SIZE;
+		for (int i = 0; i < cacheCount; i++) cache[i] = newCache[i];
+	}
+
+	for (int i = 0; i < triCount * 3; i++) indices[i] = output[i];
+}
+
+void OptimizeVertexFetch(int* indices, int indexCount, int vertexCount, int* remap) {
+	for (int v = 0; v < vertexCount; v++) remap[v] = -1;
+	int next = 0;
+	for (int i = 0; i < indexCount; i++) {
+		int v = indices[i];
+		if (remap[v] < 0) remap[v] = next++;
+		indices[i] = remap[v];
+	}
+	for (int v = 0; v < vertexCount; v++)
+		if (remap[v] < 0) remap[v] = next++;
+}
+
+struct VertexCacheRecord {
+	string name;
+	int triangles;
+	VertexCacheStats before, after;
+};
+
+static vector<VertexCacheRecord>* CacheRecords = NULL;
+
+void BeginVertexCacheLog() {
+	if (!CacheRecords) CacheRecords = new vector<VertexCacheRecord>();
+	CacheRecords->clear();
+}
+
+void LogVertexCache(const char* name, int triangles, const VertexCacheStats& before, const VertexCacheStats& after) {
+	if (!CacheRecords) return;
+	VertexCacheRecord record;
+	record.name = name;
+	record.triangles = triangles;
+	record.before = before;
+	record.after = after;
+	CacheRecords->push_back(record);
+}
+
+void EndVertexCacheLog(const char* file) {
+	if (!CacheRecords) return;
+	FILE* report = fopen(file, "w");
+	for (int r = 0; r < 2; r++) {
+		FILE* out = r == 0 ? stdout : report;
+		if (!out) continue;
+		fprintf(out, "fifo cache %d\n", VERTEX_CACHE_FIFO);
+		fprintf(out, "%-32s %8s %10s %10s %10s %10s\n", "asset", "tris", "acmr", "acmr opt", "atvr", "atvr opt");
+		for (int i = 0; i < (int)CacheRecords->size(); i++) {
+			const VertexCacheRecord& record = (*CacheRecords)[i];
+			fprintf(out, "%-32s %8d %10.3f %10.3f %10.3f %10.3f\n", record.name.c_str(), record.triangles,
+				record.before.acmr, record.after.acmr, record.before.atvr, record.after.atvr);
+		}
+	}
+	if (report) fclose(report);
+	delete CacheRecords;
+	CacheRecords = NULL;
+}
@@ -0,0 +1,41 @@
+#ifndef VERTEX_CACHE_H_
+#define VERTEX_CACHE_H_
+
+#define VERTEX_CACHE_SIZE 32 // Lru cache modeled by Forsyth scores
+#define VERTEX_CACHE_FIFO 16 // Fifo cache of ACMR/ATVR stats, close to post transform cache of real gpus
+#define VERTEX_CACHE_REPORT_FILE "vertexcache.txt"
+
+struct VertexCacheStats {
+	float acmr; // Transformed vertices per triangle, 0.5 at best
+	float atvr; // Transformed vertices per used vertex, 1.0 at best
+};
+
+// Simulate fifo cache over triangle list
+VertexCacheStats AnalyzeVertexCache(const int* indices, int indexCount, int vertexCount, int cacheSize);
+
+// Reorder triangles in place with Tom Forsyth's linear speed vertex cache optimization
+// Only order of triangles changes, vertex ids & winding stay the same
+void OptimizeVertexCache(int* indices, int indexCount, int vertexCount);
+
+// Number vertices in order of first use so vertex fetch walks memory forward, unused vertices go last
+// Indices are rewritten, remap gets new place of each old vertex
+void OptimizeVertexFetch(int* indices, int indexCount, int vertexCount, int* remap);
+
+template<typename T>
+void RemapVertexData(T* data, const int* remap, int vertexCount) {
+	if (!data) return;
+	T* copy = new T[vertexCount];
+	for (int i = 0; i < vertexCount; i++)
+		copy[remap[i]] = data[i];
+	for (int i = 0; i < vertexCount; i++)
+		data[i] = copy[i];
+	delete[] copy;
+}
+
+// Meshes & animations log stats of each reorder while a report is running
+void BeginVertexCacheLog();
+void LogVertexCache(const char* name, int triangles, const VertexCacheStats& before, const VertexCacheStats& after);
+// Print logged stats & save them to file, then stop logging
+void EndVertexCacheLog(const char* file);
+
+#endif
@@ -0,0 +1,123 @@
+#include "vertexPack.h"
+#include <math.h>
+
+#define PACK_TWO_PI 6.2831853f
+
+PackBounds GetPackBounds(const vec3* positions, const vec2* texcoords, int count) {
+	PackBounds bounds;
+	vec3 posMax(0.0, 0.0, 0.0);
+	vec2 uvMax(0.0, 0.0);
+	bounds.posMin = vec3(0.0, 0.0, 0.0), bounds.uvMin = vec2(0.0, 0.0);
+	for (int i = 0; i < count; i++) {
+		const vec3& p = positions[i];
+		const vec2& t = texcoords[i];
+		if (i == 0) {
+			bounds.posMin = p, posMax = p;
+			bounds.uvMin = t, uvMax = t;
+			continue;
+		}
+		bounds.posMin.x = p.x < bounds.posMin.x ? p.x : bounds.posMin.x;
+		bounds.posMin.y = p.y < bounds.posMin.y ? p.y : bounds.posMin.y;
+		bounds.posMin.z = p.z < bounds.posMin.z ? p.z : bounds.posMin.z;
+		posMax.x = p.x > posMax.x ? p.x : posMax.x;
+		posMax.y = p.y > posMax.y ? p.y : posMax.y;
+		posMax.z = p.z > posMax.z ? p.z : posMax.z;
+		bounds.uvMin.x = t.x < bounds.uvMin.x ? t.x : bounds.uvMin.x;
+		bounds.uvMin.y = t.y < bounds.uvMin.y ? t.y : bounds.uvMin.y;
+		uvMax.x = t.x > uvMax.x ? t.x : uvMax.x;
+		uvMax.y = t.y > uvMax.y ? t.y : uvMax.y;
+	}
+	bounds.posSize = posMax - bounds.posMin;
+	bounds.uvSize = uvMax - bounds.uvMin;
+	return bounds;
+}
+
+void WritePackBounds(const PackBounds& bounds, float* table) {
+	table[0] = bounds.posMin.x, table[1] = bounds.posMin.y, table[2] = bounds.posMin.z, table[3] = bounds.uvMin.x;
+	table[4] = bounds.posSize.x, table[5] = bounds.posSize.y, table[6] = bounds.posSize.z, table[7] = bounds.uvMin.y;
+	table[8] = bounds.uvSize.x, table[9] = bounds.uvSize.y, table[10] = 0.0, table[11] = 0.0;
+}
+
+static ushort QuantizeUnorm16(float value, float start, float size) {
+	if (size <= 0.0) return 0;
+	float unorm = (value - start) / size;
+	unorm = unorm < 0.0 ? 0.0 : (unorm > 1.0 ? 1.0 : unorm);
+	return (ushort)(unorm * PACK_UNORM16 + 0.5);
+}
+
+void PackPosition(const vec3& position, const PackBounds& bounds, ushort* packed) {
+	packed[0] = QuantizeUnorm16(position.x, bounds.posMin.x, bounds.posSize.x);
+	packed[1] = QuantizeUnorm16(position.y, bounds.posMin.y, bounds.posSize.y);
+	packed[2] = QuantizeUnorm16(position.z, bounds.posMin.z, bounds.posSize.z);
+}
+
+vec3 UnpackPosition(const ushort* packed, const PackBounds& bounds) {
+	return vec3(bounds.posMin.x + packed[0] / PACK_UNORM16 * bounds.posSize.x,
+		bounds.posMin.y + packed[1] / PACK_UNORM16 * bounds.posSize.y,
+		bounds.posMin.z + packed[2] / PACK_UNORM16 * bounds.posSize.z);
+}
+
+void PackTexcoord(const vec2& texcoord, const PackBounds& bounds, ushort* packed) {
+	packed[0] = QuantizeUnorm16(texcoord.x, bounds.uvMin.x, bounds.uvSize.x);
+	packed[1] = QuantizeUnorm16(texcoord.y, bounds.uvMin.y, bounds.uvSize.y);
+}
+
+vec2 UnpackTexcoord(const ushort* packed, const PackBounds& bounds) {
+	return vec2(bounds.uvMin.x + packed[0] / PACK_UNORM16 * bounds.uvSize.x,
+		bounds.uvMin.y + packed[1] / PACK_UNORM16 * bounds.uvSize.y);
+}
+
+static vec3 DecodeOct(uint qx, uint qy) {
+	float x = qx / PACK_UNORM10 * 2.0 - 1.0, y = qy / PACK_UNORM10 * 2.0 - 1.0;
+	vec3 n(x, y, 1.0 - fabsf(x) - fabsf(y));
+	float t = n.z < 0.0 ? -n.z : 0.0;
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return n.GetNormalized();
+}
+
+// Frisvad's basis with Duff et al.'s branchless fix, odd unorm10 steps never decode z to 0 so sign is stable
+static void NormalBasis(const vec3& n, vec3& b1, vec3& b2) {
+	float s = n.z >= 0.0 ? 1.0 : -1.0;
+	float a = -1.0 / (s + n.z);
+	float b = n.x * n.y * a;
+	b1 = vec3(1.0 + s * n.x * n.x * a, s * b, -s * n.x);
+	b2 = vec3(b, s + n.y * n.y * a, -n.y);
+}
+
+uint PackFrame(const vec3& normal, const vec3& tangent) {
+	float len = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	vec3 n = len > 0.0 ? normal / len : vec3(0.0, 0.0, 1.0);
+	float x = n.x, y = n.y;
+	if (n.z < 0.0) {
+		x = (1.0 - fabsf(n.y)) * (n.x >= 0.0 ? 1.0 : -1.0);
+		y = (1.0 - fabsf(n.x)) * (n.y >= 0.0 ? 1.0 : -1.0);
+	}
+
+	// Try both roundings of each axis and keep the closest decoded normal
+	vec3 target = len > 0.0 ? normal.GetNormalized() : vec3(0.0, 0.0, 1.0);
+	float fx = floorf((x * 0.5 + 0.5) * PACK_UNORM10), fy = floorf((y * 0.5 + 0.5) * PACK_UNORM10);
+	uint qx = 0, qy = 0;
+	float best = -2.0;
+	for (int i = 0; i < 4; i++) {
+		float cx = fx + (i & 1), cy = fy + (i >> 1);
+		if (cx < 0.0 || cx > PACK_UNORM10 || cy < 0.0 || cy > PACK_UNORM10) continue;
+		float d = DecodeOct((uint)cx, (uint)cy).DotProduct(target);
+		if (d > best) best = d, qx = (uint)cx, qy = (uint)cy;
+	}
+
+	vec3 b1, b2;
+	NormalBasis(DecodeOct(qx, qy), b1, b2);
+	float angle = atan2f(tangent.DotProduct(b2), tangent.DotProduct(b1)) / PACK_TWO_PI;
+	angle = angle < 0.0 ? angle + 1.0 : angle;
+	uint qa = (uint)(angle * PACK_UNORM10 + 0.5);
+	return qx | (qy << 10) | (qa << 20);
+}
+
+void UnpackFrame(uint packed, vec3& normal, vec3& tangent) {
+	normal = DecodeOct(packed & 0x3ff, (packed >> 10) & 0x3ff);
+	vec3 b1, b2;
+	NormalBasis(normal, b1, b2);
+	float angle = ((packed >> 20) & 0x3ff) / PACK_UNORM10 * PACK_TWO_PI;
+	tangent = b1 * cosf(angle) + b2 * sinf(angle);
+}
@@ -0,0 +1,32 @@
+#ifndef VERTEX_PACK_H_
+#define VERTEX_PACK_H_
+
+#include "../maths/Maths.h"
+#include "../constants/constants.h"
+
+#define PACK_UNORM16 65535.0f
+#define PACK_UNORM10 1023.0f
+#define PACK_MESH_FLOATS 12 // Floats of each mesh in MultiInstance mesh table
+
+// Quantization range of one mesh, instance.vert reads it from mesh table
+struct PackBounds {
+	vec3 posMin, posSize;
+	vec2 uvMin, uvSize;
+};
+
+PackBounds GetPackBounds(const vec3* positions, const vec2* texcoords, int count);
+// Layout matches meshBounds of instance.vert: (posMin, uvMin.x), (posSize, uvMin.y), (uvSize, 0, 0)
+void WritePackBounds(const PackBounds& bounds, float* table);
+
+// Positions & uvs are unorm16 inside mesh bounds
+void PackPosition(const vec3& position, const PackBounds& bounds, ushort* packed);
+vec3 UnpackPosition(const ushort* packed, const PackBounds& bounds);
+void PackTexcoord(const vec2& texcoord, const PackBounds& bounds, ushort* packed);
+vec2 UnpackTexcoord(const ushort* packed, const PackBounds& bounds);
+
+// 10:10:10:2 frame, x & y are octahedral normal, z is tangent angle around normal, w is unused
+// Angle starts from a basis built out of the decoded normal, so shader gets the same basis back
+uint PackFrame(const vec3& normal, const vec3& tangent);
+void UnpackFrame(uint packed, vec3& normal, vec3& tangent);
+
+#endif
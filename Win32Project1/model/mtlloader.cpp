@@ -1,8 +1,7 @@
 #include "mtlloader.h"
+#include "textParse.h"
+#include "../util/mappedFile.h"
 #include <stdio.h>
-#include <iostream>
-#include <fstream>
-#include <sstream>
 #include "../assets/assetManager.h"
 #include "../material/materialManager.h"
 using namespace std;
@@ -10,7 +9,6 @@ using namespace std;
 MtlLoader::MtlLoader(const char* mtlPath) {
 	mtlFilePath=mtlPath;
 	mtlCount=0;
-	readMtlInfo();
 	readMtlFile();
 }
 
@@ -18,93 +16,55 @@ MtlLoader::~MtlLoader() {
 	objMtls.clear();
 }
 
-void MtlLoader::readMtlInfo() {
-	ifstream infile(mtlFilePath);
-	string sline;
-	while(getline(infile,sline)) {
-		if(sline[0]=='n'&&sline[1]=='e')//newmtl
-			mtlCount++;
-	}
-	infile.close();
+static bool IsKey(const char* token, int length, const char* key) {
+	return length == (int)strlen(key) && strncmp(token, key, length) == 0;
 }
 
+// Single pass over mapped file, keys are the first token of a line like before, blank lines are skipped
 void MtlLoader::readMtlFile() {
-	ifstream infile(mtlFilePath);
-	string sline;
-	int n = 0, t = 0, d = 0, a = 0, s = 0, c = 0;
+	MappedFile file;
+	if (!file.open(mtlFilePath)) return;
+	const char* p = file.data;
+	const char* end = file.data + file.size;
 
-	string value,name,texture;
-	float red = 0, green = 0, blue = 0, single = 0;
+	const char* token;
+	int length;
+	float red = 0, green = 0, blue = 0;
 	Material* mtl=NULL;
-	while(getline(infile,sline)) {
-		if(sline!="") {
-			istringstream ins(sline);
-			ins>>value;
-			if(value=="newmtl") {
-				ins>>name;
-				mtl = new Material(name.c_str());
-				objMtls[name] = MaterialManager::materials->add(mtl);
-				n++;
-			} else if (value == "map_Kd") {
-				ins >> texture;
-				if (mtl) {
-					mtl->tex1 = texture;
-					mtl->srgb1 = true;
-				}
-				t++;
-			} else if (value == "map_Kn") {
-				ins >> texture;
-				if (mtl) {
-					mtl->tex2 = texture;
-					mtl->srgb2 = false;
-				}
-				t++;
-			} else if (value == "map_Km") {
-				ins >> texture;
-				if (mtl) {
-					mtl->tex3 = texture;
-					mtl->srgb3 = false;
-				}
-				t++;
-			} else if (value == "map_Kr") {
-				ins >> texture;
-				if (mtl) {
-					mtl->tex4 = texture;
-					mtl->srgb4 = false;
-				}
-				t++;
-			} else if (value == "Kd") {
-				ins>>red>>green>>blue;
-				if(mtl) {
-					mtl->diffuse.x=red;
-					mtl->diffuse.y=green;
-					mtl->diffuse.z=blue;
-				}
-				d++;
-			} else if (value == "Ka") {
-				ins >> red >> green >> blue;
-				if (mtl) {
-					mtl->ambient.x = red;
-					mtl->ambient.y = green;
-					mtl->ambient.z = blue;
-				}
-				a++;
-			} else if (value == "Ks") {
-				ins >> red >> green >> blue;
-				if (mtl) {
-					mtl->specular.x = red;
-					mtl->specular.y = green;
-					mtl->specular.z = blue;
-				}
-				s++;
-			} else if (value == "single") {
-				ins >> single;
-				if (mtl) 
-					mtl->singleFace = true;
-				c++;
-			}
+	while (p < end) {
+		const char* lineEnd = FindLineEnd(p, end);
+		const char* q = ParseToken(p, lineEnd, token, length);
+		p = lineEnd + 1;
+		if (length == 0) continue;
+
+		if (IsKey(token, length, "newmtl")) {
+			ParseToken(q, lineEnd, token, length);
+			string name(token, length);
+			mtl = new Material(name.c_str());
+			objMtls[name] = MaterialManager::materials->add(mtl);
+			mtlCount++;
+		} else if (IsKey(token, length, "map_Kd") || IsKey(token, length, "map_Kn") ||
+				IsKey(token, length, "map_Km") || IsKey(token, length, "map_Kr")) {
+			char kind = token[5];
+			ParseToken(q, lineEnd, token, length);
+			if (!mtl) continue;
+			string texture(token, length);
+			if (kind == 'd') mtl->tex1 = texture, mtl->srgb1 = true;
+			else if (kind == 'n') mtl->tex2 = texture, mtl->srgb2 = false;
+			else if (kind == 'm') mtl->tex3 = texture, mtl->srgb3 = false;
+			else mtl->tex4 = texture, mtl->srgb4 = false;
+		} else if (IsKey(token, length, "Kd") || IsKey(token, length, "Ka") || IsKey(token, length, "Ks")) {
+			char kind = token[1];
+			q = ParseFloat(q, lineEnd, red);
+			q = ParseFloat(q, lineEnd, green);
+			ParseFloat(q, lineEnd, blue);
+			if (!mtl) continue;
+			vec3 color(red, green, blue);
+			if (kind == 'd') mtl->diffuse = color;
+			else if (kind == 'a') mtl->ambient = color;
+			else mtl->specular = color;
+		} else if (IsKey(token, length, "single")) {
+			if (mtl) mtl->singleFace = true;
 		}
 	}
-	infile.close();
 }
-
@@ -17,7 +17,6 @@ private:
 	const char* mtlFilePath;
 	int mtlCount;
 
-	void readMtlInfo();
 	void readMtlFile();
 public:
 	std::map<std::string,int> objMtls;
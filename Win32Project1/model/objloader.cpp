@@ -1,8 +1,10 @@
 #include "objloader.h"
+#include "textParse.h"
+#include "../util/mappedFile.h"
+#include "../thread/jobSystem.h"
 #include <stdio.h>
-#include <iostream>
-#include <fstream>
-#include <sstream>
+#include <stdlib.h>
+#include <map>
 using namespace std;
 
 ObjLoader::ObjLoader(const char* objPath,const char* mtlPath,int vtNum) {
@@ -13,145 +15,187 @@ ObjLoader::ObjLoader(const char* objPath,const char* mtlPath,int vtNum) {
 	vnCount=0;
 	vtCount=0;
 	faceCount=0;
-	readObjInfo();
+	vArr=NULL;
+	vtArr=NULL;
+	vnArr=NULL;
+	fvArr=NULL;
+	fnArr=NULL;
+	ftArr=NULL;
+	mtArr=NULL;
+	fileSize=0;
 	readObjFile();
 	mtlLoader=new MtlLoader(mtlFilePath);
 }
 
-void ObjLoader::readObjInfo() {
-	ifstream infile(objFilePath);
-	string sline;
-
-	while(getline(infile,sline)) {//ָļжȡ
-		if(sline[0]=='v') {
-			if(sline[1]=='n')
-				vnCount++;
-			else if(sline[1]=='t')
-				vtCount++;
-			else
-				vCount++;
-		}
-		if(sline[0]=='f')
-			faceCount++;
+// Run func on every chunk, on workers when there are any
+void ObjLoader::runChunks(void (*func)(void* param)) {
+	JobSystem* jobSystem = JobSystem::jobSystem;
+	if (!jobSystem || jobSystem->getWorkerCount() == 0 || chunks.size() == 1) {
+		for (uint i = 0; i < chunks.size(); i++) func(&chunks[i]);
+		return;
 	}
-	infile.close();
+	Job* jobs = new Job[chunks.size()];
+	for (uint i = 0; i < chunks.size(); i++) {
+		jobSystem->prepare(&jobs[i], func, &chunks[i]);
+		jobSystem->submit(&jobs[i]);
+	}
+	for (uint i = 0; i < chunks.size(); i++)
+		jobSystem->wait(&jobs[i]);
+	delete[] jobs;
 }
 
 void ObjLoader::readObjFile() {
-	vArr=new float*[vCount];
-	for (int i=0;i<vCount;i++)
-		vArr[i]=new float[3];
-
-	vnArr=new float*[vnCount];
-	for (int i=0;i<vnCount;i++)
-		vnArr[i]=new float[3];
+	MappedFile file;
+	if (!file.open(objFilePath)) return;
+	fileSize = file.size;
+	const char* data = file.data;
+	const char* end = data + file.size;
 
-	vtArr=new float*[vtCount];
-	for (int i=0;i<vtCount;i++)
-		vtArr[i]=new float[vtNumber];
-
-	fvArr=new int*[faceCount];
-	ftArr=new int*[faceCount];
-	fnArr=new int*[faceCount];
-	for (int i=0;i<faceCount;i++) {
-		fvArr[i]=new int[3];
-		ftArr[i]=new int[3];
-		fnArr[i]=new int[3];
+	// Cut after line ends, so every chunk holds whole lines
+	int chunkCount = (int)(file.size / OBJ_CHUNK_SIZE);
+	chunkCount = chunkCount < 1 ? 1 : (chunkCount > OBJ_MAX_CHUNKS ? OBJ_MAX_CHUNKS : chunkCount);
+	chunks.resize(chunkCount);
+	const char* start = data;
+	for (int i = 0; i < chunkCount; i++) {
+		const char* stop = i == chunkCount - 1 ? end : data + file.size / chunkCount * (i + 1);
+		if (stop < start) stop = start;
+		if (stop < end) stop = FindLineEnd(stop, end);
+		if (stop < end) stop++;
+		ObjChunk& chunk = chunks[i];
+		chunk.loader = this;
+		chunk.start = start, chunk.end = stop;
+		chunk.vCount = 0, chunk.vtCount = 0, chunk.vnCount = 0, chunk.faceCount = 0;
+		chunk.material = 0;
+		start = stop;
 	}
-	mtArr=new string[faceCount];
+	runChunks(CountChunk);
 
-	ifstream infile(objFilePath);
-	string sline;
-	int ii=0,tt=0,jj=0,kk=0;
+	// Prefix sums give each chunk its slice, materials are carried over chunk borders in file order
+	map<string, int> mtIndices;
+	mtNames.clear();
+	mtNames.push_back("");
+	mtIndices[""] = 0;
+	int material = 0;
+	for (int i = 0; i < chunkCount; i++) {
+		ObjChunk& chunk = chunks[i];
+		chunk.vStart = vCount, chunk.vtStart = vtCount, chunk.vnStart = vnCount, chunk.faceStart = faceCount;
+		vCount += chunk.vCount, vtCount += chunk.vtCount, vnCount += chunk.vnCount, faceCount += chunk.faceCount;
+		chunk.material = material;
+		chunk.usemtlIds.resize(chunk.usemtls.size());
+		for (uint m = 0; m < chunk.usemtls.size(); m++) {
+			map<string, int>::iterator it = mtIndices.find(chunk.usemtls[m]);
+			if (it == mtIndices.end()) {
+				it = mtIndices.insert(pair<string, int>(chunk.usemtls[m], (int)mtNames.size())).first;
+				mtNames.push_back(chunk.usemtls[m]);
+			}
+			material = chunk.usemtlIds[m] = it->second;
+		}
+	}
 
-	string s1;
-	float f2,f3,f4;
-	string mtl("");
+	vArr = (float*)malloc(vCount * 3 * sizeof(float));
+	vtArr = (float*)malloc(vtCount * vtNumber * sizeof(float));
+	vnArr = (float*)malloc(vnCount * 3 * sizeof(float));
+	fvArr = (int*)malloc(faceCount * 3 * sizeof(int));
+	ftArr = (int*)malloc(faceCount * 3 * sizeof(int));
+	fnArr = (int*)malloc(faceCount * 3 * sizeof(int));
+	mtArr = (int*)malloc(faceCount * sizeof(int));
+	runChunks(ParseChunk);
+	chunks.clear();
+}
 
-	while(getline(infile,sline)) {
-		if(sline[0]=='v') {
-			if(sline[1]=='n') {//vn
-				istringstream ins(sline);
-				ins>>s1>>f2>>f3>>f4;
-				vnArr[ii][0]=f2;
-				vnArr[ii][1]=f3;
-				vnArr[ii][2]=f4;
-				ii++;
-			} else if(sline[1]=='t') {//vt
-				istringstream ins(sline);
-				if(vtNumber==3) {
-					ins>>s1>>f2>>f3>>f4;
-					vtArr[tt][0]=f2;
-					vtArr[tt][1]=f3;
-					vtArr[tt][2]=f4;
-				} else {
-					ins>>s1>>f2>>f3;
-					vtArr[tt][0]=f2;
-					vtArr[tt][1]=f3;
-				}
-				tt++;
-			} else {//v
-				istringstream ins(sline);
-				ins>>s1>>f2>>f3>>f4;
-				vArr[jj][0]=f2;
-				vArr[jj][1]=f3;
-				vArr[jj][2]=f4;
-				jj++;
-			}
-		} else if(sline[0]=='f') { //f
-			istringstream ins(sline);
-			float a;
-			ins>>s1;//ȥf
-			int i,k;
-			for(i=0;i<3;i++) {
-				ins>>s1;
-				//ȡһͷ
-				a=0;
-				for(k=0;s1[k]!='/';k++)
-					a=a*10+(s1[k]-48);
-				fvArr[kk][i]=a;
+// Line kinds are told by first 2 chars like before: vn, vt, any other v, f & us(emtl)
+void ObjLoader::CountChunk(void* param) {
+	ObjChunk* chunk = (ObjChunk*)param;
+	const char* p = chunk->start;
+	const char* end = chunk->end;
+	while (p < end) {
+		const char* lineEnd = FindLineEnd(p, end);
+		char c0 = *p, c1 = p + 1 < lineEnd ? p[1] : '\0';
+		if (c0 == 'v') {
+			if (c1 == 'n') chunk->vnCount++;
+			else if (c1 == 't') chunk->vtCount++;
+			else chunk->vCount++;
+		} else if (c0 == 'f') {
+			chunk->faceCount++;
+		} else if (c0 == 'u' && c1 == 's') {
+			const char* token;
+			int length;
+			const char* q = ParseToken(p, lineEnd, token, length);
+			ParseToken(q, lineEnd, token, length);
+			if (length > 0) chunk->usemtls.push_back(string(token, length));
+		}
+		p = lineEnd + 1;
+	}
+}
 
-				a=0;
-				for(k=k+1;s1[k]!='/';k++)
-					a=a*10+(s1[k]-48);
-				ftArr[kk][i]=a;
+void ObjLoader::ParseChunk(void* param) {
+	ObjChunk* chunk = (ObjChunk*)param;
+	ObjLoader* loader = chunk->loader;
+	int vtNumber = loader->vtNumber;
+	float* v = loader->vArr + chunk->vStart * 3;
+	float* vt = loader->vtArr + chunk->vtStart * vtNumber;
+	float* vn = loader->vnArr + chunk->vnStart * 3;
+	int* fv = loader->fvArr + chunk->faceStart * 3;
+	int* ft = loader->ftArr + chunk->faceStart * 3;
+	int* fn = loader->fnArr + chunk->faceStart * 3;
+	int* mt = loader->mtArr + chunk->faceStart;
+	int material = chunk->material, usemtl = 0;
 
-				a=0;
-				for(k=k+1;s1[k];k++)
-					a=a*10+(s1[k]-48);
-				fnArr[kk][i]=a;
+	const char* p = chunk->start;
+	const char* end = chunk->end;
+	const char* token;
+	int length;
+	while (p < end) {
+		const char* lineEnd = FindLineEnd(p, end);
+		char c0 = *p, c1 = p + 1 < lineEnd ? p[1] : '\0';
+		if (c0 == 'v') {
+			const char* q = ParseToken(p, lineEnd, token, length);
+			if (c1 == 'n') {
+				q = ParseFloat(q, lineEnd, vn[0]);
+				q = ParseFloat(q, lineEnd, vn[1]);
+				ParseFloat(q, lineEnd, vn[2]);
+				vn += 3;
+			} else if (c1 == 't') {
+				for (int i = 0; i < vtNumber; i++)
+					q = ParseFloat(q, lineEnd, vt[i]);
+				vt += vtNumber;
+			} else {
+				q = ParseFloat(q, lineEnd, v[0]);
+				q = ParseFloat(q, lineEnd, v[1]);
+				ParseFloat(q, lineEnd, v[2]);
+				v += 3;
+			}
+		} else if (c0 == 'f') {
+			const char* q = ParseToken(p, lineEnd, token, length);
+			for (int i = 0; i < 3; i++) {
+				q = ParseToken(q, lineEnd, token, length);
+				const char* tokenEnd = token + length;
+				const char* r = ParseInt(token, tokenEnd, fv[i]);
+				r = r < tokenEnd && *r == '/' ? r + 1 : tokenEnd;
+				r = ParseInt(r, tokenEnd, ft[i]);
+				r = r < tokenEnd && *r == '/' ? r + 1 : tokenEnd;
+				ParseInt(r, tokenEnd, fn[i]);
 			}
-			mtArr[kk]=mtl;
-			kk++;
-		} else if(sline[0]=='u'&&sline[1]=='s') {//usemtl
-			istringstream ins(sline);
-			ins>>s1>>mtl;
+			fv += 3, ft += 3, fn += 3;
+			*(mt++) = material;
+		} else if (c0 == 'u' && c1 == 's') {
+			const char* q = ParseToken(p, lineEnd, token, length);
+			ParseToken(q, lineEnd, token, length);
+			if (length > 0) material = chunk->usemtlIds[usemtl++];
 		}
+		p = lineEnd + 1;
 	}
-	infile.close();
 }
 
 ObjLoader::~ObjLoader() {
-	for(int i=0;i<vCount;i++)
-		delete[] vArr[i];
-	for(int i=0;i<vnCount;i++)
-		delete[] vnArr[i];
-	for(int i=0;i<vtCount;i++)
-		delete[] vtArr[i];
-	for(int i=0;i<faceCount;i++) {
-		delete[] fvArr[i];
-		delete[] ftArr[i];
-		delete[] fnArr[i];
-	}
-	delete[] vArr;
-	delete[] vnArr;
-	delete[] vtArr;
-	delete[] fvArr;
-	delete[] ftArr;
-	delete[] fnArr;
-	delete[] mtArr;
+	if (vArr) free(vArr);
+	if (vtArr) free(vtArr);
+	if (vnArr) free(vnArr);
+	if (fvArr) free(fvArr);
+	if (ftArr) free(ftArr);
+	if (fnArr) free(fnArr);
+	if (mtArr) free(mtArr);
 
 	delete mtlLoader;
 	mtlLoader=NULL;
 }
-
@@ -9,31 +9,56 @@
 #define OBJLOADER_H_
 
 #include <string>
+#include <vector>
 #include "mtlloader.h"
 
+#define OBJ_CHUNK_SIZE (256 * 1024) // Smallest part of file parsed by one job
+#define OBJ_MAX_CHUNKS 64
+
+class ObjLoader;
+
+// Line aligned part of obj file, counted first, then parsed into its own slice of the arrays
+struct ObjChunk {
+	ObjLoader* loader;
+	const char* start;
+	const char* end;
+	int vCount, vtCount, vnCount, faceCount;
+	int vStart, vtStart, vnStart, faceStart; // Prefix sums of counts of previous chunks
+	std::vector<std::string> usemtls; // Names of usemtl lines in chunk
+	std::vector<int> usemtlIds; // Index in mtNames of each usemtl
+	int material; // Faces before first usemtl of chunk keep material of previous chunks
+};
+
+// Obj is mapped & cut into chunks, chunks are parsed by JobSystem workers when there are any
+// Only first 3 vertices of each face are used, they must be written as v/vt/vn
 class ObjLoader {
 private:
 	const char* objFilePath;
 	const char* mtlFilePath;
 	int vtNumber;
 	int vtCount,vnCount;
+	std::vector<ObjChunk> chunks;
 
-	void readObjInfo();
 	void readObjFile();
-
+	void runChunks(void (*func)(void* param));
+	static void CountChunk(void* param);
+	static void ParseChunk(void* param);
 public:
 	int vCount,faceCount;
-	float** vArr;
-	float** vtArr;
-	float** vnArr;
-	int** fvArr;
-	int** fnArr;
-	int** ftArr;
-	std::string* mtArr;
+	float* vArr; // 3 floats of each v
+	float* vtArr; // vtNumber floats of each vt
+	float* vnArr; // 3 floats of each vn
+	int* fvArr; // 3 one based indices of each face
+	int* fnArr;
+	int* ftArr;
+	int* mtArr; // Index in mtNames of each face
+	std::vector<std::string> mtNames; // Names of usemtl, first one is empty for faces before any usemtl
+	size_t fileSize;
 	MtlLoader* mtlLoader;
 
 	ObjLoader(const char* objPath,const char* mtlPath,int vtNum);
 	~ObjLoader();
+	int vtStride() { return vtNumber; }
 };
 
 
@@ -0,0 +1,54 @@
+#ifndef TEXT_PARSE_H_
+#define TEXT_PARSE_H_
+
+#include <charconv>
+#include <string.h>
+
+// Line parsing helpers of obj & mtl loaders, numbers are read like istream >> does for well formed files
+// Needs C++17 for floating point from_chars
+
+inline bool IsLineSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char* SkipLineSpace(const char* p, const char* end) {
+	while (p < end && IsLineSpace(*p)) p++;
+	return p;
+}
+
+inline const char* FindLineEnd(const char* p, const char* end) {
+	const char* e = (const char*)memchr(p, '\n', end - p);
+	return e ? e : end;
+}
+
+// Length is 0 when line has no more tokens
+inline const char* ParseToken(const char* p, const char* end, const char*& token, int& length) {
+	p = SkipLineSpace(p, end);
+	token = p;
+	while (p < end && !IsLineSpace(*p)) p++;
+	length = (int)(p - token);
+	return p;
+}
+
+// Value is 0 when there is no number
+inline const char* ParseFloat(const char* p, const char* end, float& value) {
+	p = SkipLineSpace(p, end);
+	if (p < end && *p == '+') p++;
+	std::from_chars_result res = std::from_chars(p, end, value);
+	if (res.ec != std::errc()) {
+		value = 0.0;
+		return p;
+	}
+	return res.ptr;
+}
+
+inline const char* ParseInt(const char* p, const char* end, int& value) {
+	std::from_chars_result res = std::from_chars(p, end, value);
+	if (res.ec != std::errc()) {
+		value = 0;
+		return p;
+	}
+	return res.ptr;
+}
+
+#endif
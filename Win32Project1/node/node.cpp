@@ -3,9 +3,12 @@
 #include "../instance/instance.h"
 #include "../object/staticObject.h"
 #include "../scene/scene.h"
+#include <algorithm>
 
 std::vector<Node*> Node::nodesToUpdate;
 std::vector<Node*> Node::nodesToRemove;
+std::vector<Node*> Node::nodesToRefit;
+uint Node::structureVersion = 0;
 
 Node::Node(const vec3& position,const vec3& size) {
 	this->position = position;
@@ -18,6 +21,8 @@ Node::Node(const vec3& position,const vec3& size) {
 	needCreateDrawcall = false;
 	needUpdateNormal = false;
 	needUpdateNode = false;
+	bvhIndex = -1;
+	needRefit = false;
 
 	parent=NULL;
 	children.clear();
@@ -44,6 +49,11 @@ Node::~Node() {
 
 	nodeBBs.clear();
 	clearChildren();
+
+	if (needRefit) {
+		std::vector<Node*>::iterator it = std::find(nodesToRefit.begin(), nodesToRefit.end(), this);
+		if (it != nodesToRefit.end()) nodesToRefit.erase(it);
+	}
 }
 
 void Node::clearChildren() {
@@ -99,6 +109,7 @@ void Node::addObject(Scene* scene, Object* object) {
 	}
 	needCreateDrawcall = true;
 	pushToUpdate(scene);
+	structureVersion++;
 }
 
 Object* Node::removeObject(Scene* scene, Object* object) {
@@ -123,6 +134,7 @@ Object* Node::removeObject(Scene* scene, Object* object) {
 
 			needCreateDrawcall = true;
 			pushToUpdate(scene);
+			structureVersion++;
 			object->parent = NULL;
 
 			scene->collisionWorld->removeObject(object->collisionObject);
@@ -188,6 +200,7 @@ void Node::moveSelfAndDownwardNodesBounding(float dx, float dy, float dz) {
 		vec3 offset = vec3(dx, dy, dz);
 		boundingBox->update(boundingBox->position + offset);
 	}
+	pushToRefit();
 	for (uint n = 0; n < children.size(); n++) 
 		children[n]->moveSelfAndDownwardNodesBounding(dx, dy, dz);
 }
@@ -203,6 +216,7 @@ void Node::updateBounding() {
 	}
 	if (nodeBBs.size()>0)
 		boundingBox->merge(nodeBBs);
+	pushToRefit();
 }
 
 // Update Node's drawcall & its children's & children's children...
@@ -243,6 +257,7 @@ void Node::attachChild(Scene* scene, Node* child) {
 	}
 
 	updateSelfAndDownwardNodesDrawcall(scene, false);
+	structureVersion++;
 }
 
 Node* Node::detachChild(Node* child) {
@@ -251,6 +266,7 @@ Node* Node::detachChild(Node* child) {
 		if((*it)==child) {
 			child->parent=NULL;
 			children.erase(it);
+			structureVersion++;
 
 			Node* superior = this;
 			while (superior) {
@@ -307,6 +323,7 @@ void Node::translateNodeObject(Scene* scene, int i, float x, float y, float z) {
 
 	updateObjectBoundingInNode(object);
 	boundingBox->merge(objectsBBs);
+	pushToRefit();
 	Node* superior = parent;
 	while (superior) {
 		superior->updateBounding();
@@ -332,6 +349,7 @@ void Node::rotateNodeObject(Scene* scene, int i, float ax, float ay, float az) {
 
 	updateObjectBoundingInNode(object);
 	boundingBox->merge(objectsBBs);
+	pushToRefit();
 	Node* superior = parent;
 	while (superior) {
 		superior->updateBounding();
@@ -349,6 +367,7 @@ void Node::scaleNodeObject(Scene* scene, int i, float sx, float sy, float sz) {
 
 	updateObjectBoundingInNode(object);
 	boundingBox->merge(objectsBBs);
+	pushToRefit();
 	Node* superior = parent;
 	while (superior) {
 		superior->updateBounding();
@@ -384,6 +403,13 @@ void Node::updateNode(const Scene* scene) {
 	needUpdateNode = false;
 }
 
+void Node::pushToRefit() {
+	if (!needRefit) {
+		Node::nodesToRefit.push_back(this);
+		needRefit = true;
+	}
+}
+
 void Node::pushToRemove() {
 	Node::nodesToRemove.push_back(this);
 }
@@ -25,6 +25,8 @@ class Node {
 public:
 	static std::vector<Node*> nodesToUpdate;
 	static std::vector<Node*> nodesToRemove;
+	static std::vector<Node*> nodesToRefit;
+	static uint structureVersion; // Changed when nodes or objects are attached or removed
 public:
 	void updateObjectBoundingInNode(Object* object, bool nodeTransformed = false);
 private:
@@ -54,6 +56,8 @@ public:
 	bool needUpdateDrawcall;
 	bool needCreateDrawcall;
 	bool needUpdateNode;
+	int bvhIndex; // Index in flattened bounding tree
+	bool needRefit;
 
 	Node(const vec3& position,const vec3& size);
 	virtual ~Node();
@@ -64,6 +68,7 @@ public:
 	virtual void updateDrawcall() = 0;
 	void updateNode(const Scene* scene);
 	void pushToUpdate(Scene* scene);
+	void pushToRefit();
 
 	void updateBounding();
 	virtual void addObject(Scene* scene, Object* object);
@@ -3,10 +3,11 @@
 #include "../util/util.h"
 #include "../scene/scene.h"
 
+// Generated lods are used when mesh has them
 StaticObject::StaticObject(Mesh* mesh) :Object() {
 	this->mesh = mesh;
-	this->meshMid = mesh;
-	this->meshLow = mesh;
+	this->meshMid = mesh->lodMid ? mesh->lodMid : mesh;
+	this->meshLow = mesh->lodLow ? mesh->lodLow : this->meshMid;
 	positionBefore = vec3(0.0);
 	initMatricesData();
 }
@@ -117,10 +118,12 @@ void StaticObject::rotateAtWorld(const vec4& q) {
 
 void StaticObject::standOnGround(Scene* scene) {
 	vec3 worldCenter = GetTranslate(parent->nodeTransform * localTransformMatrix);
-	int bx, bz;
-	scene->terrainNode->caculateBlock(worldCenter.x, worldCenter.z, bx, bz);
-	scene->terrainNode->cauculateY(bx, bz, worldCenter.x, worldCenter.z, worldCenter.y);
-	worldCenter.y += collisionShape->getBox()->getHalfExtentsWithMargin().y();
+	if (scene->terrainNode) { // Scene without terrain keeps physics height
+		int bx, bz;
+		scene->terrainNode->caculateBlock(worldCenter.x, worldCenter.z, bx, bz);
+		scene->terrainNode->cauculateY(bx, bz, worldCenter.x, worldCenter.z, worldCenter.y);
+		worldCenter.y += collisionShape->getBox()->getHalfExtentsWithMargin().y();
+	}
 
 	translateAtWorld(worldCenter);
 	collisionObject->initTranslate(worldCenter);
@@ -129,6 +132,7 @@ void StaticObject::standOnGround(Scene* scene) {
 	localBoundPosition = boundCenter + GetTranslate(localTransformMatrix);
 	parent->updateObjectBoundingInNode(this, true);
 	parent->boundingBox->merge(parent->objectsBBs);
+	parent->pushToRefit();
 	Node* superior = parent->parent;
 	while (superior) {
 		superior->updateBounding();
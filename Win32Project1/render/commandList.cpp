@@ -0,0 +1,83 @@
+#include "commandList.h"
+#include <stdlib.h>
+#include <string.h>
+
+u64 MakeSortKey(int pass, int shader, int material, int mesh, float depth, float maxDepth) {
+	u64 depthBits = 0;
+	if (maxDepth > 0 && depth > 0) {
+		float factor = depth / maxDepth;
+		depthBits = factor >= 1.0 ? KEY_DEPTH_MASK : (u64)(factor * KEY_DEPTH_MASK);
+	}
+	return ((u64)(pass & KEY_PASS_MASK) << KEY_PASS_SHIFT)
+		| ((u64)(shader & KEY_SHADER_MASK) << KEY_SHADER_SHIFT)
+		| ((u64)(material & KEY_MATERIAL_MASK) << KEY_MATERIAL_SHIFT)
+		| ((u64)(mesh & KEY_MESH_MASK) << KEY_MESH_SHIFT)
+		| depthBits;
+}
+
+CommandList::CommandList() {
+	commands = NULL;
+	swaps = NULL;
+	capacity = 0;
+	count = 0;
+}
+
+CommandList::~CommandList() {
+	if (commands) free(commands);
+	if (swaps) free(swaps);
+}
+
+void CommandList::push(u64 key, void* data) {
+	if (count >= capacity) {
+		capacity = capacity > 0 ? capacity * 2 : COMMAND_INIT_CAPACITY;
+		commands = (DrawCommand*)realloc(commands, capacity * sizeof(DrawCommand));
+		if (swaps) free(swaps);
+		swaps = (DrawCommand*)malloc(capacity * sizeof(DrawCommand));
+	}
+	commands[count].key = key;
+	commands[count].data = data;
+	count++;
+}
+
+void CommandList::sort() {
+	if (count < 2) return;
+	DrawCommand* result = RadixSortCommands(commands, swaps, count);
+	if (result != commands) {
+		swaps = commands;
+		commands = result;
+	}
+}
+
+DrawCommand* RadixSortCommands(DrawCommand* commands, DrawCommand* tmp, int count) {
+	// Bits set in some key but not in all, byte passes without them are skipped
+	u64 keyOr = 0, keyAnd = ~(u64)0;
+	for (int i = 0; i < count; i++) {
+		keyOr |= commands[i].key;
+		keyAnd &= commands[i].key;
+	}
+	u64 diff = keyOr ^ keyAnd;
+
+	DrawCommand* src = commands;
+	DrawCommand* dst = tmp;
+	int offsets[256];
+	for (int shift = 0; shift < 64; shift += 8) {
+		if (((diff >> shift) & 0xff) == 0) continue;
+
+		memset(offsets, 0, sizeof(offsets));
+		for (int i = 0; i < count; i++)
+			offsets[(src[i].key >> shift) & 0xff]++;
+		int sum = 0;
+		for (int b = 0; b < 256; b++) {
+			int num = offsets[b];
+			offsets[b] = sum;
+			sum += num;
+		}
+		for (int i = 0; i < count; i++)
+			dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+
+		DrawCommand* swap = src;
+		src = dst;
+		dst = swap;
+	}
+	return src;
+}
@@ -0,0 +1,48 @@
+#ifndef COMMAND_LIST_H_
+#define COMMAND_LIST_H_
+
+#include "../constants/constants.h"
+
+// Sort key layout, high bits are compared first
+// | pass 4 | shader 8 | material 16 | mesh 12 | depth 24 |
+#define KEY_PASS_SHIFT     60
+#define KEY_SHADER_SHIFT   52
+#define KEY_MATERIAL_SHIFT 36
+#define KEY_MESH_SHIFT     24
+#define KEY_PASS_MASK      0xf
+#define KEY_SHADER_MASK    0xff
+#define KEY_MATERIAL_MASK  0xffff
+#define KEY_MESH_MASK      0xfff
+#define KEY_DEPTH_MASK     0xffffff
+
+#define COMMAND_INIT_CAPACITY 256
+
+// Depth is quantized on [0, maxDepth], far ones are clamped to max
+u64 MakeSortKey(int pass, int shader, int material, int mesh, float depth, float maxDepth);
+
+struct DrawCommand {
+	u64 key;
+	void* data;
+};
+
+// Commands of one pass, sorted by key with stable LSD radix sort, so equal keys keep push order
+class CommandList {
+private:
+	DrawCommand* commands;
+	DrawCommand* swaps;
+	int capacity;
+	int count;
+public:
+	CommandList();
+	~CommandList();
+	void reset() { count = 0; }
+	void push(u64 key, void* data);
+	void sort();
+	int size() { return count; }
+	DrawCommand* get(int i) { return commands + i; }
+};
+
+// Sort count commands by key, tmp holds at least count commands, return the buffer holding result
+DrawCommand* RadixSortCommands(DrawCommand* commands, DrawCommand* tmp, int count);
+
+#endif
@@ -6,8 +6,7 @@ DataBuffer::DataBuffer(int t) {
 	normalBuffer = NULL;
 	tangentBuffer = NULL;
 	texcoordBuffer = NULL;
-	texidBuffer = NULL;
-	colorBuffer = NULL;
+	materialBuffer = NULL;
 	indexBuffer = NULL;
 	vertexCount = 0, indexCount = 0;
 	maxCount = 0;
@@ -18,7 +17,6 @@ void DataBuffer::releaseDatas() {
 	if (normalBuffer) free(normalBuffer); normalBuffer = NULL;
 	if (tangentBuffer) free(tangentBuffer); tangentBuffer = NULL;
 	if (texcoordBuffer) free(texcoordBuffer); texcoordBuffer = NULL;
-	if (texidBuffer) free(texidBuffer); texidBuffer = NULL;
-	if (colorBuffer) free(colorBuffer); colorBuffer = NULL;
+	if (materialBuffer) free(materialBuffer); materialBuffer = NULL;
 	if (indexBuffer) free(indexBuffer); indexBuffer = NULL;
 }
\ No newline at end of file
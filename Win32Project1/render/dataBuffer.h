@@ -13,9 +13,8 @@ public:
 	half* normalBuffer;
 	half* tangentBuffer;
 	float* texcoordBuffer;
-	float* texidBuffer;
-	byte* colorBuffer;
-	ushort* indexBuffer;
+	ushort* materialBuffer; // Index of MaterialBuffer table
+	uint* indexBuffer; // Mesh local, MultiInstance packs them to 16 bits when all meshes fit
 public:
 	int indexCount, vertexCount, maxCount;
 	int type;
@@ -0,0 +1,157 @@
+#include "instanceStream.h"
+#include "streamBuffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+// All records in one group, for streams read whole by one drawcall
+InstanceStream::InstanceStream(int maxCount) {
+	int groupCounts[RECORD_GROUPS] = { maxCount, 0, 0, 0 };
+	init(groupCounts);
+}
+
+InstanceStream::InstanceStream(const int* groupCounts) {
+	init(groupCounts);
+}
+
+void InstanceStream::init(const int* groupCounts) {
+	capacity = 0;
+	for (int g = 0; g < RECORD_GROUPS; g++) {
+		firsts[g] = capacity;
+		capacities[g] = groupCounts[g] > 0 ? groupCounts[g] : 0;
+		capacity += capacities[g];
+		counts[g] = 0;
+	}
+	if (capacity <= 0) capacity = 1;
+	bytesWritten = 0, bytesCopied = 0;
+	bufferid = 0;
+	mappedRecords = NULL;
+	cpuRecords = (buff*)malloc(capacity * INSTANCE_RECORD * sizeof(buff));
+	records = cpuRecords;
+	fence = 0;
+	uploaded = false;
+}
+
+InstanceStream::~InstanceStream() {
+	if (fence) glDeleteSync(fence);
+	if (mappedRecords) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferid);
+		glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+	if (bufferid) glDeleteBuffers(1, &bufferid);
+	if (cpuRecords) free(cpuRecords);
+}
+
+// Render thread only, records culled from next frame on go to gpu memory
+void InstanceStream::createBuffer() {
+	if (bufferid) return;
+	uint size = capacity * INSTANCE_RECORD * sizeof(buff);
+	glGenBuffers(1, &bufferid);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferid);
+	if (StreamBuffer::Supported()) {
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, NULL, flags | GL_DYNAMIC_STORAGE_BIT);
+		mappedRecords = (buff*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, flags);
+	} else
+		glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// Producer side, called when queue is flushed for a new frame
+void InstanceStream::reset() {
+	if (mappedRecords) {
+		records = mappedRecords;
+		if (cpuRecords) free(cpuRecords);
+		cpuRecords = NULL;
+	}
+	bytesWritten += (u64)getCount() * INSTANCE_RECORD * sizeof(buff);
+	for (int g = 0; g < RECORD_GROUPS; g++)
+		counts[g] = 0;
+	uploaded = false;
+}
+
+// Spans go after records already in each group, what does not fit group capacity is dropped like push does
+void InstanceStream::append(const RecordSpans* spans) {
+	for (int g = 0; g < RECORD_GROUPS; g++) {
+		int index = counts[g].load(std::memory_order_relaxed);
+		int count = spans->counts[g] < capacities[g] - index ? spans->counts[g] : capacities[g] - index;
+		if (count <= 0) continue;
+		memcpy(records + (firsts[g] + index) * INSTANCE_RECORD, spans->records[g], count * INSTANCE_RECORD * sizeof(buff));
+		counts[g].store(index + count, std::memory_order_relaxed);
+	}
+}
+
+int InstanceStream::getCount() {
+	int count = 0;
+	for (int g = 0; g < RECORD_GROUPS; g++)
+		count += counts[g];
+	return count;
+}
+
+// Records written to cpu copy are sent once, draws of the same frame repeated later reuse them
+void InstanceStream::upload() {
+	if (!bufferid || isMapped() || uploaded) return;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferid);
+	for (int g = 0; g < RECORD_GROUPS; g++) {
+		int count = counts[g];
+		if (count <= 0) continue;
+		uint offset = firsts[g] * INSTANCE_RECORD * sizeof(buff), size = count * INSTANCE_RECORD * sizeof(buff);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, records + firsts[g] * INSTANCE_RECORD);
+		bytesCopied += size;
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	uploaded = true;
+}
+
+void InstanceStream::bindBase(int base) {
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, base, bufferid);
+}
+
+// Call after last compute pass reading the records
+void InstanceStream::setFence() {
+	if (fence) glDeleteSync(fence);
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool InstanceStream::busy() {
+	if (!fence) return false;
+	if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) return true;
+	glDeleteSync(fence);
+	fence = 0;
+	return false;
+}
+
+void InstanceStream::wait() {
+	if (!fence) return;
+	while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED);
+	glDeleteSync(fence);
+	fence = 0;
+}
+
+RecordSpans::RecordSpans() {
+	for (int g = 0; g < RECORD_GROUPS; g++) {
+		records[g] = NULL;
+		counts[g] = 0, capacities[g] = 0;
+	}
+}
+
+RecordSpans::~RecordSpans() {
+	for (int g = 0; g < RECORD_GROUPS; g++)
+		if (records[g]) free(records[g]);
+}
+
+void RecordSpans::reset() {
+	for (int g = 0; g < RECORD_GROUPS; g++)
+		counts[g] = 0;
+}
+
+buff* RecordSpans::push(int group) {
+	if (counts[group] >= capacities[group]) {
+		int capacity = capacities[group] > 0 ? capacities[group] * 2 : SPANS_INIT_CAPACITY;
+		buff* grown = (buff*)realloc(records[group], capacity * INSTANCE_RECORD * sizeof(buff));
+		if (!grown) return NULL;
+		records[group] = grown;
+		capacities[group] = capacity;
+	}
+	return records[group] + (counts[group]++) * INSTANCE_RECORD;
+}
@@ -0,0 +1,77 @@
+#ifndef INSTANCE_STREAM_H_
+#define INSTANCE_STREAM_H_
+
+#include "glheader.h"
+#include "../constants/constants.h"
+#include "../util/util.h"
+#include <atomic>
+
+#define INSTANCE_RECORD 16 // Floats of one record: translate & scale, rotation, bounding, instance ids
+
+// Records of one kind sit together, so each drawcall dispatches only the groups its pass reads
+// Order matters: normal pass reads groups normal to both, single pass reads both to single
+#define RECORD_GROUP_NORMAL 0 // Meshes with normal faces only, also animation transforms
+#define RECORD_GROUP_BOTH   1 // Meshes with normal & single faces
+#define RECORD_GROUP_SINGLE 2 // Meshes with single faces only
+#define RECORD_GROUP_BILL   3
+#define RECORD_GROUPS       4
+
+#define SPANS_INIT_CAPACITY 64
+
+// Records one cull task found for one stream, in cull order within each group
+// Tasks over different node ranges fill their own spans, which are appended to stream in range order
+// once all tasks finished, so stream holds what serial culling would whatever order tasks ran in
+class RecordSpans {
+public:
+	buff* records[RECORD_GROUPS];
+	int counts[RECORD_GROUPS], capacities[RECORD_GROUPS]; // Capacity grows & is kept for next frames
+public:
+	RecordSpans();
+	~RecordSpans();
+	void reset();
+	buff* push(int group = RECORD_GROUP_NORMAL);
+};
+
+// Instance records or animation transforms one queue culled in one frame, in cull order within each group
+// Serial culling appends records here directly, parallel culling appends spans of its tasks after them
+// Once render thread has created the gpu buffer they land in its persistent mapping and compute passes
+// read them in place, before that they go to a cpu copy uploaded at draw
+// Gpu reads are fenced, owner must not reset the stream again until busy() returns false
+class InstanceStream {
+public:
+	buff* records; // Write target of current frame
+	std::atomic<int> counts[RECORD_GROUPS]; // One producer at a time, atomic as stats read them from other threads
+	int firsts[RECORD_GROUPS], capacities[RECORD_GROUPS]; // Fixed record range of each group
+	int capacity;
+	u64 bytesWritten, bytesCopied; // Totals of cull writes & upload copies, writes are added up at reset
+private:
+	GLuint bufferid;
+	buff* mappedRecords;
+	buff* cpuRecords;
+	GLsync fence;
+	bool uploaded;
+public:
+	InstanceStream(int maxCount);
+	InstanceStream(const int* groupCounts);
+	~InstanceStream();
+	void createBuffer();
+	void reset();
+	buff* push(int group = RECORD_GROUP_NORMAL) {
+		int index = counts[group].load(std::memory_order_relaxed);
+		if (index >= capacities[group]) return NULL;
+		counts[group].store(index + 1, std::memory_order_relaxed);
+		return records + (firsts[group] + index) * INSTANCE_RECORD;
+	}
+	void append(const RecordSpans* spans);
+	int getCount();
+	void upload();
+	void bindBase(int base);
+	void setFence();
+	bool busy();
+	void wait();
+	bool isMapped() { return mappedRecords && records == mappedRecords; }
+private:
+	void init(const int* groupCounts);
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "materialBuffer.h"
+#include <stdlib.h>
+
+MaterialBuffer::MaterialBuffer() {
+	bufferid = 0;
+	capacity = 0;
+	version = 0;
+	table = NULL;
+}
+
+MaterialBuffer::~MaterialBuffer() {
+	if (bufferid) glDeleteBuffers(1, &bufferid);
+	if (table) free(table);
+}
+
+void MaterialBuffer::update(MaterialManager* mtls) {
+	uint count = mtls->size();
+	if (bufferid && version == mtls->getVersion()) return;
+	version = mtls->getVersion();
+
+	if (!bufferid) glGenBuffers(1, &bufferid);
+	bool grow = count > capacity;
+	if (grow) {
+		while (capacity < count) capacity = capacity > 0 ? capacity * 2 : 64;
+		if (table) free(table);
+		table = (float*)malloc(capacity * MATERIAL_FLOATS * sizeof(float));
+	}
+
+	for (uint i = 0; i < count; i++) {
+		Material* mat = mtls->find(i);
+		float* entry = table + i * MATERIAL_FLOATS;
+		entry[0] = mat->texids.x, entry[1] = mat->texids.y, entry[2] = mat->texids.z, entry[3] = mat->texids.w;
+		entry[4] = mat->exTexids.x, entry[5] = mat->exTexids.y, entry[6] = 0.0, entry[7] = 0.0;
+		entry[8] = (byte)(mat->ambient.x * 255), entry[9] = (byte)(mat->diffuse.x * 255), entry[10] = (byte)(mat->specular.x * 255);
+		entry[11] = 0.0;
+	}
+
+	if (grow) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, bufferid);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * MATERIAL_FLOATS * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+	glNamedBufferSubData(bufferid, 0, count * MATERIAL_FLOATS * sizeof(float), table);
+}
+
+void MaterialBuffer::bind() {
+	if (bufferid) glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MATERIAL_TABLE_BASE, bufferid);
+}
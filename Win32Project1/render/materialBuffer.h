@@ -0,0 +1,26 @@
+#ifndef MATERIAL_BUFFER_H_
+#define MATERIAL_BUFFER_H_
+
+#include "glheader.h"
+#include "../constants/constants.h"
+#include "../material/materialManager.h"
+
+#define MATERIAL_TABLE_BASE 9 // Ssbo binding of material.glsl, compute passes use 1 to 7
+#define MATERIAL_FLOATS 12 // texids, (exTexids, 0, 0), (ambient.x, diffuse.x, specular.x, 0) scaled to 0-255
+
+// Gpu copy of MaterialManager, vertices keep a 16 bit material index into it
+// Texids stay indices of texBlds, so the table only holds small numbers & bindless handles stay in one place
+class MaterialBuffer {
+private:
+	GLuint bufferid;
+	uint capacity; // Materials the buffer can hold
+	uint version; // MaterialManager version of last upload
+	float* table;
+public:
+	MaterialBuffer();
+	~MaterialBuffer();
+	void update(MaterialManager* mtls); // Upload again when materials changed since last call
+	void bind();
+};
+
+#endif
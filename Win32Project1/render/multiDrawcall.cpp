@@ -6,8 +6,7 @@
 const uint VertexSlot = 0;
 const uint NormalSlot = 1;
 const uint TexcoordSlot = 2;
-const uint TexidSlot = 3;
-const uint ColorSlot = 4;
+const uint MaterialSlot = 3;
 const uint TangentSlot = 5;
 const uint BoneidSlot = 6;
 const uint WeightSlot = 7;
@@ -17,15 +16,16 @@ const uint PositionSlot = 8;
 const uint VertexIndex = 0;
 const uint NormalIndex = 1;
 const uint TexcoordIndex = 2;
-const uint TexidIndex = 3;
-const uint ColorIndex = 4;
-const uint TangentIndex = 5;
-const uint BoneidIndex = 6;
-const uint WeightIndex = 7;
-const uint Index = 8;
-const uint PositionIndex = 9;
-const uint PositionOutIndex = 10;
-const uint BaseIndex = 11;
+const uint MaterialIndex = 3;
+const uint TangentIndex = 4;
+const uint BoneidIndex = 5;
+const uint WeightIndex = 6;
+const uint Index = 7;
+const uint PositionOutIndex = 8;
+const uint MeshTableIndex = 9;
+
+// Vertex shader ssbo binding, compute passes use 1 to 7, material table uses 9
+const uint MeshTableBase = 8;
 
 // Indirect vbo index
 const uint IndirectNormalIndex = 0;
@@ -37,9 +37,11 @@ MultiDrawcall::MultiDrawcall(MultiInstance* multi) :Drawcall() {
 	multiRef = multi;
 	vertexCount = multiRef->vertexCount;
 	indexCount = multiRef->indexCount;
-	maxObjectCount = multiRef->maxInstance;
+	maxObjectCount = multiRef->maxInstance > 0 ? multiRef->maxInstance : 1;
+	indexType = multiRef->wideIndex ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 
 	dataBuffer = createBuffers(multiRef, vertexCount, indexCount, maxObjectCount);
+	baseStream = new StreamBuffer(GL_SHADER_STORAGE_BUFFER, multiRef->meshCount * 4 * sizeof(uint));
 	indirectBuffer = createIndirects(multiRef);
 	bool dualBuffer = false;
 	if (dualBuffer) {
@@ -56,6 +58,16 @@ MultiDrawcall::MultiDrawcall(MultiInstance* multi) :Drawcall() {
 	indirectBufferDraw = indirectBuffer2 ? indirectBuffer2 : indirectBuffer;
 
 	meshCount = multiRef->meshCount;
+	firstGroup = RECORD_GROUP_NORMAL, lastGroup = RECORD_GROUP_BILL;
+	if (multiRef->hasAnim) lastGroup = RECORD_GROUP_NORMAL;
+	else if (multiRef->bufferPass == NORMAL_PASS) lastGroup = RECORD_GROUP_BOTH;
+	else if (multiRef->bufferPass == SINGLE_PASS) firstGroup = RECORD_GROUP_BOTH, lastGroup = RECORD_GROUP_SINGLE;
+	else if (multiRef->bufferPass == BILL_PASS) firstGroup = RECORD_GROUP_BILL;
+	int maxRange = 0;
+	for (uint i = 0; i < multiRef->meshletRanges.size(); i++)
+		maxRange = multiRef->meshletRanges[i].count > maxRange ? multiRef->meshletRanges[i].count : maxRange;
+	meshletIndices = maxRange > 0 ? (uint*)malloc(maxRange * sizeof(uint)) : NULL;
+	lodEye = vec4(0.0, 0.0, 0.0, 0.0), lodDist = vec2(0.0, 0.0);
 	if (!multiRef->hasAnim) setType(MULTI_DC);
 	else setType(ANIMATE_DC);
 	multiRef->releaseInstanceData();
@@ -65,38 +77,46 @@ MultiDrawcall::~MultiDrawcall() {
 	if (indirectBuffer) delete indirectBuffer;
 	if (dataBuffer2) delete dataBuffer2;
 	if (indirectBuffer2) delete indirectBuffer2;
+	delete baseStream;
+	if (meshletIndices) free(meshletIndices);
 }
 
 RenderBuffer* MultiDrawcall::createBuffers(MultiInstance* multi, int vertexCount, int indexCount, int maxObjects, RenderBuffer* ref) {
-	RenderBuffer* buffer = new RenderBuffer(12);
+	RenderBuffer* buffer = new RenderBuffer(10);
 	if (!ref) {
-		buffer->setAttribData(GL_ARRAY_BUFFER, VertexIndex, VertexSlot, GL_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, multi->vertexBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, NormalIndex, NormalSlot, GL_HALF_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, multi->normalBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, TexcoordSlot, GL_FLOAT, vertexCount, 4, 1, false, GL_STATIC_DRAW, 0, multi->texcoordBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TexidIndex, TexidSlot, GL_FLOAT, vertexCount, 2, 1, false, GL_STATIC_DRAW, 0, multi->texidBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, ColorIndex, ColorSlot, GL_UNSIGNED_BYTE, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, multi->colorBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TangentIndex, TangentSlot, GL_HALF_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, multi->tangentBuffer);
-		buffer->setBufferData(GL_ELEMENT_ARRAY_BUFFER, Index, GL_UNSIGNED_SHORT, indexCount, GL_STATIC_DRAW, multi->indexBuffer);
-		if (multi->hasAnim) {
+		if (!multi->hasAnim) {
+			// Packed static vertex, 18 bytes, see vertexPack.h
+			uint meshSlots = multi->indirectCount > 0 ? multi->indirectCount : 1;
+			buffer->setAttribData(GL_ARRAY_BUFFER, VertexIndex, VertexSlot, GL_UNSIGNED_SHORT, vertexCount, 4, 1, true, GL_STATIC_DRAW, 0, multi->packedVertexBuffer);
+			buffer->setAttribData(GL_ARRAY_BUFFER, NormalIndex, NormalSlot, GL_UNSIGNED_INT_2_10_10_10_REV, vertexCount, 4, 1, true, GL_STATIC_DRAW, 0, multi->packedFrameBuffer);
+			buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, TexcoordSlot, GL_UNSIGNED_SHORT, vertexCount, 2, 1, true, GL_STATIC_DRAW, 0, multi->packedTexcoordBuffer);
+			buffer->setBufferData(GL_SHADER_STORAGE_BUFFER, MeshTableIndex, GL_FLOAT, meshSlots * PACK_MESH_FLOATS, GL_STATIC_DRAW, multi->meshTable);
+		} else {
+			buffer->setAttribData(GL_ARRAY_BUFFER, VertexIndex, VertexSlot, GL_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, multi->vertexBuffer);
+			buffer->setAttribData(GL_ARRAY_BUFFER, NormalIndex, NormalSlot, GL_HALF_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, multi->normalBuffer);
+			buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, TexcoordSlot, GL_FLOAT, vertexCount, 2, 1, false, GL_STATIC_DRAW, 0, multi->texcoordBuffer);
+			buffer->setAttribData(GL_ARRAY_BUFFER, TangentIndex, TangentSlot, GL_HALF_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, multi->tangentBuffer);
 			buffer->setAttribData(GL_ARRAY_BUFFER, BoneidIndex, BoneidSlot, GL_UNSIGNED_BYTE, vertexCount, 4, 1, false, GL_STATIC_DRAW, 0, multi->boneidBuffer);
 			buffer->setAttribData(GL_ARRAY_BUFFER, WeightIndex, WeightSlot, GL_HALF_FLOAT, vertexCount, 4, 1, false, GL_STATIC_DRAW, 0, multi->weightBuffer);
 		}
+		// Index of MaterialBuffer table, same stream for static & animated
+		buffer->setAttribData(GL_ARRAY_BUFFER, MaterialIndex, MaterialSlot, GL_UNSIGNED_SHORT, vertexCount, 1, 1, false, GL_STATIC_DRAW, 0, multi->materialBuffer);
+		buffer->setBufferData(GL_ELEMENT_ARRAY_BUFFER, Index, indexType, indexCount, GL_STATIC_DRAW, multi->indexBuffer);
 	} else {
 		buffer->setAttribData(GL_ARRAY_BUFFER, VertexIndex, ref->streamDatas[VertexIndex]);
 		buffer->setAttribData(GL_ARRAY_BUFFER, NormalIndex, ref->streamDatas[NormalIndex]);
 		buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, ref->streamDatas[TexcoordIndex]);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TexidIndex, ref->streamDatas[TexidIndex]);
-		buffer->setAttribData(GL_ARRAY_BUFFER, ColorIndex, ref->streamDatas[ColorIndex]);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TangentIndex, ref->streamDatas[TangentIndex]);
+		buffer->setAttribData(GL_ARRAY_BUFFER, MaterialIndex, ref->streamDatas[MaterialIndex]);
 		buffer->setAttribData(GL_ELEMENT_ARRAY_BUFFER, Index, ref->streamDatas[Index]);
-		if (multi->hasAnim) {
+		if (!multi->hasAnim)
+			buffer->setBufferData(GL_SHADER_STORAGE_BUFFER, MeshTableIndex, ref->streamDatas[MeshTableIndex]);
+		else {
+			buffer->setAttribData(GL_ARRAY_BUFFER, TangentIndex, ref->streamDatas[TangentIndex]);
 			buffer->setAttribData(GL_ARRAY_BUFFER, BoneidIndex, ref->streamDatas[BoneidIndex]);
 			buffer->setAttribData(GL_ARRAY_BUFFER, WeightIndex, ref->streamDatas[WeightIndex]);
 		}
 	}
 
-	buffer->setBufferData(GL_SHADER_STORAGE_BUFFER, BaseIndex, GL_UNSIGNED_INT, multi->meshCount, 4, GL_DYNAMIC_DRAW, NULL);
-	buffer->setBufferData(GL_SHADER_STORAGE_BUFFER, PositionIndex, GL_FLOAT, maxObjects, 16, GL_DYNAMIC_DRAW, NULL);
 	buffer->setAttribData(GL_SHADER_STORAGE_BUFFER, PositionOutIndex, PositionSlot, GL_FLOAT, maxObjects, 4, 4, false, GL_STREAM_DRAW, 1, NULL);
 	buffer->useAs(PositionOutIndex, GL_ARRAY_BUFFER);
 	buffer->setAttrib(PositionOutIndex);
@@ -123,12 +143,14 @@ void MultiDrawcall::draw(Render* render, RenderState* state, Shader* shader) {
 
 		bool shadowPass = state->pass < COLOR_PASS;
 		if (!multiRef->hasAnim) {
+			dataBufferDraw->setShaderBase(MeshTableIndex, MeshTableBase);
+
 			// Draw normal faces
 			if (multiRef->normalCount > 0) {
 				render->useShader(shader);
 				if (shadowPass) render->setShaderFloat(shader, "uAlpha", 0.0);
 				indirectBufferDraw->useAs(IndirectNormalIndex, GL_DRAW_INDIRECT_BUFFER);
-				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, multiRef->normalCount, 0);
+				glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, 0, multiRef->normalCount, 0);
 			}
 
 			// Draw single faces
@@ -138,7 +160,7 @@ void MultiDrawcall::draw(Render* render, RenderState* state, Shader* shader) {
 				render->useShader(shader);
 				if (shadowPass) render->setShaderFloat(shader, "uAlpha", 1.0);
 				indirectBufferDraw->useAs(IndirectSingleIndex, GL_DRAW_INDIRECT_BUFFER);
-				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, multiRef->singleCount, 0);
+				glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, 0, multiRef->singleCount, 0);
 			}
 
 			// Draw billboard faces
@@ -149,13 +171,14 @@ void MultiDrawcall::draw(Render* render, RenderState* state, Shader* shader) {
 					render->setShaderFloat(state->shaderBill, "uAlpha", 1.0);
 				}
 				indirectBufferDraw->useAs(IndirectBillIndex, GL_DRAW_INDIRECT_BUFFER);
-				glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, multiRef->billCount, 0);
+				glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, 0, multiRef->billCount, 0);
 			}
+			UnbindShaderBuffers(MeshTableBase, 1);
 		} else {
 			render->useShader(shader);
 			render->setShaderFloat(shader, "uAlpha", 0.0);
 			indirectBufferDraw->useAs(IndirectAnimIndex, GL_DRAW_INDIRECT_BUFFER);
-			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, 0, multiRef->animCount, 0);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, 0, multiRef->animCount, 0);
 		}
 	}
 
@@ -169,12 +192,69 @@ void MultiDrawcall::swapBuffers() {
 	dataBufferDraw = dataBufferDraw == dataBuffer ? dataBuffer2 : dataBuffer;
 }
 
-void MultiDrawcall::update(Render* render, RenderState* state) {
-	objectCount = multiRef->updateTransform();
-	dataBufferPrepare->updateBufferData(BaseIndex, meshCount, (void*)(multiRef->bases));
-	dataBufferPrepare->updateBufferData(PositionIndex, objectCount, (void*)(multiRef->transforms));
+// Only record groups of this drawcall's pass are dispatched, shader skips ids of other passes in them
+// Records & animation transforms were written by cull tasks, only per mesh bases are written here
+void MultiDrawcall::update(Render* render, RenderState* state, InstanceStream* records) {
+	int required = multiRef->updateTransform();
+	if (required > maxObjectCount) growBuffers(required);
+	if (!multiRef->hasAnim) updateMeshlets();
+	records->upload();
+	objectCount = 0;
+	for (int g = firstGroup; g <= lastGroup; g++)
+		objectCount += records->counts[g];
+
+	uint* bases = (uint*)baseStream->beginWrite();
+	memcpy(bases, multiRef->bases, meshCount * 4 * sizeof(uint));
+	baseStream->endWrite(meshCount * 4 * sizeof(uint));
+
 	updateIndirect(render, state);
-	prepareRenderData(render, state);
+	prepareRenderData(render, state, records);
+
+	// Segment is only read by compute passes above, queue fences its records after all its drawcalls
+	baseStream->fence();
+}
+
+// Indirects compute passes & meshlet updates wrote to each list, lists this drawcall lacks are left as they are
+void MultiDrawcall::readIndirects(Indirect* normals, Indirect* singles, Indirect* bills) {
+	uint counts[3] = { multiRef->normalCount, multiRef->singleCount, multiRef->billCount };
+	uint lists[3] = { IndirectNormalIndex, IndirectSingleIndex, IndirectBillIndex };
+	Indirect* rets[3] = { normals, singles, bills };
+	for (int l = 0; l < 3 && !multiRef->hasAnim; l++) {
+		if (counts[l] == 0) continue;
+		indirectBufferPrepare->readBufferData(GL_SHADER_STORAGE_BUFFER, lists[l], counts[l] * sizeof(Indirect), rets[l]);
+	}
+}
+
+// Double output capacity until visible instances fit, old content is dropped as compute passes rewrite it
+void MultiDrawcall::growBuffers(int required) {
+	while (maxObjectCount < required) maxObjectCount *= 2;
+	dataBuffer->resizeBufferData(PositionOutIndex, maxObjectCount);
+	if (dataBuffer2) dataBuffer2->resizeBufferData(PositionOutIndex, maxObjectCount);
+}
+
+// Compact index ranges of meshlet meshes to meshlets visible this frame, and shrink their indirect counts to match
+// Ranges are only rewritten when visibility changed, instance ranges of other meshes are untouched
+void MultiDrawcall::updateMeshlets() {
+	for (uint i = 0; i < multiRef->meshletRanges.size(); i++) {
+		MeshletRange& range = multiRef->meshletRanges[i];
+		InstanceData* data = range.instance->insData;
+		if (!data || !data->meshletMask || data->count <= 0) continue;
+		Mesh* mesh = range.instance->instanceMesh;
+		int words = MeshletMaskWords(mesh->meshlets.size());
+		if (!CopyMeshletMask(data->meshletMask, range.lastMask, words)) continue;
+
+		uint count = GatherMeshletIndices(mesh, range.lastMask, range.start, range.count, meshletIndices);
+		if (count > 0) {
+			if (indexType == GL_UNSIGNED_SHORT) { // Pack in place, ushort i never passes uint i
+				ushort* shortIndices = (ushort*)meshletIndices;
+				for (uint k = 0; k < count; k++)
+					shortIndices[k] = (ushort)meshletIndices[k];
+			}
+			dataBufferPrepare->updateBufferRange(Index, range.firstIndex, count, meshletIndices);
+		}
+		uint indirectIndex = range.single ? IndirectSingleIndex : IndirectNormalIndex;
+		indirectBufferPrepare->updateBufferRange(indirectIndex, range.drawId * sizeof(Indirect), sizeof(uint), &count);
+	}
 }
 
 void MultiDrawcall::updateIndirect(Render* render, RenderState* state) {
@@ -185,7 +265,7 @@ void MultiDrawcall::updateIndirect(Render* render, RenderState* state) {
 		indirectBufferPrepare->setShaderBase(IndirectSingleIndex, 2);
 		indirectBufferPrepare->setShaderBase(IndirectBillIndex, 3);
 	}
-	dataBufferPrepare->setShaderBase(BaseIndex, 5);
+	baseStream->bindRange(5, meshCount * 4 * sizeof(uint));
 
 	render->useShader(state->shaderFlush);
 	render->setShaderUVec4(state->shaderFlush, "uCount", multiRef->normalCount, multiRef->singleCount, multiRef->billCount, multiRef->animCount);
@@ -196,12 +276,12 @@ void MultiDrawcall::updateIndirect(Render* render, RenderState* state) {
 		indirectBufferPrepare->unbindShaderBase(IndirectAnimIndex, 4);
 	else 
 		UnbindShaderBuffers(1, 3);
-	dataBufferPrepare->unbindShaderBase(BaseIndex, 5);
+	baseStream->unbindRange(5);
 }
 
-void MultiDrawcall::prepareRenderData(Render* render, RenderState* state) {
+void MultiDrawcall::prepareRenderData(Render* render, RenderState* state, InstanceStream* records) {
 	dataBufferPrepare->use();
-	dataBufferPrepare->setShaderBase(PositionIndex, 1);
+	records->bindBase(1);
 	dataBufferPrepare->setShaderBase(PositionOutIndex, 2);
 	if (multiRef->hasAnim)
 		indirectBufferPrepare->setShaderBase(IndirectAnimIndex, 7);
@@ -214,14 +294,21 @@ void MultiDrawcall::prepareRenderData(Render* render, RenderState* state) {
 	render->useShader(state->shaderMulti);
 	render->setShaderUint(state->shaderMulti, "bufferPass", multiRef->bufferPass);
 	render->setShaderIVec4(state->shaderMulti, "uCount", multiRef->normalCount, multiRef->singleCount, multiRef->billCount, multiRef->animCount);
+	if (!multiRef->hasAnim) {
+		render->setShaderVec4(state->shaderMulti, "uLodEye", lodEye.x, lodEye.y, lodEye.z, lodEye.w);
+		render->setShaderVec2(state->shaderMulti, "uLodDist", lodDist.x, lodDist.y);
+	}
 
-	int dispatch = objectCount > MAX_DISPATCH ? MAX_DISPATCH : objectCount;
-	render->setShaderUint(state->shaderMulti, "pass", 0);
-	glDispatchCompute(dispatch, 1, 1);
-	if (objectCount > MAX_DISPATCH) {
-		dispatch = objectCount - MAX_DISPATCH;
-		render->setShaderUint(state->shaderMulti, "pass", 1);
-		glDispatchCompute(dispatch, 1, 1);
+	for (int g = firstGroup; g <= lastGroup; g++) {
+		int count = records->counts[g];
+		if (count <= 0) continue;
+		render->setShaderUint(state->shaderMulti, "first", records->firsts[g]);
+		for (int pass = 0; pass * MAX_DISPATCH < count; pass++) {
+			int dispatch = count - pass * MAX_DISPATCH;
+			dispatch = dispatch > MAX_DISPATCH ? MAX_DISPATCH : dispatch;
+			render->setShaderUint(state->shaderMulti, "pass", pass);
+			glDispatchCompute(dispatch, 1, 1);
+		}
 	}
 	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
 
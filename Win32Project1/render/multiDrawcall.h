@@ -4,10 +4,13 @@
 class MultiInstance;
 
 #include "drawcall.h"
+#include "streamBuffer.h"
+#include "instanceStream.h"
 
 class MultiDrawcall: public Drawcall {
 private:
 	int vertexCount, indexCount, maxObjectCount;
+	GLenum indexType;
 	MultiInstance* multiRef;
 private:
 	RenderBuffer* indirectBuffer;
@@ -19,18 +22,32 @@ private:
 	RenderBuffer* indirectBufferDraw;
 	RenderBuffer* dataBufferPrepare;
 	RenderBuffer* indirectBufferPrepare;
+private:
+	StreamBuffer* baseStream; // Instance records & animation transforms are read from queue's InstanceStream
+	int firstGroup, lastGroup; // Record groups of the stream this drawcall's pass reads
+private:
+	uint* meshletIndices; // Gather space of largest meshlet range
+	vec4 lodEye; // w > 0 when shader should pick lods of lod records
+	vec2 lodDist;
 private:
 	RenderBuffer* createBuffers(MultiInstance* multi, int vertexCount, int indexCount, int maxObjects, RenderBuffer* ref = NULL);
 	RenderBuffer* createIndirects(MultiInstance* multi);
 	void swapBuffers();
+	void growBuffers(int required);
+	void updateMeshlets();
 	void updateIndirect(Render* render, RenderState* state);
-	void prepareRenderData(Render* render, RenderState* state);
+	void prepareRenderData(Render* render, RenderState* state, InstanceStream* records);
 public:
 	MultiDrawcall(MultiInstance* multi);
 	virtual ~MultiDrawcall();
 	virtual void draw(Render* render, RenderState* state, Shader* shader);
-	void update(Render* render, RenderState* state);
+	void update(Render* render, RenderState* state, InstanceStream* records);
 	MultiInstance* getInstance() { return multiRef; }
+	int getMaxObjects() { return maxObjectCount; }
+	void readIndirects(Indirect* normals, Indirect* singles, Indirect* bills);
+	void setLod(const vec3& eye, float midDistSqr, float lowDistSqr) {
+		lodEye = vec4(eye, 1.0), lodDist = vec2(midDistSqr, lowDistSqr);
+	}
 };
 
 #endif
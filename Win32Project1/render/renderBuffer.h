@@ -13,6 +13,7 @@ const std::map<GLenum, uint> TypeSize = {
 	std::map<GLenum, uint>::value_type(GL_UNSIGNED_BYTE, sizeof(GLubyte)),
 	std::map<GLenum, uint>::value_type(GL_DOUBLE, sizeof(GLdouble)),
 	std::map<GLenum, uint>::value_type(GL_BYTE, sizeof(GLbyte)),
+	std::map<GLenum, uint>::value_type(GL_UNSIGNED_INT_2_10_10_10_REV, 1), // 4 channels share one uint
 	std::map<GLenum, uint>::value_type(GL_ONE, 1)
 };
 
@@ -90,11 +91,18 @@ struct RenderData {
 	void unbindShaderBase(int base) {
 		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, base, 0);
 	}
+	void resize(uint count) { // Old content is dropped
+		dataSize = count * channelCount * rowCount;
+		glNamedBufferData(bufferid, dataSize * bitSize, NULL, drawType);
+	}
 	void updateBuffer(uint count, void* data) {
 		dataSize = count * channelCount * rowCount;
 		streamData = data;
 		glNamedBufferSubData(bufferid, 0, dataSize * bitSize, streamData);
 	}
+	void updateBufferRange(uint offset, uint count, void* data) { // Offset & count in elements
+		glNamedBufferSubData(bufferid, offset * bitSize, count * bitSize, data);
+	}
 	void updateBufferMap(GLenum target, uint count, void* data) {
 		int mapSize = count * channelCount * rowCount;
 		glBindBuffer(target, bufferid);
@@ -201,6 +209,12 @@ struct RenderBuffer {
 	void updateBufferData(uint loc, uint count, void* data) {
 		streamDatas[loc]->updateBuffer(count, data);
 	}
+	void updateBufferRange(uint loc, uint offset, uint count, void* data) {
+		streamDatas[loc]->updateBufferRange(offset, count, data);
+	}
+	void resizeBufferData(uint loc, uint count) {
+		streamDatas[loc]->resize(count);
+	}
 	void updateBufferMap(GLenum target, uint loc, uint count, void* data) {
 		streamDatas[loc]->updateBufferMap(target, count, data);
 	}
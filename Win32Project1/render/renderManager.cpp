@@ -2,6 +2,7 @@
 #include "../assets/assetManager.h"
 #include "../mesh/board.h"
 #include "../object/staticObject.h"
+#include "../util/profiler.h"
 
 RenderManager::RenderManager(ConfigArg* cfg, Scene* scene, float distance1, float distance2, const vec3& light) {
 	depthPre = LOW_PRE;
@@ -25,17 +26,21 @@ RenderManager::RenderManager(ConfigArg* cfg, Scene* scene, float distance1, floa
 	shadow->shadowPixSize = 0.5 / nearSize;
 	shadow->pixSize = 1.0 / nearSize;
 
-	nearDynamicBuffer = new FrameBuffer(nearSize, nearSize, depthPre);
-	nearStaticBuffer = new FrameBuffer(nearSize, nearSize, depthPre);
-	midBuffer = new FrameBuffer(midSize, midSize, depthPre);
-	farBuffer = new FrameBuffer(farSize, farSize, LOW_PRE);
+	nearDynamicBuffer = NULL, nearStaticBuffer = NULL, midBuffer = NULL, farBuffer = NULL;
+	materialBuffer = NULL;
+	if (!cfgs->headless) { // Headless run has no gl context, only cpu stages are used
+		materialBuffer = new MaterialBuffer();
+		nearDynamicBuffer = new FrameBuffer(nearSize, nearSize, depthPre);
+		nearStaticBuffer = new FrameBuffer(nearSize, nearSize, depthPre);
+		midBuffer = new FrameBuffer(midSize, midSize, depthPre);
+		farBuffer = new FrameBuffer(farSize, farSize, LOW_PRE);
+	}
 
 	lightDir = light.GetNormalized();
-	queue1 = new Renderable(distance1, distance2, cfgs);
-	queue2 = new Renderable(distance1, distance2, cfgs);
-	currentQueue = queue1;
-	nextQueue = queue2;
+	renderRing = new RenderRing(cfgs->renderDepth, distance1, distance2, cfgs);
+	currentQueue = renderRing->get(0);
 	renderData = NULL;
+	singleSlot = 0;
 
 	state = new RenderState();
 
@@ -52,18 +57,25 @@ RenderManager::RenderManager(ConfigArg* cfg, Scene* scene, float distance1, floa
 
 RenderManager::~RenderManager() {
 	delete shadow; shadow = NULL;
-	delete nearDynamicBuffer; nearDynamicBuffer = NULL;
-	delete nearStaticBuffer; nearStaticBuffer = NULL;
-	delete midBuffer; midBuffer = NULL;
-	delete farBuffer; farBuffer = NULL;
+	if (nearDynamicBuffer) delete nearDynamicBuffer; nearDynamicBuffer = NULL;
+	if (nearStaticBuffer) delete nearStaticBuffer; nearStaticBuffer = NULL;
+	if (midBuffer) delete midBuffer; midBuffer = NULL;
+	if (farBuffer) delete farBuffer; farBuffer = NULL;
 
-	delete queue1; queue1 = NULL;
-	delete queue2; queue2 = NULL;
+	delete renderRing; renderRing = NULL;
 
 	delete state; state = NULL;
 	if (reflectBuffer) delete reflectBuffer; reflectBuffer = NULL;
 	if (occluderDepth) delete occluderDepth; occluderDepth = NULL;
 	if (grassDrawcall) delete grassDrawcall; grassDrawcall = NULL;
+	if (materialBuffer) delete materialBuffer; materialBuffer = NULL;
+}
+
+// Vertices only carry material index, edited materials show up without rebatching
+void RenderManager::updateMaterials() {
+	if (!materialBuffer) return;
+	materialBuffer->update(MaterialManager::materials);
+	materialBuffer->bind();
 }
 
 void RenderManager::resize(float width, float height) {
@@ -106,6 +118,37 @@ void RenderManager::flushRenderQueues() {
 	if (renderData) renderData->flush();
 }
 
+// Bytes of instance records written by culling & copied again by render thread, totals of all frames
+void RenderManager::getInstanceTraffic(u64& written, u64& copied) {
+	written = 0, copied = 0;
+	for (int i = 0; i < renderRing->getDepth(); i++) {
+		Renderable* renderable = renderRing->get(i);
+		for (uint q = 0; q < renderable->queues.size(); q++) {
+			InstanceStream* stream = renderable->queues[q]->instanceStream;
+			if (!stream) continue;
+			written += stream->bytesWritten + (u64)stream->getCount() * INSTANCE_RECORD * sizeof(buff); // Current frame is added at next reset
+			copied += stream->bytesCopied;
+		}
+	}
+}
+
+struct CullTask {
+	RenderQueue* queues[CULL_MAX_VIEWS];
+	Camera* cameras[CULL_MAX_VIEWS];
+	int count;
+	Scene* scene;
+	BVH* tree;
+	Camera* mainCamera;
+	int start, end; // Node range of tree
+	CullBin* bin; // Own output of static tree tasks, animation task pushes to its queues directly
+};
+
+static void CullTaskRun(void* param) {
+	CullTask* task = (CullTask*)param;
+	if (task->bin) task->bin->reset();
+	PushNodeRangeToQueues(task->queues, task->cameras, task->count, task->scene, task->tree, task->mainCamera, task->start, task->end, task->bin);
+}
+
 void RenderManager::updateRenderQueues(Scene* scene) {
 	if (!renderData) return;
 
@@ -115,15 +158,69 @@ void RenderManager::updateRenderQueues(Scene* scene) {
 	Camera* cameraFar = shadow->actLightCameraFar;
 	Camera* cameraMain = scene->actCamera;
 
-	PushNodeToQueue(renderData->queues[QUEUE_DYNAMIC_SN], scene, scene->staticRoot, cameraDyn, cameraMain);
-	PushNodeToQueue(renderData->queues[QUEUE_STATIC_SN], scene, scene->staticRoot, cameraNear, cameraMain);
-	PushNodeToQueue(renderData->queues[QUEUE_STATIC_SM], scene, scene->staticRoot, cameraMid, cameraMain);
-	//PushNodeToQueue(renderData->queues[QUEUE_STATIC_SF], scene, scene->staticRoot, cameraFar, cameraMain);
-	PushNodeToQueue(renderData->queues[QUEUE_STATIC], scene, scene->staticRoot, cameraMain, cameraMain);
-	PushNodeToQueue(renderData->queues[QUEUE_ANIMATE_SN], scene, scene->animationRoot, cameraDyn, cameraMain);
-	PushNodeToQueue(renderData->queues[QUEUE_ANIMATE_SM], scene, scene->animationRoot, cameraMid, cameraMain);
-	//PushNodeToQueue(renderData->queues[QUEUE_ANIMATE_SF], scene, scene->animationRoot, cameraFar, cameraMain);
-	PushNodeToQueue(renderData->queues[QUEUE_ANIMATE], scene, scene->animationRoot, cameraMain, cameraMain);
+	scene->updateTrees();
+	BVH* staticTree = scene->staticTree;
+	BVH* animationTree = scene->animationTree;
+
+	// Far shadow queues (QUEUE_STATIC_SF & QUEUE_ANIMATE_SF with cameraFar) are not used now
+	RenderQueue* staticQueues[] = { 
+		renderData->queues[QUEUE_DYNAMIC_SN], renderData->queues[QUEUE_STATIC_SN], 
+		renderData->queues[QUEUE_STATIC_SM], renderData->queues[QUEUE_STATIC] };
+	Camera* staticCameras[] = { cameraDyn, cameraNear, cameraMid, cameraMain };
+	RenderQueue* animQueues[] = { 
+		renderData->queues[QUEUE_ANIMATE_SN], renderData->queues[QUEUE_ANIMATE_SM], 
+		renderData->queues[QUEUE_ANIMATE] };
+	Camera* animCameras[] = { cameraDyn, cameraMid, cameraMain };
+
+	JobSystem* jobSystem = JobSystem::jobSystem;
+	if (!jobSystem || jobSystem->getWorkerCount() == 0) {
+		PushNodeToQueues(staticQueues, staticCameras, 4, scene, staticTree, cameraMain);
+		PushNodeToQueues(animQueues, animCameras, 3, scene, animationTree, cameraMain);
+		return;
+	}
+
+	PrepareQueues(staticQueues, 4, scene, cameraMain);
+	PrepareQueues(animQueues, 3, scene, cameraMain);
+
+	// Static tree is cut into subtree ranges, each task walks all views over its range like the serial path
+	// into its own bin, bins are merged in range order after, so queues do not depend on which task ran first
+	// Animation tree stays one task, as an animation node is animated once for each queue in order
+	static CullTask tasks[CULL_MAX_TASKS + 1];
+	static CullBin bins[CULL_MAX_TASKS];
+	static Job jobs[CULL_MAX_TASKS + 1];
+	static int starts[CULL_MAX_TASKS], ends[CULL_MAX_TASKS];
+	int parts = jobSystem->getWorkerCount() + 1;
+	if (parts > CULL_MAX_TASKS) parts = CULL_MAX_TASKS;
+	int taskCount = staticTree->splitRanges(parts, starts, ends);
+	for (int t = 0; t < taskCount; t++) {
+		CullTask& task = tasks[t];
+		for (int i = 0; i < 4; i++) {
+			task.queues[i] = staticQueues[i];
+			task.cameras[i] = staticCameras[i];
+		}
+		task.count = 4;
+		task.scene = scene, task.tree = staticTree, task.mainCamera = cameraMain;
+		task.start = starts[t], task.end = ends[t];
+		task.bin = &bins[t];
+	}
+	int binCount = taskCount;
+	CullTask& animTask = tasks[taskCount++];
+	for (int i = 0; i < 3; i++) {
+		animTask.queues[i] = animQueues[i];
+		animTask.cameras[i] = animCameras[i];
+	}
+	animTask.count = 3;
+	animTask.scene = scene, animTask.tree = animationTree, animTask.mainCamera = cameraMain;
+	animTask.start = 0, animTask.end = animationTree->nodeCount;
+	animTask.bin = NULL;
+
+	for (int t = 0; t < taskCount; t++) {
+		jobSystem->prepare(&jobs[t], CullTaskRun, &tasks[t]);
+		jobSystem->submit(&jobs[t]);
+	}
+	for (int t = 0; t < taskCount; t++)
+		jobSystem->wait(&jobs[t]);
+	MergeCullBins(staticQueues, 4, bins, binCount);
 }
 
 void RenderManager::animateQueues(float velocity) {
@@ -133,32 +230,68 @@ void RenderManager::animateQueues(float velocity) {
 	currentQueue->queues[QUEUE_ANIMATE]->animate(velocity);
 }
 
-void RenderManager::swapRenderQueues(Scene* scene, bool swapQueue) {
+// Ring stats go to profiler counters, printed with zone summary & saved in trace
+void RenderManager::reportRingStats() {
+	if (!Profiler::profiler) return;
+	RenderRingStats stats = getRingStats();
+	Profiler::profiler->setCounter("ring published", (double)stats.published);
+	Profiler::profiler->setCounter("ring consumed", (double)stats.consumed);
+	Profiler::profiler->setCounter("ring dropped", (double)stats.dropped);
+	Profiler::profiler->setCounter("ring producer stalls", (double)stats.producerStalls);
+	Profiler::profiler->setCounter("ring consumer repeats", (double)stats.consumerRepeats);
+	Profiler::profiler->setCounter("ring latency avg(ms)", stats.latencyAvg);
+	Profiler::profiler->setCounter("ring latency max(ms)", stats.latencyMax);
+}
+
+// Return false if there is no new frame to draw
+bool RenderManager::swapRenderQueues(Scene* scene, bool swapQueue) {
 	if (swapQueue) {
-		currentQueue = (currentQueue == queue1) ? queue2 : queue1;
-		nextQueue = (nextQueue == queue1) ? queue2 : queue1;
-		renderData = nextQueue;
-		scene->renderCamera->copy(scene->actCamera);
-		shadow->copyCameraData();
+		Renderable* latest = renderRing->acquire();
+		reportRingStats();
+		if (!latest) return false;
+		currentQueue = latest;
+		scene->renderCamera->copy(latest->mainCamera);
+		shadow->renderLightCameraDyn->copy(latest->lightCameraDyn);
+		shadow->renderLightCameraNear->copy(latest->lightCameraNear);
+		shadow->renderLightCameraMid->copy(latest->lightCameraMid);
+		renderShowWater = latest->showWater;
 	} else {
-		currentQueue = queue1;
-		renderData = currentQueue;
+		if (renderData) currentQueue = renderData;
 		if (scene->renderCamera != scene->actCamera) {
 			delete scene->renderCamera;
 			scene->renderCamera = scene->actCamera;
 		}
 		shadow->mergeCamera();
+		renderShowWater = actShowWater;
 	}
-	renderShowWater = actShowWater;
+	return true;
 }
 
 void RenderManager::prepareData(Scene* scene) {
+	if (cfgs->dualthread) renderData = renderRing->beginWrite();
+	else {
+		// Cull into ring slots in turn, gpu may still read the last depth - 1 frames
+		// Waits only when gpu is a whole ring behind
+		singleSlot = (singleSlot + 1) % renderRing->getDepth();
+		renderData = renderRing->get(singleSlot);
+		renderData->waitGpu();
+	}
 	updateWaterVisible(scene);
 	flushRenderQueues();
 	updateRenderQueues(scene);
+
+	if (cfgs->dualthread) { // Publish frame with cameras it was culled with
+		renderData->mainCamera->copy(scene->actCamera);
+		renderData->lightCameraDyn->copy(shadow->actLightCameraDyn);
+		renderData->lightCameraNear->copy(shadow->actLightCameraNear);
+		renderData->lightCameraMid->copy(shadow->actLightCameraMid);
+		renderData->showWater = actShowWater;
+		renderRing->endWrite();
+	}
 }
 
 void RenderManager::renderShadow(Render* render, Scene* scene) {
+	PROFILE_ZONE("RenderManager::renderShadow");
 	if (cfgs->shadowQuality < 1) return;
 
 	static Shader* phongShadowShader = render->findShader("phong_s");
@@ -306,6 +439,7 @@ void RenderManager::drawGrass(Render* render, RenderState* state, Scene* scene,
 }
 
 void RenderManager::renderScene(Render* render, Scene* scene) {
+	PROFILE_ZONE("RenderManager::renderScene");
 	static Shader* phongShader = render->findShader("phong");
 	static Shader* phongInsShader = render->findShader("phong_ins");
 	static Shader* billInsShader = render->findShader("bill_ins");
@@ -457,6 +591,7 @@ void RenderManager::renderReflect(Render* render, Scene* scene) {
 }
 
 void RenderManager::drawDeferred(Render* render, Scene* scene, FrameBuffer* screenBuff, Filter* filter) {
+	PROFILE_ZONE("deferred");
 	static Shader* deferredShader = render->findShader("deferred");
 	state->reset();
 	state->eyePos = &(scene->renderCamera->position);
@@ -482,6 +617,7 @@ void RenderManager::drawDeferred(Render* render, Scene* scene, FrameBuffer* scre
 }
 
 void RenderManager::drawCombined(Render* render, Scene* scene, const std::vector<Texture2D*>& inputTextures, Filter* filter) {
+	PROFILE_ZONE("combined");
 	static Shader* combinedShader = render->findShader("combined");
 	state->reset();
 	state->eyePos = &(scene->renderCamera->position);
@@ -494,6 +630,7 @@ void RenderManager::drawCombined(Render* render, Scene* scene, const std::vector
 }
 
 void RenderManager::drawScreenFilter(Render* render, Scene* scene, const char* shaderStr, FrameBuffer* inputBuff, Filter* filter) {
+	PROFILE_ZONE(shaderStr);
 	Shader* shader = render->findShader(shaderStr);
 	state->reset();
 	state->eyePos = &(scene->renderCamera->position);
@@ -505,6 +642,7 @@ void RenderManager::drawScreenFilter(Render* render, Scene* scene, const char* s
 }
 
 void RenderManager::drawScreenFilter(Render* render, Scene* scene, const char* shaderStr, Texture2D* inputTexture, Filter* filter) {
+	PROFILE_ZONE(shaderStr);
 	Shader* shader = render->findShader(shaderStr);
 	state->reset();
 	state->eyePos = &(scene->renderCamera->position);
@@ -515,6 +653,7 @@ void RenderManager::drawScreenFilter(Render* render, Scene* scene, const char* s
 }
 
 void RenderManager::drawScreenFilter(Render* render, Scene* scene, const char* shaderStr, const std::vector<Texture2D*>& inputTextures, Filter* filter) {
+	PROFILE_ZONE(shaderStr);
 	Shader* shader = render->findShader(shaderStr);
 	state->reset();
 	state->eyePos = &(scene->renderCamera->position);
@@ -530,6 +669,7 @@ void RenderManager::drawDualFilter(Render* render, Scene* scene, const char* sha
 }
 
 void RenderManager::drawSSRFilter(Render* render, Scene* scene, const char* shaderStr, const std::vector<Texture2D*>& inputTextures, Filter* filter) {
+	PROFILE_ZONE(shaderStr);
 	Shader* shader = render->findShader(shaderStr);
 	state->reset();
 	state->eyePos = &(scene->renderCamera->position);
@@ -542,6 +682,7 @@ void RenderManager::drawSSRFilter(Render* render, Scene* scene, const char* shad
 }
 
 void RenderManager::drawSSGFilter(Render* render, Scene* scene, const char* shaderStr, const std::vector<Texture2D*>& inputTextures, Filter* filter) {
+	PROFILE_ZONE(shaderStr);
 	Shader* shader = render->findShader(shaderStr);
 	state->reset();
 	state->eyePos = &(scene->renderCamera->position);
@@ -12,32 +12,9 @@
 #include "../filter/filter.h"
 #include "../render/renderQueue.h"
 #include "../render/computeDrawcall.h"
-
-struct Renderable {
-	std::vector<RenderQueue*> queues;
-	Renderable(float midDis, float lowDis, ConfigArg* cfg) {
-		queues.clear();
-		for (uint i = 0; i < 9; i++) {
-			queues.push_back(new RenderQueue(i, midDis, lowDis));
-			queues[i]->setCfg(cfg);
-		}
-		queues[QUEUE_DYNAMIC_SN]->shadowLevel = 1;
-		queues[QUEUE_STATIC_SN]->shadowLevel = 1;
-		queues[QUEUE_STATIC_SM]->shadowLevel = 2;
-		queues[QUEUE_STATIC_SF]->shadowLevel = 3;
-		queues[QUEUE_ANIMATE_SN]->shadowLevel = 1;
-		queues[QUEUE_ANIMATE_SM]->shadowLevel = 2;
-		queues[QUEUE_ANIMATE_SF]->shadowLevel = 3;
-	}
-	~Renderable() {
-		for (uint i = 0; i < queues.size(); i++)
-			delete queues[i];
-	}
-	void flush() {
-		for (uint i = 0; i < queues.size(); i++)
-			queues[i]->flush();
-	}
-};
+#include "../thread/jobSystem.h"
+#include "renderRing.h"
+#include "materialBuffer.h"
 
 class RenderManager {
 public:
@@ -51,12 +28,13 @@ private:
 	Shadow* shadow;
 	bool needResize, needRefreshSky, actShowWater, renderShowWater;
 	ComputeDrawcall* grassDrawcall;
+	MaterialBuffer* materialBuffer;
 public:
+	RenderRing* renderRing;
 	Renderable* renderData;
-	Renderable* queue1;
-	Renderable* queue2;
 	Renderable* currentQueue;
-	Renderable* nextQueue;
+private:
+	int singleSlot; // Ring slot culled last in single thread mode
 private:
 	void drawBoundings(Render* render, RenderState* state, Scene* scene, Camera* camera);
 	void drawGrass(Render* render, RenderState* state, Scene* scene, Camera* camera);
@@ -79,8 +57,13 @@ public:
 	void flushRenderQueues();
 	void updateRenderQueues(Scene* scene);
 	void animateQueues(float velocity);
-	void swapRenderQueues(Scene* scene, bool swapQueue);
+	bool swapRenderQueues(Scene* scene, bool swapQueue);
+	bool canPrepare() { return renderRing->canWrite(); }
+	RenderRingStats getRingStats() { return renderRing->getStats(); }
+	void reportRingStats();
+	void getInstanceTraffic(u64& written, u64& copied);
 	void prepareData(Scene* scene);
+	void updateMaterials();
 	void renderShadow(Render* render,Scene* scene);
 	void renderScene(Render* render,Scene* scene);
 	void renderWater(Render* render, Scene* scene);
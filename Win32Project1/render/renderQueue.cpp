@@ -4,16 +4,21 @@
 #include "../node/instanceNode.h"
 #include "../assets/assetManager.h"
 #include "../scene/scene.h"
+#include "../util/profiler.h"
 #include <string.h>
 #include <stdlib.h>
+#include <assert.h>
 using namespace std;
 
 RenderQueue::RenderQueue(int type, float midDis, float lowDis) {
 	queueType = type;
-	queue = new Queue(1);
-	animQueue = new Queue(1);
+	arena = new FrameArena();
+	queue = new Queue(arena);
+	animQueue = new Queue(arena);
+	commands = new CommandList();
 	instanceQueue.clear();
 	animationQueue.clear();
+	instanceStream = NULL;
 	multiInstance = NULL;
 	singleInstance = NULL;
 	billboards = NULL;
@@ -21,6 +26,7 @@ RenderQueue::RenderQueue(int type, float midDis, float lowDis) {
 	batchData = NULL;
 	midDistSqr = powf(midDis, 2);
 	lowDistSqr = powf(lowDis, 2);
+	lodEye = vec3(0, 0, 0);
 	shadowLevel = 0;
 	firstFlush = true;
 	cfgArgs = NULL;
@@ -29,6 +35,8 @@ RenderQueue::RenderQueue(int type, float midDis, float lowDis) {
 RenderQueue::~RenderQueue() {
 	delete queue;
 	delete animQueue;
+	delete commands;
+	delete arena;
 
 	if (batchData) delete batchData;
 	if (multiInstance) delete multiInstance;
@@ -36,15 +44,15 @@ RenderQueue::~RenderQueue() {
 	if (billboards) delete billboards;
 	if (animations) delete animations;
 
-	map<Mesh*, InstanceData*>::iterator itIns;
-	for (itIns = instanceQueue.begin(); itIns != instanceQueue.end(); ++itIns)
-		delete itIns->second;
+	for (uint i = 0; i < instanceQueue.size(); ++i)
+		delete instanceQueue[i];
 	instanceQueue.clear();
 
-	map<Animation*, AnimationData*>::iterator itAnim;
-	for (itAnim = animationQueue.begin(); itAnim != animationQueue.end(); ++itAnim)
-		delete itAnim->second;
+	for (uint i = 0; i < animationQueue.size(); ++i)
+		delete animationQueue[i];
 	animationQueue.clear();
+
+	if (instanceStream) delete instanceStream;
 }
 
 void RenderQueue::push(Node* node) {
@@ -56,20 +64,16 @@ void RenderQueue::pushAnim(Node* node) {
 }
 
 void RenderQueue::flush() {
+	arena->reset();
 	queue->flush();
 	animQueue->flush();
 	
-	map<Mesh*, InstanceData*>::iterator itData = instanceQueue.begin();
-	while (itData != instanceQueue.end()) {
-		itData->second->resetInstance();
-		++itData;
-	}
+	for (uint i = 0; i < instanceQueue.size(); ++i)
+		instanceQueue[i]->resetInstance();
+	if (instanceStream) instanceStream->reset();
 
-	map<Animation*, AnimationData*>::iterator itAnim = animationQueue.begin();
-	while (itAnim != animationQueue.end()) {
-		itAnim->second->resetAnims();
-		++itAnim;
-	}
+	for (uint i = 0; i < animationQueue.size(); ++i)
+		animationQueue[i]->resetAnims();
 	
 	if (batchData) batchData->resetBatch();
 }
@@ -100,9 +104,8 @@ void RenderQueue::pushDatasToBatch(BatchData* data, int pass) {
 
 void RenderQueue::createInstances(Scene* scene) {
 	if (!multiInstance || !multiInstance->inited()) {
-		map<Mesh*, InstanceData*>::iterator itData = instanceQueue.begin();
-		while (itData != instanceQueue.end()) {
-			InstanceData* data = itData->second;
+		for (uint i = 0; i < instanceQueue.size(); ++i) {
+			InstanceData* data = instanceQueue[i];
 			pushDatasToInstance(scene, data, false);
 			Instance* instance = data->instance;
 			if (instance) {
@@ -127,7 +130,6 @@ void RenderQueue::createInstances(Scene* scene) {
 					}
 				}
 			}
-			++itData;
 		}
 	}
 
@@ -156,47 +158,76 @@ void RenderQueue::createInstances(Scene* scene) {
 	}
 }
 
-void RenderQueue::draw(Scene* scene, Camera* camera, Render* render, RenderState* state) {
+// Group node draws by shader, material and mesh, color pass also goes front to back to save overdraw
+void RenderQueue::sortCommands(Camera* camera, int pass) {
+	commands->reset();
+	bool frontToBack = pass == COLOR_PASS && camera;
+	float maxDepth = frontToBack ? camera->zFar : 0;
 	for (int it = 0; it < queue->size; it++) {
 		Node* node = queue->get(it);
+		if (node->type != TYPE_STATIC && node->type != TYPE_TERRAIN) continue;
+		if (node->type == TYPE_TERRAIN && pass != COLOR_PASS) continue;
+
+		int shader = node->type == TYPE_TERRAIN ? 1 : 0;
+		int material = 0, mesh = 0;
+		if (node->objects.size() > 0) {
+			Object* object = node->objects[0];
+			material = object->material;
+			if (object->mesh) mesh = object->mesh->meshId + 1;
+		}
+		float depth = 0;
+		if (frontToBack && node->boundingBox)
+			depth = (node->boundingBox->position - camera->position).GetLength();
+		commands->push(MakeSortKey(pass, shader, material, mesh, depth, maxDepth), node);
+	}
+	commands->sort();
+}
+
+void RenderQueue::draw(Scene* scene, Camera* camera, Render* render, RenderState* state) {
+	PROFILE_ZONE("RenderQueue::draw");
+	sortCommands(camera, state->pass);
+	for (int it = 0; it < commands->size(); it++) {
+		Node* node = (Node*)commands->get(it)->data;
 
 		if (node->type == TYPE_STATIC) 
 			render->draw(camera, node->drawcall, state);
 		else if (node->type == TYPE_TERRAIN) {
-			if (state->pass == COLOR_PASS) {
-				static Shader* terrainShader = render->findShader("terrain");
-				Shader* shader = state->shader;
-				state->shader = terrainShader;
-				render->draw(camera, node->drawcall, state);
-				state->shader = shader;
-			}
+			static Shader* terrainShader = render->findShader("terrain");
+			Shader* shader = state->shader;
+			state->shader = terrainShader;
+			render->draw(camera, node->drawcall, state);
+			state->shader = shader;
 		}
 	}
 
 	createInstances(scene);
+	if (instanceStream) instanceStream->createBuffer();
+
+	if (gpuLod()) {
+		if (multiInstance) multiInstance->drawcall->setLod(lodEye, midDistSqr, lowDistSqr);
+		if (singleInstance) singleInstance->drawcall->setLod(lodEye, midDistSqr, lowDistSqr);
+	}
 
 	if (multiInstance) {
-		multiInstance->drawcall->update(render, state);
+		multiInstance->drawcall->update(render, state, instanceStream);
 		render->draw(camera, multiInstance->drawcall, state);
 	}
 
 	if (singleInstance) {
-		singleInstance->drawcall->update(render, state);
+		singleInstance->drawcall->update(render, state, instanceStream);
 		render->draw(camera, singleInstance->drawcall, state);
 	}
 
 	if (billboards) {
-		billboards->drawcall->update(render, state);
+		billboards->drawcall->update(render, state, instanceStream);
 		render->draw(camera, billboards->drawcall, state);
 	}
 
 	if (!animations || !animations->inited()) {
-		map<Animation*, AnimationData*>::iterator itAnim = animationQueue.begin();
-		while (itAnim != animationQueue.end()) {
-			AnimationData* data = itAnim->second;
+		for (uint i = 0; i < animationQueue.size(); ++i) {
+			AnimationData* data = animationQueue[i];
 			if (!animations) animations = new MultiInstance();
 			if (!animations->inited()) animations->add(data);
-			++itAnim;
 		}
 	}
 
@@ -205,9 +236,11 @@ void RenderQueue::draw(Scene* scene, Camera* camera, Render* render, RenderState
 			animations->initBuffers();
 			animations->createDrawcall();
 		}
-		animations->drawcall->update(render, state);
+		animations->drawcall->update(render, state, instanceStream);
 		render->draw(camera, animations->drawcall, state);
 	}
+	if (instanceStream && (multiInstance || singleInstance || billboards || animations))
+		instanceStream->setFence();
 	
 	if (batchData) {
 		pushDatasToBatch(batchData, state->pass);
@@ -230,79 +263,194 @@ void RenderQueue::animate(float velocity) {
 	}
 }
 
+// Center comes from instance transforms like the one in records, so cpu & gpu lod selection agree
 Mesh* RenderQueue::queryLodMesh(Object* object, const vec3& eye) {
-	Mesh* mesh = object->mesh;
-	float e2oDis = (eye - object->bounding->position).GetSquaredLength();
-	if (e2oDis > lowDistSqr) 
-		mesh = object->meshLow;
-	else if (e2oDis > midDistSqr) 
-		mesh = object->meshMid;
-	
-	return mesh;
+	int lod = SelectLod(GetLodCenter(object->transformsFull), eye, midDistSqr, lowDistSqr);
+	if (lod == LOD_LOW) return object->meshLow;
+	else if (lod == LOD_MID) return object->meshMid;
+	return object->mesh;
 }
 
-void PushNodeToQueue(RenderQueue* queue, Scene* scene, Node* node, Camera* camera, Camera* mainCamera) {
-	if (queue->firstFlush) {
-		if (queue->queueType == QUEUE_DYNAMIC_SN ||
-			queue->queueType == QUEUE_STATIC_SN || queue->queueType == QUEUE_STATIC_SM || 
-			queue->queueType == QUEUE_STATIC_SF || queue->queueType == QUEUE_STATIC) {
-			for (uint i = 0; i < scene->meshes.size(); ++i) {
-				Mesh* mesh = scene->meshes[i]->mesh;
-				Object* object = scene->meshes[i]->object;
-				InstanceData* insData = new InstanceData(mesh, object, scene->queryMeshCount(mesh));
-				queue->instanceQueue.insert(pair<Mesh*, InstanceData*>(mesh, insData));
-			}
-		} else if (queue->queueType == QUEUE_ANIMATE_SN || queue->queueType == QUEUE_ANIMATE_SM || 
-				queue->queueType == QUEUE_ANIMATE_SF || queue->queueType == QUEUE_ANIMATE) {
-			map<Animation*, uint>::iterator it = scene->animCount.begin();
-			while (it != scene->animCount.end()) {
-				Animation* anim = it->first;
-				AnimationData* animData = new AnimationData(anim, it->second);
-				queue->animationQueue.insert(pair<Animation*, AnimationData*>(anim, animData));
-				++it;
+void PrepareQueueData(RenderQueue* queue, Scene* scene) {
+	if (queue->queueType == QUEUE_DYNAMIC_SN ||
+		queue->queueType == QUEUE_STATIC_SN || queue->queueType == QUEUE_STATIC_SM || 
+		queue->queueType == QUEUE_STATIC_SF || queue->queueType == QUEUE_STATIC) {
+		int groupCounts[RECORD_GROUPS] = { 0, 0, 0, 0 };
+		for (uint i = 0; i < scene->meshes.size(); ++i) {
+			Mesh* mesh = scene->meshes[i]->mesh;
+			Object* object = scene->meshes[i]->object;
+			InstanceData* insData = new InstanceData(mesh, object, scene->queryMeshCount(mesh));
+			if (queue->queueType == QUEUE_STATIC && mesh->meshlets.size() > 0) {
+				int words = MeshletMaskWords(mesh->meshlets.size());
+				insData->meshletMask = new std::atomic<uint>[words];
+				for (int w = 0; w < words; ++w)
+					insData->meshletMask[w] = 0;
 			}
+			queue->instanceQueue.push_back(insData); // Index is mesh's id
+			groupCounts[insData->recordGroup] += insData->maxInsCount;
+		}
+		queue->instanceStream = new InstanceStream(groupCounts);
+		for (uint i = 0; i < queue->instanceQueue.size(); ++i)
+			queue->instanceQueue[i]->stream = queue->instanceStream;
+	} else if (queue->queueType == QUEUE_ANIMATE_SN || queue->queueType == QUEUE_ANIMATE_SM || 
+			queue->queueType == QUEUE_ANIMATE_SF || queue->queueType == QUEUE_ANIMATE) {
+		int maxCount = 0;
+		for (uint i = 0; i < scene->anims.size(); ++i) {
+			AnimationData* animData = new AnimationData(scene->anims[i], scene->animCount[i]);
+			queue->animationQueue.push_back(animData); // Index is animation's id
+			maxCount += animData->maxCount;
 		}
-		queue->firstFlush = false;
+		queue->instanceStream = new InstanceStream(maxCount);
+		for (uint i = 0; i < queue->animationQueue.size(); ++i)
+			queue->animationQueue[i]->stream = queue->instanceStream;
 	}
+	queue->firstFlush = false;
+}
 
-	if (node->checkInCamera(camera)) {
-		for (unsigned int i = 0; i<node->children.size(); ++i) {
-			Node* child = node->children[i];
-			if (child->objects.size() <= 0)
-				PushNodeToQueue(queue, scene, child, camera, mainCamera);
-			else {
-				if (child->shadowLevel < queue->shadowLevel) continue;
-
-				if (child->checkInCamera(camera)) {
-					if (child->type != TYPE_INSTANCE && child->type != TYPE_STATIC && child->type != TYPE_ANIMATE)
-						queue->push(child);
-					else if (child->type == TYPE_INSTANCE) {
-						for (uint j = 0; j < child->objects.size(); ++j) {
-							Object* object = child->objects[j];
-							if (queue->queueType == QUEUE_DYNAMIC_SN && !object->isDynamic()) continue;
-							else if (queue->queueType == QUEUE_STATIC_SN && object->isDynamic()) continue;
-
-							if (queue->shadowLevel > 0 && !object->genShadow) continue;
-							if (object->checkInCamera(camera)) {
-								Mesh* mesh = queue->queryLodMesh(object, mainCamera->position);
-								if (!mesh) continue;
-								if (queue->shadowLevel > 0 && !mesh->drawShadow) continue;
-								InstanceData* insData = queue->instanceQueue[mesh];
-								insData->addInstance(object);
-							}
-						}
-					} else if (child->type == TYPE_ANIMATE) {
-						if (child->objects.size() > 0) {
-							queue->pushAnim(child);
-							AnimationNode* animNode = (AnimationNode*)child;
-							Animation* anim = animNode->getObject()->animation;
-							AnimationData* animData = queue->animationQueue[anim];
-							animData->addAnimObject(animNode->getObject());
-							animNode->animate(scene->velocity);
-						}
-					} 
+bool PushLodInstance(RenderQueue* queue, Object* object, const Frustum* frustum, const vec3& eye, RecordSpans* spans) {
+	Mesh* meshes[3] = { object->mesh, object->meshMid, object->meshLow };
+	InstanceData* datas[3];
+	for (int i = 0; i < 3; ++i) {
+		Mesh* mesh = meshes[i];
+		if (!mesh || mesh->isBillboard) return false;
+		if (queue->shadowLevel > 0 && !mesh->drawShadow) return false;
+		if (mesh->meshId < 0 || mesh->meshId >= (int)queue->instanceQueue.size()) return false;
+		datas[i] = queue->instanceQueue[mesh->meshId];
+		if (!datas[i]->instance) return false;
+		// Record goes to high mesh's group, lods drawn by other passes are picked on cpu
+		if (datas[i]->recordGroup != datas[LOD_HIGH]->recordGroup) return false;
+	}
+
+	buff ids[4];
+	PackLodIds(datas[LOD_HIGH]->instance, datas[LOD_MID]->instance, datas[LOD_LOW]->instance, ids);
+	if (!datas[LOD_HIGH]->addInstance(object, ids, spans)) return false;
+	if (datas[LOD_MID] != datas[LOD_HIGH]) datas[LOD_MID]->count++;
+	if (datas[LOD_LOW] != datas[LOD_HIGH] && datas[LOD_LOW] != datas[LOD_MID]) datas[LOD_LOW]->count++;
+	// Shader picks the lod cpu would from the same center & eye, only that mesh's meshlets need to be visible
+	int lod = SelectLod(GetLodCenter(object->transformsFull), eye, queue->midDistSqr, queue->lowDistSqr);
+	if (datas[lod]->meshletMask) datas[lod]->cullMeshlets(object, frustum, eye);
+	return true;
+}
+
+static void PushInstancesToQueue(RenderQueue* queue, RecordSpans* spans, BVH* tree, int start, int count, const Frustum* frustum, bool inside, const vec3& eye) {
+	uint visibility[CULL_BATCH_SIZE / CULL_MASK_BITS];
+	int end = start + count;
+	for (int batch = start; batch < end; batch += CULL_BATCH_SIZE) {
+		int batchCount = end - batch < CULL_BATCH_SIZE ? end - batch : CULL_BATCH_SIZE;
+		if (inside) // Node is totally inside frustum, so are its objects
+			memset(visibility, 0xff, sizeof(visibility));
+		else
+			tree->checkObjects(batch, batchCount, frustum, visibility);
+		for (int b = 0; b < batchCount; ++b) {
+			if (!CheckVisibleBit(visibility, b)) continue;
+			Object* object = tree->objRefs[batch + b];
+			if (queue->queueType == QUEUE_DYNAMIC_SN && !object->isDynamic()) continue;
+			else if (queue->queueType == QUEUE_STATIC_SN && object->isDynamic()) continue;
+
+			if (queue->shadowLevel > 0 && !object->genShadow) continue;
+			if (queue->gpuLod() && PushLodInstance(queue, object, frustum, eye, spans)) continue;
+			Mesh* mesh = queue->queryLodMesh(object, eye);
+			if (!mesh) continue;
+			if (queue->shadowLevel > 0 && !mesh->drawShadow) continue;
+			if (mesh->meshId < 0 || mesh->meshId >= (int)queue->instanceQueue.size()) continue;
+			InstanceData* insData = queue->instanceQueue[mesh->meshId];
+			insData->addInstance(object, NULL, spans);
+			if (insData->meshletMask) insData->cullMeshlets(object, frustum, eye);
+		}
+	}
+}
+
+struct CullState {
+	int end;
+	uint viewMask;
+	uint planeMasks[CULL_MAX_VIEWS];
+};
+
+void PrepareQueues(RenderQueue** queues, int count, Scene* scene, Camera* mainCamera) {
+	for (int v = 0; v < count; ++v) {
+		if (queues[v]->firstFlush) 
+			PrepareQueueData(queues[v], scene);
+		queues[v]->lodEye = mainCamera->position;
+	}
+}
+
+void PushNodeToQueues(RenderQueue** queues, Camera** cameras, int count, Scene* scene, BVH* tree, Camera* mainCamera) {
+	PrepareQueues(queues, count, scene, mainCamera);
+	PushNodeRangeToQueues(queues, cameras, count, scene, tree, mainCamera, 0, tree->nodeCount);
+}
+
+void PushNodeRangeToQueues(RenderQueue** queues, Camera** cameras, int count, Scene* scene, BVH* tree, Camera* mainCamera, int start, int end, CullBin* bin) {
+	PROFILE_ZONE("PushNodeToQueues");
+	// View bits & plane masks only have room for CULL_MAX_VIEWS views, extra views are left unfilled
+	assert(count > 0 && count <= CULL_MAX_VIEWS);
+	if (count > CULL_MAX_VIEWS) count = CULL_MAX_VIEWS;
+
+	CullState states[CULL_MAX_DEPTH];
+	int depth = 0;
+	states[0].end = end;
+	states[0].viewMask = (1 << count) - 1;
+	for (int v = 0; v < count; ++v)
+		states[0].planeMasks[v] = CULL_ALL_PLANES;
+
+	int i = start;
+	while (i < end) {
+		while (i >= states[depth].end) --depth;
+		const CullState& parent = states[depth];
+		uint viewMask = parent.viewMask;
+		uint planeMasks[CULL_MAX_VIEWS];
+		memcpy(planeMasks, parent.planeMasks, count * sizeof(uint));
+
+		int objCount = tree->nodeObjCount[i];
+		for (int v = 0; v < count; ++v) {
+			if (!(viewMask & (1 << v))) continue;
+			if (objCount > 0 && tree->nodeShadow[i] < queues[v]->shadowLevel) 
+				viewMask &= ~(1 << v);
+			else if (planeMasks[v] && !tree->checkNode(i, cameras[v]->frustum, planeMasks[v])) 
+				viewMask &= ~(1 << v);
+		}
+		if (!viewMask) { // Skip whole subtree
+			i = tree->nodeSkip[i];
+			continue;
+		}
+
+		if (objCount > 0) {
+			Node* child = tree->nodeRefs[i];
+			for (int v = 0; v < count; ++v) {
+				if (!(viewMask & (1 << v))) continue;
+				RenderQueue* queue = queues[v];
+				if (child->type != TYPE_INSTANCE && child->type != TYPE_STATIC && child->type != TYPE_ANIMATE) {
+					if (bin) bin->nodes[v]->push(child);
+					else queue->push(child);
+				} else if (child->type == TYPE_INSTANCE) 
+					PushInstancesToQueue(queue, bin ? bin->spans[v] : NULL, tree, tree->nodeObjStart[i], objCount, cameras[v]->frustum, planeMasks[v] == 0, mainCamera->position);
+				else if (child->type == TYPE_ANIMATE) {
+					queue->pushAnim(child);
+					AnimationNode* animNode = (AnimationNode*)child;
+					Animation* anim = animNode->getObject()->animation;
+					if (anim->animId >= 0 && anim->animId < (int)queue->animationQueue.size())
+						queue->animationQueue[anim->animId]->addAnimObject(animNode->getObject());
+					animNode->animate(scene->velocity);
 				}
 			}
+		} else if (tree->nodeSkip[i] > i + 1 && depth + 1 < CULL_MAX_DEPTH) {
+			CullState& state = states[++depth];
+			state.end = tree->nodeSkip[i];
+			state.viewMask = viewMask;
+			memcpy(state.planeMasks, planeMasks, count * sizeof(uint));
+		}
+		++i;
+	}
+}
+
+void MergeCullBins(RenderQueue** queues, int count, CullBin* bins, int binCount) {
+	PROFILE_ZONE("MergeCullBins");
+	for (int v = 0; v < count; ++v) {
+		RenderQueue* queue = queues[v];
+		for (int b = 0; b < binCount; ++b) {
+			Queue* nodes = bins[b].nodes[v];
+			for (int n = 0; n < nodes->size; ++n)
+				queue->push(nodes->get(n));
+			if (queue->instanceStream) queue->instanceStream->append(bins[b].spans[v]);
 		}
 	}
 }
\ No newline at end of file
@@ -3,12 +3,15 @@
 
 #include "render.h"
 #include "../node/node.h"
+#include "../bounding/bvh.h"
 #include <stdlib.h>
 #include <string.h>
 #include "../instance/instance.h"
 #include "../instance/multiInstance.h"
 #include "../batch/batch.h"
 #include "../animation/animationData.h"
+#include "../util/frameArena.h"
+#include "commandList.h"
 
 #ifndef QUEUE_STATIC
 #define QUEUE_DYNAMIC_SN 0
@@ -22,30 +25,40 @@
 #define QUEUE_ANIMATE    8
 #endif
 
+#define CULL_MAX_VIEWS 8
+#define CULL_MAX_DEPTH 64
+#define CULL_MAX_TASKS 16 // Subtree ranges static tree is cut into at most for parallel culling
+
+#define QUEUE_INIT_CAPACITY 64
+
+// Node list of one frame, its storage comes from queue's frame arena and is dropped when arena reset
 struct Queue {
 	Node** data;
 	int capacity, size;
-	Queue(int count) {
-		capacity = count;
-		data = (Node**)malloc(capacity*sizeof(Node*));
+	FrameArena* arena;
+	Queue(FrameArena* frameArena) {
+		arena = frameArena;
+		data = NULL;
+		capacity = 0;
 		size = 0;
 	}
 	~Queue() {
-		free(data); data = NULL;
+		data = NULL;
 	}
 	void push(Node* node) {
 		size++;
 		if (size > capacity) {
 			int capacityBefore = capacity;
-			capacity += 10;
-			Node** tmp = (Node**)malloc(capacity*sizeof(Node*));
-			memcpy(tmp, data, capacityBefore * sizeof(Node*));
-			free(data);
+			capacity = capacity > 0 ? capacity * 2 : QUEUE_INIT_CAPACITY;
+			Node** tmp = arena->allocArray<Node*>(capacity);
+			if (capacityBefore > 0) memcpy(tmp, data, capacityBefore * sizeof(Node*));
 			data = tmp;
 		}
 		*(data + size - 1) = node;
 	}
-	void flush() {
+	void flush() { // Call it after arena reset
+		data = NULL;
+		capacity = 0;
 		size = 0;
 	}
 	Node* get(int i) {
@@ -59,15 +72,20 @@ class RenderQueue {
 private:
 	Queue* queue;
 	Queue* animQueue;
+	FrameArena* arena;
+	CommandList* commands; // Node draws of current pass, sorted before submission
 private:
 	void pushDatasToInstance(Scene* scene, InstanceData* data, bool copy);
 	void pushDatasToBatch(BatchData* data, int pass);
+	void sortCommands(Camera* camera, int pass);
 public:
 	ConfigArg* cfgArgs;
 	int queueType;
 	float midDistSqr, lowDistSqr;
-	std::map<Mesh*, InstanceData*> instanceQueue;
-	std::map<Animation*, AnimationData*> animationQueue;
+	vec3 lodEye; // Main camera position the queue was culled with, lods are chosen from it
+	std::vector<InstanceData*> instanceQueue; // Indexed by Mesh::meshId
+	std::vector<AnimationData*> animationQueue; // Indexed by Animation::animId
+	InstanceStream* instanceStream; // Culled instance records of all meshes in instanceQueue
 	MultiInstance* multiInstance;
 	MultiInstance* singleInstance;
 	MultiInstance* billboards;
@@ -87,8 +105,56 @@ public:
 	void animate(float velocity);
 	Mesh* queryLodMesh(Object* object, const vec3& eye);
 	void setCfg(ConfigArg* cfg) { cfgArgs = cfg; }
+	bool gpuLod() { return cfgArgs && cfgArgs->gpulod; }
+	FrameArena* getArena() { return arena; }
+	Queue* getQueue() { return queue; }
+};
+
+// Output of one parallel cull task, nodes & records of each view it found in its node range
+// Queues are filled from bins in range order after tasks finished, so they come out as serial culling leaves them
+struct CullBin {
+	FrameArena* arena;
+	Queue* nodes[CULL_MAX_VIEWS];
+	RecordSpans* spans[CULL_MAX_VIEWS];
+	CullBin() {
+		arena = new FrameArena();
+		for (int v = 0; v < CULL_MAX_VIEWS; ++v) {
+			nodes[v] = new Queue(arena);
+			spans[v] = new RecordSpans();
+		}
+	}
+	~CullBin() {
+		for (int v = 0; v < CULL_MAX_VIEWS; ++v) {
+			delete nodes[v];
+			delete spans[v];
+		}
+		delete arena;
+	}
+	void reset() {
+		arena->reset();
+		for (int v = 0; v < CULL_MAX_VIEWS; ++v) {
+			nodes[v]->flush();
+			spans[v]->reset();
+		}
+	}
 };
 
-void PushNodeToQueue(RenderQueue* queue, Scene* scene, Node* node, Camera* camera, Camera* mainCamera);
+// Create queue's InstanceData/AnimationData at first flush, not thread safe as it may touch scene's mesh count
+void PrepareQueueData(RenderQueue* queue, Scene* scene);
+// Per frame setup of queues before any culling into them
+void PrepareQueues(RenderQueue** queues, int count, Scene* scene, Camera* mainCamera);
+// Cull tree once for all queues, queues[i] is filled with nodes visible from cameras[i]
+// count is at most CULL_MAX_VIEWS
+void PushNodeToQueues(RenderQueue** queues, Camera** cameras, int count, Scene* scene, BVH* tree, Camera* mainCamera);
+// Same walk over node range [start, end) of BVH::splitRanges only, queues must be prepared
+// Tasks may cull different ranges of static tree at once, each into its own bin, nodes & records then go
+// to bin instead of queues, counts & meshlet masks of instance datas are still added to directly
+void PushNodeRangeToQueues(RenderQueue** queues, Camera** cameras, int count, Scene* scene, BVH* tree, Camera* mainCamera, int start, int end, CullBin* bin = NULL);
+// Append nodes & records of bins to queues, bins in order of their node ranges
+void MergeCullBins(RenderQueue** queues, int count, CullBin* bins, int binCount);
+// Push one record with ids of all lods to high mesh, and keep output space in mid & low meshes for it
+// Record goes to spans instead of queue's stream when given
+// Return false to fall back to cpu selection, when some lod can not be drawn by multi drawcalls
+bool PushLodInstance(RenderQueue* queue, Object* object, const Frustum* frustum, const vec3& eye, RecordSpans* spans = NULL);
 
 #endif
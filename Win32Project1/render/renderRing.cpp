@@ -0,0 +1,143 @@
+#include "renderRing.h"
+#include <thread>
+#include <chrono>
+using namespace std;
+
+static double NowMs() {
+	return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RenderRing::RenderRing(int count, float midDis, float lowDis, ConfigArg* cfg) {
+	depth = count < MIN_RENDER_DEPTH ? MIN_RENDER_DEPTH : count;
+	states = new atomic<u64>[depth];
+	publishTimes = (double*)malloc(depth * sizeof(double));
+	for (int i = 0; i < depth; i++) {
+		slots.push_back(new Renderable(midDis, lowDis, cfg));
+		states[i] = SLOT_FREE;
+		publishTimes[i] = 0.0;
+	}
+	writeSlot = -1, readSlot = -1;
+	sequence = 0, readSequence = 0;
+	published = 0, consumed = 0, dropped = 0;
+	producerStalls = 0, consumerRepeats = 0;
+	latencySum = 0.0, latencyMax = 0.0;
+}
+
+RenderRing::~RenderRing() {
+	for (int i = 0; i < depth; i++)
+		delete slots[i];
+	slots.clear();
+	delete[] states;
+	free(publishTimes);
+}
+
+int RenderRing::countReady() {
+	int ready = 0;
+	for (int i = 0; i < depth; i++) {
+		if ((states[i].load() & 3) == SLOT_READY)
+			ready++;
+	}
+	return ready;
+}
+
+// Called before a new frame is prepared, keeps producer at most depth - 2 frames ahead
+bool RenderRing::canWrite() {
+	if (countReady() < depth - 2) return true;
+	producerStalls++;
+	return false;
+}
+
+Renderable* RenderRing::beginWrite() {
+	while (true) {
+		int oldest = -1;
+		u64 oldestState = 0;
+		for (int i = 0; i < depth; i++) {
+			u64 state = states[i].load();
+			if ((state & 3) == SLOT_FREE) {
+				if (states[i].compare_exchange_strong(state, SLOT_WRITING)) {
+					writeSlot = i;
+					return slots[i];
+				}
+			} else if ((state & 3) == SLOT_READY) {
+				if (oldest < 0 || (state >> 2) < (oldestState >> 2))
+					oldest = i, oldestState = state;
+			}
+		}
+		// No free slot, reuse oldest frame renderer has not picked up
+		if (oldest >= 0 && states[oldest].compare_exchange_strong(oldestState, SLOT_WRITING)) {
+			dropped++;
+			writeSlot = oldest;
+			return slots[oldest];
+		}
+		// Renderer is switching slots right now
+		this_thread::yield();
+	}
+}
+
+void RenderRing::endWrite() {
+	if (writeSlot < 0) return;
+	publishTimes[writeSlot] = NowMs();
+	states[writeSlot].store(((++sequence) << 2) | SLOT_READY);
+	writeSlot = -1;
+	published++;
+}
+
+// Retired slots keep reading state so producer can not take them
+void RenderRing::releaseRetired() {
+	for (uint i = 0; i < retired.size();) {
+		if (!slots[retired[i]]->gpuBusy()) {
+			states[retired[i]].store(SLOT_FREE);
+			retired[i] = retired.back();
+			retired.pop_back();
+		} else i++;
+	}
+}
+
+// Pick up newest ready frame, return NULL if nothing newer than current one
+Renderable* RenderRing::acquire() {
+	releaseRetired();
+	int newest = -1;
+	u64 newestState = 0;
+	for (int i = 0; i < depth; i++) {
+		u64 state = states[i].load();
+		if ((state & 3) == SLOT_READY && (state >> 2) > readSequence) {
+			if (newest < 0 || (state >> 2) > (newestState >> 2))
+				newest = i, newestState = state;
+		}
+	}
+	if (newest < 0 || !states[newest].compare_exchange_strong(newestState, (newestState & ~3ull) | SLOT_READING)) {
+		consumerRepeats++;
+		return NULL;
+	}
+
+	if (readSlot >= 0) retired.push_back(readSlot);
+	readSlot = newest;
+	readSequence = newestState >> 2;
+	consumed++;
+
+	// Older ready frames will never be drawn
+	for (int i = 0; i < depth; i++) {
+		u64 state = states[i].load();
+		if ((state & 3) == SLOT_READY && (state >> 2) < readSequence) {
+			if (states[i].compare_exchange_strong(state, SLOT_FREE))
+				dropped++;
+		}
+	}
+
+	double latency = NowMs() - publishTimes[newest];
+	latencySum.store(latencySum.load(memory_order_relaxed) + latency, memory_order_relaxed);
+	if (latency > latencyMax.load(memory_order_relaxed)) latencyMax.store(latency, memory_order_relaxed);
+	return slots[newest];
+}
+
+RenderRingStats RenderRing::getStats() {
+	RenderRingStats stats;
+	stats.published = published;
+	stats.consumed = consumed;
+	stats.dropped = dropped;
+	stats.producerStalls = producerStalls;
+	stats.consumerRepeats = consumerRepeats;
+	stats.latencyAvg = stats.consumed > 0 ? latencySum / stats.consumed : 0.0;
+	stats.latencyMax = latencyMax;
+	return stats;
+}
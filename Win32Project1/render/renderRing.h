@@ -0,0 +1,106 @@
+#ifndef RENDER_RING_H_
+#define RENDER_RING_H_
+
+#include "renderQueue.h"
+#include <vector>
+#include <atomic>
+
+#define MIN_RENDER_DEPTH 3
+
+#define SLOT_FREE    0
+#define SLOT_WRITING 1
+#define SLOT_READY   2
+#define SLOT_READING 3
+
+struct Renderable {
+	std::vector<RenderQueue*> queues;
+	Camera* mainCamera; // Camera & light cameras used to cull this frame
+	Camera* lightCameraDyn;
+	Camera* lightCameraNear;
+	Camera* lightCameraMid;
+	bool showWater;
+	Renderable(float midDis, float lowDis, ConfigArg* cfg) {
+		queues.clear();
+		for (uint i = 0; i < 9; i++) {
+			queues.push_back(new RenderQueue(i, midDis, lowDis));
+			queues[i]->setCfg(cfg);
+		}
+		queues[QUEUE_DYNAMIC_SN]->shadowLevel = 1;
+		queues[QUEUE_STATIC_SN]->shadowLevel = 1;
+		queues[QUEUE_STATIC_SM]->shadowLevel = 2;
+		queues[QUEUE_STATIC_SF]->shadowLevel = 3;
+		queues[QUEUE_ANIMATE_SN]->shadowLevel = 1;
+		queues[QUEUE_ANIMATE_SM]->shadowLevel = 2;
+		queues[QUEUE_ANIMATE_SF]->shadowLevel = 3;
+		mainCamera = new Camera(0);
+		lightCameraDyn = new Camera(0);
+		lightCameraNear = new Camera(0);
+		lightCameraMid = new Camera(0);
+		showWater = false;
+	}
+	~Renderable() {
+		for (uint i = 0; i < queues.size(); i++)
+			delete queues[i];
+		delete mainCamera;
+		delete lightCameraDyn;
+		delete lightCameraNear;
+		delete lightCameraMid;
+	}
+	void flush() {
+		for (uint i = 0; i < queues.size(); i++)
+			queues[i]->flush();
+	}
+	// Render thread only, true while gpu may still read instance records culled into this frame
+	bool gpuBusy() {
+		for (uint i = 0; i < queues.size(); i++) {
+			if (queues[i]->instanceStream && queues[i]->instanceStream->busy())
+				return true;
+		}
+		return false;
+	}
+	void waitGpu() {
+		for (uint i = 0; i < queues.size(); i++) {
+			if (queues[i]->instanceStream)
+				queues[i]->instanceStream->wait();
+		}
+	}
+};
+
+struct RenderRingStats {
+	u64 published, consumed, dropped;
+	u64 producerStalls; // Checks where producer was idle but ring was full of unconsumed frames
+	u64 consumerRepeats; // Times renderer found no new frame
+	double latencyAvg, latencyMax; // Milliseconds between publish and pick up
+};
+
+// Lock free ring of Renderable between prepare jobs (single producer) and render thread (single consumer)
+// Every slot has an atomic state word (sequence << 2 | SLOT_*), renderer always picks the newest ready slot
+// Producer may run depth - 2 frames ahead of renderer, older unconsumed frames are dropped
+// A slot renderer has left stays retired until gpu is done with it, as culling writes straight to its gpu buffers
+class RenderRing {
+private:
+	std::vector<Renderable*> slots;
+	std::vector<int> retired;
+	std::atomic<u64>* states;
+	double* publishTimes;
+	int depth;
+	int writeSlot, readSlot;
+	u64 sequence, readSequence;
+	std::atomic<u64> published, consumed, dropped, producerStalls, consumerRepeats;
+	std::atomic<double> latencySum, latencyMax; // Only renderer writes them, stats are read from any thread
+private:
+	int countReady();
+	void releaseRetired();
+public:
+	RenderRing(int count, float midDis, float lowDis, ConfigArg* cfg);
+	~RenderRing();
+	Renderable* get(int i) { return slots[i]; }
+	int getDepth() { return depth; }
+	bool canWrite();
+	Renderable* beginWrite();
+	void endWrite();
+	Renderable* acquire();
+	RenderRingStats getStats();
+};
+
+#endif
@@ -189,6 +189,7 @@ void SetupShaders(ShaderManager* shaders, const ConfigArg* cfgs) {
 	multi->attachDef("WORKGROUP_SIZE", to_string(WORKGROUPE_SIZE).data());
 	multi->attachDef("MAX_DISPATCH", to_string(MAX_DISPATCH).data());
 	multi->attachDef("InvalidIns", to_string(InvalidInsId).data());
+	multi->attachDef("LodIdRange", to_string(LodIdRange).data());
 
 	Shader* animMulti = shaders->addShader("animMulti", MULTI_COMP);
 	animMulti->attachDef("WORKGROUP_SIZE", to_string(WORKGROUPE_SIZE).data());
@@ -200,6 +201,7 @@ void SetupShaders(ShaderManager* shaders, const ConfigArg* cfgs) {
 	multiShadow->attachDef("WORKGROUP_SIZE", to_string(WORKGROUPE_SIZE).data());
 	multiShadow->attachDef("MAX_DISPATCH", to_string(MAX_DISPATCH).data());
 	multiShadow->attachDef("InvalidIns", to_string(InvalidInsId).data());
+	multiShadow->attachDef("LodIdRange", to_string(LodIdRange).data());
 	multiShadow->attachDef("ShadowPass", "1.0");
 
 	Shader* animMultiShadow = shaders->addShader("animMulti_s", MULTI_COMP);
@@ -8,8 +8,7 @@
 const uint VertexSlot = 0;
 const uint NormalSlot = 1;
 const uint TexcoordSlot = 2;
-const uint TexidSlot = 3;
-const uint ColorSlot = 4;
+const uint MaterialSlot = 3;
 const uint TangentSlot = 5;
 const uint ObjidSlot = 6;
 
@@ -17,12 +16,11 @@ const uint ObjidSlot = 6;
 const uint VertexIndex = 0;
 const uint NormalIndex = 1;
 const uint TexcoordIndex = 2;
-const uint TexidIndex = 3;
-const uint ColorIndex = 4;
-const uint TangentIndex = 5;
-const uint ObjidIndex = 6;
-const uint Index = 7;
-const uint TerrainIndex = 6;
+const uint MaterialIndex = 3;
+const uint TangentIndex = 4;
+const uint ObjidIndex = 5;
+const uint Index = 6;
+const uint TerrainIndex = 5;
 
 StaticDrawcall::StaticDrawcall(Batch* batch) :Drawcall() {
 	batchRef = batch;
@@ -36,7 +34,7 @@ StaticDrawcall::StaticDrawcall(Batch* batch) :Drawcall() {
 	indCount = dynDC ? MAX_INDEX_COUNT : indexCount;
 	drawType = dynDC ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
 
-	bufCount = !isFullStatic() ? 8 : 7;
+	bufCount = !isFullStatic() ? 7 : 6;
 	dataBuffer = createBuffers(batchRef, bufCount, vertCount, indCount, drawType, NULL);
 	dataBufferVisual = NULL;
 	bufferToDraw = dataBuffer;
@@ -71,9 +69,8 @@ RenderBuffer* StaticDrawcall::createBuffers(Batch* batch, int bufCount, int vert
 	if (!dupBuf) {
 		buffer->setAttribData(GL_ARRAY_BUFFER, VertexIndex,VertexSlot, GL_FLOAT, vertCount, 3, 1, false, drawType, -1, batch->vertexBuffer);
 		buffer->setAttribData(GL_ARRAY_BUFFER, NormalIndex, NormalSlot, GL_FLOAT, vertCount, 3, 1, false, drawType, -1, batch->normalBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, TexcoordSlot, GL_FLOAT, vertCount, 4, 1, false, drawType, -1, batch->texcoordBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TexidIndex, TexidSlot, GL_FLOAT, vertCount, 4, 1, false, drawType, -1, batch->texidBuffer);
-		buffer->setAttribData(GL_ARRAY_BUFFER, ColorIndex, ColorSlot, GL_UNSIGNED_BYTE, vertCount, 3, 1, false, drawType, -1, batch->colorBuffer);
+		buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, TexcoordSlot, GL_FLOAT, vertCount, 2, 1, false, drawType, -1, batch->texcoordBuffer);
+		buffer->setAttribData(GL_ARRAY_BUFFER, MaterialIndex, MaterialSlot, GL_UNSIGNED_SHORT, vertCount, 1, 1, false, drawType, -1, batch->materialBuffer);
 		buffer->setAttribData(GL_ARRAY_BUFFER, TangentIndex, TangentSlot, GL_FLOAT, vertCount, 3, 1, false, drawType, -1, batch->tangentBuffer);
 		if (!isFullStatic())
 			buffer->setAttribData(GL_ARRAY_BUFFER, ObjidIndex, ObjidSlot, GL_UNSIGNED_BYTE, vertCount, 1, 1, false, drawType, -1, batch->objectidBuffer);
@@ -81,8 +78,7 @@ RenderBuffer* StaticDrawcall::createBuffers(Batch* batch, int bufCount, int vert
 		buffer->setAttribData(GL_ARRAY_BUFFER, VertexIndex, dupBuf->streamDatas[VertexIndex]);
 		buffer->setAttribData(GL_ARRAY_BUFFER, NormalIndex, dupBuf->streamDatas[NormalIndex]);
 		buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, dupBuf->streamDatas[TexcoordIndex]);
-		buffer->setAttribData(GL_ARRAY_BUFFER, TexidIndex, dupBuf->streamDatas[TexidIndex]);
-		buffer->setAttribData(GL_ARRAY_BUFFER, ColorIndex, dupBuf->streamDatas[ColorIndex]);
+		buffer->setAttribData(GL_ARRAY_BUFFER, MaterialIndex, dupBuf->streamDatas[MaterialIndex]);
 		buffer->setAttribData(GL_ARRAY_BUFFER, TangentIndex, dupBuf->streamDatas[TangentIndex]);
 		if (!isFullStatic())
 			buffer->setAttribData(GL_ARRAY_BUFFER, ObjidIndex, dupBuf->streamDatas[ObjidIndex]);
@@ -150,8 +146,7 @@ void StaticDrawcall::updateBuffers(int pass, uint* indices, int indexCount) {
 		dataBuffer->updateBufferData(VertexIndex, vertexCntToPrepare, (void*)batchRef->vertexBuffer);
 		dataBuffer->updateBufferData(NormalIndex, vertexCntToPrepare, (void*)batchRef->normalBuffer);
 		dataBuffer->updateBufferData(TexcoordIndex, vertexCntToPrepare, (void*)batchRef->texcoordBuffer);
-		dataBuffer->updateBufferData(TexidIndex, vertexCntToPrepare, (void*)batchRef->texidBuffer);
-		dataBuffer->updateBufferData(ColorIndex, vertexCntToPrepare, (void*)batchRef->colorBuffer);
+		dataBuffer->updateBufferData(MaterialIndex, vertexCntToPrepare, (void*)batchRef->materialBuffer);
 		dataBuffer->updateBufferData(TangentIndex, vertexCntToPrepare, (void*)batchRef->tangentBuffer);
 		dataBuffer->updateBufferData(ObjidIndex, vertexCntToPrepare, (void*)batchRef->objectidBuffer);
 
@@ -161,6 +156,7 @@ void StaticDrawcall::updateBuffers(int pass, uint* indices, int indexCount) {
 	else if (pass == NEAR_SHADOW_PASS || pass == MID_SHADOW_PASS) {
 		dataBuffer->updateBufferData(VertexIndex, vertexCntToPrepare, (void*)batchRef->vertexBuffer);
 		dataBuffer->updateBufferData(TexcoordIndex, vertexCntToPrepare, (void*)batchRef->texcoordBuffer);
+		dataBuffer->updateBufferData(MaterialIndex, vertexCntToPrepare, (void*)batchRef->materialBuffer);
 		dataBuffer->updateBufferData(ObjidIndex, vertexCntToPrepare, (void*)batchRef->objectidBuffer);
 
 		dataBuffer->use();
@@ -0,0 +1,92 @@
+#include "streamBuffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool StreamBuffer::Supported() {
+	return GLEW_ARB_buffer_storage || GLEW_VERSION_4_4;
+}
+
+StreamBuffer::StreamBuffer(GLenum bufferTarget, uint size) {
+	target = bufferTarget;
+	current = 0;
+	waitCount = 0;
+	mapped = NULL;
+	staging = NULL;
+	for (uint i = 0; i < STREAM_SEGMENTS; i++)
+		fences[i] = 0;
+
+	GLint align = 256;
+	if (target == GL_SHADER_STORAGE_BUFFER) glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &align);
+	else if (target == GL_UNIFORM_BUFFER) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+	if (align <= 0) align = 256;
+	segmentSize = (size + align - 1) / align * align;
+
+	persistent = Supported();
+	glGenBuffers(1, &bufferid);
+	glBindBuffer(target, bufferid);
+	if (persistent) {
+		// Dynamic storage bit keeps glBufferSubData usable if mapping fails
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(target, segmentSize * STREAM_SEGMENTS, NULL, flags | GL_DYNAMIC_STORAGE_BIT);
+		mapped = (byte*)glMapBufferRange(target, 0, segmentSize * STREAM_SEGMENTS, flags);
+		if (!mapped) persistent = false;
+	} else
+		glBufferData(target, segmentSize * STREAM_SEGMENTS, NULL, GL_DYNAMIC_DRAW);
+	if (!persistent) staging = (byte*)malloc(segmentSize);
+	glBindBuffer(target, 0);
+}
+
+StreamBuffer::~StreamBuffer() {
+	for (uint i = 0; i < STREAM_SEGMENTS; i++)
+		if (fences[i]) glDeleteSync(fences[i]);
+	if (mapped) {
+		glBindBuffer(target, bufferid);
+		glUnmapBuffer(target);
+		glBindBuffer(target, 0);
+	}
+	glDeleteBuffers(1, &bufferid);
+	if (staging) free(staging);
+}
+
+void StreamBuffer::waitFence(uint segment) {
+	GLsync sync = fences[segment];
+	if (!sync) return;
+	GLenum res = glClientWaitSync(sync, 0, 0);
+	if (res == GL_TIMEOUT_EXPIRED) {
+		waitCount++;
+		do {
+			res = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_WAIT_TIMEOUT);
+		} while (res == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(sync);
+	fences[segment] = 0;
+}
+
+// Return write pointer of current segment, at most segmentSize bytes can be written
+void* StreamBuffer::beginWrite() {
+	waitFence(current);
+	return persistent ? mapped + current * segmentSize : staging;
+}
+
+void StreamBuffer::endWrite(uint size) {
+	if (!persistent && size > 0) {
+		glBindBuffer(target, bufferid);
+		glBufferSubData(target, current * segmentSize, size > segmentSize ? segmentSize : size, staging);
+		glBindBuffer(target, 0);
+	}
+}
+
+void StreamBuffer::bindRange(int base, uint size) {
+	glBindBufferRange(target, base, bufferid, current * segmentSize, size > 0 ? size : segmentSize);
+}
+
+void StreamBuffer::unbindRange(int base) {
+	glBindBufferBase(target, base, 0);
+}
+
+// Call after last gl command reading current segment, then move to next one
+void StreamBuffer::fence() {
+	if (fences[current]) glDeleteSync(fences[current]);
+	fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	current = (current + 1) % STREAM_SEGMENTS;
+}
@@ -0,0 +1,41 @@
+#ifndef STREAM_BUFFER_H_
+#define STREAM_BUFFER_H_
+
+#include "glheader.h"
+#include "../constants/constants.h"
+
+#define STREAM_SEGMENTS 3
+#define STREAM_WAIT_TIMEOUT 1000000 // Nanoseconds per glClientWaitSync try
+
+// Buffer cut into STREAM_SEGMENTS segments, cpu writes one segment while gpu may still read the other two
+// With ARB_buffer_storage the whole buffer is mapped persistent & coherent once, so writes go straight to gpu memory
+// Each segment is guarded by a fence placed after its last reader, writer waits on it before reuse
+// Without ARB_buffer_storage writes go to a cpu copy and are uploaded by glBufferSubData in endWrite
+// Buffers are bound to target for every call, DSA would need GL 4.5
+class StreamBuffer {
+public:
+	GLuint bufferid;
+	GLenum target;
+	uint segmentSize; // Bytes of one segment, aligned to offset alignment of target
+	uint current;
+	bool persistent;
+	u64 waitCount; // Times writer found its segment still in use
+private:
+	byte* mapped;
+	byte* staging;
+	GLsync fences[STREAM_SEGMENTS];
+private:
+	void waitFence(uint segment);
+public:
+	StreamBuffer(GLenum bufferTarget, uint size);
+	~StreamBuffer();
+	void* beginWrite();
+	void endWrite(uint size);
+	void bindRange(int base, uint size);
+	void unbindRange(int base);
+	void fence();
+	uint offset() { return current * segmentSize; }
+	static bool Supported();
+};
+
+#endif
@@ -5,19 +5,17 @@
 const uint VertexSlot = 0;
 const uint NormalSlot = 1;
 const uint TexcoordSlot = 2;
-const uint TexidSlot = 3;
-const uint ColorSlot = 4;
+const uint MaterialSlot = 3;
 const uint TangentSlot = 5;
 
 // VBO index
 const uint VertexIndex = 0;
 const uint NormalIndex = 1;
 const uint TexcoordIndex = 2;
-const uint TexidIndex = 3;
-const uint ColorIndex = 4;
-const uint TangentIndex = 5;
-const uint OutIndex = 6;
-const uint IndirectIndex = 7;
+const uint MaterialIndex = 3;
+const uint TangentIndex = 4;
+const uint OutIndex = 5;
+const uint IndirectIndex = 6;
 
 // SSBO index
 const uint BoundCenterIndex = 0;
@@ -45,12 +43,11 @@ TerrainDrawcall::TerrainDrawcall(Terrain* terrain, Batch* batch) {
 }
 
 RenderBuffer* TerrainDrawcall::createBuffers() {
-	RenderBuffer* buffer = new RenderBuffer(8);
+	RenderBuffer* buffer = new RenderBuffer(7);
 	buffer->setAttribData(GL_ARRAY_BUFFER, VertexIndex, VertexSlot, GL_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, data->vertexBuffer);
 	buffer->setAttribData(GL_ARRAY_BUFFER, NormalIndex, NormalSlot, GL_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, data->normalBuffer);
-	buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, TexcoordSlot, GL_FLOAT, vertexCount, 4, 1, false, GL_STATIC_DRAW, 0, data->texcoordBuffer);
-	buffer->setAttribData(GL_ARRAY_BUFFER, TexidIndex, TexidSlot, GL_FLOAT, vertexCount, 4, 1, false, GL_STATIC_DRAW, 0, data->texidBuffer);
-	buffer->setAttribData(GL_ARRAY_BUFFER, ColorIndex, ColorSlot, GL_UNSIGNED_BYTE, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, data->colorBuffer);
+	buffer->setAttribData(GL_ARRAY_BUFFER, TexcoordIndex, TexcoordSlot, GL_FLOAT, vertexCount, 2, 1, false, GL_STATIC_DRAW, 0, data->texcoordBuffer);
+	buffer->setAttribData(GL_ARRAY_BUFFER, MaterialIndex, MaterialSlot, GL_UNSIGNED_SHORT, vertexCount, 1, 1, false, GL_STATIC_DRAW, 0, data->materialBuffer);
 	buffer->setAttribData(GL_ARRAY_BUFFER, TangentIndex, TangentSlot, GL_FLOAT, vertexCount, 3, 1, false, GL_STATIC_DRAW, 0, data->tangentBuffer);
 	buffer->setBufferData(GL_SHADER_STORAGE_BUFFER, OutIndex, GL_UNSIGNED_INT, maxIndexCount, GL_STREAM_DRAW, NULL);
 	buffer->useAs(OutIndex, GL_ELEMENT_ARRAY_BUFFER);
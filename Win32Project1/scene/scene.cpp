@@ -26,6 +26,8 @@ Scene::Scene() {
 	staticRoot = NULL;
 	billboardRoot = NULL;
 	animationRoot = NULL;
+	staticTree = NULL;
+	animationTree = NULL;
 	initNodes();
 	boundingNodes.clear();
 	meshCount.clear();
@@ -37,6 +39,7 @@ Scene::Scene() {
 	dynamicObjects.clear();
 	Node::nodesToUpdate.clear();
 	Node::nodesToRemove.clear();
+	Node::nodesToRefit.clear();
 	Instance::instanceTable.clear();
 
 	collisionWorld = new DynamicWorld();
@@ -57,6 +60,8 @@ Scene::~Scene() {
 	if (staticRoot) delete staticRoot; staticRoot = NULL;
 	if (billboardRoot) delete billboardRoot; billboardRoot = NULL;
 	if (animationRoot) delete animationRoot; animationRoot = NULL;
+	if (staticTree) delete staticTree; staticTree = NULL;
+	if (animationTree) delete animationTree; animationTree = NULL;
 	meshCount.clear();
 	clearAllAABB();
 	for (uint i = 0; i < meshes.size(); ++i)
@@ -79,6 +84,8 @@ void Scene::initNodes() {
 	staticRoot = new StaticNode(vec3(0, 0, 0));
 	billboardRoot = new StaticNode(vec3(0, 0, 0));
 	animationRoot = new StaticNode(vec3(0, 0, 0));
+	staticTree = new BVH(staticRoot);
+	animationTree = new BVH(animationRoot);
 }
 
 void Scene::updateNodes() {
@@ -89,6 +96,23 @@ void Scene::updateNodes() {
 	Node::nodesToUpdate.clear();
 }
 
+// Rebuild bounding trees after nodes attached or removed, otherwise just refit changed nodes
+void Scene::updateTrees() {
+	if (staticTree->needRebuild() || animationTree->needRebuild()) {
+		staticTree->build();
+		animationTree->build();
+	} else {
+		uint size = Node::nodesToRefit.size();
+		for (uint i = 0; i < size; i++) {
+			Node* node = Node::nodesToRefit[i];
+			staticTree->refit(node);
+			animationTree->refit(node);
+			node->needRefit = false;
+		}
+	}
+	Node::nodesToRefit.clear();
+}
+
 void Scene::flushNodes() {
 	uint size = Node::nodesToRemove.size();
 	if (size == 0) return;
@@ -215,39 +239,22 @@ void Scene::clearAllAABB() {
 
 void Scene::addObject(Object* object) {
 	Mesh* cur = object->mesh;
-	if (cur) {
-		if (meshCount.find(cur) == meshCount.end()) {
-			meshCount[cur] = 0;
-			meshes.push_back(new MeshObject(cur, object));
-		}
-		meshCount[cur]++;
-	}
+	if (cur) addMesh(cur, object);
 	cur = object->meshMid;
-	if (cur && cur != object->mesh) {
-		if (meshCount.find(cur) == meshCount.end()) {
-			meshCount[cur] = 0;
-			meshes.push_back(new MeshObject(cur, object));
-		}
-		meshCount[cur]++;
-	}
+	if (cur && cur != object->mesh) addMesh(cur, object);
 	cur = object->meshLow;
-	if (cur && cur != object->meshMid && cur != object->mesh) {
-		if (meshCount.find(cur) == meshCount.end()) {
-			meshCount[cur] = 0;
-			meshes.push_back(new MeshObject(cur, object));
-		}
-		meshCount[cur]++;
-	}
+	if (cur && cur != object->meshMid && cur != object->mesh) addMesh(cur, object);
 	
 	if (!object->mesh) { // Animation object
 		AnimationObject* animObj = (AnimationObject*)object;
 		if (animObj) {
 			Animation* curAnim = animObj->animation;
-			if (animCount.find(curAnim) == animCount.end()) {
-				animCount[curAnim] = 0;
+			if (!hasAnimation(curAnim)) {
+				curAnim->animId = anims.size();
 				anims.push_back(curAnim);
+				animCount.push_back(0);
 			}
-			animCount[curAnim]++;
+			animCount[curAnim->animId]++;
 			if (animObj->parent)
 				animationNodes.push_back((AnimationNode*)(animObj->parent));
 		}
@@ -259,6 +266,9 @@ void Scene::addObject(Object* object) {
 	
 	object->caculateCollisionShape();
 	CollisionObject* cob = object->initCollisionObject();
+	// Place body before it enters broadphase, bodies piled up at origin would all pair with each other
+	if (object->parent)
+		cob->initTransform(GetTranslate(object->parent->nodeTransform * object->translateMat), object->rotateQuat);
 	collisionWorld->addObject(cob);
 }
 
@@ -266,10 +276,18 @@ void Scene::addPlay(AnimationNode* node) {
 	animPlayers.push_back(node);
 }
 
+// Give mesh a dense id when scene first meets it
+void Scene::addMesh(Mesh* mesh, Object* object) {
+	if (!hasMesh(mesh)) {
+		mesh->meshId = meshes.size();
+		meshes.push_back(new MeshObject(mesh, object));
+		meshCount.push_back(0);
+	}
+	meshCount[mesh->meshId]++;
+}
+
 uint Scene::queryMeshCount(Mesh* mesh) {
-	if (meshCount.find(mesh) == meshCount.end())
-		meshCount[mesh] = 0;
-	return meshCount[mesh];
+	return hasMesh(mesh) ? meshCount[mesh->meshId] : 0;
 }
 
 void Scene::initAnimNodes() {
@@ -322,8 +340,9 @@ void Scene::updateAnimNodes() {
 		if (!object->collisionObject || object->collisionObject->isStatic()) continue;
 
 		synPhysics2Graphic(node, object); // Read back collision transform
-		terrainNode->standObjectsOnGround(this, node); // Stand animation nodes on ground after collision (no terrain collision)
+		if (terrainNode) terrainNode->standObjectsOnGround(this, node); // Stand animation nodes on ground after collision (no terrain collision)
 		node->boundingBox->update(GetTranslate(node->nodeTransform)); // Update bounding box after terrain collision
+		node->pushToRefit();
 		Node* superior = node->parent;
 		while (superior) {
 			superior->updateBounding();
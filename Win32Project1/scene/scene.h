@@ -13,6 +13,7 @@
 #include "../node/animationNode.h"
 #include "../node/instanceNode.h"
 #include "../sky/sky.h"
+#include "../bounding/bvh.h"
 #include "player.h"
 
 struct MeshObject {
@@ -27,12 +28,13 @@ public:
 	std::vector<MeshObject*> meshes;
 	std::vector<Animation*> anims;
 public:
-	std::map<Animation*, uint> animCount;
+	std::vector<uint> animCount; // Indexed by Animation::animId
 private:
-	std::map<Mesh*, uint> meshCount;
+	std::vector<uint> meshCount; // Indexed by Mesh::meshId
 	bool inited;
 private:
 	void initNodes();
+	void addMesh(Mesh* mesh, Object* object);
 public:
 	float time, velocity;
 	Camera* actCamera;
@@ -44,6 +46,8 @@ public:
 	Node* staticRoot;
 	Node* billboardRoot;
 	Node* animationRoot;
+	BVH* staticTree;
+	BVH* animationTree;
 	Node* noise3d;
 	Player* player;
 	StaticNode* textureNode; // Use it to draw texture for debugging
@@ -61,11 +65,14 @@ public:
 	void createTerrain(const vec3& position, const vec3& size);
 	void updateVisualTerrain(int bx, int bz, int sizex, int sizez);
 	void updateNodes();
+	void updateTrees();
 	void flushNodes();
 	void updateReflectCamera();
 	void addObject(Object* object);
 	void addPlay(AnimationNode* node);
 	uint queryMeshCount(Mesh* mesh);
+	bool hasMesh(Mesh* mesh) { return mesh->meshId >= 0 && mesh->meshId < (int)meshes.size() && meshes[mesh->meshId]->mesh == mesh; }
+	bool hasAnimation(Animation* anim) { return anim->animId >= 0 && anim->animId < (int)anims.size() && anims[anim->animId] == anim; }
 	void finishInit() { inited = true; }
 	bool isInited() { return inited; }
 	void act(float dTime) { time = dTime * 0.025; }
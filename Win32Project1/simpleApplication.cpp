@@ -161,6 +161,7 @@ void SimpleApplication::preDraw() {
 void SimpleApplication::draw() {
 	if (!sceneFilter || !renderMgr || !AssetManager::assetManager) return;
 	else preDraw();
+	renderMgr->updateMaterials();
 
 	if (ssrChain) {
 		AssetManager::assetManager->setReflectTexture(ssrBlurFilter->getOutput(0));
@@ -254,13 +255,15 @@ void SimpleApplication::updateMovement() {
 }
 
 void SimpleApplication::act(long startTime, long currentTime, float dTime, float velocity) {
-	wheelAct();
-	if (wheelDir != MNONE) {
-		scene->player->wheelAct(wheelDir == MNEAR ? -1.0 : 1.0);
-		wheelDir = MNONE;
+	if (!cameraPath->isReplaying()) { // Replay takes camera from path only
+		wheelAct();
+		if (wheelDir != MNONE) {
+			scene->player->wheelAct(wheelDir == MNEAR ? -1.0 : 1.0);
+			wheelDir = MNONE;
+		}
+		keyAct(velocity);
+		scene->player->controlAct(input, scene, velocity * 0.05);
 	}
-	keyAct(velocity);
-	scene->player->controlAct(input, scene, velocity * 0.05);
 
 	Application::act(startTime, currentTime, dTime, velocity);
 
@@ -310,21 +313,22 @@ void SimpleApplication::initScene() {
 	MaterialManager* mtlMgr = MaterialManager::materials;
 
 	// Load meshes
-	assetMgr->addMesh("tree", new Model("models/firC.obj", "models/firC.mtl", 2));
-	assetMgr->addMesh("treeMid", new Model("models/firC_mid.obj", "models/firC_mid.mtl", 2));
-	assetMgr->addMesh("treeLow", new Model("models/fir_mesh.obj", "models/fir_mesh.mtl", 3));
-	assetMgr->addMesh("treeA", new Model("models/treeA.obj", "models/treeA.mtl", 2));
-	assetMgr->addMesh("treeAMid", new Model("models/treeA_mid.obj", "models/treeA_mid.mtl", 2));
-	assetMgr->addMesh("treeALow", new Model("models/treeA_low.obj", "models/treeA_low.mtl", 2));
-	assetMgr->addMesh("birch", new Model("models/birchB.obj", "models/birchB.mtl", 2));
-	assetMgr->addMesh("bigtree", new Model("models/bigtreeC.obj", "models/bigtreeC.mtl", 3));
-	assetMgr->addMesh("tank", new Model("models/tank.obj", "models/tank.mtl", 3));
-	assetMgr->addMesh("m1a2", new Model("models/m1a2.obj", "models/m1a2.mtl", 2));
-	assetMgr->addMesh("house", new Model("models/house.obj", "models/house.mtl", 2));
-	assetMgr->addMesh("oildrum", new Model("models/oildrum.obj", "models/oildrum.mtl", 3));
-	assetMgr->addMesh("rock", new Model("models/sharprockfree.obj", "models/sharprockfree.mtl", 2));
-	assetMgr->addMesh("rock_low", new Model("models/sharprockfree_low.obj", "models/sharprockfree_low.mtl", 2));
-	assetMgr->addMesh("cottage", new Model("models/cottage_obj.obj", "models/cottage_obj.mtl", 2));
+	// Trees & rock come with hand made lods or are given their lods by objects, so none are generated for them
+	assetMgr->addMesh("tree", "models/firC.obj", "models/firC.mtl", 2, false, true, false);
+	assetMgr->addMesh("treeMid", "models/firC_mid.obj", "models/firC_mid.mtl", 2, false, true, false);
+	assetMgr->addMesh("treeLow", "models/fir_mesh.obj", "models/fir_mesh.mtl", 3, false, true, false);
+	assetMgr->addMesh("treeA", "models/treeA.obj", "models/treeA.mtl", 2, false, true, false);
+	assetMgr->addMesh("treeAMid", "models/treeA_mid.obj", "models/treeA_mid.mtl", 2, false, true, false);
+	assetMgr->addMesh("treeALow", "models/treeA_low.obj", "models/treeA_low.mtl", 2, false, true, false);
+	assetMgr->addMesh("birch", "models/birchB.obj", "models/birchB.mtl", 2, false, true, false);
+	assetMgr->addMesh("bigtree", "models/bigtreeC.obj", "models/bigtreeC.mtl", 3, false, true, false);
+	assetMgr->addMesh("tank", "models/tank.obj", "models/tank.mtl", 3);
+	assetMgr->addMesh("m1a2", "models/m1a2.obj", "models/m1a2.mtl", 2);
+	assetMgr->addMesh("house", "models/house.obj", "models/house.mtl", 2);
+	assetMgr->addMesh("oildrum", "models/oildrum.obj", "models/oildrum.mtl", 3);
+	assetMgr->addMesh("rock", "models/sharprockfree.obj", "models/sharprockfree.mtl", 2, false, true, false);
+	assetMgr->addMesh("rock_low", "models/sharprockfree_low.obj", "models/sharprockfree_low.mtl", 2, false, true, false);
+	assetMgr->addMesh("cottage", "models/cottage_obj.obj", "models/cottage_obj.mtl", 2);
 	assetMgr->addMesh("terrain", new Terrain("terrain/Terrain.raw"));
 	assetMgr->addMesh("water", new Water(1024, 16));
 
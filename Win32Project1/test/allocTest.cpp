@@ -0,0 +1,78 @@
+#include "test.h"
+#include "../benchmark/benchmark.h"
+#include "../render/renderManager.h"
+#include "../render/renderRing.h"
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+#include <map>
+
+#define ALLOC_TEST_OBJECTS 5000
+#define ALLOC_TEST_WORKERS 3
+
+// Every operator new of tests executable is counted while counting is on, on any thread
+static std::atomic<int> AllocCount(0);
+static std::atomic<bool> AllocCounting(false);
+
+void* operator new(size_t size) {
+	if (AllocCounting.load(std::memory_order_relaxed)) AllocCount++;
+	void* ptr = malloc(size > 0 ? size : 1);
+	if (!ptr) throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void StartAllocCount() {
+	AllocCount = 0;
+	AllocCounting = true;
+}
+
+int StopAllocCount() {
+	AllocCounting = false;
+	return AllocCount;
+}
+
+// Chunks frame arenas of a frame's queues got from malloc, they are not seen by operator new
+static int GetArenaChunks(Renderable* frame) {
+	int chunks = 0;
+	for (uint q = 0; q < frame->queues.size(); q++)
+		chunks += frame->queues[q]->getArena()->getChunkCount();
+	return chunks;
+}
+
+// One lap of bench orbit warms queues, arenas & job rings up, second lap sees the same views
+// and must not touch the heap in any stage of any frame
+bool TestFrameAllocs() {
+	BenchSceneDesc desc;
+	desc.objectCount = ALLOC_TEST_OBJECTS;
+	desc.staticRatio = 0.05;
+	desc.dynamicRatio = 0.01;
+	desc.animRatio = 0.01;
+	desc.seed = 100;
+
+	BenchmarkApplication* app = new BenchmarkApplication(desc);
+	app->cfgs->workers = ALLOC_TEST_WORKERS;
+	app->init();
+	BenchStage stages[STAGE_COUNT];
+	std::map<Renderable*, int> warmChunks;
+	for (int f = 0; f < BENCH_FRAMES; f++) {
+		app->runFrame(f, stages, false);
+		warmChunks[app->renderMgr->currentQueue] = GetArenaChunks(app->renderMgr->currentQueue);
+	}
+
+	int frameAllocs = 0, grownArenas = 0;
+	for (int f = BENCH_FRAMES; f < BENCH_FRAMES * 2; f++) {
+		StartAllocCount();
+		app->runFrame(f, stages, false);
+		frameAllocs += StopAllocCount();
+		if (GetArenaChunks(app->renderMgr->currentQueue) > warmChunks[app->renderMgr->currentQueue]) grownArenas++;
+	}
+	printf("    %d frames: %d heap allocations, %d frames grew an arena\n", BENCH_FRAMES, frameAllocs, grownArenas);
+	delete app;
+	TEST_CHECK(frameAllocs == 0);
+	TEST_CHECK(grownArenas == 0);
+	return true;
+}
@@ -0,0 +1,118 @@
+#include "test.h"
+#include "../animation/animFile.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#define ANIM_TEST_BONES 6
+#define ANIM_TEST_FRAMES 40
+#define ANIM_TEST_PATH "animfile_test.t3a"
+
+// Bones turn around y & move up at their own rates, rows are 3 rotation values then translation
+static AnimFrame* CreateTestClip() {
+	AnimFrame* clip = new AnimFrame("test");
+	clip->setDuration(ANIM_TEST_FRAMES - 1);
+	clip->setTicksPerSecond(30.0f);
+	for (int f = 0; f < ANIM_TEST_FRAMES; f++) {
+		Frame* frame = new Frame(ANIM_TEST_BONES);
+		for (int b = 0; b < ANIM_TEST_BONES; b++) {
+			float angle = f * 0.05f * (b + 1), c = cosf(angle), s = sinf(angle);
+			float rows[12] = { c, 0.0f, s, (float)b, 0.0f, 1.0f, 0.0f, f * 0.1f, -s, 0.0f, c, 0.5f * b };
+			memcpy(frame->data + b * ANIM_BONE_FLOATS, rows, sizeof(rows));
+		}
+		clip->frames.push_back(frame);
+	}
+	return clip;
+}
+
+// Largest difference of loaded frame texture to clip's frames
+static float MaxFrameError(const AnimFile& file, const AnimFrame* clip) {
+	float maxError = 0.0f;
+	for (int f = 0; f < ANIM_TEST_FRAMES; f++) {
+		const float* loaded = file.data + f * ANIM_TEST_BONES * ANIM_BONE_FLOATS;
+		for (int i = 0; i < ANIM_TEST_BONES * ANIM_BONE_FLOATS; i++) {
+			float error = fabsf(loaded[i] - clip->frames[f]->data[i]);
+			maxError = error > maxError ? error : maxError;
+		}
+	}
+	return maxError;
+}
+
+static bool CheckLoaded(const AnimFile& file, const AnimFrame* clip, uint format) {
+	TEST_CHECK(file.data && file.format == format);
+	TEST_CHECK(file.boneCount == ANIM_TEST_BONES && file.frameCount == ANIM_TEST_FRAMES);
+	TEST_CHECK(file.duration == clip->duration && file.ticksPerSecond == clip->ticksPerSecond);
+	return true;
+}
+
+// Float v2 file as the v2 writer left it, header ends before keyCount & frames start at next aligned offset
+static bool WriteV2File(const AnimFrame* clip, const char* path, uint format) {
+	uint headerSize = offsetof(AnimFileHeader, keyCount);
+	uint offset = (headerSize + ANIM_FILE_ALIGN - 1) / ANIM_FILE_ALIGN * ANIM_FILE_ALIGN;
+	uint frameSize = ANIM_TEST_BONES * ANIM_BONE_FLOATS * sizeof(float);
+	AnimFileHeader header;
+	memset(&header, 0, sizeof(AnimFileHeader));
+	header.magic = ANIM_FILE_MAGIC;
+	header.version = 2;
+	header.format = format;
+	header.boneCount = ANIM_TEST_BONES, header.frameCount = ANIM_TEST_FRAMES;
+	header.duration = clip->duration, header.ticksPerSecond = clip->ticksPerSecond;
+	header.offsets[ANIM_SECTION_FRAMES] = offset, header.sizes[ANIM_SECTION_FRAMES] = frameSize * ANIM_TEST_FRAMES;
+	header.offsets[ANIM_SECTION_TRANSLATIONS] = offset + header.sizes[ANIM_SECTION_FRAMES];
+	FILE* out = fopen(path, "wb");
+	if (!out) return false;
+	char padding[ANIM_FILE_ALIGN] = { 0 };
+	fwrite(&header, 1, headerSize, out);
+	fwrite(padding, 1, offset - headerSize, out);
+	for (int f = 0; f < ANIM_TEST_FRAMES; f++)
+		fwrite(clip->frames[f]->data, 1, frameSize, out);
+	fclose(out);
+	return true;
+}
+
+// Clip saved as float, quantized & key v3 files and as a hand written v2 file must load back
+// v2 files claiming key format have no key sections and are rejected
+bool TestAnimFiles() {
+	AnimFrame* clip = CreateTestClip();
+	AnimFile file;
+	bool passed = true;
+
+	TEST_CHECK(SaveAnimFile(clip, ANIM_TEST_PATH, false) && IsAnimFile(ANIM_TEST_PATH));
+	passed = passed && file.load(ANIM_TEST_PATH) && CheckLoaded(file, clip, ANIM_FORMAT_FLOAT);
+	float floatError = passed ? MaxFrameError(file, clip) : 1.0f;
+
+	TEST_CHECK(SaveAnimFile(clip, ANIM_TEST_PATH, true));
+	passed = passed && file.load(ANIM_TEST_PATH) && CheckLoaded(file, clip, ANIM_FORMAT_QUANTIZED);
+	float quantError = passed ? MaxFrameError(file, clip) : 1.0f;
+
+	AnimCompressor compressor;
+	TEST_CHECK(compressor.compress(clip) && SaveAnimKeyFile(clip, ANIM_TEST_PATH, &compressor));
+	passed = passed && file.load(ANIM_TEST_PATH) && CheckLoaded(file, clip, ANIM_FORMAT_KEYS);
+	float keyError = 0.0f;
+	for (int f = 0; passed && f < ANIM_TEST_FRAMES; f++) {
+		for (int b = 0; b < ANIM_TEST_BONES; b++) {
+			int i = (f * ANIM_TEST_BONES + b) * ANIM_BONE_FLOATS;
+			float error = GetBoneError(file.data + i, clip->frames[f]->data + b * ANIM_BONE_FLOATS, compressor.shell);
+			keyError = error > keyError ? error : keyError;
+		}
+	}
+
+	TEST_CHECK(WriteV2File(clip, ANIM_TEST_PATH, ANIM_FORMAT_FLOAT) && IsAnimFile(ANIM_TEST_PATH));
+	passed = passed && file.load(ANIM_TEST_PATH) && CheckLoaded(file, clip, ANIM_FORMAT_FLOAT);
+	float v2Error = passed ? MaxFrameError(file, clip) : 1.0f;
+	TEST_CHECK(WriteV2File(clip, ANIM_TEST_PATH, ANIM_FORMAT_KEYS));
+	bool v2Keys = file.load(ANIM_TEST_PATH);
+	file.release();
+	remove(ANIM_TEST_PATH);
+
+	printf("    float error %g, quantized error %g of scale 1, key error %g of tolerance %g, v2 error %g, v2 keys %s\n",
+		floatError, quantError, keyError, compressor.tolerance, v2Error, v2Keys ? "loaded" : "rejected");
+	delete clip;
+	TEST_CHECK(passed);
+	TEST_CHECK(floatError == 0.0f && v2Error == 0.0f);
+	TEST_CHECK(quantError <= 0.5f / 32767.0f + 0.000001f);
+	TEST_CHECK(keyError <= compressor.tolerance * 1.001f);
+	TEST_CHECK(!v2Keys);
+	return true;
+}
@@ -0,0 +1,70 @@
+#include "test.h"
+#include "../bounding/bvh.h"
+#include <stdlib.h>
+#include <vector>
+
+#define BVH_TEST_TREES 32
+#define BVH_TEST_MAX_DEPTH 6
+#define BVH_TEST_MAX_PARTS 16
+
+// Flattened nodes as BVH::flattenNode lays them out, leaves get random object counts, some none
+static void AddTestNode(BVH* tree, int depth) {
+	int i = tree->nodeCount++;
+	tree->nodeSkip.push_back(0);
+	tree->nodeObjStart.push_back(tree->objectCount);
+	tree->nodeObjCount.push_back(0);
+	if (depth > 0 && (depth >= BVH_TEST_MAX_DEPTH || rand() % 4 == 0)) {
+		int objects = rand() % 8 == 0 ? 0 : 1 + rand() % 300;
+		tree->nodeObjCount[i] = objects;
+		tree->objectCount += objects;
+	} else {
+		int children = depth == 0 ? 1 + rand() % 8 : rand() % 5;
+		for (int c = 0; c < children; c++)
+			AddTestNode(tree, depth + 1);
+	}
+	tree->nodeSkip[i] = tree->nodeCount;
+}
+
+// Ranges of splitRanges must be ordered, start at subtree roots & hold every object exactly once
+bool TestBVHSplit() {
+	srand(4);
+	float worst = 0.0f;
+	for (int t = 0; t < BVH_TEST_TREES; t++) {
+		BVH tree(NULL);
+		AddTestNode(&tree, 0);
+		for (int parts = 1; parts <= BVH_TEST_MAX_PARTS; parts++) {
+			int starts[BVH_TEST_MAX_PARTS], ends[BVH_TEST_MAX_PARTS];
+			int count = tree.splitRanges(parts, starts, ends);
+			TEST_CHECK(count >= 0 && count <= parts);
+			TEST_CHECK(tree.objectCount == 0 || count > 0);
+
+			std::vector<int> covered(tree.objectCount, 0);
+			int largest = 0, largestLeaf = 0;
+			for (int i = 0; i < tree.nodeCount; i++)
+				largestLeaf = tree.nodeObjCount[i] > largestLeaf ? tree.nodeObjCount[i] : largestLeaf;
+			for (int r = 0; r < count; r++) {
+				TEST_CHECK(starts[r] < ends[r] && ends[r] <= tree.nodeCount);
+				TEST_CHECK(r == 0 || starts[r] >= ends[r - 1]);
+				TEST_CHECK(tree.nodeSkip[starts[r]] <= ends[r]);
+				int objects = 0;
+				for (int i = starts[r]; i < ends[r]; i++) {
+					for (int o = 0; o < tree.nodeObjCount[i]; o++)
+						covered[tree.nodeObjStart[i] + o]++;
+					objects += tree.nodeObjCount[i];
+				}
+				largest = objects > largest ? objects : largest;
+			}
+			for (int o = 0; o < tree.objectCount; o++)
+				TEST_CHECK(covered[o] == 1);
+
+			// No split beats an even share or largest leaf, a range passes it by one subtree at most
+			int bound = (tree.objectCount + parts - 1) / parts;
+			bound = largestLeaf > bound ? largestLeaf : bound;
+			TEST_CHECK(largest <= bound * 2 + 1);
+			float share = bound > 0 ? largest / (float)bound : 0.0f;
+			worst = share > worst ? share : worst;
+		}
+	}
+	printf("    largest range holds %.2f times the best possible\n", worst);
+	return true;
+}
@@ -0,0 +1,72 @@
+#include "test.h"
+#include "../benchmark/benchmark.h"
+#include "../render/renderManager.h"
+#include "../render/renderRing.h"
+#include <string.h>
+#include <vector>
+
+#define CULL_TEST_OBJECTS 5000
+#define CULL_TEST_FRAMES 20
+
+// Per frame of the bench orbit & per queue: instance count of each mesh, tree index of each node in queue order
+// and record bytes of each stream group, which hold culled objects in cull order
+static void CullBenchScene(int workers, std::vector<int>& counts, std::vector<int>& nodes, std::vector<buff>& records) {
+	BenchSceneDesc desc;
+	desc.objectCount = CULL_TEST_OBJECTS;
+	desc.staticRatio = 0.05;
+	desc.dynamicRatio = 0.01;
+	desc.animRatio = 0.01;
+	desc.seed = 100;
+
+	BenchmarkApplication* app = new BenchmarkApplication(desc);
+	app->cfgs->workers = workers;
+	app->init();
+	BenchStage stages[STAGE_COUNT];
+	for (int f = 0; f < CULL_TEST_FRAMES; f++) {
+		app->runFrame(f, stages, false);
+		Renderable* frame = app->renderMgr->currentQueue;
+		for (uint q = 0; q < frame->queues.size(); q++) {
+			RenderQueue* queue = frame->queues[q];
+			Queue* queued = queue->getQueue();
+			nodes.push_back(queued->size);
+			for (int n = 0; n < queued->size; n++)
+				nodes.push_back(queued->get(n)->bvhIndex);
+			InstanceStream* stream = queue->instanceStream;
+			if (!stream) continue;
+			for (uint i = 0; i < queue->instanceQueue.size(); i++)
+				counts.push_back(queue->instanceQueue[i]->count);
+			for (int g = 0; g < RECORD_GROUPS; g++) {
+				counts.push_back(stream->counts[g]);
+				const buff* first = stream->records + stream->firsts[g] * INSTANCE_RECORD;
+				records.insert(records.end(), first, first + stream->counts[g] * INSTANCE_RECORD);
+			}
+		}
+	}
+	delete app;
+}
+
+// Static tree cut into subtree ranges over job workers must fill queues exactly as serial walk does,
+// same nodes in same order and same records byte for byte, whatever order the tasks ran in
+bool TestCullTasks() {
+	std::vector<int> serialCounts, serialNodes;
+	std::vector<buff> serialRecords;
+	CullBenchScene(0, serialCounts, serialNodes, serialRecords);
+	TEST_CHECK(serialCounts.size() > 0 && serialRecords.size() > 0);
+	printf("    %d counts, %d node entries, %d records compared\n", (int)serialCounts.size(), (int)serialNodes.size(),
+		(int)serialRecords.size() / INSTANCE_RECORD);
+
+	int workerCounts[] = { 1, 3, 7 };
+	for (int w = 0; w < 3; w++) {
+		std::vector<int> counts, nodes;
+		std::vector<buff> records;
+		CullBenchScene(workerCounts[w], counts, nodes, records);
+		bool sameRecords = records.size() == serialRecords.size() &&
+			memcmp(&records[0], &serialRecords[0], records.size() * sizeof(buff)) == 0;
+		printf("    %d workers: counts %s, nodes %s, records %s\n", workerCounts[w], counts == serialCounts ? "same" : "differ",
+			nodes == serialNodes ? "same" : "differ", sameRecords ? "same" : "differ");
+		TEST_CHECK(counts == serialCounts);
+		TEST_CHECK(nodes == serialNodes);
+		TEST_CHECK(sameRecords);
+	}
+	return true;
+}
@@ -0,0 +1,161 @@
+#include "test.h"
+#include "../bounding/aabb.h"
+#include "../bounding/frustumCull.h"
+#include "../camera/camera.h"
+#include "../benchmark/benchUtil.h"
+#include <stdlib.h>
+
+#define FRUSTUM_TEST_VIEWS 16
+#define FRUSTUM_TEST_BOXES 4096
+#define FRUSTUM_BENCH_BOXES 100000
+#define FRUSTUM_BENCH_RUNS 20
+
+enum BoxSide {
+	BOX_INSIDE, // All corners inside all planes
+	BOX_OUTSIDE, // All corners outside one plane
+	BOX_STRADDLE // Neither, box crosses at least one plane
+};
+
+static float RandRange(float min, float max) {
+	return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+static BoxSide GetBoxSide(const Frustum* frustum, const vec3& minVertex, const vec3& maxVertex) {
+	bool inside = true;
+	for (int p = 0; p < 6; p++) {
+		int out = 0;
+		for (int c = 0; c < 8; c++) {
+			vec3 corner((c & 1) ? maxVertex.x : minVertex.x, (c & 2) ? maxVertex.y : minVertex.y, (c & 4) ? maxVertex.z : minVertex.z);
+			if (frustum->normals[p].DotProduct(corner) + frustum->ds[p] < 0.0f) out++;
+		}
+		if (out == 8) return BOX_OUTSIDE;
+		if (out > 0) inside = false;
+	}
+	return inside ? BOX_INSIDE : BOX_STRADDLE;
+}
+
+// Boxes around view, some of them large enough to hold whole near part of frustum
+static void RandomBoxes(const Camera* camera, int count, float* mins[3], float* maxs[3]) {
+	for (int i = 0; i < count; i++) {
+		float depth = RandRange(-20.0f, camera->zFar * 1.2f);
+		vec3 center = camera->position + camera->lookDir * depth;
+		float spread = depth > 10.0f ? depth : 10.0f;
+		float size = (rand() % 16) == 0 ? RandRange(20.0f, 200.0f) : RandRange(0.1f, 20.0f);
+		float c[3] = { center.x + RandRange(-spread, spread), center.y + RandRange(-spread, spread), center.z + RandRange(-spread, spread) };
+		for (int k = 0; k < 3; k++) {
+			float extent = size * RandRange(0.2f, 1.0f);
+			mins[k][i] = c[k] - extent;
+			maxs[k][i] = c[k] + extent;
+		}
+	}
+}
+
+static void SetTestView(Camera* camera, int view) {
+	camera->initPerspectCamera(RandRange(30.0f, 90.0f), RandRange(1.0f, 2.0f), 1.0f, RandRange(100.0f, 1000.0f));
+	vec3 dir(RandRange(-1.0f, 1.0f), RandRange(-0.5f, 0.5f), RandRange(-1.0f, 1.0f));
+	if (view == 0) dir = vec3(0.0f, 0.0f, -1.0f);
+	dir.Normalize();
+	camera->updateLook(vec3(RandRange(-100.0f, 100.0f), RandRange(0.0f, 50.0f), RandRange(-100.0f, 100.0f)), dir);
+}
+
+// Plane test against AABB::checkWithCamera on the same boxes
+// Inside & outside boxes must agree with levels 1 & 2. Straddling boxes are always kept by the plane
+// test, while checkWithCamera at level 1 drops those without a corner inside frustum
+// Whatever levels 1 & 2 keep, plane test & batch kernels must keep too. Ray tests of levels 3 & 4
+// also keep some boxes outside one plane, those are only counted
+bool TestFrustumCull() {
+	srand(2);
+	Camera camera(0.0f);
+	float* mins[3]; float* maxs[3];
+	for (int k = 0; k < 3; k++) {
+		mins[k] = (float*)malloc(FRUSTUM_BENCH_BOXES * sizeof(float));
+		maxs[k] = (float*)malloc(FRUSTUM_BENCH_BOXES * sizeof(float));
+	}
+	uint* visibility = (uint*)malloc((FRUSTUM_BENCH_BOXES / CULL_MASK_BITS + 1) * sizeof(uint));
+
+	int sides[3] = { 0, 0, 0 }, straddleKept = 0, straddleLevel1 = 0, straddleLevel2 = 0, outsideLevel4 = 0;
+	bool passed = true;
+	for (int v = 0; v < FRUSTUM_TEST_VIEWS && passed; v++) {
+		SetTestView(&camera, v);
+		Frustum* frustum = camera.frustum;
+		RandomBoxes(&camera, FRUSTUM_TEST_BOXES, mins, maxs);
+		CheckBoxesWithFrustum(frustum, FRUSTUM_TEST_BOXES, mins[0], mins[1], mins[2], maxs[0], maxs[1], maxs[2], visibility);
+
+		for (int i = 0; i < FRUSTUM_TEST_BOXES && passed; i++) {
+			vec3 minVertex(mins[0][i], mins[1][i], mins[2][i]), maxVertex(maxs[0][i], maxs[1][i], maxs[2][i]);
+			AABB box(minVertex, maxVertex);
+			bool planes = CheckBoxWithFrustum(frustum, minVertex.x, minVertex.y, minVertex.z, maxVertex.x, maxVertex.y, maxVertex.z);
+			uint planeMask = CULL_ALL_PLANES;
+			bool masked = CheckBoxWithFrustumPlanes(frustum, minVertex.x, minVertex.y, minVertex.z, maxVertex.x, maxVertex.y, maxVertex.z, planeMask);
+			bool levels[5];
+			for (int level = 1; level <= 4; level++)
+				levels[level] = box.checkWithCamera(frustum, level);
+
+			passed = planes == CheckVisibleBit(visibility, i) && planes == masked;
+			for (int level = 1; level <= 2 && passed; level++)
+				passed = !levels[level] || planes;
+
+			BoxSide side = GetBoxSide(frustum, minVertex, maxVertex);
+			sides[side]++;
+			if (side == BOX_INSIDE) passed = passed && planes && levels[1] && planeMask == 0;
+			else if (side == BOX_OUTSIDE) {
+				passed = passed && !planes && !levels[1] && !levels[2];
+				outsideLevel4 += levels[4] ? 1 : 0;
+			} else {
+				passed = passed && planes;
+				straddleKept += planes ? 1 : 0;
+				straddleLevel1 += levels[1] ? 1 : 0;
+				straddleLevel2 += levels[2] ? 1 : 0;
+			}
+			if (!passed) printf("    view %d box %d (%g %g %g)-(%g %g %g) side %d: planes %d batch %d levels %d%d%d%d\n",
+				v, i, minVertex.x, minVertex.y, minVertex.z, maxVertex.x, maxVertex.y, maxVertex.z, side,
+				planes, CheckVisibleBit(visibility, i), levels[1], levels[2], levels[3], levels[4]);
+		}
+	}
+	printf("    boxes inside %d, outside %d, straddling %d\n", sides[BOX_INSIDE], sides[BOX_OUTSIDE], sides[BOX_STRADDLE]);
+	printf("    straddling kept: planes %d, checkWithCamera level 1 %d, level 2 %d\n", straddleKept, straddleLevel1, straddleLevel2);
+	printf("    outside kept by checkWithCamera level 4: %d\n", outsideLevel4);
+
+	// Time of each path on the same boxes
+	SetTestView(&camera, 0);
+	RandomBoxes(&camera, FRUSTUM_BENCH_BOXES, mins, maxs);
+	std::vector<AABB*> boxes;
+	for (int i = 0; i < FRUSTUM_BENCH_BOXES; i++)
+		boxes.push_back(new AABB(vec3(mins[0][i], mins[1][i], mins[2][i]), vec3(maxs[0][i], maxs[1][i], maxs[2][i])));
+	double times[3] = { 0.0, 0.0, 0.0 };
+	int visibles[3] = { 0, 0, 0 };
+	for (int run = 0; run < FRUSTUM_BENCH_RUNS; run++) {
+		double start = NowMs();
+		int visible = 0;
+		for (int i = 0; i < FRUSTUM_BENCH_BOXES; i++)
+			visible += boxes[i]->checkWithCamera(camera.frustum, 1) ? 1 : 0;
+		double time = NowMs() - start;
+		times[0] = run == 0 || time < times[0] ? time : times[0], visibles[0] = visible;
+
+		start = NowMs();
+		visible = 0;
+		for (int i = 0; i < FRUSTUM_BENCH_BOXES; i++)
+			visible += CheckBoxWithFrustum(camera.frustum, mins[0][i], mins[1][i], mins[2][i], maxs[0][i], maxs[1][i], maxs[2][i]) ? 1 : 0;
+		time = NowMs() - start;
+		times[1] = run == 0 || time < times[1] ? time : times[1], visibles[1] = visible;
+
+		start = NowMs();
+		CheckBoxesWithFrustum(camera.frustum, FRUSTUM_BENCH_BOXES, mins[0], mins[1], mins[2], maxs[0], maxs[1], maxs[2], visibility);
+		time = NowMs() - start;
+		times[2] = run == 0 || time < times[2] ? time : times[2];
+	}
+	for (int i = 0; i < FRUSTUM_BENCH_BOXES; i++)
+		visibles[2] += CheckVisibleBit(visibility, i) ? 1 : 0;
+	const char* names[3] = { "checkWithCamera(1)", "CheckBoxWithFrustum", "CheckBoxesWithFrustum" };
+	for (int i = 0; i < 3; i++)
+		printf("    %-22s %8.2f ns/box, %d of %d visible\n", names[i], times[i] * 1000000.0 / FRUSTUM_BENCH_BOXES, visibles[i], FRUSTUM_BENCH_BOXES);
+
+	for (int i = 0; i < FRUSTUM_BENCH_BOXES; i++)
+		delete boxes[i];
+	for (int k = 0; k < 3; k++)
+		free(mins[k]), free(maxs[k]);
+	free(visibility);
+	TEST_CHECK(passed);
+	TEST_CHECK(visibles[1] == visibles[2]);
+	return true;
+}
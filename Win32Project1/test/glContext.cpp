@@ -0,0 +1,75 @@
+#include "test.h"
+#include "../render/glheader.h"
+#include <windows.h>
+
+static HWND testWnd = NULL;
+static HDC testDc = NULL;
+static HGLRC testRc = NULL;
+
+// Hidden window with the same pixel format as the game, GL calls of gpu tests go to it
+bool CreateTestContext() {
+	if (testRc) return true;
+	WNDCLASS wndClass;
+	memset(&wndClass, 0, sizeof(WNDCLASS));
+	wndClass.lpfnWndProc = DefWindowProc;
+	wndClass.hInstance = GetModuleHandle(NULL);
+	wndClass.lpszClassName = TEXT("TinyTests");
+	RegisterClass(&wndClass);
+	testWnd = CreateWindow(TEXT("TinyTests"), TEXT("Tests"), WS_OVERLAPPEDWINDOW, 0, 0, 64, 64, NULL, NULL, wndClass.hInstance, NULL);
+	if (!testWnd) return false;
+
+	const PIXELFORMATDESCRIPTOR pfd = {
+		sizeof(PIXELFORMATDESCRIPTOR), 1,
+		PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER,
+		PFD_TYPE_RGBA, 32,
+		0, 0, 0, 0, 0, 0,
+		0, 0, 0,
+		0, 0, 0, 0,
+		24, 0, 0,
+		PFD_MAIN_PLANE, 0, 0, 0, 0
+	};
+	testDc = GetDC(testWnd);
+	SetPixelFormat(testDc, ChoosePixelFormat(testDc, &pfd), &pfd);
+	testRc = wglCreateContext(testDc);
+	if (!testRc || !wglMakeCurrent(testDc, testRc) || glewInit() != GLEW_OK || !GLEW_VERSION_4_3) {
+		DestroyTestContext();
+		return false;
+	}
+	return true;
+}
+
+void DestroyTestContext() {
+	if (testRc) {
+		wglMakeCurrent(NULL, NULL);
+		wglDeleteContext(testRc);
+	}
+	if (testDc) ReleaseDC(testWnd, testDc);
+	if (testWnd) DestroyWindow(testWnd);
+	testRc = NULL, testDc = NULL, testWnd = NULL;
+}
+
+// Compute program from source, 0 with log printed if it does not build
+GLuint CreateTestProgram(const char* source) {
+	GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	GLint ok = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if (!ok) {
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		printf("    compute shader: %s\n", log);
+		glDeleteShader(shader);
+		return 0;
+	}
+	GLuint program = glCreateProgram();
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+	glDeleteShader(shader);
+	glGetProgramiv(program, GL_LINK_STATUS, &ok);
+	if (!ok) {
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
@@ -0,0 +1,67 @@
+#include "test.h"
+#include "../thread/jobSystem.h"
+
+#define JOB_TEST_ROUNDS 2000
+#define JOB_TEST_WORKERS 3
+
+// Every job records whether all its prerequisites had run before it
+struct OrderJob {
+	Job job;
+	OrderJob* prerequisites[MAX_JOB_SUCCESSORS];
+	int prerequisiteCount;
+	std::atomic<bool> ran;
+	bool inOrder;
+};
+
+static void OrderJobRun(void* param) {
+	OrderJob* order = (OrderJob*)param;
+	order->inOrder = true;
+	for (int i = 0; i < order->prerequisiteCount; i++)
+		order->inOrder = order->inOrder && order->prerequisites[i]->ran.load();
+	order->ran = true;
+}
+
+static void PrepareOrderJob(JobSystem* jobSystem, OrderJob* order) {
+	jobSystem->prepare(&order->job, OrderJobRun, order);
+	order->prerequisiteCount = 0;
+	order->ran = false;
+	order->inOrder = false;
+}
+
+static bool DependOrderJob(JobSystem* jobSystem, OrderJob* order, OrderJob* prerequisite) {
+	if (!jobSystem->depend(&order->job, &prerequisite->job)) return false;
+	order->prerequisites[order->prerequisiteCount++] = prerequisite;
+	return true;
+}
+
+// Fan out of MAX_JOB_SUCCESSORS jobs after a root, joined by a last job, submitted in reverse order
+bool TestJobGraph() {
+	JobSystem::Release();
+	JobSystem::Init(JOB_TEST_WORKERS);
+	JobSystem* jobSystem = JobSystem::jobSystem;
+	static OrderJob root, fan[MAX_JOB_SUCCESSORS], join;
+	bool passed = true;
+	for (int round = 0; round < JOB_TEST_ROUNDS && passed; round++) {
+		PrepareOrderJob(jobSystem, &root);
+		PrepareOrderJob(jobSystem, &join);
+		for (int i = 0; i < MAX_JOB_SUCCESSORS; i++) {
+			PrepareOrderJob(jobSystem, &fan[i]);
+			passed = passed && DependOrderJob(jobSystem, &fan[i], &root);
+			passed = passed && DependOrderJob(jobSystem, &join, &fan[i]);
+		}
+		TEST_CHECK(passed);
+
+		jobSystem->submit(&join.job);
+		for (int i = 0; i < MAX_JOB_SUCCESSORS; i++)
+			jobSystem->submit(&fan[i].job);
+		jobSystem->submit(&root.job);
+		jobSystem->wait(&join.job);
+
+		passed = root.inOrder && join.inOrder;
+		for (int i = 0; i < MAX_JOB_SUCCESSORS; i++)
+			passed = passed && fan[i].inOrder;
+	}
+	JobSystem::Release();
+	TEST_CHECK(passed);
+	return true;
+}
@@ -0,0 +1,128 @@
+#include "test.h"
+#include "../render/renderQueue.h"
+#include "../material/materialManager.h"
+#include "../object/staticObject.h"
+#include "../mesh/sphere.h"
+#include "../camera/camera.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LOD_TEST_OBJECTS 3000
+#define LOD_TEST_MID 30.0f
+#define LOD_TEST_LOW 60.0f
+
+static float RandRange(float min, float max) {
+	return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+// Object is not under any node, so global transform & record fields a node update would set are written here
+static void PlaceObject(Object* object, const vec3& position) {
+	object->transformMatrix.SetTranslation(position);
+	object->transformsFull[0] = position.x, object->transformsFull[1] = position.y, object->transformsFull[2] = position.z;
+	object->transformsFull[3] = 1.0;
+	object->transformsFull[8] = 1.0, object->transformsFull[9] = 1.0, object->transformsFull[10] = 1.0;
+	object->transformsFull[11] = position.y;
+}
+
+// Lod records of objects in front of eye, some right at mid & low distance, go through PushLodInstance & the multi drawcall
+// Shader's SelectLodIds must count each record to the mesh cpu SelectLod & DecodeLodIds pick,
+// and mid & low meshes with meshlets must keep visible indices to draw
+bool TestLodSelect() {
+	if (!CreateTestContext()) return TestSkipped("no GL 4.3 context");
+	srand(11);
+	bool ownMaterials = !MaterialManager::materials;
+	MaterialManager::Init();
+	ConfigArg cfgs;
+	memset(&cfgs, 0, sizeof(ConfigArg));
+	cfgs.gpulod = true;
+	Render* render = new Render();
+	render->initShaders(&cfgs);
+	RenderState state;
+	state.shaderMulti = render->findShader("multi_s");
+	state.shaderFlush = render->findShader("flush");
+	while (glGetError() != GL_NO_ERROR); // Fixed function state set up by Render is not checked here
+
+	Mesh* meshes[3] = { new Sphere(64, 64), new Sphere(48, 48), new Sphere(40, 40) };
+	StaticObject* object = new StaticObject(meshes[LOD_HIGH], meshes[LOD_MID], meshes[LOD_LOW]);
+	RenderQueue* queue = new RenderQueue(QUEUE_STATIC, LOD_TEST_MID, LOD_TEST_LOW);
+	queue->setCfg(&cfgs);
+	queue->multiInstance = new MultiInstance();
+	int groupCounts[RECORD_GROUPS] = { 0, 0, 0, 0 };
+	for (int m = 0; m < 3; m++) {
+		meshes[m]->setIsBillboard(false);
+		BuildMeshlets(meshes[m]);
+		meshes[m]->meshId = m;
+		InstanceData* data = new InstanceData(meshes[m], object, LOD_TEST_OBJECTS);
+		int words = MeshletMaskWords(meshes[m]->meshlets.size());
+		data->meshletMask = new std::atomic<uint>[words];
+		for (int w = 0; w < words; w++)
+			data->meshletMask[w] = 0;
+		data->instance = new Instance(data);
+		data->instance->initInstanceBuffers(object, meshes[m]->vertexCount, meshes[m]->indexCount, LOD_TEST_OBJECTS, false);
+		data->instance->setRenderData(data);
+		queue->instanceQueue.push_back(data);
+		queue->multiInstance->add(data->instance);
+		groupCounts[data->recordGroup] += LOD_TEST_OBJECTS;
+	}
+	queue->multiInstance->initBuffers(NORMAL_PASS);
+	queue->multiInstance->createDrawcall();
+	queue->instanceStream = new InstanceStream(groupCounts);
+	queue->instanceStream->createBuffer();
+	for (int m = 0; m < 3; m++)
+		queue->instanceQueue[m]->stream = queue->instanceStream;
+
+	Camera camera(0.0f);
+	vec3 eye(3.0f, 2.0f, -5.0f), dir = vec3(0.2f, -0.1f, 1.0f).GetNormalized();
+	camera.initPerspectCamera(60.0f, 1.5f, 1.0f, 500.0f);
+	camera.updateLook(eye, dir);
+	queue->flush();
+	int expects[3] = { 0, 0, 0 }, pushed = 0, wrongIds = 0;
+	for (int i = 0; i < LOD_TEST_OBJECTS; i++) {
+		float dist = i % 10 == 0 ? LOD_TEST_MID : (i % 10 == 1 ? LOD_TEST_LOW : RandRange(4.0f, LOD_TEST_LOW * 1.5f));
+		vec3 side(RandRange(-0.2f, 0.2f), RandRange(-0.1f, 0.1f), 0.0f);
+		PlaceObject(object, eye + (dir + side).GetNormalized() * dist);
+		if (!PushLodInstance(queue, object, camera.frustum, eye)) continue;
+		pushed++;
+
+		buff ids[4];
+		int normalId, singleId;
+		PackLodIds(queue->instanceQueue[LOD_HIGH]->instance, queue->instanceQueue[LOD_MID]->instance, queue->instanceQueue[LOD_LOW]->instance, ids);
+		int lod = SelectLod(GetLodCenter(object->transformsFull), eye, queue->midDistSqr, queue->lowDistSqr);
+		DecodeLodIds(ids, lod, &normalId, &singleId);
+		Instance* instance = queue->instanceQueue[queue->queryLodMesh(object, eye)->meshId]->instance;
+		wrongIds += normalId != instance->insId || singleId != instance->insSingleId ? 1 : 0;
+		expects[lod]++;
+	}
+
+	MultiDrawcall* drawcall = queue->multiInstance->drawcall;
+	drawcall->setLod(eye, queue->midDistSqr, queue->lowDistSqr);
+	drawcall->update(render, &state, queue->instanceStream);
+	Indirect normals[3], singles[3], bills[3];
+	memset(normals, 0, sizeof(normals)), memset(singles, 0, sizeof(singles)), memset(bills, 0, sizeof(bills));
+	drawcall->readIndirects(normals, singles, bills);
+	queue->instanceStream->setFence();
+
+	int wrongCounts = 0, emptyLods = 0;
+	for (int m = 0; m < 3; m++) {
+		Indirect& indirect = normals[queue->instanceQueue[m]->instance->insId];
+		wrongCounts += indirect.primCount != (uint)expects[m] ? 1 : 0;
+		emptyLods += indirect.count == 0 || indirect.count > (uint)meshes[m]->indexCount ? 1 : 0;
+		printf("    lod %d: %d cpu, %u gpu instances, %u of %d indices drawn\n", m, expects[m], indirect.primCount, indirect.count, meshes[m]->indexCount);
+	}
+	printf("    %d of %d pushed, %d cpu id mismatches, %d wrong gpu counts, %d lods without indices\n", pushed, LOD_TEST_OBJECTS, wrongIds, wrongCounts, emptyLods);
+	GLenum error = glGetError();
+
+	delete queue;
+	delete object;
+	for (int m = 0; m < 3; m++)
+		delete meshes[m];
+	delete render;
+	if (ownMaterials) MaterialManager::Release();
+	DestroyTestContext();
+	TEST_CHECK(pushed == LOD_TEST_OBJECTS && wrongIds == 0);
+	TEST_CHECK(expects[LOD_MID] > 0 && expects[LOD_LOW] > 0);
+	TEST_CHECK(wrongCounts == 0);
+	TEST_CHECK(emptyLods == 0);
+	TEST_CHECK(error == GL_NO_ERROR);
+	return true;
+}
@@ -0,0 +1,125 @@
+#include "test.h"
+#include "../mesh/sphere.h"
+#include "../camera/camera.h"
+#include <stdlib.h>
+
+#define MESHLET_TEST_VIEWS 200
+#define MESHLET_TEST_TRANSFORMS 4
+
+static float RandRange(float min, float max) {
+	return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+// Each meshlet stays in its limits, holds its vertices in its sphere, and ranges tile mesh's faces in order
+static bool CheckMeshletBuild(const Mesh* mesh) {
+	int next = mesh->normalFaces[0]->start;
+	for (uint i = 0; i < mesh->meshlets.size(); i++) {
+		const Meshlet& meshlet = mesh->meshlets[i];
+		TEST_CHECK(meshlet.start == next && meshlet.count > 0 && meshlet.count % 3 == 0);
+		TEST_CHECK(meshlet.count / 3 <= MESHLET_MAX_TRIANGLES && meshlet.vertexCount <= MESHLET_MAX_VERTICES);
+		int unique = 0;
+		for (int k = 0; k < meshlet.count; k++) {
+			int id = mesh->indices[meshlet.start + k];
+			bool seen = false;
+			for (int j = 0; j < k && !seen; j++)
+				seen = mesh->indices[meshlet.start + j] == id;
+			unique += seen ? 0 : 1;
+			TEST_CHECK((mesh->vertices3[id] - meshlet.center).GetLength() <= meshlet.radius * 1.0001f + 0.00001f);
+		}
+		TEST_CHECK(unique == meshlet.vertexCount);
+		next = meshlet.start + meshlet.count;
+	}
+	TEST_CHECK(next == mesh->normalFaces[0]->start + mesh->normalFaces[0]->count);
+	return true;
+}
+
+// Uniform scales with & without rotation, then non-uniform scale & mirror whose cones must be skipped
+static mat4 GetTestTransform(int index) {
+	mat4 translate, rotate, scale;
+	translate.SetTranslation(vec3(RandRange(-10.0f, 10.0f), RandRange(-10.0f, 10.0f), RandRange(-10.0f, 10.0f)));
+	rotate.SetRotationAxis(RandRange(0.0f, 360.0f), vec3(RandRange(-1.0f, 1.0f), RandRange(0.1f, 1.0f), RandRange(-1.0f, 1.0f)));
+	if (index == 0) rotate.LoadIdentity();
+	if (index == 2) scale.SetScale(vec3(4.0f, 1.0f, 0.5f));
+	else if (index == 3) scale.SetScale(vec3(-3.0f, 3.0f, 3.0f));
+	else scale.SetScale(vec3(3.0f, 3.0f, 3.0f));
+	return translate * rotate * scale;
+}
+
+static vec3 TransformPoint(const mat4& transform, const vec3& p) {
+	vec4 world = transform * vec4(p, 1.0);
+	return vec3(world.x, world.y, world.z);
+}
+
+// A culled meshlet must have all its triangles facing away from eye, or all its vertices outside one frustum plane
+// Without cones only the latter counts
+static bool CheckCulled(const Mesh* mesh, const Meshlet& meshlet, const mat4& transform, const Frustum* frustum, const vec3& eye, bool cones, bool* byCone) {
+	bool backFacing = cones;
+	for (int k = 0; k < meshlet.count && backFacing; k += 3) {
+		vec3 p0 = TransformPoint(transform, mesh->vertices3[mesh->indices[meshlet.start + k]]);
+		vec3 p1 = TransformPoint(transform, mesh->vertices3[mesh->indices[meshlet.start + k + 1]]);
+		vec3 p2 = TransformPoint(transform, mesh->vertices3[mesh->indices[meshlet.start + k + 2]]);
+		vec3 normal = (p1 - p0).CrossProduct(p2 - p0), view = p0 - eye;
+		backFacing = normal.DotProduct(view) >= -0.0001f * normal.GetLength() * view.GetLength();
+	}
+	*byCone = backFacing;
+	if (backFacing) return true;
+	for (int p = 0; p < 6; p++) {
+		bool outside = true;
+		for (int k = 0; k < meshlet.count && outside; k++) {
+			vec3 v = TransformPoint(transform, mesh->vertices3[mesh->indices[meshlet.start + k]]);
+			outside = frustum->normals[p].DotProduct(v) + frustum->ds[p] < 0.0f;
+		}
+		if (outside) return true;
+	}
+	return false;
+}
+
+// Meshlets of a finely tessellated sphere seen from random views under several transforms
+// Nothing visible may be culled, and cones only cull under uniform scale without mirroring
+bool TestMeshletCull() {
+	srand(5);
+	Sphere* sphere = new Sphere(64, 64);
+	sphere->setIsBillboard(false);
+	BuildMeshlets(sphere);
+	int cones = 0;
+	for (uint i = 0; i < sphere->meshlets.size(); i++)
+		cones += sphere->meshlets[i].coneCutoff < MESHLET_NO_CONE ? 1 : 0;
+	printf("    %d triangles, %d meshlets, %d with cones\n", sphere->indexCount / 3, (int)sphere->meshlets.size(), cones);
+	TEST_CHECK(sphere->meshlets.size() > 1 && cones > 0);
+	TEST_CHECK(CheckMeshletBuild(sphere));
+
+	int words = MeshletMaskWords(sphere->meshlets.size());
+	std::atomic<uint>* visibility = new std::atomic<uint>[words];
+	Camera camera(0.0f);
+	bool passed = true;
+	for (int t = 0; t < MESHLET_TEST_TRANSFORMS && passed; t++) {
+		mat4 transform = GetTestTransform(t);
+		vec3 center = TransformPoint(transform, vec3(0.0f, 0.0f, 0.0f));
+		int culled = 0, coneCulled = 0, wrong = 0;
+		for (int v = 0; v < MESHLET_TEST_VIEWS; v++) {
+			vec3 offset(RandRange(-1.0f, 1.0f), RandRange(-1.0f, 1.0f), RandRange(-1.0f, 1.0f));
+			if (offset.GetLength() < 0.01f) offset = vec3(0.0f, 0.0f, 1.0f);
+			vec3 eye = center + offset.GetNormalized() * RandRange(14.0f, 40.0f);
+			vec3 dir = center + vec3(RandRange(-6.0f, 6.0f), RandRange(-6.0f, 6.0f), RandRange(-6.0f, 6.0f)) - eye;
+			camera.initPerspectCamera(RandRange(30.0f, 90.0f), 1.5f, 1.0f, 500.0f);
+			camera.updateLook(eye, dir.GetNormalized());
+
+			for (int w = 0; w < words; w++)
+				visibility[w] = 0;
+			CullMeshlets(sphere, transform, camera.frustum, eye, visibility);
+			for (uint i = 0; i < sphere->meshlets.size(); i++) {
+				if ((visibility[i / 32].load() >> (i % 32)) & 1) continue;
+				bool byCone = false;
+				culled++;
+				if (!CheckCulled(sphere, sphere->meshlets[i], transform, camera.frustum, eye, t < 2, &byCone)) wrong++;
+				coneCulled += byCone ? 1 : 0;
+			}
+		}
+		printf("    transform %d: %d meshlets culled, %d of them by cone, %d wrongly\n", t, culled, coneCulled, wrong);
+		passed = wrong == 0 && (t >= 2 || coneCulled > 0);
+	}
+	delete[] visibility;
+	delete sphere;
+	TEST_CHECK(passed);
+	return true;
+}
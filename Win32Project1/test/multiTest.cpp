@@ -0,0 +1,131 @@
+#include "test.h"
+#include "../instance/multiInstance.h"
+#include "../render/render.h"
+#include "../material/materialManager.h"
+#include "../object/staticObject.h"
+#include "../mesh/box.h"
+#include "../mesh/board.h"
+#include "../mesh/sphere.h"
+#include <string.h>
+
+#define MULTI_TEST_INSTANCES 100000
+#define MULTI_TEST_MESHES 5
+#define MULTI_TEST_FRAMES 3
+
+// Normal, single, mixed & billboard boxes, and a sphere too large for 16 bit indices
+static void CreateTestMeshes(Mesh** meshes) {
+	meshes[0] = new Box();
+	meshes[0]->setIsBillboard(false);
+	meshes[1] = new Box();
+	meshes[1]->setAllSingle();
+	meshes[2] = new Box();
+	meshes[2]->clearFaceBuf();
+	meshes[2]->singleFaces.push_back(new FaceBuf(0, 18));
+	meshes[2]->normalFaces.push_back(new FaceBuf(18, meshes[2]->indexCount - 18));
+	meshes[3] = new Board();
+	meshes[3]->setIsBillboard(true);
+	meshes[4] = new Sphere(300, 300);
+	meshes[4]->setIsBillboard(false);
+}
+
+static void AddToPasses(Instance* instance, MultiInstance** passes) {
+	if (instance->isBillboard) passes[2]->add(instance);
+	else {
+		if (instance->hasNormal) passes[0]->add(instance);
+		if (instance->hasSingle) passes[1]->add(instance);
+	}
+}
+
+// Instances of several meshes far above the 4096 per mesh start capacity go through the dual queue passes
+// Drawcalls must grow their output buffers and count every instance into the indirects of its mesh
+bool TestMultiStress() {
+	if (!CreateTestContext()) return TestSkipped("no GL 4.3 context");
+	bool ownMaterials = !MaterialManager::materials;
+	MaterialManager::Init();
+	ConfigArg cfgs;
+	memset(&cfgs, 0, sizeof(ConfigArg));
+	Render* render = new Render();
+	render->initShaders(&cfgs);
+	RenderState state;
+	state.shaderMulti = render->findShader("multi_s");
+	state.shaderFlush = render->findShader("flush");
+	while (glGetError() != GL_NO_ERROR); // Fixed function state set up by Render is not checked here
+
+	Mesh* meshes[MULTI_TEST_MESHES];
+	CreateTestMeshes(meshes);
+	StaticObject* objects[MULTI_TEST_MESHES];
+	InstanceData* datas[MULTI_TEST_MESHES];
+	int groupCounts[RECORD_GROUPS] = { 0, 0, 0, 0 };
+	MultiInstance* passes[3] = { new MultiInstance(), new MultiInstance(), new MultiInstance() };
+	for (int m = 0; m < MULTI_TEST_MESHES; m++) {
+		int count = MULTI_TEST_INSTANCES / MULTI_TEST_MESHES;
+		objects[m] = new StaticObject(meshes[m]);
+		if (meshes[m]->isBillboard) objects[m]->setBillboard(1.0, 1.0, 0);
+		datas[m] = new InstanceData(meshes[m], objects[m], count);
+		datas[m]->instance = new Instance(datas[m]);
+		datas[m]->instance->initInstanceBuffers(objects[m], meshes[m]->vertexCount, meshes[m]->indexCount, count, false);
+		datas[m]->instance->setRenderData(datas[m]);
+		groupCounts[datas[m]->recordGroup] += count;
+		AddToPasses(datas[m]->instance, passes);
+	}
+	int passTypes[3] = { NORMAL_PASS, SINGLE_PASS, BILL_PASS };
+	for (int p = 0; p < 3; p++) {
+		passes[p]->initBuffers(passTypes[p]);
+		passes[p]->createDrawcall();
+	}
+	InstanceStream* stream = new InstanceStream(groupCounts);
+	stream->createBuffer();
+	for (int m = 0; m < MULTI_TEST_MESHES; m++)
+		datas[m]->stream = stream;
+
+	bool wide = passes[0]->wideIndex && !passes[1]->wideIndex;
+	int startCapacity = passes[0]->drawcall->getMaxObjects(), firstCount = 0, bad = 0;
+	Indirect normals[MULTI_TEST_MESHES], singles[MULTI_TEST_MESHES], bills[MULTI_TEST_MESHES];
+	for (int f = 0; f < MULTI_TEST_FRAMES; f++) {
+		// Fewer instances each frame, buffers grown in first frame are kept
+		int total = MULTI_TEST_INSTANCES >> f;
+		stream->reset();
+		for (int m = 0; m < MULTI_TEST_MESHES; m++)
+			datas[m]->resetInstance();
+		for (int i = 0; i < total; i++)
+			datas[i % MULTI_TEST_MESHES]->addInstance(objects[i % MULTI_TEST_MESHES]);
+
+		memset(normals, 0, sizeof(normals)), memset(singles, 0, sizeof(singles)), memset(bills, 0, sizeof(bills));
+		for (int p = 0; p < 3; p++) {
+			passes[p]->drawcall->update(render, &state, stream);
+			passes[p]->drawcall->readIndirects(normals, singles, bills);
+		}
+		stream->setFence();
+		if (f == 0) firstCount = passes[0]->instanceCount;
+		int drawn = 0;
+		for (int m = 0; m < MULTI_TEST_MESHES; m++) {
+			Instance* instance = datas[m]->instance;
+			uint expect = (uint)(int)datas[m]->count;
+			if (instance->insId != InvalidInsId) drawn += normals[instance->insId].primCount, bad += normals[instance->insId].primCount != expect ? 1 : 0;
+			if (instance->insSingleId != InvalidInsId) drawn += singles[instance->insSingleId].primCount, bad += singles[instance->insSingleId].primCount != expect ? 1 : 0;
+			if (instance->insBillId != InvalidInsId) drawn += bills[instance->insBillId].primCount, bad += bills[instance->insBillId].primCount != expect ? 1 : 0;
+		}
+		printf("    frame %d: %d instances, %d indirect instances, capacity normal %d single %d bill %d\n", f, total, drawn,
+			passes[0]->drawcall->getMaxObjects(), passes[1]->drawcall->getMaxObjects(), passes[2]->drawcall->getMaxObjects());
+	}
+	printf("    wide index %d, start capacity %d, %d wrong indirect counts\n", wide ? 1 : 0, startCapacity, bad);
+	bool grown = passes[0]->drawcall->getMaxObjects() >= firstCount && firstCount > startCapacity;
+	GLenum error = glGetError();
+
+	for (int p = 0; p < 3; p++)
+		delete passes[p];
+	delete stream;
+	for (int m = 0; m < MULTI_TEST_MESHES; m++) {
+		delete datas[m];
+		delete objects[m];
+		delete meshes[m];
+	}
+	delete render;
+	if (ownMaterials) MaterialManager::Release();
+	DestroyTestContext();
+	TEST_CHECK(wide);
+	TEST_CHECK(bad == 0);
+	TEST_CHECK(grown);
+	TEST_CHECK(error == GL_NO_ERROR);
+	return true;
+}
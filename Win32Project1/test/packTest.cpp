@@ -0,0 +1,94 @@
+#include "test.h"
+#include "../mesh/vertexPack.h"
+#include "../mesh/sphere.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define PACK_TEST_FRAMES 100000
+#define PACK_NORMAL_COS 0.99999f // Octahedral unorm10 normal stays within about 0.26 degrees
+#define PACK_TANGENT_COS 0.99998f // Tangent angle step & normal error together, about 0.36 degrees
+
+static float RandRange(float min, float max) {
+	return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+static vec3 RandDirection() {
+	vec3 v(0.0, 0.0, 0.0);
+	while (v.GetLength() < 0.01f || v.GetLength() > 1.0f)
+		v = vec3(RandRange(-1.0f, 1.0f), RandRange(-1.0f, 1.0f), RandRange(-1.0f, 1.0f));
+	return v.GetNormalized();
+}
+
+// Positions & uvs of a mesh come back within half a unorm16 step of its bounds, flat axes come back exactly
+static bool TestPackAttributes() {
+	Sphere* sphere = new Sphere(32, 32);
+	for (int i = 0; i < sphere->vertexCount; i++)
+		sphere->vertices3[i] = sphere->vertices3[i] * 7.5f + vec3(100.0f, -3.0f, 0.25f);
+	PackBounds bounds = GetPackBounds(sphere->vertices3, sphere->texcoords, sphere->vertexCount);
+	vec3 posStep = bounds.posSize / PACK_UNORM16;
+	vec2 uvStep = bounds.uvSize / PACK_UNORM16;
+	int bad = 0;
+	float maxPos = 0.0f, maxUv = 0.0f;
+	for (int i = 0; i < sphere->vertexCount; i++) {
+		ushort position[4], texcoord[2];
+		PackPosition(sphere->vertices3[i], bounds, position);
+		PackTexcoord(sphere->texcoords[i], bounds, texcoord);
+		vec3 p = UnpackPosition(position, bounds) - sphere->vertices3[i];
+		vec2 t = UnpackTexcoord(texcoord, bounds) - sphere->texcoords[i];
+		bad += fabsf(p.x) > posStep.x * 0.5001f || fabsf(p.y) > posStep.y * 0.5001f || fabsf(p.z) > posStep.z * 0.5001f ? 1 : 0;
+		bad += fabsf(t.x) > uvStep.x * 0.5001f || fabsf(t.y) > uvStep.y * 0.5001f ? 1 : 0;
+		maxPos = p.GetLength() > maxPos ? p.GetLength() : maxPos;
+		maxUv = t.GetLength() > maxUv ? t.GetLength() : maxUv;
+	}
+	printf("    %d vertices, max position error %.6f of size %.2f, max uv error %.7f, %d out of tolerance\n",
+		sphere->vertexCount, maxPos, bounds.posSize.x, maxUv, bad);
+
+	// Zero sized bounds must not divide by zero
+	vec3 flat(1.5f, 2.0f, -4.0f);
+	vec2 flatUv(0.5f, 0.5f);
+	PackBounds flatBounds = GetPackBounds(&flat, &flatUv, 1);
+	ushort position[4], texcoord[2];
+	PackPosition(flat, flatBounds, position);
+	PackTexcoord(flatUv, flatBounds, texcoord);
+	vec3 flatBack = UnpackPosition(position, flatBounds);
+	vec2 flatUvBack = UnpackTexcoord(texcoord, flatBounds);
+	delete sphere;
+	TEST_CHECK(bad == 0);
+	TEST_CHECK(flatBack.x == flat.x && flatBack.y == flat.y && flatBack.z == flat.z);
+	TEST_CHECK(flatUvBack.x == flatUv.x && flatUvBack.y == flatUv.y);
+	return true;
+}
+
+// Random frames, axis aligned normals & both octahedron halves included, unpack as instance.vert does
+static bool TestPackFrames() {
+	int bad = 0;
+	float minNormal = 1.0f, minTangent = 1.0f, maxSkew = 0.0f;
+	for (int i = 0; i < PACK_TEST_FRAMES; i++) {
+		vec3 normal = RandDirection();
+		if (i < 6) normal = vec3(i == 0 ? 1.0f : (i == 1 ? -1.0f : 0.0f), i == 2 ? 1.0f : (i == 3 ? -1.0f : 0.0f), i == 4 ? 1.0f : (i == 5 ? -1.0f : 0.0f));
+		vec3 tangent = RandDirection();
+		tangent = (tangent - normal * normal.DotProduct(tangent));
+		if (tangent.GetLength() < 0.01f) continue;
+		tangent = tangent.GetNormalized();
+
+		vec3 normalBack, tangentBack;
+		UnpackFrame(PackFrame(normal, tangent), normalBack, tangentBack);
+		float normalCos = normalBack.DotProduct(normal), tangentCos = tangentBack.DotProduct(tangent);
+		float skew = fabsf(normalBack.DotProduct(tangentBack));
+		bad += normalCos < PACK_NORMAL_COS || tangentCos < PACK_TANGENT_COS || skew > 0.001f ? 1 : 0;
+		minNormal = normalCos < minNormal ? normalCos : minNormal;
+		minTangent = tangentCos < minTangent ? tangentCos : minTangent;
+		maxSkew = skew > maxSkew ? skew : maxSkew;
+	}
+	printf("    %d frames, worst normal %.3f deg, worst tangent %.3f deg, max skew %.6f, %d out of tolerance\n", PACK_TEST_FRAMES,
+		acosf(minNormal > 1.0f ? 1.0f : minNormal) * 57.29578f, acosf(minTangent > 1.0f ? 1.0f : minTangent) * 57.29578f, maxSkew, bad);
+	TEST_CHECK(bad == 0);
+	return true;
+}
+
+bool TestVertexPack() {
+	srand(3);
+	bool passed = TestPackAttributes();
+	passed = passed && TestPackFrames();
+	return passed;
+}
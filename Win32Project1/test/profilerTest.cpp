@@ -0,0 +1,43 @@
+#include "test.h"
+#include "../util/profiler.h"
+#include <string.h>
+
+#define PROFILER_TEST_EVENTS 100
+
+// Same zone name from two pointers, as a literal may have a copy in each module
+// Events of both go to one zone, and collecting known names allocates nothing
+bool TestProfilerZones() {
+	Profiler::Init(); // Left alive, releasing it would overwrite a trace saved by the game
+	Profiler* profiler = Profiler::profiler;
+	static char copy[32];
+	const char* literal = "profiler test zone";
+	strcpy(copy, literal);
+
+	for (int i = 0; i < PROFILER_TEST_EVENTS; i++) {
+		u64 start = Profiler::Now();
+		profiler->record(i % 2 == 0 ? literal : copy, start, start + 1000);
+	}
+	profiler->frame();
+
+	for (int i = 0; i < PROFILER_TEST_EVENTS; i++) {
+		u64 start = Profiler::Now();
+		profiler->record(i % 2 == 0 ? literal : copy, start, start + 1000);
+	}
+	StartAllocCount();
+	profiler->frame();
+	int allocs = StopAllocCount();
+
+	std::vector<ProfileStat> stats;
+	profiler->getStats(stats);
+	int zones = 0, samples = 0;
+	for (uint i = 0; i < stats.size(); i++) {
+		if (strcmp(stats[i].name, literal) != 0) continue;
+		zones++;
+		samples = stats[i].count;
+	}
+	printf("    %d zone, %d samples, %d allocations collecting known names\n", zones, samples, allocs);
+	TEST_CHECK(zones == 1);
+	TEST_CHECK(samples == PROFILER_TEST_EVENTS * 2);
+	TEST_CHECK(allocs == 0);
+	return true;
+}
@@ -0,0 +1,105 @@
+#include "test.h"
+#include "../mesh/lodMesh.h"
+#include "../mesh/sphere.h"
+#include <stdio.h>
+
+#define SIMPLIFY_TEST_SLACK 1.05f // Lod may stop a few triangles above its target
+#define SIMPLIFY_MID_ERROR 0.015f // Max distance of source vertices to lod surface, relative to radius
+#define SIMPLIFY_LOW_ERROR 0.04f
+#define SIMPLIFY_TEST_CACHE LOD_CACHE_DIR "/simplify_test.t3l"
+
+static float Clamp01(float x) {
+	return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+// Distance from p to closest point of triangle abc, by region of p against the triangle
+static float PointTriangleDistance(const vec3& p, const vec3& a, const vec3& b, const vec3& c) {
+	vec3 ab = b - a, ac = c - a, ap = p - a;
+	float d1 = ab.DotProduct(ap), d2 = ac.DotProduct(ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) return ap.GetLength();
+	vec3 bp = p - b;
+	float d3 = ab.DotProduct(bp), d4 = ac.DotProduct(bp);
+	if (d3 >= 0.0f && d4 <= d3) return bp.GetLength();
+	vec3 cp = p - c;
+	float d5 = ab.DotProduct(cp), d6 = ac.DotProduct(cp);
+	if (d6 >= 0.0f && d5 <= d6) return cp.GetLength();
+	float vc = d1 * d4 - d3 * d2, vb = d5 * d2 - d1 * d6, va = d3 * d6 - d5 * d4;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return (p - (a + ab * Clamp01(d1 / (d1 - d3)))).GetLength();
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return (p - (a + ac * Clamp01(d2 / (d2 - d6)))).GetLength();
+	if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) return (p - (b + (c - b) * Clamp01((d4 - d3) / ((d4 - d3) + (d5 - d6))))).GetLength();
+	float denom = 1.0f / (va + vb + vc);
+	return (p - (a + ab * (vb * denom) + ac * (vc * denom))).GetLength();
+}
+
+// Largest distance of any source vertex to the lod surface
+static float MaxSurfaceError(const Mesh* source, const Mesh* lod) {
+	float maxError = 0.0f;
+	for (int v = 0; v < source->vertexCount; v++) {
+		float nearest = 1e30f;
+		for (int k = 0; k + 2 < lod->indexCount && nearest > 0.0f; k += 3) {
+			float dist = PointTriangleDistance(source->vertices3[v], lod->vertices3[lod->indices[k]],
+				lod->vertices3[lod->indices[k + 1]], lod->vertices3[lod->indices[k + 2]]);
+			nearest = dist < nearest ? dist : nearest;
+		}
+		maxError = nearest > maxError ? nearest : maxError;
+	}
+	return maxError;
+}
+
+// Face ranges tile lod's indices, and no triangle of the closed sphere turned inward or collapsed
+static bool CheckLodTriangles(const Mesh* lod) {
+	int next = 0;
+	for (uint i = 0; i < lod->singleFaces.size() + lod->normalFaces.size(); i++) {
+		FaceBuf* buf = i < lod->singleFaces.size() ? lod->singleFaces[i] : lod->normalFaces[i - lod->singleFaces.size()];
+		TEST_CHECK(buf->start == next && buf->count % 3 == 0);
+		next += buf->count;
+	}
+	TEST_CHECK(next == lod->indexCount);
+	for (int k = 0; k < lod->indexCount; k += 3) {
+		vec3 a = lod->vertices3[lod->indices[k]], b = lod->vertices3[lod->indices[k + 1]], c = lod->vertices3[lod->indices[k + 2]];
+		vec3 normal = (b - a).CrossProduct(c - a);
+		TEST_CHECK(normal.GetLength() > 0.0f && normal.DotProduct(a + b + c) > 0.0f);
+	}
+	return true;
+}
+
+// Sphere with uv seam & poles simplified to mid & low ratios
+// Each lod must reach its triangle target and stay close to source surface, and come back the same from its cache
+bool TestSimplifyMesh() {
+	Sphere* sphere = new Sphere(64, 64);
+	sphere->setIsBillboard(false);
+	float radius = sphere->vertices3[0].GetLength();
+	int sourceTriangles = sphere->indexCount / 3;
+	float ratios[2] = { LOD_MID_RATIO, LOD_LOW_RATIO };
+	float maxErrors[2] = { SIMPLIFY_MID_ERROR, SIMPLIFY_LOW_ERROR };
+	bool passed = true;
+	for (int r = 0; r < 2 && passed; r++) {
+		LodMesh* lod = SimplifyMesh(sphere, ratios[r]);
+		TEST_CHECK(lod);
+		int target = (int)(sourceTriangles * ratios[r]), triangles = lod->indexCount / 3;
+		float error = MaxSurfaceError(sphere, lod) / radius;
+		printf("    ratio %.2f: %d -> %d triangles (target %d), %d vertices, max error %.4f of radius\n",
+			ratios[r], sourceTriangles, triangles, target, lod->vertexCount, error);
+		passed = triangles <= target * SIMPLIFY_TEST_SLACK && triangles >= target / 2 && error <= maxErrors[r];
+		passed = passed && CheckLodTriangles(lod);
+		delete lod;
+	}
+	TEST_CHECK(passed);
+
+	// First call simplifies & saves, second must load the same lod
+	remove(SIMPLIFY_TEST_CACHE);
+	LodMesh* made = CreateLodMesh(sphere, LOD_LOW_RATIO, SIMPLIFY_TEST_CACHE);
+	LodMesh* loaded = CreateLodMesh(sphere, LOD_LOW_RATIO, SIMPLIFY_TEST_CACHE);
+	bool same = made && loaded && made->vertexCount == loaded->vertexCount && made->indexCount == loaded->indexCount;
+	for (int i = 0; same && i < made->indexCount; i++)
+		same = made->indices[i] == loaded->indices[i];
+	for (int i = 0; same && i < made->vertexCount; i++)
+		same = made->sourceVertices[i] == loaded->sourceVertices[i];
+	printf("    cache %s: %s\n", SIMPLIFY_TEST_CACHE, same ? "reloaded" : "differs");
+	remove(SIMPLIFY_TEST_CACHE);
+	if (made) delete made;
+	if (loaded) delete loaded;
+	delete sphere;
+	TEST_CHECK(same);
+	return true;
+}
@@ -0,0 +1,166 @@
+#include "test.h"
+#include "../render/streamBuffer.h"
+#include "../render/renderRing.h"
+#include <thread>
+#include <atomic>
+
+#define STREAM_TEST_FLOATS 4096
+#define STREAM_TEST_FRAMES 60
+#define RING_TEST_RECORDS 4096
+#define RING_TEST_FRAMES 300
+
+static const char* AddSource =
+	"#version 430\n"
+	"layout(local_size_x = 64) in;\n"
+	"layout(binding = 1, std430) readonly buffer In { float inData[]; };\n"
+	"layout(binding = 2, std430) buffer Out { float outData[]; };\n"
+	"void main() { uint i = gl_GlobalInvocationID.x; outData[i] += inData[i]; }\n";
+
+// Every record of a frame must carry that frame & its own index, torn frames count as bad
+// Records are read again after a busy loop, so the gpu is still reading when the next frames are culled
+static const char* CheckSource =
+	"#version 430\n"
+	"layout(local_size_x = 64) in;\n"
+	"layout(binding = 1, std430) readonly buffer In { vec4 records[]; };\n"
+	"layout(binding = 2, std430) buffer Out { uint bad; uint checked; };\n"
+	"uniform uint count;\n"
+	"void main() {\n"
+	"	uint i = gl_GlobalInvocationID.x;\n"
+	"	if (i >= count) return;\n"
+	"	vec4 first = records[i * 4];\n"
+	"	float spin = 0.0;\n"
+	"	for (uint k = 0u; k < 256u; k++) spin += records[((i + k) % count) * 4 + 1].x;\n"
+	"	vec4 last = records[i * 4 + 3];\n"
+	"	if (first.x != records[0].x || first.y != float(i) || last.w != first.x || spin < 0.0) atomicAdd(bad, 1u);\n"
+	"	atomicAdd(checked, 1u);\n"
+	"}\n";
+
+static GLuint CreateOutBuffer(uint size) {
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, size, NULL, GL_DYNAMIC_READ);
+	uint zero = 0;
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, buffer);
+	return buffer;
+}
+
+// Same segment is written again every STREAM_SEGMENTS frames, sum is only exact if writer waited for its fence
+static bool TestStreamBuffer(GLuint program) {
+	GLuint out = CreateOutBuffer(STREAM_TEST_FLOATS * sizeof(float));
+	StreamBuffer* stream = new StreamBuffer(GL_SHADER_STORAGE_BUFFER, STREAM_TEST_FLOATS * sizeof(float));
+	glUseProgram(program);
+	for (int f = 0; f < STREAM_TEST_FRAMES; f++) {
+		float* data = (float*)stream->beginWrite();
+		for (int i = 0; i < STREAM_TEST_FLOATS; i++)
+			data[i] = (float)(f + i);
+		stream->endWrite(STREAM_TEST_FLOATS * sizeof(float));
+		stream->bindRange(1, STREAM_TEST_FLOATS * sizeof(float));
+		glDispatchCompute(STREAM_TEST_FLOATS / 64, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+		stream->unbindRange(1);
+		stream->fence();
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, out);
+	float* sums = (float*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, STREAM_TEST_FLOATS * sizeof(float), GL_MAP_READ_BIT);
+	int bad = 0;
+	for (int i = 0; sums && i < STREAM_TEST_FLOATS; i++) {
+		float expect = (float)(STREAM_TEST_FRAMES * i) + STREAM_TEST_FRAMES * (STREAM_TEST_FRAMES - 1) / 2.0f;
+		if (sums[i] != expect) bad++;
+	}
+	glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+	printf("    stream buffer: persistent %d, segment %u bytes, %llu waits, %d of %d sums wrong\n",
+		stream->persistent, stream->segmentSize, (unsigned long long)stream->waitCount, bad, STREAM_TEST_FLOATS);
+	delete stream;
+	glDeleteBuffers(1, &out);
+	TEST_CHECK(sums && bad == 0);
+	TEST_CHECK(glGetError() == GL_NO_ERROR);
+	return true;
+}
+
+// Producer thread fills mapped instance records of ring slots like cull tasks do, render thread checks each frame on gpu
+// A slot handed back while gpu still reads it would show up as torn records
+static bool TestRingFences(GLuint program) {
+	RenderRing* ring = new RenderRing(MIN_RENDER_DEPTH, 100.0f, 200.0f, NULL);
+	for (int i = 0; i < ring->getDepth(); i++) {
+		InstanceStream* stream = new InstanceStream(RING_TEST_RECORDS);
+		stream->createBuffer();
+		ring->get(i)->queues[QUEUE_STATIC]->instanceStream = stream;
+	}
+	GLuint out = CreateOutBuffer(2 * sizeof(uint));
+	glUseProgram(program);
+	GLint countLoc = glGetUniformLocation(program, "count");
+
+	std::atomic<bool> produced(false);
+	std::thread producer([ring, &produced]() {
+		for (int f = 1; f <= RING_TEST_FRAMES; f++) {
+			while (!ring->canWrite()) std::this_thread::yield();
+			InstanceStream* stream = ring->beginWrite()->queues[QUEUE_STATIC]->instanceStream;
+			stream->reset();
+			for (int i = 0; i < RING_TEST_RECORDS; i++) {
+				buff* record = stream->push();
+				if (!record) break;
+				record[0] = (buff)f, record[1] = (buff)i;
+				for (int k = 2; k < INSTANCE_RECORD - 1; k++) record[k] = 0.0;
+				record[INSTANCE_RECORD - 1] = (buff)f;
+			}
+			ring->endWrite();
+		}
+		produced = true;
+	});
+
+	int drawn = 0, mapped = 0, records = 0;
+	while (true) {
+		bool last = produced;
+		Renderable* frame = ring->acquire();
+		if (!frame) {
+			if (last) break;
+			std::this_thread::yield();
+			continue;
+		}
+		InstanceStream* stream = frame->queues[QUEUE_STATIC]->instanceStream;
+		int count = stream->getCount();
+		stream->upload();
+		stream->bindBase(1);
+		glUniform1ui(countLoc, count);
+		glDispatchCompute((count + 63) / 64, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		stream->setFence();
+		mapped += stream->isMapped() ? 1 : 0;
+		records += count;
+		drawn++;
+	}
+	producer.join();
+	glFinish();
+
+	uint result[2] = { 0, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, out);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(result), result);
+	RenderRingStats stats = ring->getStats();
+	printf("    ring: %d frames drawn (%d mapped), %llu dropped, %llu producer stalls, latency avg %.3f ms max %.3f ms\n",
+		drawn, mapped, (unsigned long long)stats.dropped, (unsigned long long)stats.producerStalls, stats.latencyAvg, stats.latencyMax);
+	printf("    ring: %u records checked on gpu, %u torn\n", result[1], result[0]);
+	delete ring;
+	glDeleteBuffers(1, &out);
+	TEST_CHECK(result[0] == 0);
+	TEST_CHECK(result[1] == (uint)records && records == drawn * RING_TEST_RECORDS);
+	TEST_CHECK(stats.published == RING_TEST_FRAMES && stats.consumed + stats.dropped == stats.published);
+	TEST_CHECK(glGetError() == GL_NO_ERROR);
+	return true;
+}
+
+bool TestStreamFences() {
+	if (!CreateTestContext()) return TestSkipped("no GL 4.3 context");
+	GLuint addProgram = CreateTestProgram(AddSource);
+	GLuint checkProgram = CreateTestProgram(CheckSource);
+	bool passed = addProgram && checkProgram;
+	passed = passed && TestStreamBuffer(addProgram);
+	passed = passed && TestRingFences(checkProgram);
+	glUseProgram(0);
+	if (addProgram) glDeleteProgram(addProgram);
+	if (checkProgram) glDeleteProgram(checkProgram);
+	DestroyTestContext();
+	return passed;
+}
@@ -0,0 +1,43 @@
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+
+// Print failed condition & leave test function with false
+#define TEST_CHECK(cond) { if (!(cond)) { printf("    failed at %s:%d: %s\n", __FILE__, __LINE__, #cond); return false; } }
+
+typedef bool (*TestFunc)();
+
+struct TestCase {
+	const char* name;
+	TestFunc func;
+};
+
+// Tests run by testMain, each prints its measurements & returns false on first failed check
+bool TestFrustumCull();
+bool TestBVHSplit();
+bool TestCullTasks();
+bool TestJobGraph();
+bool TestFrameAllocs();
+bool TestProfilerZones();
+bool TestStreamFences();
+bool TestMultiStress();
+bool TestMeshletCull();
+bool TestLodSelect();
+bool TestSimplifyMesh();
+bool TestVertexPack();
+bool TestAnimFiles();
+
+// Mark running test as skipped & return true, testMain then counts it apart from passed ones
+bool TestSkipped(const char* reason);
+
+// Hidden window & GL 4.3 context for gpu tests, they are skipped when it can not be made
+bool CreateTestContext();
+void DestroyTestContext();
+unsigned int CreateTestProgram(const char* source);
+
+// Count operator new calls of any thread between the two
+void StartAllocCount();
+int StopAllocCount();
+
+#endif
@@ -0,0 +1,66 @@
+#include "test.h"
+#include "../benchmark/benchmark.h"
+#include "../mesh/meshCache.h"
+#include "../material/materialManager.h"
+#include <string.h>
+#include <stdlib.h>
+
+static TestCase Tests[] = {
+	{ "frustum", TestFrustumCull },
+	{ "bvh", TestBVHSplit },
+	{ "cull", TestCullTasks },
+	{ "jobs", TestJobGraph },
+	{ "alloc", TestFrameAllocs },
+	{ "pack", TestVertexPack },
+	{ "animfile", TestAnimFiles },
+	{ "stream", TestStreamFences },
+	{ "multi", TestMultiStress },
+	{ "meshlet", TestMeshletCull },
+	{ "lod", TestLodSelect },
+	{ "simplify", TestSimplifyMesh },
+	{ "profiler", TestProfilerZones }, // Last, as profiler stays on
+};
+
+static bool skipped = false;
+
+bool TestSkipped(const char* reason) {
+	printf("    skipped: %s\n", reason);
+	skipped = true;
+	return true;
+}
+
+// Console entry of tests, run from Tiny like the game so assets & shaders are found
+// Without arguments every test runs, otherwise only tests whose names are given
+// -benchmark [frames] runs headless benchmark of tiny.exe -benchmark instead, so it can run from a console
+// -bake obj mtl [vt] builds meshlets of a model offline into its mesh cache
+int main(int argc, char** argv) {
+	if (argc > 1 && strncmp(argv[1], "-benchmark", strlen("-benchmark")) == 0) {
+		const char* frames = argv[1] + strlen("-benchmark");
+		if (!frames[0] && argc > 2) frames = argv[2];
+		return RunBenchmark(atoi(frames));
+	}
+	if (argc > 3 && strcmp(argv[1], "-bake") == 0) {
+		MaterialManager::Init();
+		bool baked = BakeMeshCache(argv[2], argv[3], argc > 4 ? atoi(argv[4]) : 2);
+		MaterialManager::Release();
+		return baked ? 0 : 1;
+	}
+
+	int count = sizeof(Tests) / sizeof(TestCase), run = 0, failed = 0, skips = 0;
+	for (int i = 0; i < count; i++) {
+		bool selected = argc <= 1;
+		for (int a = 1; a < argc && !selected; a++)
+			selected = strcmp(argv[a], Tests[i].name) == 0;
+		if (!selected) continue;
+
+		printf("[%s]\n", Tests[i].name);
+		skipped = false;
+		bool passed = Tests[i].func();
+		printf("[%s] %s\n", Tests[i].name, !passed ? "FAILED" : (skipped ? "SKIPPED" : "passed"));
+		run++;
+		if (!passed) failed++;
+		else if (skipped) skips++;
+	}
+	printf("%d of %d tests passed, %d skipped\n", run - failed - skips, run, skips);
+	return failed;
+}
@@ -47,15 +47,20 @@ Texture2D::Texture2D(uint w,uint h,int t,int p,int c,int filter,bool clampBorder
 	}
 	if (type == TEXTURE_TYPE_DEPTH) format = GL_DEPTH_COMPONENT;
 
+	// Blank data is only made when caller has none to upload
 	void* texData = NULL;
 	texType = GL_UNSIGNED_BYTE;
 	if (precision < FLOAT_PRE) {
-		texData = malloc((width*height*channel)*sizeof(byte));
-		memset(texData, 255, (width*height*channel)*sizeof(byte));
+		if (!initData) {
+			texData = malloc((width*height*channel)*sizeof(byte));
+			memset(texData, 255, (width*height*channel)*sizeof(byte));
+		}
 		texType = GL_UNSIGNED_BYTE;
 	} else {
-		texData = malloc((width*height*channel)*sizeof(float));
-		memset(texData, 0, (width*height*channel)*sizeof(float));
+		if (!initData) {
+			texData = malloc((width*height*channel)*sizeof(float));
+			memset(texData, 0, (width*height*channel)*sizeof(float));
+		}
 		texType = GL_FLOAT;
 	}
 	depthType = precision > HIGH_PRE ? GL_FLOAT : GL_UNSIGNED_BYTE;
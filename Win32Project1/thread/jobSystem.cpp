@@ -0,0 +1,156 @@
+#include "jobSystem.h"
+#include <assert.h>
+using namespace std;
+
+JobSystem* JobSystem::jobSystem = NULL;
+
+static thread_local int CurrentQueue = 0;
+
+void JobSystem::Init(int workerCount) {
+	if (!JobSystem::jobSystem) {
+		if (workerCount < 0) workerCount = DefaultWorkerCount();
+		JobSystem::jobSystem = new JobSystem(workerCount);
+	}
+}
+
+void JobSystem::Release() {
+	if (JobSystem::jobSystem) delete JobSystem::jobSystem;
+	JobSystem::jobSystem = NULL;
+}
+
+int JobSystem::DefaultWorkerCount() {
+	int cores = (int)thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 1; // Render thread keeps its own core
+}
+
+JobSystem::JobSystem(int workerCount) {
+	queued = 0;
+	exiting = false;
+	for (int i = 0; i <= workerCount; i++)
+		queues.push_back(new WorkQueue());
+	for (int i = 1; i <= workerCount; i++)
+		workers.push_back(new thread(&JobSystem::workerRun, this, i));
+}
+
+JobSystem::~JobSystem() {
+	{
+		unique_lock<mutex> lock(sleepMutex);
+		exiting = true;
+	}
+	sleepCond.notify_all();
+	for (int i = 0; i < getWorkerCount(); i++) {
+		workers[i]->join();
+		delete workers[i];
+	}
+	workers.clear();
+	for (int i = 0; i < (int)queues.size(); i++)
+		delete queues[i];
+	queues.clear();
+}
+
+void JobSystem::workerRun(int index) {
+	CurrentQueue = index;
+	int idle = 0;
+	while (!exiting) {
+		if (runOne()) {
+			idle = 0;
+			continue;
+		}
+		if (++idle < JOB_SPIN_COUNT) {
+			this_thread::yield();
+			continue;
+		}
+		unique_lock<mutex> lock(sleepMutex);
+		while (!exiting && queued.load() == 0)
+			sleepCond.wait(lock);
+		idle = 0;
+	}
+}
+
+void JobSystem::push(Job* job) {
+	WorkQueue* queue = queues[CurrentQueue];
+	{
+		unique_lock<mutex> lock(queue->lock);
+		if (!queue->full()) {
+			queue->pushBack(job);
+			job = NULL;
+		}
+	}
+	if (job) { // Queue is full, run it now
+		execute(job);
+		return;
+	}
+	{
+		unique_lock<mutex> lock(sleepMutex); // Sleeping worker must see queued changed
+		queued++;
+	}
+	sleepCond.notify_one();
+}
+
+// Pop newest job from own queue, or steal oldest job from others
+Job* JobSystem::fetch(int index) {
+	Job* job = NULL;
+	int count = (int)queues.size();
+	for (int i = 0; i < count && !job; i++) {
+		WorkQueue* queue = queues[(index + i) % count];
+		unique_lock<mutex> lock(queue->lock);
+		if (queue->empty()) continue;
+		job = i == 0 ? queue->popBack() : queue->popFront();
+	}
+	if (job) queued--;
+	return job;
+}
+
+void JobSystem::execute(Job* job) {
+	job->func(job->param);
+
+	// Job may be released by its waiter once done is set, so successors are copied first
+	Job* successors[MAX_JOB_SUCCESSORS];
+	int successorCount = job->successorCount;
+	for (int i = 0; i < successorCount; i++)
+		successors[i] = job->successors[i];
+	job->done.store(true, memory_order_release);
+
+	for (int i = 0; i < successorCount; i++) {
+		if (successors[i]->dependencies.fetch_sub(1) == 1)
+			push(successors[i]);
+	}
+}
+
+bool JobSystem::runOne() {
+	Job* job = fetch(CurrentQueue);
+	if (!job) return false;
+	execute(job);
+	return true;
+}
+
+void JobSystem::prepare(Job* job, JobFunc func, void* param) {
+	job->func = func;
+	job->param = param;
+	job->dependencies = 1;
+	job->done = false;
+	job->successorCount = 0;
+}
+
+// Must be called before prerequisite is submitted
+// Return false without adding the edge when prerequisite has MAX_JOB_SUCCESSORS successors already,
+// caller must not submit the graph then, as job could run before prerequisite
+bool JobSystem::depend(Job* job, Job* prerequisite) {
+	assert(prerequisite->successorCount < MAX_JOB_SUCCESSORS);
+	if (prerequisite->successorCount >= MAX_JOB_SUCCESSORS) return false;
+	job->dependencies++;
+	prerequisite->successors[prerequisite->successorCount++] = job;
+	return true;
+}
+
+void JobSystem::submit(Job* job) {
+	if (job->dependencies.fetch_sub(1) == 1)
+		push(job);
+}
+
+// Help running jobs until job finished
+void JobSystem::wait(Job* job) {
+	while (!finished(job)) {
+		if (!runOne()) this_thread::yield();
+	}
+}
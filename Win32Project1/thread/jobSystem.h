@@ -0,0 +1,73 @@
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#define MAX_JOB_SUCCESSORS 8
+#define JOB_SPIN_COUNT 64
+#define JOB_QUEUE_SIZE 1024
+
+typedef void (*JobFunc)(void* param);
+
+// Job storage is owned by caller and must live until job finished
+// Build a graph with JobSystem::prepare & depend, then submit every job of it
+struct Job {
+	JobFunc func;
+	void* param;
+	std::atomic<int> dependencies; // Unfinished prerequisites, plus 1 until submitted
+	std::atomic<bool> done;
+	Job* successors[MAX_JOB_SUCCESSORS];
+	int successorCount;
+};
+
+// Fixed size deque, owner works at tail and thieves at head, so scheduling never allocates
+struct WorkQueue {
+	std::mutex lock;
+	Job* jobs[JOB_QUEUE_SIZE];
+	int head, tail;
+	WorkQueue() :head(0), tail(0) {}
+	bool empty() { return head == tail; }
+	bool full() { return tail - head >= JOB_QUEUE_SIZE; }
+	void pushBack(Job* job) { jobs[(tail++) % JOB_QUEUE_SIZE] = job; }
+	Job* popBack() { Job* job = jobs[(--tail) % JOB_QUEUE_SIZE]; rewind(); return job; }
+	Job* popFront() { Job* job = jobs[(head++) % JOB_QUEUE_SIZE]; rewind(); return job; }
+	void rewind() { if (head == tail) head = tail = 0; }
+};
+
+// Work stealing job system, each worker owns a deque, pops its newest job and steals oldest jobs of others
+// Queue 0 belongs to threads outside of the system (main & render thread), they run jobs only in wait()
+class JobSystem {
+public:
+	static JobSystem* jobSystem;
+	static void Init(int workerCount);
+	static void Release();
+private:
+	std::vector<std::thread*> workers;
+	std::vector<WorkQueue*> queues;
+	std::mutex sleepMutex;
+	std::condition_variable sleepCond;
+	std::atomic<int> queued;
+	std::atomic<bool> exiting;
+private:
+	JobSystem(int workerCount);
+	~JobSystem();
+	void workerRun(int index);
+	void push(Job* job);
+	Job* fetch(int index);
+	void execute(Job* job);
+	bool runOne();
+public:
+	void prepare(Job* job, JobFunc func, void* param);
+	bool depend(Job* job, Job* prerequisite);
+	void submit(Job* job);
+	void wait(Job* job);
+	bool finished(Job* job) { return job->done.load(std::memory_order_acquire); }
+	int getWorkerCount() { return (int)workers.size(); }
+	static int DefaultWorkerCount();
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "frameArena.h"
+
+FrameArena::FrameArena() {
+	chunks.clear();
+	current = -1;
+	offset = 0;
+	used = 0, peak = 0;
+}
+
+FrameArena::~FrameArena() {
+	for (unsigned int i = 0; i < chunks.size(); i++)
+		free(chunks[i].data);
+	chunks.clear();
+}
+
+// Move to next chunk which can hold size bytes, create one if needed
+void FrameArena::nextChunk(size_t size) {
+	for (int i = current + 1; i < (int)chunks.size(); i++) {
+		if (chunks[i].size >= size) {
+			// Skipped small chunks are moved behind, they will be tried again after reset
+			ArenaChunk chunk = chunks[i];
+			chunks.erase(chunks.begin() + i);
+			chunks.insert(chunks.begin() + current + 1, chunk);
+			current++;
+			offset = 0;
+			return;
+		}
+	}
+
+	ArenaChunk chunk;
+	chunk.size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+	chunk.data = (char*)malloc(chunk.size);
+	chunks.insert(chunks.begin() + current + 1, chunk);
+	current++;
+	offset = 0;
+}
+
+void* FrameArena::alloc(size_t size) {
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+	if (current < 0 || offset + size > chunks[current].size)
+		nextChunk(size);
+	void* ptr = chunks[current].data + offset;
+	offset += size;
+	used += size;
+	if (used > peak) peak = used;
+	return ptr;
+}
+
+void FrameArena::reset() {
+	current = chunks.size() > 0 ? 0 : -1;
+	offset = 0;
+	used = 0;
+}
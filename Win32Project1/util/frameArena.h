@@ -0,0 +1,36 @@
+#ifndef FRAME_ARENA_H_
+#define FRAME_ARENA_H_
+
+#include <vector>
+#include <stdlib.h>
+
+#define ARENA_CHUNK_SIZE (64 * 1024)
+#define ARENA_ALIGN 16
+
+struct ArenaChunk {
+	char* data;
+	size_t size;
+};
+
+// Linear allocator for data which lives only one frame
+// reset() is O(1), chunks are kept for next frames, so steady frames do no heap allocation
+class FrameArena {
+private:
+	std::vector<ArenaChunk> chunks;
+	int current;
+	size_t offset;
+	size_t used, peak;
+private:
+	void nextChunk(size_t size);
+public:
+	FrameArena();
+	~FrameArena();
+	void* alloc(size_t size);
+	template<typename T> T* allocArray(int count) { return (T*)alloc(count * sizeof(T)); }
+	void reset();
+	size_t getUsed() { return used; }
+	size_t getPeak() { return peak; }
+	int getChunkCount() { return (int)chunks.size(); }
+};
+
+#endif
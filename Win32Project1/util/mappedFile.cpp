@@ -0,0 +1,78 @@
+#include "mappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {
+	fileHandle = NULL;
+	mapHandle = NULL;
+	data = NULL;
+	size = 0;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const char* path) {
+	close();
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : NULL;
+	if (!view) {
+		if (mapping) CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	mapHandle = mapping;
+	data = (char*)view;
+	size = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void MappedFile::close() {
+	if (data) UnmapViewOfFile(data);
+	if (mapHandle) CloseHandle((HANDLE)mapHandle);
+	if (fileHandle) CloseHandle((HANDLE)fileHandle);
+	fileHandle = NULL;
+	mapHandle = NULL;
+	data = NULL;
+	size = 0;
+}
+#else
+bool MappedFile::open(const char* path) {
+	close();
+	int file = ::open(path, O_RDONLY);
+	if (file < 0) return false;
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size <= 0) {
+		::close(file);
+		return false;
+	}
+	void* view = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (view == MAP_FAILED) return false;
+	data = (char*)view;
+	size = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::close() {
+	if (data) munmap(data, size);
+	data = NULL;
+	size = 0;
+}
+#endif
@@ -0,0 +1,21 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <stdlib.h>
+
+// Read only file view, pages are copy on write so callers may patch data in place
+class MappedFile {
+private:
+	void* fileHandle;
+	void* mapHandle;
+public:
+	char* data;
+	size_t size;
+public:
+	MappedFile();
+	~MappedFile();
+	bool open(const char* path);
+	void close();
+};
+
+#endif
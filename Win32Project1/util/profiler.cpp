@@ -0,0 +1,227 @@
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_RDTSC
+#endif
+
+Profiler* Profiler::profiler = NULL;
+
+static thread_local ProfileRing* CurrentRing = NULL;
+static thread_local Profiler* RingOwner = NULL;
+
+static double SteadyUs() {
+	return chrono::duration<double, micro>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::Init() {
+	if (!Profiler::profiler) Profiler::profiler = new Profiler();
+}
+
+void Profiler::Release() {
+	if (Profiler::profiler) delete Profiler::profiler;
+	Profiler::profiler = NULL;
+}
+
+u64 Profiler::Now() {
+#ifdef PROFILE_RDTSC
+	return __rdtsc();
+#else
+	return (u64)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+Profiler::Profiler() {
+	rings.clear();
+	zones.clear();
+	baseTick = Now();
+	baseTime = SteadyUs();
+	frames = 0;
+}
+
+Profiler::~Profiler() {
+	printSummary();
+	if (writeTrace(PROFILE_TRACE_FILE)) printf("Profile trace saved to %s\n", PROFILE_TRACE_FILE);
+
+	for (uint i = 0; i < rings.size(); i++)
+		delete rings[i];
+	rings.clear();
+	map<string, ProfileZone*>::iterator it = zones.begin();
+	for (; it != zones.end(); it++)
+		delete it->second;
+	zones.clear();
+	zoneIds.clear();
+}
+
+ProfileRing* Profiler::getRing() {
+	if (CurrentRing && RingOwner == this) return CurrentRing;
+	ProfileRing* ring = new ProfileRing();
+	ring->written = 0;
+	ring->collected = 0;
+	{
+		unique_lock<mutex> lock(ringLock);
+		ring->threadId = (int)rings.size();
+		rings.push_back(ring);
+	}
+	CurrentRing = ring;
+	RingOwner = this;
+	return ring;
+}
+
+// Tick rate is measured over whole profiler lifetime, so no calibration wait at startup
+double Profiler::tickToUs(u64 tick) {
+	double elapsedUs = SteadyUs() - baseTime;
+	u64 elapsedTick = Now() - baseTick;
+	if (elapsedTick == 0 || elapsedUs <= 0) return 0;
+	return (double)tick * elapsedUs / (double)elapsedTick;
+}
+
+void Profiler::record(const char* name, u64 start, u64 end) {
+	if (start < baseTick) return; // Zone began before profiler inited
+	ProfileRing* ring = getRing();
+	u64 index = ring->written.load(memory_order_relaxed);
+	ProfileEvent* event = &ring->events[index % PROFILE_RING_SIZE];
+	event->name = name;
+	event->start = start;
+	event->end = end;
+	ring->written.store(index + 1, memory_order_release);
+}
+
+void Profiler::frame() {
+	double usPerTick = tickToUs(1000000) / 1000000.0;
+	unique_lock<mutex> lock(ringLock);
+	for (uint r = 0; r < rings.size(); r++) {
+		ProfileRing* ring = rings[r];
+		u64 written = ring->written.load(memory_order_acquire);
+		u64 from = ring->collected;
+		// Slot of written may already be filling, so only SIZE - 1 older events are safe
+		if (written - from >= PROFILE_RING_SIZE) from = written - PROFILE_RING_SIZE + 1;
+		for (u64 i = from; i < written; i++) {
+			ProfileEvent event = ring->events[i % PROFILE_RING_SIZE];
+			if (ring->written.load(memory_order_acquire) - i >= PROFILE_RING_SIZE) continue; // Overwritten while reading
+
+			// Names are looked up as strings only first time a pointer is seen
+			map<const char*, ProfileZone*>::iterator it = zoneIds.find(event.name);
+			ProfileZone* zone = NULL;
+			if (it == zoneIds.end()) {
+				map<string, ProfileZone*>::iterator named = zones.find(event.name);
+				if (named == zones.end()) {
+					zone = new ProfileZone();
+					zone->name = event.name;
+					zone->count = 0;
+					zone->next = 0;
+					zones[zone->name] = zone;
+				} else
+					zone = named->second;
+				zoneIds[event.name] = zone;
+			} else
+				zone = it->second;
+			zone->samples[zone->next] = (float)((event.end - event.start) * usPerTick * 0.001);
+			zone->next = (zone->next + 1) % PROFILE_HISTORY;
+			if (zone->count < PROFILE_HISTORY) zone->count++;
+		}
+		ring->collected = written;
+	}
+	lock.unlock();
+
+	if (++frames % PROFILE_REPORT_FRAMES == 0) printSummary();
+}
+
+void Profiler::setCounter(const char* name, double value) {
+	unique_lock<mutex> lock(ringLock);
+	for (uint i = 0; i < counters.size(); i++) {
+		if (counters[i].name == name) {
+			counters[i].value = value;
+			return;
+		}
+	}
+	ProfileCounter counter;
+	counter.name = name;
+	counter.value = value;
+	counters.push_back(counter);
+}
+
+void Profiler::getStats(vector<ProfileStat>& stats) {
+	stats.clear();
+	float sorted[PROFILE_HISTORY];
+	map<string, ProfileZone*>::iterator it = zones.begin();
+	for (; it != zones.end(); it++) {
+		ProfileZone* zone = it->second;
+		if (zone->count <= 0) continue;
+		memcpy(sorted, zone->samples, zone->count * sizeof(float));
+		std::sort(sorted, sorted + zone->count);
+		float sum = 0;
+		for (int i = 0; i < zone->count; i++)
+			sum += sorted[i];
+		int p99 = (zone->count * 99 + 99) / 100 - 1;
+
+		ProfileStat stat;
+		stat.name = zone->name.c_str();
+		stat.minTime = sorted[0];
+		stat.avgTime = sum / zone->count;
+		stat.p99Time = sorted[p99];
+		stat.count = zone->count;
+		stats.push_back(stat);
+	}
+}
+
+void Profiler::printSummary() {
+	vector<ProfileStat> stats;
+	getStats(stats);
+	if (stats.size() > 0) {
+		printf("%-32s %10s %10s %10s %6s\n", "zone", "min(ms)", "avg(ms)", "p99(ms)", "count");
+		for (uint i = 0; i < stats.size(); i++) {
+			ProfileStat& stat = stats[i];
+			printf("%-32s %10.3f %10.3f %10.3f %6d\n", stat.name, stat.minTime, stat.avgTime, stat.p99Time, stat.count);
+		}
+	}
+	unique_lock<mutex> lock(ringLock);
+	for (uint i = 0; i < counters.size(); i++)
+		printf("%-32s %10.3f\n", counters[i].name, counters[i].value);
+}
+
+// Chrome trace event format, open it in chrome://tracing or Perfetto
+bool Profiler::writeTrace(const char* path) {
+	FILE* file = fopen(path, "w");
+	if (!file) return false;
+	double usPerTick = tickToUs(1000000) / 1000000.0;
+
+	unique_lock<mutex> lock(ringLock);
+	fprintf(file, "{\"traceEvents\":[\n");
+	bool first = true;
+	for (uint r = 0; r < rings.size(); r++) {
+		ProfileRing* ring = rings[r];
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+			first ? "" : ",\n", ring->threadId, ring->threadId);
+		first = false;
+
+		u64 written = ring->written.load(memory_order_acquire);
+		u64 from = written >= PROFILE_RING_SIZE ? written - PROFILE_RING_SIZE + 1 : 0;
+		for (u64 i = from; i < written; i++) {
+			ProfileEvent event = ring->events[i % PROFILE_RING_SIZE];
+			if (ring->written.load(memory_order_acquire) - i >= PROFILE_RING_SIZE) continue;
+			double ts = (double)(event.start - baseTick) * usPerTick;
+			double dur = (double)(event.end - event.start) * usPerTick;
+			fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				event.name, ring->threadId, ts, dur);
+		}
+	}
+	// Counters have only their latest value, it is put at the end of trace
+	double now = (double)(Now() - baseTick) * usPerTick;
+	for (uint i = 0; i < counters.size(); i++) {
+		fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"C\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"args\":{\"value\":%.3f}}",
+			first ? "" : ",\n", counters[i].name, now, counters[i].value);
+		first = false;
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
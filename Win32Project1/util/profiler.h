@@ -0,0 +1,104 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include "../constants/constants.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include <atomic>
+
+// Comment it out to compile all profile zones away
+#define PROFILE_ENABLE
+
+#define PROFILE_RING_SIZE 16384 // Events kept per thread, older ones are overwritten
+#define PROFILE_HISTORY 256 // Samples kept per zone for rolling stats
+#define PROFILE_REPORT_FRAMES 600
+#define PROFILE_TRACE_FILE "profile.json"
+
+struct ProfileEvent {
+	const char* name; // Must live as long as profiler, usually a string literal
+	u64 start, end;
+};
+
+// Single writer ring of one thread, read by collect & writeTrace
+struct ProfileRing {
+	ProfileEvent events[PROFILE_RING_SIZE];
+	std::atomic<u64> written;
+	u64 collected;
+	int threadId;
+};
+
+struct ProfileZone {
+	std::string name;
+	float samples[PROFILE_HISTORY]; // Durations in ms
+	int count, next;
+};
+
+// Latest value of a named count, set from outside zones
+struct ProfileCounter {
+	const char* name; // Must live as long as profiler like event names
+	double value;
+};
+
+struct ProfileStat {
+	const char* name;
+	float minTime, avgTime, p99Time;
+	int count;
+};
+
+// Scoped timer profiler, each thread records into its own ring without lock
+// Ticks come from rdtsc when available and are converted to time with steady_clock
+class Profiler {
+public:
+	static Profiler* profiler;
+	static void Init();
+	static void Release();
+	static u64 Now();
+private:
+	std::vector<ProfileRing*> rings;
+	std::map<std::string, ProfileZone*> zones;
+	std::map<const char*, ProfileZone*> zoneIds; // By name pointer, a name may have a pointer in each module
+	std::vector<ProfileCounter> counters;
+	std::mutex ringLock;
+	u64 baseTick;
+	double baseTime;
+	int frames;
+private:
+	Profiler();
+	~Profiler();
+	ProfileRing* getRing();
+	double tickToUs(u64 tick);
+public:
+	void record(const char* name, u64 start, u64 end);
+	void frame(); // Collect new events to zones, call once per frame on render thread
+	void setCounter(const char* name, double value);
+	void getStats(std::vector<ProfileStat>& stats);
+	void printSummary();
+	bool writeTrace(const char* path);
+};
+
+struct ProfileScope {
+	const char* name;
+	u64 start;
+	ProfileScope(const char* zone) {
+		name = zone;
+		start = Profiler::profiler ? Profiler::Now() : 0;
+	}
+	~ProfileScope() {
+		if (Profiler::profiler) Profiler::profiler->record(name, start, Profiler::Now());
+	}
+};
+
+#define PROFILE_JOIN2(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN2(a, b)
+
+#ifdef PROFILE_ENABLE
+#define PROFILE_ZONE(name) ProfileScope PROFILE_JOIN(profileScope, __LINE__)(name)
+#define PROFILE_FRAME() if (Profiler::profiler) Profiler::profiler->frame()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_FRAME()
+#endif
+
+#endif
@@ -411,6 +411,11 @@ struct ConfigArg {
 	bool dynsky;
 	bool cartoon;
 	bool debug;
+	int workers;
+	int renderDepth;
+	bool profile;
+	bool headless;
+	bool gpulod;
 };
 
 #define MIN_VAL 1.175494351e-38f